@@ -901,6 +901,17 @@ macro(CheckPTHREAD)
         endif()
       endif()
 
+      if(PTHREADS_FUTEX)
+        check_c_source_compiles("
+            #include <linux/futex.h>
+            #include <sys/syscall.h>
+            #include <unistd.h>
+            int main(int argc, char **argv) {
+                int word = 0;
+                return (int)syscall(SYS_futex, &word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+            }" HAVE_PTHREADS_FUTEX)
+      endif()
+
       check_c_source_compiles("
           #include <pthread.h>
           #include <pthread_np.h>
@@ -910,16 +921,25 @@ macro(CheckPTHREAD)
 
       set(SOURCE_FILES ${SOURCE_FILES}
           ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_systhread.c
-          ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_sysmutex.c   # Can be faked, if necessary
-          ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_syscond.c    # Can be faked, if necessary
           ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_systls.c
           )
-      if(HAVE_PTHREADS_SEM)
+      if(HAVE_PTHREADS_FUTEX)
+        # Threads still come from pthreads, the sync primitives don't
         set(SOURCE_FILES ${SOURCE_FILES}
-            ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_syssem.c)
+            ${SDL2_SOURCE_DIR}/src/thread/futex/SDL_sysmutex.c
+            ${SDL2_SOURCE_DIR}/src/thread/futex/SDL_syscond.c
+            ${SDL2_SOURCE_DIR}/src/thread/futex/SDL_syssem.c)
       else()
         set(SOURCE_FILES ${SOURCE_FILES}
-            ${SDL2_SOURCE_DIR}/src/thread/generic/SDL_syssem.c)
+            ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_sysmutex.c   # Can be faked, if necessary
+            ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_syscond.c)   # Can be faked, if necessary
+        if(HAVE_PTHREADS_SEM)
+          set(SOURCE_FILES ${SOURCE_FILES}
+              ${SDL2_SOURCE_DIR}/src/thread/pthread/SDL_syssem.c)
+        else()
+          set(SOURCE_FILES ${SOURCE_FILES}
+              ${SDL2_SOURCE_DIR}/src/thread/generic/SDL_syssem.c)
+        endif()
       endif()
       set(HAVE_SDL_THREADS TRUE)
     endif()
@@ -43,6 +43,7 @@
 #include "SDL_gamecontroller.h"
 #include "SDL_haptic.h"
 #include "SDL_hints.h"
+#include "SDL_jobs.h"
 #include "SDL_joystick.h"
 #include "SDL_loadso.h"
 #include "SDL_log.h"
@@ -57,6 +58,7 @@
 #include "SDL_system.h"
 #include "SDL_thread.h"
 #include "SDL_timer.h"
+#include "SDL_trace.h"
 #include "SDL_version.h"
 #include "SDL_video.h"
 
@@ -425,6 +425,7 @@ extern DECLSPEC void SDLCALL SDL_PauseAudioDevice(SDL_AudioDeviceID dev,
  *  Loading a WAVE file requires \c src, \c spec, \c audio_buf and \c audio_len
  *  to be valid pointers. The entire data portion of the file is then loaded
  *  into memory and decoded if necessary.
+ *  SDL_OpenWAVDecoder_RW() decodes it a piece at a time instead.
  *
  *  If \c freesrc is non-zero, the data source gets automatically closed and
  *  freed before the function returns.
@@ -646,6 +647,100 @@ extern DECLSPEC void SDLCALL SDL_AudioStreamClear(SDL_AudioStream *stream);
  */
 extern DECLSPEC void SDLCALL SDL_FreeAudioStream(SDL_AudioStream *stream);
 
+/* SDL_WAVDecoder decodes a WAVE file a few thousand sample frames at a time,
+   instead of loading all of it like SDL_LoadWAV_RW() does. */
+/* this is opaque to the outside world. */
+struct SDL_WAVDecoder;
+typedef struct SDL_WAVDecoder SDL_WAVDecoder;
+
+/**
+ *  Flag for SDL_OpenWAVDecoder_RW(): read and decode the next batch of
+ *  sample frames on the job worker threads while the current one is used.
+ */
+#define SDL_WAV_DECODE_THREADED 0x00000001
+
+/**
+ *  Open a WAVE file for incremental decoding.
+ *
+ *  This reads the headers of the file, but none of its audio data. The
+ *  formats, hints and \c spec are the same as with SDL_LoadWAV_RW(), so
+ *  the decoded audio matches what it would return.
+ *
+ *  The data source must support seeking and must not be used by anyone
+ *  else until the decoder is closed.
+ *
+ *  \param src     The data source with the WAVE data.
+ *  \param freesrc Non-zero to close the data source with the decoder, or
+ *                 right away if this function fails.
+ *  \param spec    A pointer filled with the audio format of the decoded audio.
+ *  \param flags   0, or ::SDL_WAV_DECODE_THREADED.
+ *  \return The new decoder, or NULL on error.
+ *
+ *  \sa SDL_DecodeWAV
+ *  \sa SDL_DecodeWAVToStream
+ *  \sa SDL_SeekWAVDecoder
+ *  \sa SDL_CloseWAVDecoder
+ */
+extern DECLSPEC SDL_WAVDecoder *SDLCALL SDL_OpenWAVDecoder_RW(SDL_RWops * src,
+                                                              int freesrc,
+                                                              SDL_AudioSpec * spec,
+                                                              Uint32 flags);
+
+/**
+ *  Decode the next sample frames of a WAVE file into a buffer.
+ *
+ *  \param decoder The decoder.
+ *  \param buf     The buffer to fill.
+ *  \param len     The size of \c buf in bytes. Only whole sample frames
+ *                 are written.
+ *  \return The number of bytes written, 0 at the end of the audio data,
+ *          or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_DecodeWAV(SDL_WAVDecoder *decoder, void *buf, int len);
+
+/**
+ *  Decode the next sample frames of a WAVE file into an audio stream.
+ *
+ *  The decoded audio is put straight from the decoder's buffers, so
+ *  \c stream must have been created with the format, channels and rate
+ *  from the decoder's spec as its source.
+ *
+ *  \param decoder The decoder.
+ *  \param stream  The stream to put the audio into.
+ *  \param len     The most bytes of decoded audio to put.
+ *  \return The number of bytes put, 0 at the end of the audio data, or -1
+ *          on error.
+ */
+extern DECLSPEC int SDLCALL SDL_DecodeWAVToStream(SDL_WAVDecoder *decoder, SDL_AudioStream *stream, int len);
+
+/**
+ *  Move the decoder to a sample frame.
+ *
+ *  Seeking within the sample frames decoded last is free. Otherwise the
+ *  decoder starts again at the ADPCM block holding \c frame.
+ *
+ *  \param decoder The decoder.
+ *  \param frame   The sample frame to decode next, from 0 up to
+ *                 SDL_GetWAVDecoderLength().
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_SeekWAVDecoder(SDL_WAVDecoder *decoder, Sint64 frame);
+
+/**
+ *  Get the sample frame the decoder returns next.
+ */
+extern DECLSPEC Sint64 SDLCALL SDL_TellWAVDecoder(SDL_WAVDecoder *decoder);
+
+/**
+ *  Get the number of sample frames in the WAVE file.
+ */
+extern DECLSPEC Sint64 SDLCALL SDL_GetWAVDecoderLength(SDL_WAVDecoder *decoder);
+
+/**
+ *  Close a decoder and, if it was opened with \c freesrc, its data source.
+ */
+extern DECLSPEC void SDLCALL SDL_CloseWAVDecoder(SDL_WAVDecoder *decoder);
+
 #define SDL_MIX_MAXVOLUME 128
 /**
  *  This takes two audio buffers of the playing audio format and mixes
@@ -667,6 +762,40 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
                                                 SDL_AudioFormat format,
                                                 Uint32 len, int volume);
 
+/**
+ *  Flag for SDL_MixAudioSources(): compress peaks with a soft knee instead
+ *  of hard clipping them. Samples below -2.5 dBFS pass through unchanged.
+ */
+#define SDL_MIX_SOFTCLIP 0x00000001
+
+/**
+ *  Mix several audio buffers of the same format into \c dst at once.
+ *
+ *  The contents of \c dst and each of the \c num_srcs buffers in \c srcs,
+ *  scaled by the matching entry in \c volumes (0 - ::SDL_MIX_MAXVOLUME),
+ *  are summed in floating point and clipped once when the result is stored.
+ *  This is both faster and cleaner than calling SDL_MixAudioFormat() once
+ *  per buffer, which clips after every addition. Float results are clipped
+ *  to -1.0 - 1.0.
+ *
+ *  \param dst       The buffer to mix into, \c len bytes long.
+ *  \param srcs      The buffers to mix, each \c len bytes long.
+ *  \param volumes   A volume for each buffer, or NULL for ::SDL_MIX_MAXVOLUME.
+ *  \param num_srcs  The number of buffers in \c srcs.
+ *  \param format    The format of \c dst and all of \c srcs.
+ *  \param len       The length of each buffer in bytes.
+ *  \param flags     0, or ::SDL_MIX_SOFTCLIP.
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_MixAudioFormat
+ */
+extern DECLSPEC int SDLCALL SDL_MixAudioSources(Uint8 * dst,
+                                                const Uint8 * const * srcs,
+                                                const int * volumes,
+                                                int num_srcs,
+                                                SDL_AudioFormat format,
+                                                Uint32 len, Uint32 flags);
+
 /**
  *  Queue more audio on non-callback devices.
  *
@@ -226,6 +226,9 @@
 /* SDL internal assertion support */
 #cmakedefine SDL_DEFAULT_ASSERT_LEVEL @SDL_DEFAULT_ASSERT_LEVEL@
 
+/* Record contention statistics for SDL_GetLockStats() */
+#cmakedefine SDL_LOCK_PROFILING @SDL_LOCK_PROFILING@
+
 /* Allow disabling of core subsystems */
 #cmakedefine SDL_ATOMIC_DISABLED @SDL_ATOMIC_DISABLED@
 #cmakedefine SDL_AUDIO_DISABLED @SDL_AUDIO_DISABLED@
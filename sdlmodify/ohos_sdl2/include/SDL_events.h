@@ -697,6 +697,18 @@ extern DECLSPEC int SDLCALL SDL_WaitEventTimeout(SDL_Event * event,
  */
 extern DECLSPEC int SDLCALL SDL_PushEvent(SDL_Event * event);
 
+/**
+ *  \brief Add several events to the event queue at once.
+ *
+ *  Each event goes through the event filter and watchers like with
+ *  SDL_PushEvent(). The events that pass are queued together, in order,
+ *  at a fraction of the cost of pushing them one by one.
+ *
+ *  \return The number of events queued, or -1 if none could be queued
+ *          because the event queue was full or there was some other error.
+ */
+extern DECLSPEC int SDLCALL SDL_PushEvents(SDL_Event * events, int numevents);
+
 typedef int (SDLCALL * SDL_EventFilter) (void *userdata, SDL_Event * event);
 
 /**
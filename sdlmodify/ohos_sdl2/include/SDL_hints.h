@@ -135,7 +135,7 @@ extern "C" {
  *
  *  This variable can be set to the following values:
  *    "0" or "nearest" - Nearest pixel sampling
- *    "1" or "linear"  - Linear filtering (supported by OpenGL and Direct3D)
+ *    "1" or "linear"  - Linear filtering (supported by OpenGL, Direct3D and the software renderer)
  *    "2" or "best"    - Currently this is the same as "linear"
  *
  *  By default nearest pixel sampling is used
@@ -153,6 +153,20 @@ extern "C" {
  */
 #define SDL_HINT_RENDER_VSYNC               "SDL_RENDER_VSYNC"
 
+/**
+ *  \brief  A variable controlling whether the software renderer draws large batches on the job worker threads.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Draw everything on the thread calling the render functions
+ *    "1"       - Split clears, fills, points and unscaled copies into bands of rows drawn in parallel
+ *
+ *  By default the bands are drawn in parallel. The output is the same either way.
+ *  The value is read when the renderer is created.
+ *
+ *  \sa SDL_HINT_JOB_THREADS
+ */
+#define SDL_HINT_RENDER_SOFTWARE_TILED      "SDL_RENDER_SOFTWARE_TILED"
+
 /**
  *  \brief  A variable controlling whether the screensaver is enabled. 
  *
@@ -979,6 +993,51 @@ extern "C" {
  */
 #define SDL_HINT_OHOS_BLOCK_ON_PAUSE "SDL_OHOS_BLOCK_ON_PAUSE"
 
+/**
+ * \brief A variable controlling how many audio periods are queued between the mixer and the OHOS renderer.
+ *
+ * Fewer periods give lower output latency, more periods ride out longer stalls of the
+ * audio thread without audible dropouts. The variable can be set to a number between
+ * "1" and "16"; the default is "3".
+ *
+ * The value should be set before the audio device is opened.
+ */
+#define SDL_HINT_OHOS_AUDIO_PERIODS "SDL_OHOS_AUDIO_PERIODS"
+
+/**
+ * \brief A variable controlling whether OHOS rawfile assets are memory mapped when opened.
+ *
+ * The variable can be set to the following values:
+ *   "0"       - Read assets through the resource manager.
+ *   "1"       - Map the asset read-only, reads and seeks become memory accesses. (default)
+ *
+ * Mapped assets expose their contents through SDL_OHOSGetRWopsData().
+ */
+#define SDL_HINT_OHOS_RAWFILE_MMAP "SDL_OHOS_RAWFILE_MMAP"
+
+/**
+ * \brief A variable controlling the number of I/O threads used by SDL_RWReadAsync().
+ *
+ * The default is "2". The value is read when the first asynchronous read is submitted.
+ */
+#define SDL_HINT_RWASYNC_THREADS "SDL_RWASYNC_THREADS"
+
+/**
+ * \brief A variable controlling the number of worker threads running SDL jobs.
+ *
+ * The default is the number of CPU cores. The value is read when the workers are
+ * started by the first job submitted after SDL_Init().
+ */
+#define SDL_HINT_JOB_THREADS "SDL_JOB_THREADS"
+
+/**
+ * \brief A variable naming a file to record a trace to.
+ *
+ * If set, SDL_Init() starts a trace and SDL_Quit() saves it to this file in the
+ * Chrome trace event format. By default no trace is recorded.
+ */
+#define SDL_HINT_TRACE_FILE "SDL_TRACE_FILE"
+
  /**
  * \brief A variable to control whether the return key on the soft keyboard
  *        should hide the soft keyboard on Android and iOS.
@@ -1126,18 +1185,20 @@ extern "C" {
  *  that produce different levels of quality, using more CPU.
  *
  *  If this hint isn't specified to a valid setting, or libsamplerate isn't
- *  available, SDL will use the default, internal resampling algorithm.
+ *  available, SDL will use its internal polyphase resampler, with a longer
+ *  filter for the higher quality settings.
  *
- *  Note that this is currently only applicable to resampling audio that is
- *  being written to a device for playback or audio being read from a device
- *  for capture. SDL_AudioCVT always uses the default resampler (although this
- *  might change for SDL 2.1).
+ *  Note that this is currently only applicable to SDL_AudioStream, which
+ *  also resamples audio that is being written to a device for playback or
+ *  read from a device for capture. SDL_AudioCVT always uses the default
+ *  resampler (although this might change for SDL 2.1).
  *
- *  This hint is currently only checked at audio subsystem initialization.
+ *  libsamplerate is chosen at audio subsystem initialization, the internal
+ *  resampler's quality when each audio stream is created.
  *
  *  This variable can be set to the following values:
  *
- *    "0" or "default" - Use SDL's internal resampling (Default when not set - low quality, fast)
+ *    "0" or "default" - Use SDL's internal resampling (Default when not set - medium quality)
  *    "1" or "fast"    - Use fast, slightly higher quality resampling, if available
  *    "2" or "medium"  - Use medium quality resampling, if available
  *    "3" or "best"    - Use high quality resampling, if available
@@ -1157,6 +1218,29 @@ extern "C" {
  */
 #define SDL_HINT_AUDIO_CATEGORY   "SDL_AUDIO_CATEGORY"
 
+/**
+ *  \brief  A variable controlling whether playback devices run the audio callback from the system's audio thread.
+ *
+ *  In pull mode there is no SDL audio thread. The backend's own callback calls
+ *  the app's callback, which then writes straight into the buffer the system
+ *  hands out. When no conversion is needed, the data is never copied. This
+ *  saves a thread hop and the intermediate buffering. The callback's len may
+ *  then differ from the obtained spec's size from one call to the next. The
+ *  system's thread never waits on the app: while the app holds
+ *  SDL_LockAudioDevice(), the device plays silence instead.
+ *
+ *  Backends that can't do this ignore the hint. Currently these are all
+ *  backends except OHOS and disk.
+ *
+ *  This variable can be set to the following values:
+ *
+ *    "0"       - Use an SDL audio thread (default)
+ *    "1"       - Let the backend's thread pull audio from the callback
+ *
+ *  The value should be set before the audio device is opened.
+ */
+#define SDL_HINT_AUDIO_PULL_MODE   "SDL_AUDIO_PULL_MODE"
+
 /**
  *  \brief  A variable controlling whether the 2D render API is compatible or efficient.
  *
@@ -0,0 +1,159 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDL_jobs_h_
+#define SDL_jobs_h_
+
+/**
+ *  \file SDL_jobs.h
+ *
+ *  Header for the SDL job system.
+ *
+ *  Jobs are short functions run by a pool of worker threads, one per CPU
+ *  core by default. Each worker keeps its own queue and idle workers steal
+ *  from the others. Counters track groups of jobs: a job can be tied to a
+ *  counter that drops back when it finishes, and can be held back until
+ *  another counter reaches zero.
+ *
+ *  The workers are started the first time a job is submitted and stopped
+ *  by SDL_Quit().
+ */
+
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+
+#include "begin_code.h"
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The job counter structure, defined in SDL_jobs.c */
+struct SDL_JobCounter;
+typedef struct SDL_JobCounter SDL_JobCounter;
+
+/**
+ *  The function run by a job.
+ */
+typedef void (SDLCALL * SDL_JobFunction) (void *data);
+
+/**
+ *  The function passed to SDL_ParallelFor(), called for the indices
+ *  from \c start up to but not including \c end.
+ */
+typedef void (SDLCALL * SDL_ParallelForFunction) (int start, int end, void *data);
+
+/**
+ *  \brief Get the number of worker threads running jobs.
+ *
+ *  This starts the workers if they aren't running yet.
+ *
+ *  \return The number of workers, or -1 on error.
+ *
+ *  \sa SDL_HINT_JOB_THREADS
+ */
+extern DECLSPEC int SDLCALL SDL_GetJobThreadCount(void);
+
+/**
+ *  \brief Create a counter to track a group of jobs, starting at zero.
+ *
+ *  \return The new counter, or NULL on error.
+ */
+extern DECLSPEC SDL_JobCounter *SDLCALL SDL_CreateJobCounter(void);
+
+/**
+ *  \brief Destroy a job counter.
+ *
+ *  No job may still be tied to or waiting on the counter.
+ */
+extern DECLSPEC void SDLCALL SDL_DestroyJobCounter(SDL_JobCounter *counter);
+
+/**
+ *  \brief Get the number of unfinished jobs tied to a counter.
+ */
+extern DECLSPEC int SDLCALL SDL_GetJobCounterValue(SDL_JobCounter *counter);
+
+/**
+ *  \brief Run a job on the worker threads.
+ *
+ *  \param function The function to run.
+ *  \param data     The pointer passed to the function.
+ *  \param counter  A counter that goes up by one now and back down when
+ *                  the job has finished, or NULL.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_RunJob(SDL_JobFunction function, void *data,
+                                       SDL_JobCounter *counter);
+
+/**
+ *  \brief Run a job once the jobs tied to another counter are done.
+ *
+ *  If \c dependency is already zero the job is queued right away.
+ *
+ *  \param dependency The counter that has to reach zero first.
+ *  \param function   The function to run.
+ *  \param data       The pointer passed to the function.
+ *  \param counter    A counter that goes up by one now and back down when
+ *                    the job has finished, or NULL.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_RunJobAfter(SDL_JobCounter *dependency,
+                                            SDL_JobFunction function, void *data,
+                                            SDL_JobCounter *counter);
+
+/**
+ *  \brief Wait until a counter reaches zero.
+ *
+ *  The calling thread runs queued jobs while it waits, so this is safe to
+ *  call from inside a job.
+ */
+extern DECLSPEC void SDLCALL SDL_WaitJobCounter(SDL_JobCounter *counter);
+
+/**
+ *  \brief Call a function for the indices 0 to count-1, split across the
+ *         worker threads, and wait for all of them.
+ *
+ *  \param count    The number of indices.
+ *  \param grain    The most indices handed to one call, or 0 to split the
+ *                  range into a few pieces per worker.
+ *  \param function The function to call for each piece.
+ *  \param data     The pointer passed to the function.
+ *
+ *  If the workers can't be started, the whole range is run on the calling
+ *  thread.
+ *
+ *  \return 0 on success, or -1 if the parameters are invalid.
+ */
+extern DECLSPEC int SDLCALL SDL_ParallelFor(int count, int grain,
+                                            SDL_ParallelForFunction function,
+                                            void *data);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include "close_code.h"
+
+#endif /* SDL_jobs_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -240,6 +240,85 @@ extern DECLSPEC int SDLCALL SDL_CondWaitTimeout(SDL_cond * cond,
 /* @} *//* Condition variable functions */
 
 
+/**
+ *  \name Lock profiling
+ *
+ *  When SDL is built with SDL_LOCK_PROFILING (the LOCK_PROFILING CMake
+ *  option), mutexes, semaphores and condition variables count how often
+ *  they are taken, how often that meant waiting for another thread, and for
+ *  how long. Locks with the same name share their statistics, unnamed ones
+ *  are counted together for each type.
+ *
+ *  Without SDL_LOCK_PROFILING, naming a lock does nothing and
+ *  SDL_GetLockStats() returns -1.
+ */
+/* @{ */
+
+typedef enum
+{
+    SDL_LOCKSTATS_MUTEX,
+    SDL_LOCKSTATS_SEMAPHORE,
+    SDL_LOCKSTATS_CONDITION
+} SDL_LockStatsType;
+
+/**
+ *  Statistics for the locks sharing one name. For condition variables
+ *  every wait counts as contended, and the wait time is how long it took
+ *  to be signaled or time out. Times are in nanoseconds.
+ */
+typedef struct SDL_LockStats
+{
+    char name[64];
+    SDL_LockStatsType type;
+    Uint64 acquires;        /**< Locks, or waits that returned */
+    Uint64 contended;       /**< Acquires that had to wait for another thread */
+    Uint64 wait_total_ns;
+    Uint64 wait_max_ns;
+    Uint64 hold_total_ns;   /**< How long mutexes were held, 0 for the others */
+    Uint64 hold_max_ns;
+} SDL_LockStats;
+
+/**
+ *  Set the name a mutex is profiled under. The name is copied.
+ */
+extern DECLSPEC void SDLCALL SDL_SetMutexName(SDL_mutex * mutex, const char *name);
+
+/**
+ *  Set the name a semaphore is profiled under. The name is copied.
+ */
+extern DECLSPEC void SDLCALL SDL_SetSemaphoreName(SDL_sem * sem, const char *name);
+
+/**
+ *  Set the name a condition variable is profiled under. The name is copied.
+ */
+extern DECLSPEC void SDLCALL SDL_SetCondName(SDL_cond * cond, const char *name);
+
+/**
+ *  Get the statistics recorded so far.
+ *
+ *  \param stats    An array to fill in, or NULL to only count the entries.
+ *  \param maxstats The number of entries stats has room for.
+ *
+ *  \return The number of entries there are, which may be more than
+ *          maxstats, or -1 if lock profiling isn't built in.
+ */
+extern DECLSPEC int SDLCALL SDL_GetLockStats(SDL_LockStats * stats, int maxstats);
+
+/**
+ *  Get the statistics recorded so far as a JSON document.
+ *
+ *  \return A string that should be freed with SDL_free(), or NULL on error.
+ */
+extern DECLSPEC char *SDLCALL SDL_GetLockStatsJSON(void);
+
+/**
+ *  Clear the statistics recorded so far.
+ */
+extern DECLSPEC void SDLCALL SDL_ResetLockStats(void);
+
+/* @} *//* Lock profiling */
+
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
@@ -118,6 +118,9 @@ typedef struct SDL_RWops
             long size;
             long offset;
             int fd;
+            void *mapAddress;   /* page aligned mapping of the descriptor range, or NULL */
+            size_t mapLength;
+            const Uint8 *mapData;  /* first byte of the rawfile inside the mapping */
         } ohosio;
 #elif defined(__WIN32__)
         struct
@@ -293,6 +296,89 @@ extern DECLSPEC size_t SDLCALL SDL_WriteLE64(SDL_RWops * dst, Uint64 value);
 extern DECLSPEC size_t SDLCALL SDL_WriteBE64(SDL_RWops * dst, Uint64 value);
 /* @} *//* Write endian functions */
 
+/**
+ *  \name Asynchronous reads
+ *
+ *  Reads are carried out by a small pool of I/O threads, so loading can
+ *  overlap with decoding on the calling thread. Requests on the same RWops
+ *  run one after another; requests on different RWops run in parallel.
+ *  While a RWops has reads in flight, only the I/O threads may use it.
+ */
+/* @{ */
+
+/**
+ *  Completion of one asynchronous read.
+ */
+typedef struct SDL_RWAsyncResult
+{
+    SDL_RWops *context;
+    Sint64 offset;
+    void *buffer;
+    size_t requested;
+    size_t completed;   /**< bytes read, less than requested at end of stream */
+    int status;         /**< 0 on success, -1 if the seek or the read failed */
+    void *userdata;
+} SDL_RWAsyncResult;
+
+/**
+ *  Called on an I/O thread as soon as a read finishes.
+ */
+typedef void (SDLCALL * SDL_RWAsyncCallback) (const SDL_RWAsyncResult *result);
+
+/**
+ *  One asynchronous read of \c size bytes at absolute \c offset into \c buffer.
+ */
+typedef struct SDL_RWAsyncRead
+{
+    SDL_RWops *context;
+    Sint64 offset;
+    void *buffer;
+    size_t size;
+    SDL_RWAsyncCallback callback;   /**< may be NULL */
+    void *userdata;
+} SDL_RWAsyncRead;
+
+#define SDL_RWASYNC_POLL    0x01    /**< Queue completions for SDL_RWAsyncWait() */
+#define SDL_RWASYNC_EVENT   0x02    /**< Push an SDL_RWAsyncEventType() event per completion */
+
+/**
+ *  Submit a batch of reads.
+ *
+ *  With ::SDL_RWASYNC_EVENT each completion also pushes a user event of type
+ *  SDL_RWAsyncEventType() with \c code set to the status, \c data1 to the
+ *  request userdata and \c data2 to its buffer.
+ *
+ *  \return 0 if every request was queued, -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_RWReadAsync(const SDL_RWAsyncRead *requests, int count, Uint32 flags);
+
+/**
+ *  Take one completion queued with ::SDL_RWASYNC_POLL.
+ *
+ *  \param timeout milliseconds to wait, 0 to poll, -1 to wait until one is available.
+ *
+ *  \return SDL_TRUE if \c result was filled in, SDL_FALSE if nothing completed in time.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_RWAsyncWait(SDL_RWAsyncResult *result, Sint32 timeout);
+
+/**
+ *  The event type used for ::SDL_RWASYNC_EVENT completions.
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_RWAsyncEventType(void);
+
+/**
+ *  Wrap a sequential stream so the next \c window bytes are always being
+ *  read in the background while the current ones are consumed.
+ *
+ *  The returned RWops is read-only. Seeks inside the current window are
+ *  free; other seeks restart the read-ahead at the new position.
+ *
+ *  If \c freesrc is non-zero, \c src is closed with the returned RWops.
+ */
+extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromReadAhead(SDL_RWops *src, size_t window, int freesrc);
+
+/* @} *//* Asynchronous reads */
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
@@ -501,15 +501,25 @@ extern DECLSPEC int SDLCALL SDL_LowerBlit
 
 /**
  *  \brief Perform a fast, low quality, stretch blit between two surfaces of the
- *         same pixel format.
- *
- *  \note This function uses a static buffer, and is not thread-safe.
+ *         same pixel format, using nearest pixel sampling.
  */
 extern DECLSPEC int SDLCALL SDL_SoftStretch(SDL_Surface * src,
                                             const SDL_Rect * srcrect,
                                             SDL_Surface * dst,
                                             const SDL_Rect * dstrect);
 
+/**
+ *  \brief Perform a bilinear filtered stretch blit between two surfaces of the
+ *         same pixel format.
+ *
+ *  Paletted formats and formats with less than 16 bits per pixel aren't
+ *  supported.
+ */
+extern DECLSPEC int SDLCALL SDL_SoftStretchLinear(SDL_Surface * src,
+                                                  const SDL_Rect * srcrect,
+                                                  SDL_Surface * dst,
+                                                  const SDL_Rect * dstrect);
+
 #define SDL_BlitScaled SDL_UpperBlitScaled
 
 /**
@@ -29,6 +29,7 @@
 #define SDL_system_h_
 
 #include "SDL_stdinc.h"
+#include "SDL_audio.h"
 #include "SDL_keyboard.h"
 #include "SDL_render.h"
 #include "SDL_video.h"
@@ -200,6 +201,70 @@ extern DECLSPEC const char * SDLCALL SDL_AndroidGetExternalStoragePath(void);
 
 #endif /* __ANDROID__ */
 
+/* Platform specific functions for OHOS */
+#ifdef __OHOS__
+
+/**
+   \brief Render queue statistics of an OHOS audio output device.
+ */
+typedef struct SDL_OHOSAudioRenderStats
+{
+    Uint32 periods;         /**< depth of the render queue, see SDL_HINT_OHOS_AUDIO_PERIODS */
+    Uint32 periodBytes;     /**< size of one period, as requested by the system renderer */
+    Uint32 queuedPeriods;   /**< periods currently waiting to be played */
+    Uint32 underruns;       /**< renderer callbacks that found the queue empty */
+    Uint32 silentBytes;     /**< bytes of silence inserted by those underruns */
+} SDL_OHOSAudioRenderStats;
+
+/**
+   \brief Get the render queue statistics of an opened audio output device.
+
+   \return 0 on success, or -1 if the device is not an OHOS output device.
+ */
+extern DECLSPEC int SDLCALL SDL_OHOSGetAudioRenderStats(SDL_AudioDeviceID dev, SDL_OHOSAudioRenderStats *stats);
+
+/**
+   \brief Presentation statistics of an OHOS window.
+
+   Input latency runs from the UI thread receiving the oldest touch, mouse or
+   wheel event of a frame to the buffer swap that follows it.
+ */
+typedef struct SDL_OHOSWindowFrameStats
+{
+    Uint32 frames;              /**< buffer swaps since the window was created */
+    Uint32 skippedFrames;       /**< swaps refused because the surface was gone */
+    float lastFrameMs;          /**< time between the last two swaps */
+    float averageFrameMs;
+    float maxFrameMs;
+    float lastSwapMs;           /**< time spent in the last eglSwapBuffers */
+    Uint32 inputFrames;         /**< swaps that presented new input */
+    float lastInputLatencyMs;
+    float averageInputLatencyMs;
+    float maxInputLatencyMs;
+} SDL_OHOSWindowFrameStats;
+
+/**
+   \brief Get the presentation statistics of an OpenGL ES window.
+
+   \return 0 on success, or -1 if the window is not an OHOS window.
+ */
+extern DECLSPEC int SDLCALL SDL_OHOSGetWindowFrameStats(SDL_Window *window, SDL_OHOSWindowFrameStats *stats);
+
+/**
+   \brief Get the contents of a read-only RWops without copying them.
+
+   Works for memory mapped rawfile assets (see SDL_HINT_OHOS_RAWFILE_MMAP) and
+   for RWops created with SDL_RWFromMem() or SDL_RWFromConstMem(). The pointer
+   stays valid until the RWops is closed.
+
+   \param context the RWops to query
+   \param size filled in with the size of the data in bytes, may be NULL
+   \return the start of the data, or NULL if the RWops is not memory backed.
+ */
+extern DECLSPEC const void * SDLCALL SDL_OHOSGetRWopsData(SDL_RWops *context, Sint64 *size);
+
+#endif /* __OHOS__ */
+
 /* Platform specific functions for WinRT */
 #ifdef __WINRT__
 
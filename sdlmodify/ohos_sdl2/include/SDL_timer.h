@@ -94,6 +94,26 @@ extern DECLSPEC SDL_TimerID SDLCALL SDL_AddTimer(Uint32 interval,
                                                  SDL_TimerCallback callback,
                                                  void *param);
 
+/**
+ *  Function prototype for the nanosecond timer callback function.
+ *
+ *  Works like SDL_TimerCallback, with the interval in nanoseconds.
+ */
+typedef Uint64 (SDLCALL * SDL_NSTimerCallback) (Uint64 interval, void *param);
+
+/**
+ * \brief Add a new timer with an interval in nanoseconds.
+ *
+ * These timers run on the same thread as the SDL_AddTimer() ones and are
+ * removed with SDL_RemoveTimer(). They are dispatched with a resolution of
+ * about 0.1 ms where the platform can sleep that precisely.
+ *
+ * \return A timer ID, or 0 when an error occurs.
+ */
+extern DECLSPEC SDL_TimerID SDLCALL SDL_AddTimerNS(Uint64 interval,
+                                                   SDL_NSTimerCallback callback,
+                                                   void *param);
+
 /**
  * \brief Remove a timer knowing its ID.
  *
@@ -0,0 +1,125 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDL_trace_h_
+#define SDL_trace_h_
+
+/**
+ *  \file SDL_trace.h
+ *
+ *  Header for the SDL trace recorder.
+ *
+ *  While a trace is running, SDL records when its rendering, audio, event
+ *  and blitting paths start and finish, and applications can add their own
+ *  scopes, instant events and counters. Each thread writes to its own
+ *  buffer without taking a lock. The trace is saved in the Chrome trace
+ *  event JSON format, which chrome://tracing and the Perfetto UI both load.
+ *
+ *  Event names are stored as pointers, so they must stay valid until the
+ *  trace is saved. String literals are the usual choice.
+ */
+
+#include "SDL_stdinc.h"
+#include "SDL_error.h"
+#include "SDL_rwops.h"
+
+#include "begin_code.h"
+/* Set up for C function definitions, even when using C++ */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  \brief Start recording a trace, discarding any events recorded before.
+ *
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_HINT_TRACE_FILE
+ */
+extern DECLSPEC int SDLCALL SDL_StartTrace(void);
+
+/**
+ *  \brief Stop recording. The events recorded so far are kept until the
+ *         next call to SDL_StartTrace().
+ */
+extern DECLSPEC void SDLCALL SDL_StopTrace(void);
+
+/**
+ *  \brief Find out whether a trace is being recorded.
+ */
+extern DECLSPEC SDL_bool SDLCALL SDL_IsTracing(void);
+
+/**
+ *  \brief Mark the start of a named scope on the calling thread.
+ *
+ *  Every call must be matched by a call to SDL_TraceEnd() on the same
+ *  thread. Scopes may be nested.
+ */
+extern DECLSPEC void SDLCALL SDL_TraceBegin(const char *name);
+
+/**
+ *  \brief Mark the end of the innermost scope started on the calling thread.
+ */
+extern DECLSPEC void SDLCALL SDL_TraceEnd(void);
+
+/**
+ *  \brief Record a point in time on the calling thread.
+ */
+extern DECLSPEC void SDLCALL SDL_TraceInstant(const char *name);
+
+/**
+ *  \brief Record the current value of a named counter.
+ *
+ *  Counters are drawn as a graph above the thread timelines.
+ */
+extern DECLSPEC void SDLCALL SDL_TraceCounter(const char *name, Sint64 value);
+
+/**
+ *  \brief Save the recorded events as Chrome trace event JSON.
+ *
+ *  This may be called while the trace is running, but events recorded
+ *  while it is being written may be left out. Scopes that were still open
+ *  when the trace stopped are closed at that point.
+ *
+ *  \param dst     The stream to write the trace to.
+ *  \param freedst Non-zero to close the stream when done.
+ *
+ *  \return 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL SDL_SaveTrace_RW(SDL_RWops *dst, int freedst);
+
+/**
+ *  Save the recorded events to a file.
+ *
+ *  Convenience macro.
+ */
+#define SDL_SaveTrace(file) \
+        SDL_SaveTrace_RW(SDL_RWFromFile(file, "wb"), 1)
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+}
+#endif
+#include "close_code.h"
+
+#endif /* SDL_trace_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -38,10 +38,13 @@
 #include "SDL_bits.h"
 #include "SDL_revision.h"
 #include "SDL_assert_c.h"
+#include "SDL_trace_c.h"
 #include "events/SDL_events_c.h"
+#include "file/SDL_rwops_c.h"
 #include "haptic/SDL_haptic_c.h"
 #include "joystick/SDL_joystick_c.h"
 #include "sensor/SDL_sensor_c.h"
+#include "thread/SDL_jobs_c.h"
 
 /* Initialization/Cleanup routines */
 #if !SDL_TIMERS_DISABLED
@@ -171,6 +174,8 @@ SDL_InitSubSystem(Uint32 flags)
     SDL_TicksInit();
 #endif
 
+    SDL_TraceInit();
+
     /* Initialize the event subsystem */
     if ((flags & SDL_INIT_EVENTS)) {
 #if !SDL_EVENTS_DISABLED
@@ -417,6 +422,10 @@ SDL_Quit(void)
 #endif
     SDL_QuitSubSystem(SDL_INIT_EVERYTHING);
 
+    SDL_RWAsyncQuit();
+    SDL_JobsQuit();
+    SDL_TraceQuit();
+
 #if !SDL_TIMERS_DISABLED
     SDL_TicksQuit();
 #endif
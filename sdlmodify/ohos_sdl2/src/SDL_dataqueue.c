@@ -24,35 +24,113 @@
 #include "./SDL_dataqueue.h"
 #include "SDL_assert.h"
 
+/* The queue is a linked list of packets with one writer and one reader,
+ * neither of which ever waits for the other.
+ *
+ * The writer appends to the tail packet and publishes what it wrote by
+ * storing the packet's new datalen. When the tail is full it links a fresh
+ * packet after it, and never touches the old one again. The reader consumes
+ * from the head packet and moves on once it has read everything and there
+ * is a next packet, so the list always keeps at least one packet.
+ *
+ * Finished packets go back to the writer through `recycled`, a stack the
+ * reader pushes onto and the writer takes whole into its private pool, so
+ * after the first few packets neither side calls malloc.
+ */
 typedef struct SDL_DataQueuePacket
 {
-    size_t datalen;  /* bytes currently in use in this packet. */
-    size_t startpos;  /* bytes currently consumed in this packet. */
-    struct SDL_DataQueuePacket *next;  /* next item in linked list. */
+    SDL_atomic_t datalen;  /* bytes written to this packet, only the writer changes it. */
+    size_t startpos;  /* bytes consumed in this packet, only the reader changes it. */
+    void *next;  /* next packet in the queue or pool, set once the writer moves on. */
     Uint8 data[SDL_VARIABLE_LENGTH_ARRAY];  /* packet data */
 } SDL_DataQueuePacket;
 
 struct SDL_DataQueue
 {
-    SDL_DataQueuePacket *head; /* device fed from here. */
-    SDL_DataQueuePacket *tail; /* queue fills to here. */
-    SDL_DataQueuePacket *pool; /* these are unused packets. */
+    SDL_DataQueuePacket *head; /* reader side: device fed from here. */
+    SDL_DataQueuePacket *tail; /* writer side: queue fills to here. */
+    SDL_DataQueuePacket *pool; /* writer side: unused packets. */
+    size_t reserved;      /* writer side: bytes reserved at the end of tail. */
+    void *recycled;       /* packets the reader is done with, for the writer. */
     size_t packet_size;   /* size of new packets */
-    size_t queued_bytes;  /* number of bytes of data in the queue. */
+    SDL_atomic_t queued_bytes;  /* number of bytes of data in the queue. */
 };
 
 static void
 SDL_FreeDataQueueList(SDL_DataQueuePacket *packet)
 {
     while (packet) {
-        SDL_DataQueuePacket *next = packet->next;
+        SDL_DataQueuePacket *next = (SDL_DataQueuePacket *) packet->next;
         SDL_free(packet);
         packet = next;
     }
 }
 
+/* Reader side: hand a finished packet back to the writer. */
+static void
+RecycleDataQueuePacket(SDL_DataQueue *queue, SDL_DataQueuePacket *packet)
+{
+    void *top;
+
+    do {
+        top = SDL_AtomicGetPtr(&queue->recycled);
+        packet->next = top;
+    } while (!SDL_AtomicCASPtr(&queue->recycled, top, packet));
+}
+
+/* Writer side: get an empty packet, not yet linked into the queue. */
+static SDL_DataQueuePacket *
+AllocateDataQueuePacket(SDL_DataQueue *queue)
+{
+    SDL_DataQueuePacket *packet;
+
+    SDL_assert(queue != NULL);
+
+    if (!queue->pool) {
+        queue->pool = (SDL_DataQueuePacket *) SDL_AtomicSetPtr(&queue->recycled, NULL);
+        SDL_MemoryBarrierAcquire();
+    }
+
+    packet = queue->pool;
+    if (packet != NULL) {
+        /* we have one available in the pool. */
+        queue->pool = (SDL_DataQueuePacket *) packet->next;
+    } else {
+        /* Have to allocate a new one! */
+        packet = (SDL_DataQueuePacket *) SDL_malloc(sizeof (SDL_DataQueuePacket) + queue->packet_size);
+        if (packet == NULL) {
+            return NULL;
+        }
+    }
+
+    SDL_AtomicSet(&packet->datalen, 0);
+    packet->startpos = 0;
+    packet->next = NULL;
+    return packet;
+}
+
+/* Writer side: return packets that never made it into the queue. */
+static void
+ReleaseDataQueuePackets(SDL_DataQueue *queue, SDL_DataQueuePacket *packet)
+{
+    while (packet) {
+        SDL_DataQueuePacket *next = (SDL_DataQueuePacket *) packet->next;
+        packet->next = queue->pool;
+        queue->pool = packet;
+        packet = next;
+    }
+}
+
+/* Writer side: make `packet` the new tail. Everything written to the old
+   tail must already be published, the reader may retire it right away. */
+static void
+LinkDataQueuePacket(SDL_DataQueue *queue, SDL_DataQueuePacket *packet)
+{
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSetPtr(&queue->tail->next, packet);
+    queue->tail = packet;
+}
 
-/* this all expects that you managed thread safety elsewhere. */
 
 SDL_DataQueue *
 SDL_NewDataQueue(const size_t _packetlen, const size_t initialslack)
@@ -73,12 +151,20 @@ SDL_NewDataQueue(const size_t _packetlen, const size_t initialslack)
         for (i = 0; i < wantpackets; i++) {
             SDL_DataQueuePacket *packet = (SDL_DataQueuePacket *) SDL_malloc(sizeof (SDL_DataQueuePacket) + packetlen);
             if (packet) { /* don't care if this fails, we'll deal later. */
-                packet->datalen = 0;
-                packet->startpos = 0;
                 packet->next = queue->pool;
                 queue->pool = packet;
             }
         }
+
+        /* The queue always holds at least one packet, the reader and the
+           writer share it while the queue is empty. */
+        queue->head = queue->tail = AllocateDataQueuePacket(queue);
+        if (!queue->head) {
+            SDL_FreeDataQueueList(queue->pool);
+            SDL_free(queue);
+            SDL_OutOfMemory();
+            return NULL;
+        }
     }
 
     return queue;
@@ -90,6 +176,7 @@ SDL_FreeDataQueue(SDL_DataQueue *queue)
     if (queue) {
         SDL_FreeDataQueueList(queue->head);
         SDL_FreeDataQueueList(queue->pool);
+        SDL_FreeDataQueueList((SDL_DataQueuePacket *) queue->recycled);
         SDL_free(queue);
     }
 }
@@ -100,76 +187,44 @@ SDL_ClearDataQueue(SDL_DataQueue *queue, const size_t slack)
     const size_t packet_size = queue ? queue->packet_size : 1;
     const size_t slackpackets = (slack + (packet_size-1)) / packet_size;
     SDL_DataQueuePacket *packet;
-    SDL_DataQueuePacket *prev = NULL;
+    size_t discarded = 0;
     size_t i;
 
     if (!queue) {
         return;
     }
 
-    packet = queue->head;
-
-    /* merge the available pool and the current queue into one list. */
-    if (packet) {
-        queue->tail->next = queue->pool;
-    } else {
-        packet = queue->pool;
+    /* Read past everything the writer has published so far. */
+    for (;;) {
+        SDL_DataQueuePacket *next;
+        size_t datalen;
+
+        packet = queue->head;
+        next = (SDL_DataQueuePacket *) SDL_AtomicGetPtr(&packet->next);
+        datalen = (size_t) SDL_AtomicGet(&packet->datalen);
+        discarded += datalen - packet->startpos;
+        packet->startpos = datalen;
+        if (!next) {
+            break;
+        }
+        queue->head = next;
+        RecycleDataQueuePacket(queue, packet);
     }
+    SDL_AtomicAdd(&queue->queued_bytes, -(int) discarded);
 
-    /* Remove the queued packets from the device. */
-    queue->tail = NULL;
-    queue->head = NULL;
-    queue->queued_bytes = 0;
-    queue->pool = packet;
-
-    /* Optionally keep some slack in the pool to reduce malloc pressure. */
+    /* Optionally keep some slack in the recycled packets to reduce malloc
+       pressure, free the rest. Packets in the writer's own pool stay. */
+    packet = (SDL_DataQueuePacket *) SDL_AtomicSetPtr(&queue->recycled, NULL);
+    SDL_MemoryBarrierAcquire();
     for (i = 0; packet && (i < slackpackets); i++) {
-        prev = packet;
-        packet = packet->next;
-    }
-
-    if (prev) {
-        prev->next = NULL;
-    } else {
-        queue->pool = NULL;
+        SDL_DataQueuePacket *next = (SDL_DataQueuePacket *) packet->next;
+        RecycleDataQueuePacket(queue, packet);
+        packet = next;
     }
 
     SDL_FreeDataQueueList(packet);  /* free extra packets */
 }
 
-static SDL_DataQueuePacket *
-AllocateDataQueuePacket(SDL_DataQueue *queue)
-{
-    SDL_DataQueuePacket *packet;
-
-    SDL_assert(queue != NULL);
-
-    packet = queue->pool;
-    if (packet != NULL) {
-        /* we have one available in the pool. */
-        queue->pool = packet->next;
-    } else {
-        /* Have to allocate a new one! */
-        packet = (SDL_DataQueuePacket *) SDL_malloc(sizeof (SDL_DataQueuePacket) + queue->packet_size);
-        if (packet == NULL) {
-            return NULL;
-        }
-    }
-
-    packet->datalen = 0;
-    packet->startpos = 0;
-    packet->next = NULL;
-                
-    SDL_assert((queue->head != NULL) == (queue->queued_bytes != 0));
-    if (queue->tail == NULL) {
-        queue->head = packet;
-    } else {
-        queue->tail->next = packet;
-    }
-    queue->tail = packet;
-    return packet;
-}
-
 
 int
 SDL_WriteToDataQueue(SDL_DataQueue *queue, const void *_data, const size_t _len)
@@ -177,49 +232,62 @@ SDL_WriteToDataQueue(SDL_DataQueue *queue, const void *_data, const size_t _len)
     size_t len = _len;
     const Uint8 *data = (const Uint8 *) _data;
     const size_t packet_size = queue ? queue->packet_size : 0;
-    SDL_DataQueuePacket *orighead;
-    SDL_DataQueuePacket *origtail;
-    size_t origlen;
+    SDL_DataQueuePacket *tail;
+    SDL_DataQueuePacket *first = NULL;
+    SDL_DataQueuePacket *last = NULL;
+    size_t taillen;
     size_t datalen;
 
     if (!queue) {
         return SDL_InvalidParamError("queue");
     }
 
-    orighead = queue->head;
-    origtail = queue->tail;
-    origlen = origtail ? origtail->datalen : 0;
+    SDL_assert(queue->reserved == 0);  /* commit reserved space first! */
+
+    if (len == 0) {
+        return 0;
+    }
+
+    /* Fill what's left of the tail packet; the reader can't see it yet. */
+    tail = queue->tail;
+    taillen = (size_t) SDL_AtomicGet(&tail->datalen);
+    SDL_assert(taillen <= packet_size);
+    datalen = SDL_min(len, packet_size - taillen);
+    SDL_memcpy(tail->data + taillen, data, datalen);
+    data += datalen;
+    len -= datalen;
 
+    /* Put the rest in a chain of new packets, private until it's linked in. */
     while (len > 0) {
-        SDL_DataQueuePacket *packet = queue->tail;
-        SDL_assert(!packet || (packet->datalen <= packet_size));
-        if (!packet || (packet->datalen >= packet_size)) {
-            /* tail packet missing or completely full; we need a new packet. */
-            packet = AllocateDataQueuePacket(queue);
-            if (!packet) {
-                /* uhoh, reset so we've queued nothing new, free what we can. */
-                if (!origtail) {
-                    packet = queue->head;  /* whole queue. */
-                } else {
-                    packet = origtail->next;  /* what we added to existing queue. */
-                    origtail->next = NULL;
-                    origtail->datalen = origlen;
-                }
-                queue->head = orighead;
-                queue->tail = origtail;
-                queue->pool = NULL;
-
-                SDL_FreeDataQueueList(packet);  /* give back what we can. */
-                return SDL_OutOfMemory();
-            }
+        SDL_DataQueuePacket *packet = AllocateDataQueuePacket(queue);
+        if (!packet) {
+            /* uhoh, nothing was published, so just give the packets back. */
+            ReleaseDataQueuePackets(queue, first);
+            return SDL_OutOfMemory();
         }
 
-        datalen = SDL_min(len, packet_size - packet->datalen);
-        SDL_memcpy(packet->data + packet->datalen, data, datalen);
+        datalen = SDL_min(len, packet_size);
+        SDL_memcpy(packet->data, data, datalen);
+        SDL_AtomicSet(&packet->datalen, (int) datalen);
         data += datalen;
         len -= datalen;
-        packet->datalen += datalen;
-        queue->queued_bytes += datalen;
+
+        if (last) {
+            last->next = packet;
+        } else {
+            first = packet;
+        }
+        last = packet;
+    }
+
+    /* Count before publishing, so the reader never takes the count below zero. */
+    SDL_AtomicAdd(&queue->queued_bytes, (int) _len);
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&tail->datalen, (int) (taillen + SDL_min(_len, packet_size - taillen)));
+    if (first) {
+        LinkDataQueuePacket(queue, first);
+        queue->tail = last;
     }
 
     return 0;
@@ -237,14 +305,18 @@ SDL_PeekIntoDataQueue(SDL_DataQueue *queue, void *_buf, const size_t _len)
         return 0;
     }
 
-    for (packet = queue->head; len && packet; packet = packet->next) {
-        const size_t avail = packet->datalen - packet->startpos;
+    for (packet = queue->head; len && packet; ) {
+        /* next before datalen: once there is a next, datalen is final. */
+        SDL_DataQueuePacket *next = (SDL_DataQueuePacket *) SDL_AtomicGetPtr(&packet->next);
+        const size_t datalen = (size_t) SDL_AtomicGet(&packet->datalen);
+        const size_t avail = datalen - packet->startpos;
         const size_t cpy = SDL_min(len, avail);
-        SDL_assert(queue->queued_bytes >= avail);
 
+        SDL_MemoryBarrierAcquire();
         SDL_memcpy(ptr, packet->data + packet->startpos, cpy);
         ptr += cpy;
         len -= cpy;
+        packet = next;
     }
 
     return (size_t) (ptr - buf);
@@ -256,36 +328,33 @@ SDL_ReadFromDataQueue(SDL_DataQueue *queue, void *_buf, const size_t _len)
     size_t len = _len;
     Uint8 *buf = (Uint8 *) _buf;
     Uint8 *ptr = buf;
-    SDL_DataQueuePacket *packet;
 
     if (!queue) {
         return 0;
     }
 
-    while ((len > 0) && ((packet = queue->head) != NULL)) {
-        const size_t avail = packet->datalen - packet->startpos;
-        const size_t cpy = SDL_min(len, avail);
-        SDL_assert(queue->queued_bytes >= avail);
-
-        SDL_memcpy(ptr, packet->data + packet->startpos, cpy);
-        packet->startpos += cpy;
-        ptr += cpy;
-        queue->queued_bytes -= cpy;
-        len -= cpy;
-
-        if (packet->startpos == packet->datalen) {  /* packet is done, put it in the pool. */
-            queue->head = packet->next;
-            SDL_assert((packet->next != NULL) || (packet == queue->tail));
-            packet->next = queue->pool;
-            queue->pool = packet;
+    while (len > 0) {
+        SDL_DataQueuePacket *packet = queue->head;
+        /* next before datalen: once there is a next, datalen is final. */
+        SDL_DataQueuePacket *next = (SDL_DataQueuePacket *) SDL_AtomicGetPtr(&packet->next);
+        const size_t datalen = (size_t) SDL_AtomicGet(&packet->datalen);
+
+        SDL_MemoryBarrierAcquire();
+        if (packet->startpos < datalen) {
+            const size_t cpy = SDL_min(len, datalen - packet->startpos);
+            SDL_memcpy(ptr, packet->data + packet->startpos, cpy);
+            packet->startpos += cpy;
+            ptr += cpy;
+            len -= cpy;
+        } else if (next) {  /* packet is done, give it back to the writer. */
+            queue->head = next;
+            RecycleDataQueuePacket(queue, packet);
+        } else {
+            break;  /* drained the queue entirely. */
         }
     }
 
-    SDL_assert((queue->head != NULL) == (queue->queued_bytes != 0));
-
-    if (queue->head == NULL) {
-        queue->tail = NULL;  /* in case we drained the queue entirely. */
-    }
+    SDL_AtomicAdd(&queue->queued_bytes, -(int) (ptr - buf));
 
     return (size_t) (ptr - buf);
 }
@@ -293,13 +362,14 @@ SDL_ReadFromDataQueue(SDL_DataQueue *queue, void *_buf, const size_t _len)
 size_t
 SDL_CountDataQueue(SDL_DataQueue *queue)
 {
-    return queue ? queue->queued_bytes : 0;
+    return queue ? (size_t) SDL_AtomicGet(&queue->queued_bytes) : 0;
 }
 
 void *
 SDL_ReserveSpaceInDataQueue(SDL_DataQueue *queue, const size_t len)
 {
     SDL_DataQueuePacket *packet;
+    size_t datalen;
 
     if (!queue) {
         SDL_InvalidParamError("queue");
@@ -312,28 +382,43 @@ SDL_ReserveSpaceInDataQueue(SDL_DataQueue *queue, const size_t len)
         return NULL;
     }
 
-    packet = queue->head;
-    if (packet) {
-        const size_t avail = queue->packet_size - packet->datalen;
-        if (len <= avail) {  /* we can use the space at end of this packet. */
-            void *retval = packet->data + packet->datalen;
-            packet->datalen += len;
-            queue->queued_bytes += len;
-            return retval;
+    SDL_assert(queue->reserved == 0);  /* commit reserved space first! */
+
+    packet = queue->tail;
+    datalen = (size_t) SDL_AtomicGet(&packet->datalen);
+    if (len > queue->packet_size - datalen) {
+        /* Need a fresh packet, the reader gets the old one as it is. */
+        packet = AllocateDataQueuePacket(queue);
+        if (!packet) {
+            SDL_OutOfMemory();
+            return NULL;
         }
+        LinkDataQueuePacket(queue, packet);
+        datalen = 0;
     }
 
-    /* Need a fresh packet. */
-    packet = AllocateDataQueuePacket(queue);
-    if (!packet) {
-        SDL_OutOfMemory();
-        return NULL;
+    queue->reserved = len;
+    return packet->data + datalen;
+}
+
+void
+SDL_CommitSpaceInDataQueue(SDL_DataQueue *queue, const size_t len)
+{
+    SDL_DataQueuePacket *packet;
+
+    if (!queue) {
+        return;
     }
 
-    packet->datalen = len;
-    queue->queued_bytes += len;
-    return packet->data;
+    SDL_assert(len <= queue->reserved);
+    queue->reserved = 0;
+
+    if (len > 0) {
+        packet = queue->tail;
+        SDL_AtomicAdd(&queue->queued_bytes, (int) len);
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&packet->datalen, SDL_AtomicGet(&packet->datalen) + (int) len);
+    }
 }
 
 /* vi: set ts=4 sw=4 expandtab: */
-
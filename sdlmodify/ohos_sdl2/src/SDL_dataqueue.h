@@ -23,6 +23,13 @@
 
 /* this is not (currently) a public API. But maybe it should be! */
 
+/* One thread may write (SDL_WriteToDataQueue, SDL_ReserveSpaceInDataQueue,
+   SDL_CommitSpaceInDataQueue) while another one reads (SDL_ReadFromDataQueue,
+   SDL_PeekIntoDataQueue, SDL_ClearDataQueue), without any locking; neither
+   side ever waits for the other. SDL_CountDataQueue is safe from any thread.
+   If several threads may write, or several may read, they need a lock of
+   their own. SDL_FreeDataQueue needs both sides to be done. */
+
 struct SDL_DataQueue;
 typedef struct SDL_DataQueue SDL_DataQueue;
 
@@ -34,21 +41,23 @@ size_t SDL_ReadFromDataQueue(SDL_DataQueue *queue, void *buf, const size_t len);
 size_t SDL_PeekIntoDataQueue(SDL_DataQueue *queue, void *buf, const size_t len);
 size_t SDL_CountDataQueue(SDL_DataQueue *queue);
 
-/* this sets a section of the data queue aside (possibly allocating memory for it)
-   as if it's been written to, but returns a pointer to that space. You may write
-   to this space until a read would consume it. Writes (and other calls to this
-   function) will safely append their data after this reserved space and can
-   be in flight at the same time. There is no thread safety.
-   If there isn't an existing block of memory that can contain the reserved
-   space, one will be allocated for it. You can not (currently) allocate
+/* this sets aside (len) bytes of contiguous space at the end of the data queue
+   (possibly allocating memory for it) and returns a pointer to it, so the
+   writer can produce data in place instead of copying it in. Nothing is
+   visible to the reader until SDL_CommitSpaceInDataQueue() publishes it, and
+   the writer may not write or reserve anything else until then.
+   If the last packet can't hold the reserved space, the next one will be
+   used, allocating it if the pool is empty. You can not (currently) reserve
    a space larger than the packetlen requested in SDL_NewDataQueue.
    Returned buffer is uninitialized.
-   This lets you avoid an extra copy in some cases, but it's safer to use
-   SDL_WriteToDataQueue() unless you know what you're doing.
    Returns pointer to buffer of at least (len) bytes, NULL on error.
 */
 void *SDL_ReserveSpaceInDataQueue(SDL_DataQueue *queue, const size_t len);
 
+/* this publishes the first (len) bytes of the space from the last
+   SDL_ReserveSpaceInDataQueue() call, and gives up the rest. (len) may be 0. */
+void SDL_CommitSpaceInDataQueue(SDL_DataQueue *queue, const size_t len);
+
 #endif /* SDL_dataqueue_h_ */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,512 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "./SDL_internal.h"
+
+/* The trace recorder, see SDL_trace.h */
+
+#include "SDL_atomic.h"
+#include "SDL_hints.h"
+#include "SDL_log.h"
+#include "SDL_thread.h"
+#include "SDL_timer.h"
+#include "SDL_trace_c.h"
+
+/* Events each thread can record per trace, about 2 MB */
+#define SDL_TRACE_BUFFER_EVENTS (64 * 1024)
+
+/* The longest event name written out, longer names are cut short */
+#define SDL_TRACE_MAX_NAME      256
+
+typedef enum
+{
+    SDL_TRACE_EVENT_BEGIN,
+    SDL_TRACE_EVENT_END,
+    SDL_TRACE_EVENT_INSTANT,
+    SDL_TRACE_EVENT_COUNTER
+} SDL_TraceEventType;
+
+typedef struct
+{
+    Uint64 ticks;
+    const char *name;
+    Sint64 value;
+    SDL_TraceEventType type;
+} SDL_TraceEvent;
+
+/* Only the owning thread writes to a buffer. It publishes new events by
+   bumping count after they're written, so SDL_SaveTrace_RW() can read up
+   to count at any time. */
+typedef struct SDL_TraceBuffer
+{
+    int generation;             /* the trace these events belong to */
+    SDL_atomic_t count;
+    SDL_atomic_t exited;
+    int depth;                  /* scopes open on the owning thread */
+    int dropped;
+    int tid;
+    char thread_name[64];
+    struct SDL_TraceBuffer *next;
+    SDL_TraceEvent events[SDL_TRACE_BUFFER_EVENTS];
+} SDL_TraceBuffer;
+
+volatile SDL_bool SDL_trace_enabled = SDL_FALSE;
+
+static SDL_atomic_t SDL_trace_generation;
+static Uint64 SDL_trace_start_ticks;
+static Uint64 SDL_trace_stop_ticks;
+static char *SDL_trace_file;
+
+/* Protects the buffer list and the TLS ids below */
+static SDL_SpinLock SDL_trace_lock;
+static SDL_TraceBuffer *SDL_trace_buffers;
+static int SDL_trace_saving;    /* saves in progress, buffers stay put meanwhile */
+static int SDL_trace_next_tid = 1;
+static SDL_TLSID SDL_trace_buffer_tls;
+static SDL_TLSID SDL_trace_name_tls;
+
+/* Call with SDL_trace_lock held */
+static SDL_bool
+SDL_CreateTraceTLS(void)
+{
+    if (!SDL_trace_name_tls) {
+        SDL_trace_name_tls = SDL_TLSCreate();
+    }
+    if (!SDL_trace_buffer_tls) {
+        SDL_trace_buffer_tls = SDL_TLSCreate();
+    }
+    return (SDL_trace_name_tls && SDL_trace_buffer_tls) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Called when the owning thread exits, including threads SDL didn't create
+   on systems that report it. Events in the current trace are kept until the
+   next trace starts, in a buffer cut down to fit them; anything else goes
+   right away, so threads that come and go don't pile up buffers. */
+static void SDLCALL
+SDL_TraceThreadExited(void *data)
+{
+    SDL_TraceBuffer *buffer = (SDL_TraceBuffer *)data;
+    SDL_TraceBuffer **prev;
+
+    SDL_AtomicLock(&SDL_trace_lock);
+    for (prev = &SDL_trace_buffers; *prev && *prev != buffer; prev = &(*prev)->next) {
+    }
+    if (*prev && SDL_trace_saving == 0) {
+        if (buffer->generation != SDL_AtomicGet(&SDL_trace_generation) ||
+            SDL_AtomicGet(&buffer->count) == 0) {
+            *prev = buffer->next;
+            SDL_free(buffer);
+            buffer = NULL;
+        } else {
+            const size_t size = sizeof (*buffer) - sizeof (buffer->events) +
+                                SDL_AtomicGet(&buffer->count) * sizeof (buffer->events[0]);
+            SDL_TraceBuffer *shrunk = (SDL_TraceBuffer *)SDL_realloc(buffer, size);
+            if (shrunk) {
+                buffer = shrunk;
+                *prev = buffer;
+            }
+        }
+    }
+    if (buffer) {
+        SDL_AtomicSet(&buffer->exited, 1);
+    }
+    SDL_AtomicUnlock(&SDL_trace_lock);
+}
+
+static SDL_TraceBuffer *
+SDL_CreateTraceBuffer(void)
+{
+    SDL_TraceBuffer *buffer = (SDL_TraceBuffer *)SDL_calloc(1, sizeof (*buffer));
+    const char *name;
+
+    if (!buffer) {
+        /* Don't try again for every event */
+        SDL_trace_enabled = SDL_FALSE;
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    name = (const char *)SDL_TLSGet(SDL_trace_name_tls);
+    if (name) {
+        SDL_strlcpy(buffer->thread_name, name, sizeof (buffer->thread_name));
+    } else {
+        SDL_snprintf(buffer->thread_name, sizeof (buffer->thread_name), "Thread %lu", SDL_ThreadID());
+    }
+    buffer->generation = SDL_AtomicGet(&SDL_trace_generation);
+
+    SDL_AtomicLock(&SDL_trace_lock);
+    buffer->tid = SDL_trace_next_tid++;
+    buffer->next = SDL_trace_buffers;
+    SDL_trace_buffers = buffer;
+    SDL_AtomicUnlock(&SDL_trace_lock);
+
+    SDL_TLSSet(SDL_trace_buffer_tls, buffer, SDL_TraceThreadExited);
+    return buffer;
+}
+
+static void
+SDL_AddTraceEvent(SDL_TraceEventType type, const char *name, Sint64 value)
+{
+    SDL_TraceBuffer *buffer;
+    SDL_TraceEvent *event;
+    int generation;
+    int count;
+
+    if (!SDL_trace_enabled) {
+        return;
+    }
+
+    buffer = (SDL_TraceBuffer *)SDL_TLSGet(SDL_trace_buffer_tls);
+    if (!buffer) {
+        buffer = SDL_CreateTraceBuffer();
+        if (!buffer) {
+            return;
+        }
+    }
+
+    /* A new trace started since this thread last recorded anything */
+    generation = SDL_AtomicGet(&SDL_trace_generation);
+    if (buffer->generation != generation) {
+        SDL_AtomicSet(&buffer->count, 0);
+        buffer->depth = 0;
+        buffer->dropped = 0;
+        buffer->generation = generation;
+    }
+
+    if (type == SDL_TRACE_EVENT_END) {
+        if (buffer->depth == 0) {
+            return;  /* the scope started before the trace did */
+        }
+        --buffer->depth;
+    }
+
+    count = SDL_AtomicGet(&buffer->count);
+    if (count == SDL_TRACE_BUFFER_EVENTS) {
+        ++buffer->dropped;
+        return;
+    }
+    if (type == SDL_TRACE_EVENT_BEGIN) {
+        ++buffer->depth;
+    }
+
+    event = &buffer->events[count];
+    event->ticks = SDL_GetPerformanceCounter();
+    event->name = name;
+    event->value = value;
+    event->type = type;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&buffer->count, count + 1);
+}
+
+/* Call with SDL_trace_lock held */
+static void
+SDL_FreeExitedTraceBuffers(void)
+{
+    SDL_TraceBuffer **prev = &SDL_trace_buffers;
+
+    if (SDL_trace_saving > 0) {
+        return;  /* they go at the next start or quit */
+    }
+
+    while (*prev) {
+        SDL_TraceBuffer *buffer = *prev;
+        if (SDL_AtomicGet(&buffer->exited)) {
+            *prev = buffer->next;
+            SDL_free(buffer);
+        } else {
+            prev = &buffer->next;
+        }
+    }
+}
+
+int
+SDL_StartTrace(void)
+{
+    SDL_AtomicLock(&SDL_trace_lock);
+    if (!SDL_CreateTraceTLS()) {
+        SDL_AtomicUnlock(&SDL_trace_lock);
+        return -1;
+    }
+    SDL_FreeExitedTraceBuffers();
+    SDL_trace_start_ticks = SDL_GetPerformanceCounter();
+    SDL_trace_stop_ticks = 0;
+    SDL_AtomicIncRef(&SDL_trace_generation);
+    SDL_trace_enabled = SDL_TRUE;
+    SDL_AtomicUnlock(&SDL_trace_lock);
+    return 0;
+}
+
+void
+SDL_StopTrace(void)
+{
+    SDL_AtomicLock(&SDL_trace_lock);
+    if (SDL_trace_enabled) {
+        SDL_trace_enabled = SDL_FALSE;
+        SDL_trace_stop_ticks = SDL_GetPerformanceCounter();
+    }
+    SDL_AtomicUnlock(&SDL_trace_lock);
+}
+
+SDL_bool
+SDL_IsTracing(void)
+{
+    return SDL_trace_enabled;
+}
+
+void
+SDL_TraceBegin(const char *name)
+{
+    SDL_AddTraceEvent(SDL_TRACE_EVENT_BEGIN, name, 0);
+}
+
+void
+SDL_TraceEnd(void)
+{
+    SDL_AddTraceEvent(SDL_TRACE_EVENT_END, NULL, 0);
+}
+
+void
+SDL_TraceInstant(const char *name)
+{
+    SDL_AddTraceEvent(SDL_TRACE_EVENT_INSTANT, name, 0);
+}
+
+void
+SDL_TraceCounter(const char *name, Sint64 value)
+{
+    SDL_AddTraceEvent(SDL_TRACE_EVENT_COUNTER, name, value);
+}
+
+void
+SDL_TraceThreadStarted(const char *name)
+{
+    SDL_bool ready;
+
+    SDL_AtomicLock(&SDL_trace_lock);
+    ready = SDL_CreateTraceTLS();
+    SDL_AtomicUnlock(&SDL_trace_lock);
+    if (ready) {
+        SDL_TLSSet(SDL_trace_name_tls, (void *)name, NULL);
+    }
+}
+
+/* Output is collected in a buffer and written out in large pieces */
+typedef struct
+{
+    SDL_RWops *dst;
+    size_t used;
+    SDL_bool failed;
+    char data[16 * 1024];
+} SDL_TraceWriter;
+
+static void
+SDL_FlushTraceWriter(SDL_TraceWriter *writer)
+{
+    if (writer->used && !writer->failed) {
+        if (SDL_RWwrite(writer->dst, writer->data, writer->used, 1) != 1) {
+            writer->failed = SDL_TRUE;
+        }
+    }
+    writer->used = 0;
+}
+
+static void
+SDL_WriteTrace(SDL_TraceWriter *writer, SDL_PRINTF_FORMAT_STRING const char *fmt, ...) SDL_PRINTF_VARARG_FUNC(2);
+
+static void
+SDL_WriteTrace(SDL_TraceWriter *writer, const char *fmt, ...)
+{
+    /* Each call writes at most one event, well below this */
+    const size_t reserve = 2 * 1024;
+    va_list ap;
+    int len;
+
+    if (writer->used + reserve > sizeof (writer->data)) {
+        SDL_FlushTraceWriter(writer);
+    }
+    va_start(ap, fmt);
+    len = SDL_vsnprintf(writer->data + writer->used, reserve, fmt, ap);
+    va_end(ap);
+    if (len > 0) {
+        writer->used += SDL_min((size_t)len, reserve - 1);
+    }
+}
+
+const char *
+SDL_EscapeJSONString(const char *str, char *escaped, size_t size)
+{
+    char *dst = escaped;
+    char *end = escaped + size - 7;
+
+    if (!str) {
+        return "";
+    }
+    for (; *str && dst < end; ++str) {
+        const unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\') {
+            *dst++ = '\\';
+            *dst++ = (char)c;
+        } else if (c < 0x20) {
+            dst += SDL_snprintf(dst, 7, "\\u%04x", c);
+        } else {
+            *dst++ = (char)c;
+        }
+    }
+    *dst = '\0';
+    return escaped;
+}
+
+int
+SDL_SaveTrace_RW(SDL_RWops *dst, int freedst)
+{
+    SDL_TraceWriter *writer;
+    SDL_TraceBuffer *buffers, *buffer;
+    char name[SDL_TRACE_MAX_NAME * 6 + 8];
+    const double us_per_tick = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+    Uint64 start_ticks, end_ticks;
+    int generation;
+    int dropped = 0;
+    int retval = 0;
+
+    if (!dst) {
+        return -1;  /* the error was set by whoever made the stream */
+    }
+    writer = (SDL_TraceWriter *)SDL_malloc(sizeof (*writer));
+    if (!writer) {
+        if (freedst) {
+            SDL_RWclose(dst);
+        }
+        return SDL_OutOfMemory();
+    }
+    writer->dst = dst;
+    writer->used = 0;
+    writer->failed = SDL_FALSE;
+
+    /* Buffers are neither freed nor reused while a save is in progress,
+       and new ones go in front of the list, so everything from this head
+       on can be walked without the lock. Threads keep recording meanwhile,
+       each buffer is written up to the count it had published. */
+    SDL_AtomicLock(&SDL_trace_lock);
+    ++SDL_trace_saving;
+    buffers = SDL_trace_buffers;
+    generation = SDL_AtomicGet(&SDL_trace_generation);
+    start_ticks = SDL_trace_start_ticks;
+    end_ticks = SDL_trace_enabled ? SDL_GetPerformanceCounter() : SDL_trace_stop_ticks;
+    SDL_AtomicUnlock(&SDL_trace_lock);
+
+    SDL_WriteTrace(writer, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    SDL_WriteTrace(writer, "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"SDL\"}}");
+    for (buffer = buffers; buffer; buffer = buffer->next) {
+        int count, depth = 0;
+        int i;
+
+        if (buffer->generation != generation) {
+            continue;  /* nothing recorded in this trace yet */
+        }
+        count = SDL_AtomicGet(&buffer->count);
+        SDL_MemoryBarrierAcquire();
+
+        SDL_WriteTrace(writer, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                       buffer->tid, SDL_EscapeJSONString(buffer->thread_name, name, sizeof (name)));
+        for (i = 0; i < count; ++i) {
+            const SDL_TraceEvent *event = &buffer->events[i];
+            const double ts = (double)(event->ticks - start_ticks) * us_per_tick;
+
+            switch (event->type) {
+            case SDL_TRACE_EVENT_BEGIN:
+                ++depth;
+                SDL_WriteTrace(writer, ",\n{\"ph\":\"B\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+                               SDL_EscapeJSONString(event->name, name, sizeof (name)), buffer->tid, ts);
+                break;
+            case SDL_TRACE_EVENT_END:
+                --depth;
+                SDL_WriteTrace(writer, ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", buffer->tid, ts);
+                break;
+            case SDL_TRACE_EVENT_INSTANT:
+                SDL_WriteTrace(writer, ",\n{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+                               SDL_EscapeJSONString(event->name, name, sizeof (name)), buffer->tid, ts);
+                break;
+            case SDL_TRACE_EVENT_COUNTER:
+                SDL_WriteTrace(writer, ",\n{\"ph\":\"C\",\"name\":\"%s\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"args\":{\"value\":%" SDL_PRIs64 "}}",
+                               SDL_EscapeJSONString(event->name, name, sizeof (name)), buffer->tid, ts, event->value);
+                break;
+            }
+        }
+
+        /* Close the scopes still open at the end of the trace */
+        if (depth > 0) {
+            const double ts = (double)(end_ticks - start_ticks) * us_per_tick;
+            for (; depth > 0; --depth) {
+                SDL_WriteTrace(writer, ",\n{\"ph\":\"E\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}", buffer->tid, ts);
+            }
+        }
+        dropped += buffer->dropped;
+    }
+
+    SDL_AtomicLock(&SDL_trace_lock);
+    --SDL_trace_saving;
+    SDL_AtomicUnlock(&SDL_trace_lock);
+
+    SDL_WriteTrace(writer, "\n],\n\"otherData\":{\"dropped_events\":\"%d\"}}\n", dropped);
+    SDL_FlushTraceWriter(writer);
+    if (writer->failed) {
+        retval = -1;  /* SDL_RWwrite() set the error */
+    }
+    SDL_free(writer);
+
+    if (freedst) {
+        if (SDL_RWclose(dst) < 0) {
+            retval = -1;
+        }
+    }
+    return retval;
+}
+
+void
+SDL_TraceInit(void)
+{
+    const char *file = SDL_GetHint(SDL_HINT_TRACE_FILE);
+
+    if (file && *file && !SDL_trace_file && !SDL_trace_enabled) {
+        SDL_trace_file = SDL_strdup(file);
+        if (SDL_trace_file) {
+            SDL_StartTrace();
+        }
+    }
+}
+
+void
+SDL_TraceQuit(void)
+{
+    if (SDL_trace_file) {
+        SDL_StopTrace();
+        if (SDL_SaveTrace(SDL_trace_file) < 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Couldn't save trace to %s: %s", SDL_trace_file, SDL_GetError());
+        }
+        SDL_free(SDL_trace_file);
+        SDL_trace_file = NULL;
+
+        SDL_AtomicLock(&SDL_trace_lock);
+        SDL_FreeExitedTraceBuffers();
+        SDL_AtomicUnlock(&SDL_trace_lock);
+    }
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,57 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "./SDL_internal.h"
+
+#ifndef SDL_trace_c_h_
+#define SDL_trace_c_h_
+
+#include "SDL_trace.h"
+
+/* Set while a trace is running. The macros below read it without a
+   barrier so an idle annotation costs one load and a branch. */
+extern volatile SDL_bool SDL_trace_enabled;
+
+#define SDL_TRACE_BEGIN(name) \
+    do { if (SDL_trace_enabled) { SDL_TraceBegin(name); } } while (0)
+#define SDL_TRACE_END() \
+    do { if (SDL_trace_enabled) { SDL_TraceEnd(); } } while (0)
+#define SDL_TRACE_INSTANT(name) \
+    do { if (SDL_trace_enabled) { SDL_TraceInstant(name); } } while (0)
+#define SDL_TRACE_COUNTER(name, value) \
+    do { if (SDL_trace_enabled) { SDL_TraceCounter(name, value); } } while (0)
+
+/* Remember the name of the calling SDL thread for the trace, called from
+   SDL_RunThread(). The name must outlive the thread. */
+extern void SDL_TraceThreadStarted(const char *name);
+
+/* Escape a string for use inside a JSON string literal. size must be at
+   least 7, longer input is cut short. Returns escaped, or "" for NULL. */
+extern const char *SDL_EscapeJSONString(const char *str, char *escaped, size_t size);
+
+/* Start a trace if SDL_HINT_TRACE_FILE is set, called from SDL_Init() */
+extern void SDL_TraceInit(void);
+
+/* Stop and save the SDL_HINT_TRACE_FILE trace, called from SDL_Quit() */
+extern void SDL_TraceQuit(void);
+
+#endif /* SDL_trace_c_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
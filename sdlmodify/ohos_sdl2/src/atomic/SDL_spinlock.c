@@ -27,6 +27,7 @@
 #include "SDL_atomic.h"
 #include "SDL_mutex.h"
 #include "SDL_timer.h"
+#include "SDL_atomic_c.h"
 
 #if !defined(HAVE_GCC_ATOMICS) && defined(__SOLARIS__)
 #include <atomic.h>
@@ -36,10 +37,6 @@
 #include <unixlib/local.h>
 #endif
 
-#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
-#include <xmmintrin.h>
-#endif
-
 #if defined(__WATCOMC__) && defined(__386__)
 SDL_COMPILE_TIME_ASSERT(locksize, 4==sizeof(SDL_SpinLock));
 extern _inline int _SDL_xchg_watcom(volatile int *a, int v);
@@ -135,32 +132,31 @@ SDL_AtomicTryLock(SDL_SpinLock *lock)
 #endif
 }
 
-/* "REP NOP" is PAUSE, coded for tools that don't know it by that name. */
-#if (defined(__GNUC__) || defined(__clang__)) && (defined(__i386__) || defined(__x86_64__))
-    #define PAUSE_INSTRUCTION() __asm__ __volatile__("pause\n")  /* Some assemblers can't do REP NOP, so go with PAUSE. */
-#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
-    #define PAUSE_INSTRUCTION() _mm_pause()  /* this is actually "rep nop" and not a SIMD instruction. No inline asm in MSVC x86-64! */
-#elif defined(__WATCOMC__) && defined(__386__)
-    /* watcom assembler rejects PAUSE if CPU < i686, and it refuses REP NOP as an invalid combination. Hardcode the bytes.  */
-    extern _inline void PAUSE_INSTRUCTION(void);
-    #pragma aux PAUSE_INSTRUCTION = "db 0f3h,90h"
-#else
-    #define PAUSE_INSTRUCTION()
-#endif
+/* Longest run of pause instructions between attempts, before yielding */
+#define SDL_SPINLOCK_MAX_BACKOFF 64
 
 void
 SDL_AtomicLock(SDL_SpinLock *lock)
 {
-    int iterations = 0;
+    int backoff = 1;
+    int i;
+
     /* FIXME: Should we have an eventual timeout? */
     while (!SDL_AtomicTryLock(lock)) {
-        if (iterations < 32) {
-            iterations++;
-            PAUSE_INSTRUCTION();
-        } else {
-            /* !!! FIXME: this doesn't definitely give up the current timeslice, it does different things on various platforms. */
-            SDL_Delay(0);
-        }
+        /* Back off exponentially, and only retry the exchange once the lock
+           looks free, so waiters don't keep stealing the cache line from
+           the thread that holds it. */
+        do {
+            if (backoff <= SDL_SPINLOCK_MAX_BACKOFF) {
+                for (i = 0; i < backoff; ++i) {
+                    PAUSE_INSTRUCTION();
+                }
+                backoff *= 2;
+            } else {
+                /* !!! FIXME: this doesn't definitely give up the current timeslice, it does different things on various platforms. */
+                SDL_Delay(0);
+            }
+        } while (*(volatile SDL_SpinLock *)lock);
     }
 }
 
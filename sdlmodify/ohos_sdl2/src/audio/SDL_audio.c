@@ -27,6 +27,10 @@
 #include "SDL_audio_c.h"
 #include "SDL_sysaudio.h"
 #include "../thread/SDL_systhread.h"
+#include "../SDL_trace_c.h"
+#if SDL_AUDIO_DRIVER_OHOS
+#include "ohos/SDL_ohosaudiomanager.h"
+#endif
 
 #define _THIS SDL_AudioDevice *_this
 
@@ -563,7 +567,8 @@ SDL_RemoveAudioDevice(const int iscapture, void *handle)
 static void SDLCALL
 SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
 {
-    /* this function always holds the mixer lock before being called. */
+    /* the audio thread reads the queue, SDL_QueueAudio writes to it without
+       waiting on this thread, and the other way around. */
     SDL_AudioDevice *device = (SDL_AudioDevice *) userdata;
     size_t dequeued;
 
@@ -576,7 +581,6 @@ SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
     len -= (int) dequeued;
 
     if (len > 0) {  /* fill any remaining space in the stream with silence. */
-        SDL_assert(SDL_CountDataQueue(device->buffer_queue) == 0);
         SDL_memset(stream, device->spec.silence, len);
     }
 }
@@ -584,7 +588,7 @@ SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
 static void SDLCALL
 SDL_BufferQueueFillCallback(void *userdata, Uint8 *stream, int len)
 {
-    /* this function always holds the mixer lock before being called. */
+    /* the audio thread writes the queue, SDL_DequeueAudio reads from it. */
     SDL_AudioDevice *device = (SDL_AudioDevice *) userdata;
 
     SDL_assert(device != NULL);  /* this shouldn't ever happen, right?! */
@@ -612,9 +616,9 @@ SDL_QueueAudio(SDL_AudioDeviceID devid, const void *data, Uint32 len)
     }
 
     if (len > 0) {
-        current_audio.impl.LockDevice(device);
+        SDL_LockMutex(device->buffer_queue_lock);
         rc = SDL_WriteToDataQueue(device->buffer_queue, data, len);
-        current_audio.impl.UnlockDevice(device);
+        SDL_UnlockMutex(device->buffer_queue_lock);
     }
 
     return rc;
@@ -633,9 +637,9 @@ SDL_DequeueAudio(SDL_AudioDeviceID devid, void *data, Uint32 len)
         return 0;  /* just report zero bytes dequeued. */
     }
 
-    current_audio.impl.LockDevice(device);
+    SDL_LockMutex(device->buffer_queue_lock);
     rc = (Uint32) SDL_ReadFromDataQueue(device->buffer_queue, data, len);
-    current_audio.impl.UnlockDevice(device);
+    SDL_UnlockMutex(device->buffer_queue_lock);
     return rc;
 }
 
@@ -653,9 +657,7 @@ SDL_GetQueuedAudioSize(SDL_AudioDeviceID devid)
     if (device->callbackspec.callback == SDL_BufferQueueDrainCallback ||
         device->callbackspec.callback == SDL_BufferQueueFillCallback)
     {
-        current_audio.impl.LockDevice(device);
         retval = (Uint32) SDL_CountDataQueue(device->buffer_queue);
-        current_audio.impl.UnlockDevice(device);
     }
 
     return retval;
@@ -666,17 +668,25 @@ SDL_ClearQueuedAudio(SDL_AudioDeviceID devid)
 {
     SDL_AudioDevice *device = get_audio_device(devid);
 
-    if (!device) {
+    if (!device || !device->buffer_queue) {
         return;  /* nothing to do. */
     }
 
-    /* Blank out the device and release the mutex. Free it afterwards. */
-    current_audio.impl.LockDevice(device);
+    /* Clearing is the reader's job. The audio thread reads playback queues,
+       so keep it out of the way for this one. The device lock comes first,
+       like an app calling SDL_QueueAudio() inside SDL_LockAudioDevice(). */
+    if (!device->iscapture) {
+        current_audio.impl.LockDevice(device);
+    }
+    SDL_LockMutex(device->buffer_queue_lock);
 
     /* Keep up to two packets in the pool to reduce future malloc pressure. */
     SDL_ClearDataQueue(device->buffer_queue, SDL_AUDIOBUFFERQUEUE_PACKETLEN * 2);
 
-    current_audio.impl.UnlockDevice(device);
+    SDL_UnlockMutex(device->buffer_queue_lock);
+    if (!device->iscapture) {
+        current_audio.impl.UnlockDevice(device);
+    }
 }
 
 
@@ -709,6 +719,7 @@ SDL_RunAudio(void *devicep)
 
     /* Loop, filling the audio buffers */
     while (!SDL_AtomicGet(&device->shutdown)) {
+        SDL_TRACE_BEGIN("SDL_RunAudio");
         current_audio.impl.BeginLoopIteration(device);
     #ifndef __OHOS__
         data_len = device->callbackspec.size;
@@ -740,7 +751,9 @@ SDL_RunAudio(void *devicep)
         if (SDL_AtomicGet(&device->paused)) {
             SDL_memset(data, device->spec.silence, data_len);
         } else {
+            SDL_TRACE_BEGIN("SDL_AudioCallback");
             callback(udata, data, data_len);
+            SDL_TRACE_END();
         }
         SDL_UnlockMutex(device->mixer_lock);
 
@@ -763,7 +776,9 @@ SDL_RunAudio(void *devicep)
                         SDL_memset(data, device->spec.silence, device->spec.size);
                     }
                     current_audio.impl.PlayDevice(device);
+                    SDL_TRACE_BEGIN("WaitDevice");
                     current_audio.impl.WaitDevice(device);
+                    SDL_TRACE_END();
                 }
             }
         } else if (data == device->work_buffer) {
@@ -773,8 +788,11 @@ SDL_RunAudio(void *devicep)
         } else {  /* writing directly to the device. */
             /* queue this buffer and wait for it to finish playing. */
             current_audio.impl.PlayDevice(device);
+            SDL_TRACE_BEGIN("WaitDevice");
             current_audio.impl.WaitDevice(device);
+            SDL_TRACE_END();
         }
+        SDL_TRACE_END();
     }
 
     current_audio.impl.PrepareToClose(device);
@@ -787,6 +805,64 @@ SDL_RunAudio(void *devicep)
     return 0;
 }
 
+/* Pull mode: the backend's own thread asks for len bytes to play. */
+void
+SDL_PullAudio(SDL_AudioDevice *device, Uint8 *stream, int len)
+{
+    void *udata;
+    SDL_AudioCallback callback;
+
+    SDL_assert(device->pull_mode);
+    SDL_assert(device->mixer_lock != NULL);
+
+    /* Devices start paused, so this also covers calls made while opening. */
+    if (SDL_AtomicGet(&device->shutdown) || !SDL_AtomicGet(&device->enabled) || SDL_AtomicGet(&device->paused)) {
+        SDL_memset(stream, device->spec.silence, len);
+        return;
+    }
+
+    /* The system's thread never waits on the app. If someone holds the
+       device lock (or the device is being paused), play silence for now. */
+    if (SDL_TryLockMutex(device->mixer_lock) != 0) {
+        SDL_memset(stream, device->spec.silence, len);
+        return;
+    }
+
+    SDL_TRACE_BEGIN("SDL_PullAudio");
+    udata = device->callbackspec.userdata;
+    callback = device->callbackspec.callback;
+    if (SDL_AtomicGet(&device->paused)) {
+        SDL_memset(stream, device->spec.silence, len);
+    } else if (!device->stream) {
+        /* no conversion, so the app writes straight into the system's buffer. */
+        SDL_TRACE_BEGIN("SDL_AudioCallback");
+        callback(udata, stream, len);
+        SDL_TRACE_END();
+    } else {  /* the stream converts straight into the system's buffer. */
+        const int stream_len = device->callbackspec.size;
+        int got;
+
+        while (SDL_AudioStreamAvailable(device->stream) < len) {
+            SDL_TRACE_BEGIN("SDL_AudioCallback");
+            callback(udata, device->work_buffer, stream_len);
+            SDL_TRACE_END();
+            /* if this fails...oh well. We'll play silence here. */
+            if (SDL_AudioStreamPut(device->stream, device->work_buffer, stream_len) == -1) {
+                SDL_AudioStreamClear(device->stream);
+                break;
+            }
+        }
+
+        got = SDL_AudioStreamGet(device->stream, stream, len);
+        SDL_assert((got < 0) || (got == len));
+        if (got != len) {
+            SDL_memset(stream, device->spec.silence, len);
+        }
+    }
+    SDL_UnlockMutex(device->mixer_lock);
+    SDL_TRACE_END();
+}
+
 /* !!! FIXME: this needs to deal with device spec changes. */
 /* The general capture thread function */
 static int SDLCALL
@@ -819,6 +895,7 @@ SDL_CaptureAudio(void *devicep)
 
     /* Loop, filling the audio buffers */
     while (!SDL_AtomicGet(&device->shutdown)) {
+        SDL_bool queued = SDL_FALSE;
         int still_need;
         Uint8 *ptr;
 
@@ -836,8 +913,17 @@ SDL_CaptureAudio(void *devicep)
         /* Fill the current buffer with sound */
         still_need = data_len;
 
-        /* Use the work_buffer to hold data read from the device. */
-        data = device->work_buffer;
+        /* Queued capture that needs no conversion reads straight into the
+           queue. Otherwise, use the work_buffer to hold data read from the device. */
+        data = NULL;
+        if (!device->stream && (callback == SDL_BufferQueueFillCallback) &&
+            (data_len <= SDL_AUDIOBUFFERQUEUE_PACKETLEN)) {
+            data = (Uint8 *) SDL_ReserveSpaceInDataQueue(device->buffer_queue, data_len);
+            queued = (data != NULL);
+        }
+        if (!data) {
+            data = device->work_buffer;
+        }
         SDL_assert(data != NULL);
 
         ptr = data;
@@ -881,15 +967,21 @@ SDL_CaptureAudio(void *devicep)
                 /* !!! FIXME: this should be LockDevice. */
                 SDL_LockMutex(device->mixer_lock);
                 if (!SDL_AtomicGet(&device->paused)) {
+                    SDL_TRACE_BEGIN("SDL_AudioCallback");
                     callback(udata, device->work_buffer, device->callbackspec.size);
+                    SDL_TRACE_END();
                 }
                 SDL_UnlockMutex(device->mixer_lock);
             }
+        } else if (queued) {  /* already in place, just publish it. */
+            SDL_CommitSpaceInDataQueue(device->buffer_queue, SDL_AtomicGet(&device->paused) ? 0 : data_len);
         } else {  /* feeding user callback directly without streaming. */
             /* !!! FIXME: this should be LockDevice. */
             SDL_LockMutex(device->mixer_lock);
             if (!SDL_AtomicGet(&device->paused)) {
+                SDL_TRACE_BEGIN("SDL_AudioCallback");
                 callback(udata, data, device->callbackspec.size);
+                SDL_TRACE_END();
             }
             SDL_UnlockMutex(device->mixer_lock);
         }
@@ -1135,6 +1227,13 @@ close_audio_device(SDL_AudioDevice * device)
     }
 #endif
 
+    /* In pull mode the backend's thread calls into the device, so stop it
+       before tearing down the lock, stream and buffers it uses. */
+    if (device->pull_mode && (device->hidden != NULL)) {
+        current_audio.impl.CloseDevice(device);
+        device->hidden = NULL;
+    }
+
     if (device->thread != NULL) {
         SDL_WaitThread(device->thread, NULL);
     }
@@ -1158,6 +1257,9 @@ close_audio_device(SDL_AudioDevice * device)
     }
 
     SDL_FreeDataQueue(device->buffer_queue);
+    if (device->buffer_queue_lock != NULL) {
+        SDL_DestroyMutex(device->buffer_queue_lock);
+    }
 
     SDL_free(device);
 }
@@ -1350,6 +1452,10 @@ open_audio_device(const char *devname, int iscapture,
     SDL_AtomicSet(&device->paused, 1);
     SDL_AtomicSet(&device->enabled, 1);
 
+    if (!iscapture && current_audio.impl.SupportsPullMode) {
+        device->pull_mode = SDL_GetHintBoolean(SDL_HINT_AUDIO_PULL_MODE, SDL_FALSE);
+    }
+
     /* Create a mutex for locking the sound buffers */
     if (!current_audio.impl.SkipMixerLock) {
         device->mixer_lock = SDL_CreateMutex();
@@ -1358,6 +1464,7 @@ open_audio_device(const char *devname, int iscapture,
             SDL_SetError("Couldn't create mixer lock");
             return 0;
         }
+        SDL_SetMutexName(device->mixer_lock, "SDL_AudioDevice.mixer_lock");
     }
 
     if (current_audio.impl.OpenDevice(device, handle, devname, iscapture) < 0) {
@@ -1424,7 +1531,8 @@ open_audio_device(const char *devname, int iscapture,
     if (device->spec.callback == NULL) {  /* use buffer queueing? */
         /* pool a few packets to start. Enough for two callbacks. */
         device->buffer_queue = SDL_NewDataQueue(SDL_AUDIOBUFFERQUEUE_PACKETLEN, obtained->size * 2);
-        if (!device->buffer_queue) {
+        device->buffer_queue_lock = SDL_CreateMutex();
+        if (!device->buffer_queue || !device->buffer_queue_lock) {
             close_audio_device(device);
             SDL_SetError("Couldn't create audio buffer queue");
             return 0;
@@ -1450,7 +1558,7 @@ open_audio_device(const char *devname, int iscapture,
     open_devices[id] = device;  /* add it to our list of open devices. */
 
     /* Start the audio thread if necessary */
-    if (!current_audio.impl.ProvidesOwnCallbackThread) {
+    if (!current_audio.impl.ProvidesOwnCallbackThread && !device->pull_mode) {
         /* Start the audio thread */
         /* !!! FIXME: we don't force the audio thread stack size here if it calls into user code, but maybe we should? */
         /* buffer queueing callback only needs a few bytes, so make the stack tiny. */
@@ -1600,6 +1708,28 @@ SDL_CloseAudio(void)
     SDL_CloseAudioDevice(1);
 }
 
+#ifdef __OHOS__
+int
+SDL_OHOSGetAudioRenderStats(SDL_AudioDeviceID devid, SDL_OHOSAudioRenderStats *stats)
+{
+#if SDL_AUDIO_DRIVER_OHOS
+    SDL_AudioDevice *device = get_audio_device(devid);
+    if (!device) {
+        return -1;  /* get_audio_device() will have set the error state */
+    }
+    if (!stats) {
+        return SDL_InvalidParamError("stats");
+    }
+    if (SDL_strcmp(current_audio.name, "ohos") != 0) {
+        return SDL_Unsupported();
+    }
+    return OHOSAUDIO_NATIVE_GetRenderStats(device, stats);
+#else
+    return SDL_Unsupported();
+#endif
+}
+#endif /* __OHOS__ */
+
 void
 SDL_AudioQuit(void)
 {
@@ -75,6 +75,29 @@ extern SDL_AudioFilter SDL_Convert_F32_to_S32;
 extern int SDL_PrepareResampleFilter(void);
 extern void SDL_FreeResampleFilter(void);
 
+/* Polyphase resampler used by SDL_AudioStream, in SDL_audioresample.c. */
+typedef enum
+{
+    SDL_RESAMPLER_QUALITY_FAST,
+    SDL_RESAMPLER_QUALITY_MEDIUM,
+    SDL_RESAMPLER_QUALITY_BEST
+} SDL_ResamplerQuality;
+
+typedef struct SDL_PolyphaseResampler SDL_PolyphaseResampler;
+
+/* Reads SDL_HINT_AUDIO_RESAMPLING_MODE, medium quality if it isn't set. */
+extern SDL_ResamplerQuality SDL_GetResamplerQuality(void);
+
+/* Fails if the ratio needs too many phases, or more than maxlookahead frames
+   past the end of the input. */
+extern SDL_PolyphaseResampler *SDL_NewPolyphaseResampler(const int chans, const int inrate, const int outrate,
+                                                         const int maxlookahead, const SDL_ResamplerQuality quality);
+/* inbuf must be followed by maxlookahead valid frames. Returns the frames written to outbuf. */
+extern int SDL_PolyphaseResample(SDL_PolyphaseResampler *resampler, const float *inbuf, const int inframes,
+                                 float *outbuf, const int maxoutframes);
+extern void SDL_ResetPolyphaseResampler(SDL_PolyphaseResampler *resampler);
+extern void SDL_FreePolyphaseResampler(SDL_PolyphaseResampler *resampler);
+
 #endif /* SDL_audio_c_h_ */
 
 /* vi: set ts=4 sw=4 expandtab: */
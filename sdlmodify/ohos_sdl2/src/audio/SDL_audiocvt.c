@@ -1226,6 +1226,58 @@ SetupLibSampleRateResampling(SDL_AudioStream *stream)
 #endif /* HAVE_LIBSAMPLERATE_H */
 
 
+static int
+SDL_ResampleAudioStream_Polyphase(SDL_AudioStream *stream, const void *_inbuf, const int inbuflen, void *_outbuf, const int outbuflen)
+{
+    const float *inbuf = (const float *) _inbuf;
+    float *outbuf = (float *) _outbuf;
+    const int framelen = sizeof (float) * stream->pre_resample_channels;
+    SDL_PolyphaseResampler *resampler = (SDL_PolyphaseResampler *) stream->resampler_state;
+
+    SDL_assert(inbuf != ((const float *) outbuf));  /* SDL_AudioStreamPut() shouldn't allow in-place resamples. */
+
+    /* the filter looks ahead into the padding samples set up at the end of the input buffer. */
+    return SDL_PolyphaseResample(resampler, inbuf, inbuflen / framelen, outbuf, outbuflen / framelen) * framelen;
+}
+
+static void
+SDL_ResetAudioStreamResampler_Polyphase(SDL_AudioStream *stream)
+{
+    SDL_ResetPolyphaseResampler((SDL_PolyphaseResampler *) stream->resampler_state);
+}
+
+static void
+SDL_CleanupAudioStreamResampler_Polyphase(SDL_AudioStream *stream)
+{
+    SDL_FreePolyphaseResampler((SDL_PolyphaseResampler *) stream->resampler_state);
+
+    stream->resampler_state = NULL;
+    stream->resampler_func = NULL;
+    stream->reset_resampler_func = NULL;
+    stream->cleanup_resampler_func = NULL;
+}
+
+static SDL_bool
+SetupPolyphaseResampling(SDL_AudioStream *stream)
+{
+    const int lookahead = stream->resampler_padding_samples / stream->pre_resample_channels;
+    SDL_PolyphaseResampler *resampler;
+
+    resampler = SDL_NewPolyphaseResampler(stream->pre_resample_channels, stream->src_rate, stream->dst_rate,
+                                          lookahead, SDL_GetResamplerQuality());
+    if (!resampler) {
+        return SDL_FALSE;
+    }
+
+    stream->resampler_state = resampler;
+    stream->resampler_func = SDL_ResampleAudioStream_Polyphase;
+    stream->reset_resampler_func = SDL_ResetAudioStreamResampler_Polyphase;
+    stream->cleanup_resampler_func = SDL_CleanupAudioStreamResampler_Polyphase;
+
+    return SDL_TRUE;
+}
+
+
 static int
 SDL_ResampleAudioStream(SDL_AudioStream *stream, const void *_inbuf, const int inbuflen, void *_outbuf, const int outbuflen)
 {
@@ -1338,6 +1390,11 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
         SetupLibSampleRateResampling(retval);
 #endif
 
+        /* Odd ratios the polyphase tables can't cover use the interpolating resampler. */
+        if (!retval->resampler_func) {
+            SetupPolyphaseResampling(retval);
+        }
+
         if (!retval->resampler_func) {
             retval->resampler_state = SDL_calloc(retval->resampler_padding_samples, sizeof (float));
             if (!retval->resampler_state) {
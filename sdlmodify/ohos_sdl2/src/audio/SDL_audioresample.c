@@ -0,0 +1,500 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+/* Polyphase resampler for SDL_AudioStream.
+
+   The rate ratio is reduced to outrate/inrate = L/M. Output frame n then
+   sits at input position n*M/L, so there are only L distinct fractional
+   offsets ("phases") and the windowed-sinc filter is precomputed once for
+   each of them. Each phase's taps are stored contiguously and repeated for
+   every channel, so producing one output frame is a single dot product of
+   the interleaved input window against one row of the table. The input
+   position and phase advance with integer adds, which carries the exact
+   position from one call to the next.
+
+   Ratios that need too many phases (odd rates like 44100 -> 47999) aren't
+   handled here, the caller falls back to the interpolating resampler. */
+
+#include "SDL_audio.h"
+#include "SDL_audio_c.h"
+#include "SDL_assert.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_hints.h"
+
+#ifdef __ARM_NEON
+#define HAVE_NEON_INTRINSICS 1
+#endif
+
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
+#if defined(HAVE_IMMINTRIN_H) && !defined(SDL_DISABLE_IMMINTRIN_H) && \
+    defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/* Ratios needing more phases than this use the interpolating resampler. */
+#define POLYPHASE_MAX_PHASES 1024
+/* ...as do ratios whose table would be larger than this many floats. */
+#define POLYPHASE_MAX_TABLE_SIZE (1024 * 1024)
+/* Filters are padded to a multiple of this many taps so the SIMD kernels
+   never need a tail loop. */
+#define POLYPHASE_TAP_ALIGN 16
+
+typedef void (*SDL_PolyphaseKernel)(const float *in, const float *coef, const int len, const int chans, float *out);
+
+struct SDL_PolyphaseResampler
+{
+    int chans;
+    int phases;         /* L */
+    int step;           /* M / L */
+    int step_frac;      /* M % L */
+    int taps;           /* filter length in frames, a multiple of POLYPHASE_TAP_ALIGN */
+    int rowlen;         /* taps * chans */
+    float *table;       /* phases rows of rowlen floats */
+    float *history;     /* the last taps/2 input frames before the current buffer */
+    float *window;      /* scratch for windows that start in the history */
+    int pos;            /* input frame of the next output, relative to the current buffer */
+    int phase;          /* its fractional offset, in 1/L frames */
+    SDL_PolyphaseKernel kernel;
+};
+
+typedef struct
+{
+    int zero_crossings;   /* on each side, at the lower of the two rates */
+    double attenuation;   /* stopband attenuation in dB */
+} SDL_PolyphasePreset;
+
+static const SDL_PolyphasePreset polyphase_presets[] = {
+    { 8, 60.0 },     /* SDL_RESAMPLER_QUALITY_FAST */
+    { 16, 80.0 },    /* SDL_RESAMPLER_QUALITY_MEDIUM */
+    { 32, 100.0 }    /* SDL_RESAMPLER_QUALITY_BEST */
+};
+
+SDL_ResamplerQuality
+SDL_GetResamplerQuality(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_AUDIO_RESAMPLING_MODE);
+
+    if (!hint) {
+        return SDL_RESAMPLER_QUALITY_MEDIUM;
+    } else if (*hint == '1' || SDL_strcasecmp(hint, "fast") == 0) {
+        return SDL_RESAMPLER_QUALITY_FAST;
+    } else if (*hint == '3' || SDL_strcasecmp(hint, "best") == 0) {
+        return SDL_RESAMPLER_QUALITY_BEST;
+    }
+    return SDL_RESAMPLER_QUALITY_MEDIUM;
+}
+
+/* Zeroth order modified Bessel function of the first kind, for the Kaiser window. */
+static double
+bessel_i0(const double x)
+{
+    const double xdiv2 = x / 2.0;
+    double sum = 1.0;
+    double term = 1.0;
+    int i;
+
+    for (i = 1; term > 1.0e-21 * sum; i++) {
+        term *= (xdiv2 / i) * (xdiv2 / i);
+        sum += term;
+    }
+    return sum;
+}
+
+static int
+gcd(int a, int b)
+{
+    while (b) {
+        const int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Adds up the lanes of the accumulators that belong to each channel.
+   sums holds len floats, len being a multiple of chans. */
+SDL_FORCE_INLINE void
+Polyphase_SumChannels(const float *sums, const int len, const int chans, float *out)
+{
+    int i, chan;
+
+    for (chan = 0; chan < chans; chan++) {
+        float sample = 0.0f;
+        for (i = chan; i < len; i += chans) {
+            sample += sums[i];
+        }
+        out[chan] = sample;
+    }
+}
+
+static void
+Polyphase_Scalar(const float *in, const float *coef, const int len, const int chans, float *out)
+{
+    float sums[8];
+    int i, chan;
+
+    SDL_assert(chans <= 8);
+
+    for (chan = 0; chan < chans; chan++) {
+        sums[chan] = 0.0f;
+    }
+    for (i = 0; i < len; i += chans) {
+        for (chan = 0; chan < chans; chan++) {
+            sums[chan] += in[i + chan] * coef[i + chan];
+        }
+    }
+    for (chan = 0; chan < chans; chan++) {
+        out[chan] = sums[chan];
+    }
+}
+
+/* The SIMD kernels run one accumulator per vector of a block. A block is a
+   whole number of frames, so lane k of the block always belongs to channel
+   k % chans. Mono and stereo get more accumulators than they need to keep
+   several adds in flight. */
+
+#if HAVE_SSE2_INTRINSICS
+SDL_FORCE_INLINE void
+Polyphase_SSE2(const float *in, const float *coef, const int len, const int chans, float *out)
+{
+    const int accums = (chans < 4) ? 4 : chans;
+    const int blocklen = accums * 4;
+    __m128 acc[8];
+    float sums[32];
+    int i, j;
+
+    SDL_assert((len % blocklen) == 0);
+
+    for (j = 0; j < accums; j++) {
+        acc[j] = _mm_setzero_ps();
+    }
+    for (i = 0; i < len; i += blocklen) {
+        for (j = 0; j < accums; j++) {
+            acc[j] = _mm_add_ps(acc[j], _mm_mul_ps(_mm_loadu_ps(in + i + j * 4), _mm_loadu_ps(coef + i + j * 4)));
+        }
+    }
+    for (j = 0; j < accums; j++) {
+        _mm_storeu_ps(sums + j * 4, acc[j]);
+    }
+    Polyphase_SumChannels(sums, blocklen, chans, out);
+}
+#endif
+
+#if HAVE_AVX2_INTRINSICS
+SDL_FORCE_INLINE void SDL_TARGET_AVX2
+Polyphase_AVX2(const float *in, const float *coef, const int len, const int chans, float *out)
+{
+    const int accums = (chans < 2) ? 2 : chans;
+    const int blocklen = accums * 8;
+    __m256 acc[8];
+    float sums[64];
+    int i, j;
+
+    SDL_assert((len % blocklen) == 0);
+
+    for (j = 0; j < accums; j++) {
+        acc[j] = _mm256_setzero_ps();
+    }
+    for (i = 0; i < len; i += blocklen) {
+        for (j = 0; j < accums; j++) {
+            acc[j] = _mm256_add_ps(acc[j], _mm256_mul_ps(_mm256_loadu_ps(in + i + j * 8), _mm256_loadu_ps(coef + i + j * 8)));
+        }
+    }
+    for (j = 0; j < accums; j++) {
+        _mm256_storeu_ps(sums + j * 8, acc[j]);
+    }
+    Polyphase_SumChannels(sums, blocklen, chans, out);
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+SDL_FORCE_INLINE void
+Polyphase_NEON(const float *in, const float *coef, const int len, const int chans, float *out)
+{
+    const int accums = (chans < 4) ? 4 : chans;
+    const int blocklen = accums * 4;
+    float32x4_t acc[8];
+    float sums[32];
+    int i, j;
+
+    SDL_assert((len % blocklen) == 0);
+
+    for (j = 0; j < accums; j++) {
+        acc[j] = vdupq_n_f32(0.0f);
+    }
+    for (i = 0; i < len; i += blocklen) {
+        for (j = 0; j < accums; j++) {
+            acc[j] = vmlaq_f32(acc[j], vld1q_f32(in + i + j * 4), vld1q_f32(coef + i + j * 4));
+        }
+    }
+    for (j = 0; j < accums; j++) {
+        vst1q_f32(sums + j * 4, acc[j]);
+    }
+    Polyphase_SumChannels(sums, blocklen, chans, out);
+}
+#endif
+
+/* Instantiate each SIMD kernel with a constant channel count, so its
+   accumulators stay in registers. Odd layouts pass the count through. */
+#define POLYPHASE_KERNELS(simd, attr) \
+    static void attr Polyphase_##simd##_c1(const float *in, const float *coef, const int len, const int chans, float *out) { \
+        Polyphase_##simd(in, coef, len, 1, out); \
+    } \
+    static void attr Polyphase_##simd##_c2(const float *in, const float *coef, const int len, const int chans, float *out) { \
+        Polyphase_##simd(in, coef, len, 2, out); \
+    } \
+    static void attr Polyphase_##simd##_c4(const float *in, const float *coef, const int len, const int chans, float *out) { \
+        Polyphase_##simd(in, coef, len, 4, out); \
+    } \
+    static void attr Polyphase_##simd##_c6(const float *in, const float *coef, const int len, const int chans, float *out) { \
+        Polyphase_##simd(in, coef, len, 6, out); \
+    } \
+    static void attr Polyphase_##simd##_c8(const float *in, const float *coef, const int len, const int chans, float *out) { \
+        Polyphase_##simd(in, coef, len, 8, out); \
+    } \
+    static void attr Polyphase_##simd##_cN(const float *in, const float *coef, const int len, const int chans, float *out) { \
+        Polyphase_##simd(in, coef, len, chans, out); \
+    }
+
+#if HAVE_SSE2_INTRINSICS
+POLYPHASE_KERNELS(SSE2, )
+#endif
+#if HAVE_AVX2_INTRINSICS
+POLYPHASE_KERNELS(AVX2, SDL_TARGET_AVX2)
+#endif
+#if HAVE_NEON_INTRINSICS
+POLYPHASE_KERNELS(NEON, )
+#endif
+#undef POLYPHASE_KERNELS
+
+static SDL_PolyphaseKernel
+ChoosePolyphaseKernel(const int chans)
+{
+#define CHOOSE_KERNEL(simd) \
+    switch (chans) { \
+        case 1: return Polyphase_##simd##_c1; \
+        case 2: return Polyphase_##simd##_c2; \
+        case 4: return Polyphase_##simd##_c4; \
+        case 6: return Polyphase_##simd##_c6; \
+        case 8: return Polyphase_##simd##_c8; \
+        default: return Polyphase_##simd##_cN; \
+    }
+
+#if HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        CHOOSE_KERNEL(AVX2);
+    }
+#endif
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        CHOOSE_KERNEL(SSE2);
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        CHOOSE_KERNEL(NEON);
+    }
+#endif
+#undef CHOOSE_KERNEL
+
+    return Polyphase_Scalar;
+}
+
+/* Fill in the taps of every phase. Tap k of phase p weighs input frame
+   pos - taps/2 + 1 + k for an output at pos + p/L. When downsampling, the
+   cutoff and the filter length scale with the ratio to keep out aliases. */
+static void
+BuildPolyphaseTable(SDL_PolyphaseResampler *resampler, const SDL_PolyphasePreset *preset, const double scale)
+{
+    const int chans = resampler->chans;
+    const int taps = resampler->taps;
+    const int halftaps = taps / 2;
+    /* Kaiser's estimate of the transition band for this length and attenuation,
+       relative to the lower rate. Half of it is allowed to alias, just below Nyquist. */
+    const double transition = (preset->attenuation - 7.95) / (14.36 * (2 * preset->zero_crossings - 1));
+    const double cutoff = (1.0 - (transition / 2.0)) * scale;
+    const double beta = 0.1102 * (preset->attenuation - 8.7);
+    const double i0beta = bessel_i0(beta);
+    int phase, tap, chan;
+
+    for (phase = 0; phase < resampler->phases; phase++) {
+        float *row = resampler->table + (phase * resampler->rowlen);
+        double sum = 0.0;
+
+        for (tap = 0; tap < taps; tap++) {
+            const double t = (double) (tap - halftaps + 1) - (((double) phase) / resampler->phases);
+            const double x = t / halftaps;
+            double h = 0.0;
+            if (x > -1.0 && x < 1.0) {
+                const double window = bessel_i0(beta * SDL_sqrt(1.0 - (x * x))) / i0beta;
+                const double arg = M_PI * cutoff * t;
+                h = cutoff * window * ((t == 0.0) ? 1.0 : (SDL_sin(arg) / arg));
+            }
+            row[tap * chans] = (float) h;
+            sum += h;
+        }
+
+        /* Every phase passes DC at exactly unity gain, so a constant signal
+           comes out constant. */
+        for (tap = 0; tap < taps; tap++) {
+            const float h = (float) (row[tap * chans] / sum);
+            for (chan = 0; chan < chans; chan++) {
+                row[(tap * chans) + chan] = h;
+            }
+        }
+    }
+}
+
+SDL_PolyphaseResampler *
+SDL_NewPolyphaseResampler(const int chans, const int inrate, const int outrate,
+                          const int maxlookahead, const SDL_ResamplerQuality quality)
+{
+    const SDL_PolyphasePreset *preset = &polyphase_presets[quality];
+    const int divisor = gcd(inrate, outrate);
+    const int phases = outrate / divisor;
+    const int step = inrate / divisor;
+    const double scale = (step > phases) ? (((double) phases) / step) : 1.0;
+    int taps;
+    SDL_PolyphaseResampler *resampler;
+
+    if (chans < 1 || chans > 8) {
+        SDL_SetError("Polyphase resampler doesn't support %d channels", chans);
+        return NULL;
+    }
+
+    /* twice the zero crossings, widened when downsampling */
+    taps = 2 * (int) SDL_ceil(preset->zero_crossings / scale);
+    taps = (taps + (POLYPHASE_TAP_ALIGN - 1)) & ~(POLYPHASE_TAP_ALIGN - 1);
+
+    if (phases > POLYPHASE_MAX_PHASES || ((Sint64) phases * taps * chans) > POLYPHASE_MAX_TABLE_SIZE) {
+        SDL_SetError("Polyphase resampler can't do %d to %d Hz", inrate, outrate);
+        return NULL;
+    } else if (taps / 2 > maxlookahead) {
+        SDL_SetError("Polyphase resampler needs %d frames of lookahead", taps / 2);
+        return NULL;
+    }
+
+    resampler = (SDL_PolyphaseResampler *) SDL_calloc(1, sizeof (SDL_PolyphaseResampler));
+    if (!resampler) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    resampler->chans = chans;
+    resampler->phases = phases;
+    resampler->step = step / phases;
+    resampler->step_frac = step % phases;
+    resampler->taps = taps;
+    resampler->rowlen = taps * chans;
+    resampler->table = (float *) SDL_malloc(phases * resampler->rowlen * sizeof (float));
+    resampler->history = (float *) SDL_calloc((taps / 2) * chans, sizeof (float));
+    resampler->window = (float *) SDL_malloc(resampler->rowlen * sizeof (float));
+    if (!resampler->table || !resampler->history || !resampler->window) {
+        SDL_FreePolyphaseResampler(resampler);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    BuildPolyphaseTable(resampler, preset, scale);
+    resampler->kernel = ChoosePolyphaseKernel(chans);
+
+    return resampler;
+}
+
+int
+SDL_PolyphaseResample(SDL_PolyphaseResampler *resampler, const float *inbuf, const int inframes,
+                      float *outbuf, const int maxoutframes)
+{
+    const int chans = resampler->chans;
+    const int halftaps = resampler->taps / 2;
+    const int framelen = chans * (int) sizeof (float);
+    const SDL_PolyphaseKernel kernel = resampler->kernel;
+    int pos = resampler->pos;
+    int phase = resampler->phase;
+    int outframes = 0;
+
+    while (pos < inframes) {
+        const int start = pos - halftaps + 1;
+        const float *window = inbuf + (start * chans);
+
+        if (start < 0) {
+            /* the window reaches back into the previous buffer. */
+            const int fromhistory = -start;
+            SDL_memcpy(resampler->window, resampler->history + ((halftaps - fromhistory) * chans), fromhistory * framelen);
+            SDL_memcpy(resampler->window + (fromhistory * chans), inbuf, (resampler->taps - fromhistory) * framelen);
+            window = resampler->window;
+        }
+
+        /* The stream sizes the output for every frame we can make, this
+           only drops frames if that ever goes wrong; the position still
+           advances so the next call stays in step. */
+        SDL_assert(outframes < maxoutframes);
+        if (outframes < maxoutframes) {
+            kernel(window, resampler->table + (phase * resampler->rowlen), resampler->rowlen, chans, outbuf + (outframes * chans));
+            outframes++;
+        }
+
+        pos += resampler->step;
+        phase += resampler->step_frac;
+        if (phase >= resampler->phases) {
+            phase -= resampler->phases;
+            pos++;
+        }
+    }
+
+    /* keep the end of this buffer for the windows of the next one. */
+    if (inframes >= halftaps) {
+        SDL_memcpy(resampler->history, inbuf + ((inframes - halftaps) * chans), halftaps * framelen);
+    } else if (inframes > 0) {
+        SDL_memmove(resampler->history, resampler->history + (inframes * chans), (halftaps - inframes) * framelen);
+        SDL_memcpy(resampler->history + ((halftaps - inframes) * chans), inbuf, inframes * framelen);
+    }
+
+    resampler->pos = pos - inframes;
+    resampler->phase = phase;
+    return outframes;
+}
+
+void
+SDL_ResetPolyphaseResampler(SDL_PolyphaseResampler *resampler)
+{
+    SDL_memset(resampler->history, '\0', (resampler->taps / 2) * resampler->chans * sizeof (float));
+    resampler->pos = 0;
+    resampler->phase = 0;
+}
+
+void
+SDL_FreePolyphaseResampler(SDL_PolyphaseResampler *resampler)
+{
+    if (resampler) {
+        SDL_free(resampler->table);
+        SDL_free(resampler->history);
+        SDL_free(resampler->window);
+        SDL_free(resampler);
+    }
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
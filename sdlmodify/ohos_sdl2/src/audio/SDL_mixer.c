@@ -27,6 +27,20 @@
 #include "SDL_audio.h"
 #include "SDL_sysaudio.h"
 
+#ifdef __ARM_NEON
+#define HAVE_NEON_INTRINSICS 1
+#endif
+
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
+#endif
+
+#if defined(HAVE_IMMINTRIN_H) && !defined(SDL_DISABLE_IMMINTRIN_H) && \
+    defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
 /* This table is used to add two sound values together and pin
  * the value to avoid overflow.  (used with permission from ARDI)
  * Changed to use 0xFE instead of 0xFF for better sound quality.
@@ -85,6 +99,728 @@ static const Uint8 mix8[] = {
 #define ADJUST_VOLUME(s, v) (s = (s*v)/SDL_MIX_MAXVOLUME)
 #define ADJUST_VOLUME_U8(s, v)  (s = (((s-128)*v)/SDL_MIX_MAXVOLUME)+128)
 
+/* Native-endian S16, S32 and F32 mixing has SIMD versions. They return the
+ * number of samples they mixed, and the scalar code below finishes the rest.
+ * The results match the scalar code exactly, including the rounding toward
+ * zero in ADJUST_VOLUME.
+ */
+typedef int (*SDL_MixSamplesFunc)(Uint8 *dst, const Uint8 *src, int num, int volume);
+
+/* SDL_MixAudioSources() adds every buffer into a block of floats, then clips
+ * and stores the block once. Samples are normalized to -1.0 - 1.0.
+ */
+#define MIX_BLOCK_SAMPLES 256
+#define MIX_SOFTCLIP_KNEE 0.75f     /* -2.5 dBFS */
+
+typedef void (*SDL_AccumSamplesFunc)(float *accum, const Uint8 *src, int num, float gain);
+typedef void (*SDL_StoreSamplesFunc)(Uint8 *dst, const float *accum, int num);
+
+/* Rounds half away from zero; the SIMD stores do the same. */
+#define MIX_ROUND(x) ((int) ((x) + (((x) < 0.0f) ? -0.5f : 0.5f)))
+
+/* This is the largest float below 2^31. */
+#define MIX_MAX_S32_FLOAT 2147483520.0f
+
+static void
+AccumSamples(float *accum, const Uint8 *src, SDL_AudioFormat format, int num, float gain)
+{
+    int i;
+
+    switch (format) {
+    case AUDIO_U8:
+        {
+            const float scale = gain * (1.0f / 128.0f);
+            for (i = 0; i < num; ++i) {
+                accum[i] += (float) ((int) src[i] - 128) * scale;
+            }
+        }
+        break;
+
+    case AUDIO_S8:
+        {
+            const Sint8 *src8 = (const Sint8 *) src;
+            const float scale = gain * (1.0f / 128.0f);
+            for (i = 0; i < num; ++i) {
+                accum[i] += (float) src8[i] * scale;
+            }
+        }
+        break;
+
+    case AUDIO_U16LSB:
+    case AUDIO_U16MSB:
+        {
+            const Uint16 *src16 = (const Uint16 *) src;
+            const float scale = gain * (1.0f / 32768.0f);
+            for (i = 0; i < num; ++i) {
+                const Uint16 sample = (format == AUDIO_U16LSB) ? SDL_SwapLE16(src16[i]) : SDL_SwapBE16(src16[i]);
+                accum[i] += (float) ((int) sample - 32768) * scale;
+            }
+        }
+        break;
+
+    case AUDIO_S16LSB:
+    case AUDIO_S16MSB:
+        {
+            const Uint16 *src16 = (const Uint16 *) src;
+            const float scale = gain * (1.0f / 32768.0f);
+            for (i = 0; i < num; ++i) {
+                const Uint16 sample = (format == AUDIO_S16LSB) ? SDL_SwapLE16(src16[i]) : SDL_SwapBE16(src16[i]);
+                accum[i] += (float) (Sint16) sample * scale;
+            }
+        }
+        break;
+
+    case AUDIO_S32LSB:
+    case AUDIO_S32MSB:
+        {
+            const Uint32 *src32 = (const Uint32 *) src;
+            const float scale = gain * (1.0f / 2147483648.0f);
+            for (i = 0; i < num; ++i) {
+                const Uint32 sample = (format == AUDIO_S32LSB) ? SDL_SwapLE32(src32[i]) : SDL_SwapBE32(src32[i]);
+                accum[i] += (float) (Sint32) sample * scale;
+            }
+        }
+        break;
+
+    case AUDIO_F32LSB:
+    case AUDIO_F32MSB:
+        {
+            const float *srcf = (const float *) src;
+            for (i = 0; i < num; ++i) {
+                const float sample = (format == AUDIO_F32LSB) ? SDL_SwapFloatLE(srcf[i]) : SDL_SwapFloatBE(srcf[i]);
+                accum[i] += sample * gain;
+            }
+        }
+        break;
+    }
+}
+
+static void
+StoreSamples(Uint8 *dst, const float *accum, SDL_AudioFormat format, int num)
+{
+    int i;
+
+    switch (format) {
+    case AUDIO_U8:
+    case AUDIO_S8:
+        {
+            const int bias = (format == AUDIO_U8) ? 128 : 0;
+            for (i = 0; i < num; ++i) {
+                const float sample = SDL_min(SDL_max(accum[i] * 128.0f, -128.0f), 127.0f);
+                dst[i] = (Uint8) (MIX_ROUND(sample) + bias);
+            }
+        }
+        break;
+
+    case AUDIO_U16LSB:
+    case AUDIO_U16MSB:
+    case AUDIO_S16LSB:
+    case AUDIO_S16MSB:
+        {
+            Uint16 *dst16 = (Uint16 *) dst;
+            const int bias = SDL_AUDIO_ISSIGNED(format) ? 0 : 32768;
+            for (i = 0; i < num; ++i) {
+                const float sample = SDL_min(SDL_max(accum[i] * 32768.0f, -32768.0f), 32767.0f);
+                const Uint16 value = (Uint16) (MIX_ROUND(sample) + bias);
+                dst16[i] = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapBE16(value) : SDL_SwapLE16(value);
+            }
+        }
+        break;
+
+    case AUDIO_S32LSB:
+    case AUDIO_S32MSB:
+        {
+            Uint32 *dst32 = (Uint32 *) dst;
+            for (i = 0; i < num; ++i) {
+                const float sample = SDL_min(SDL_max(accum[i] * 2147483648.0f, -2147483648.0f), MIX_MAX_S32_FLOAT);
+                const Uint32 value = (Uint32) MIX_ROUND(sample);
+                dst32[i] = (format == AUDIO_S32LSB) ? SDL_SwapLE32(value) : SDL_SwapBE32(value);
+            }
+        }
+        break;
+
+    case AUDIO_F32LSB:
+    case AUDIO_F32MSB:
+        {
+            float *dstf = (float *) dst;
+            for (i = 0; i < num; ++i) {
+                const float sample = SDL_min(SDL_max(accum[i], -1.0f), 1.0f);
+                dstf[i] = (format == AUDIO_F32LSB) ? SDL_SwapFloatLE(sample) : SDL_SwapFloatBE(sample);
+            }
+        }
+        break;
+    }
+}
+
+/* Passes samples under the knee through unchanged and bends everything
+ * above it smoothly toward full scale, which it never quite reaches.
+ */
+static void
+SoftClipSamples(float *accum, int num)
+{
+    const float range = 1.0f - MIX_SOFTCLIP_KNEE;
+    int i;
+
+    for (i = 0; i < num; ++i) {
+        const float sample = accum[i];
+        const float over = ((sample < 0.0f) ? -sample : sample) - MIX_SOFTCLIP_KNEE;
+        if (over > 0.0f) {
+            const float clipped = MIX_SOFTCLIP_KNEE + range * over / (range + over);
+            accum[i] = (sample < 0.0f) ? -clipped : clipped;
+        }
+    }
+}
+
+#if HAVE_SSE2_INTRINSICS
+static int
+Mix_S16_SSE2(Uint8 *dst, const Uint8 *src, int num, int volume)
+{
+    Sint16 *dst16 = (Sint16 *) dst;
+    const Sint16 *src16 = (const Sint16 *) src;
+    const __m128i vol = _mm_set1_epi16((Sint16) volume);
+    const __m128i bias = _mm_set1_epi32(SDL_MIX_MAXVOLUME - 1);
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        const __m128i samples = _mm_loadu_si128((const __m128i *) (src16 + i));
+        const __m128i prodlo = _mm_mullo_epi16(samples, vol);
+        const __m128i prodhi = _mm_mulhi_epi16(samples, vol);
+        __m128i lo = _mm_unpacklo_epi16(prodlo, prodhi);
+        __m128i hi = _mm_unpackhi_epi16(prodlo, prodhi);
+        /* Divide by 128, rounding toward zero like the scalar code */
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, _mm_and_si128(_mm_srai_epi32(lo, 31), bias)), 7);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, _mm_and_si128(_mm_srai_epi32(hi, 31), bias)), 7);
+        _mm_storeu_si128((__m128i *) (dst16 + i),
+                         _mm_adds_epi16(_mm_loadu_si128((const __m128i *) (dst16 + i)), _mm_packs_epi32(lo, hi)));
+    }
+    return i;
+}
+
+static int
+Mix_S32_SSE2(Uint8 *dst, const Uint8 *src, int num, int volume)
+{
+    /* Every step here is exact in double precision. */
+    Sint32 *dst32 = (Sint32 *) dst;
+    const Sint32 *src32 = (const Sint32 *) src;
+    const __m128d vol = _mm_set1_pd((double) volume / SDL_MIX_MAXVOLUME);
+    const __m128d maxval = _mm_set1_pd(2147483647.0);
+    const __m128d minval = _mm_set1_pd(-2147483648.0);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        const __m128i samples = _mm_loadu_si128((const __m128i *) (src32 + i));
+        const __m128i mixed = _mm_loadu_si128((const __m128i *) (dst32 + i));
+        __m128d lo = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(samples), vol)));
+        __m128d hi = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_unpackhi_epi64(samples, samples)), vol)));
+        lo = _mm_add_pd(lo, _mm_cvtepi32_pd(mixed));
+        hi = _mm_add_pd(hi, _mm_cvtepi32_pd(_mm_unpackhi_epi64(mixed, mixed)));
+        lo = _mm_min_pd(_mm_max_pd(lo, minval), maxval);
+        hi = _mm_min_pd(_mm_max_pd(hi, minval), maxval);
+        _mm_storeu_si128((__m128i *) (dst32 + i), _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo), _mm_cvttpd_epi32(hi)));
+    }
+    return i;
+}
+
+static int
+Mix_F32_SSE2(Uint8 *dst, const Uint8 *src, int num, int volume)
+{
+    float *dstf = (float *) dst;
+    const float *srcf = (const float *) src;
+    const __m128 vol = _mm_set1_ps((float) volume);
+    const __m128 maxvolume = _mm_set1_ps(1.0f / ((float) SDL_MIX_MAXVOLUME));
+    const __m128 maxval = _mm_set1_ps(3.402823466e+38F);
+    const __m128 minval = _mm_set1_ps(-3.402823466e+38F);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        const __m128 samples = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(srcf + i), vol), maxvolume);
+        const __m128 mixed = _mm_add_ps(samples, _mm_loadu_ps(dstf + i));
+        _mm_storeu_ps(dstf + i, _mm_min_ps(_mm_max_ps(mixed, minval), maxval));
+    }
+    return i;
+}
+
+static void
+Accum_S16_SSE2(float *accum, const Uint8 *src, int num, float gain)
+{
+    const Sint16 *src16 = (const Sint16 *) src;
+    const __m128 scale = _mm_set1_ps(gain * (1.0f / 32768.0f));
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        const __m128i samples = _mm_loadu_si128((const __m128i *) (src16 + i));
+        const __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16));
+        const __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16));
+        _mm_storeu_ps(accum + i, _mm_add_ps(_mm_loadu_ps(accum + i), _mm_mul_ps(lo, scale)));
+        _mm_storeu_ps(accum + i + 4, _mm_add_ps(_mm_loadu_ps(accum + i + 4), _mm_mul_ps(hi, scale)));
+    }
+    AccumSamples(accum + i, (const Uint8 *) (src16 + i), AUDIO_S16SYS, num - i, gain);
+}
+
+static void
+Accum_S32_SSE2(float *accum, const Uint8 *src, int num, float gain)
+{
+    const Sint32 *src32 = (const Sint32 *) src;
+    const __m128 scale = _mm_set1_ps(gain * (1.0f / 2147483648.0f));
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        const __m128 samples = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *) (src32 + i)));
+        _mm_storeu_ps(accum + i, _mm_add_ps(_mm_loadu_ps(accum + i), _mm_mul_ps(samples, scale)));
+    }
+    AccumSamples(accum + i, (const Uint8 *) (src32 + i), AUDIO_S32SYS, num - i, gain);
+}
+
+static void
+Accum_F32_SSE2(float *accum, const Uint8 *src, int num, float gain)
+{
+    const float *srcf = (const float *) src;
+    const __m128 scale = _mm_set1_ps(gain);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        _mm_storeu_ps(accum + i, _mm_add_ps(_mm_loadu_ps(accum + i), _mm_mul_ps(_mm_loadu_ps(srcf + i), scale)));
+    }
+    AccumSamples(accum + i, (const Uint8 *) (srcf + i), AUDIO_F32SYS, num - i, gain);
+}
+
+/* Scales, clamps and rounds half away from zero, like MIX_ROUND */
+SDL_FORCE_INLINE __m128i
+Quantize_SSE2(const __m128 samples, const __m128 scale, const __m128 minval, const __m128 maxval)
+{
+    const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_mul_ps(samples, scale), minval), maxval);
+    const __m128 half = _mm_or_ps(_mm_and_ps(clamped, _mm_set1_ps(-0.0f)), _mm_set1_ps(0.5f));
+    return _mm_cvttps_epi32(_mm_add_ps(clamped, half));
+}
+
+static void
+Store_S16_SSE2(Uint8 *dst, const float *accum, int num)
+{
+    Sint16 *dst16 = (Sint16 *) dst;
+    const __m128 scale = _mm_set1_ps(32768.0f);
+    const __m128 minval = _mm_set1_ps(-32768.0f);
+    const __m128 maxval = _mm_set1_ps(32767.0f);
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        const __m128i lo = Quantize_SSE2(_mm_loadu_ps(accum + i), scale, minval, maxval);
+        const __m128i hi = Quantize_SSE2(_mm_loadu_ps(accum + i + 4), scale, minval, maxval);
+        _mm_storeu_si128((__m128i *) (dst16 + i), _mm_packs_epi32(lo, hi));
+    }
+    StoreSamples((Uint8 *) (dst16 + i), accum + i, AUDIO_S16SYS, num - i);
+}
+
+static void
+Store_S32_SSE2(Uint8 *dst, const float *accum, int num)
+{
+    Sint32 *dst32 = (Sint32 *) dst;
+    const __m128 scale = _mm_set1_ps(2147483648.0f);
+    const __m128 minval = _mm_set1_ps(-2147483648.0f);
+    const __m128 maxval = _mm_set1_ps(MIX_MAX_S32_FLOAT);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        _mm_storeu_si128((__m128i *) (dst32 + i), Quantize_SSE2(_mm_loadu_ps(accum + i), scale, minval, maxval));
+    }
+    StoreSamples((Uint8 *) (dst32 + i), accum + i, AUDIO_S32SYS, num - i);
+}
+
+static void
+Store_F32_SSE2(Uint8 *dst, const float *accum, int num)
+{
+    float *dstf = (float *) dst;
+    const __m128 minval = _mm_set1_ps(-1.0f);
+    const __m128 maxval = _mm_set1_ps(1.0f);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        _mm_storeu_ps(dstf + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(accum + i), minval), maxval));
+    }
+    StoreSamples((Uint8 *) (dstf + i), accum + i, AUDIO_F32SYS, num - i);
+}
+#endif
+
+#if HAVE_AVX2_INTRINSICS
+static int SDL_TARGET_AVX2
+Mix_S16_AVX2(Uint8 *dst, const Uint8 *src, int num, int volume)
+{
+    Sint16 *dst16 = (Sint16 *) dst;
+    const Sint16 *src16 = (const Sint16 *) src;
+    const __m256i vol = _mm256_set1_epi16((Sint16) volume);
+    const __m256i bias = _mm256_set1_epi32(SDL_MIX_MAXVOLUME - 1);
+    int i;
+
+    /* The unpacks and the pack both work within 128-bit lanes, so the
+       samples come back out in order. */
+    for (i = 0; i + 16 <= num; i += 16) {
+        const __m256i samples = _mm256_loadu_si256((const __m256i *) (src16 + i));
+        const __m256i prodlo = _mm256_mullo_epi16(samples, vol);
+        const __m256i prodhi = _mm256_mulhi_epi16(samples, vol);
+        __m256i lo = _mm256_unpacklo_epi16(prodlo, prodhi);
+        __m256i hi = _mm256_unpackhi_epi16(prodlo, prodhi);
+        lo = _mm256_srai_epi32(_mm256_add_epi32(lo, _mm256_and_si256(_mm256_srai_epi32(lo, 31), bias)), 7);
+        hi = _mm256_srai_epi32(_mm256_add_epi32(hi, _mm256_and_si256(_mm256_srai_epi32(hi, 31), bias)), 7);
+        _mm256_storeu_si256((__m256i *) (dst16 + i),
+                            _mm256_adds_epi16(_mm256_loadu_si256((const __m256i *) (dst16 + i)), _mm256_packs_epi32(lo, hi)));
+    }
+    return i;
+}
+
+static int SDL_TARGET_AVX2
+Mix_S32_AVX2(Uint8 *dst, const Uint8 *src, int num, int volume)
+{
+    Sint32 *dst32 = (Sint32 *) dst;
+    const Sint32 *src32 = (const Sint32 *) src;
+    const __m256d vol = _mm256_set1_pd((double) volume / SDL_MIX_MAXVOLUME);
+    const __m256d maxval = _mm256_set1_pd(2147483647.0);
+    const __m256d minval = _mm256_set1_pd(-2147483648.0);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        const __m128i samples = _mm_loadu_si128((const __m128i *) (src32 + i));
+        const __m128i mixed = _mm_loadu_si128((const __m128i *) (dst32 + i));
+        __m256d sum = _mm256_cvtepi32_pd(_mm256_cvttpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(samples), vol)));
+        sum = _mm256_add_pd(sum, _mm256_cvtepi32_pd(mixed));
+        sum = _mm256_min_pd(_mm256_max_pd(sum, minval), maxval);
+        _mm_storeu_si128((__m128i *) (dst32 + i), _mm256_cvttpd_epi32(sum));
+    }
+    return i;
+}
+
+static int SDL_TARGET_AVX2
+Mix_F32_AVX2(Uint8 *dst, const Uint8 *src, int num, int volume)
+{
+    float *dstf = (float *) dst;
+    const float *srcf = (const float *) src;
+    const __m256 vol = _mm256_set1_ps((float) volume);
+    const __m256 maxvolume = _mm256_set1_ps(1.0f / ((float) SDL_MIX_MAXVOLUME));
+    const __m256 maxval = _mm256_set1_ps(3.402823466e+38F);
+    const __m256 minval = _mm256_set1_ps(-3.402823466e+38F);
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        const __m256 samples = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(srcf + i), vol), maxvolume);
+        const __m256 mixed = _mm256_add_ps(samples, _mm256_loadu_ps(dstf + i));
+        _mm256_storeu_ps(dstf + i, _mm256_min_ps(_mm256_max_ps(mixed, minval), maxval));
+    }
+    return i;
+}
+
+static void SDL_TARGET_AVX2
+Accum_S16_AVX2(float *accum, const Uint8 *src, int num, float gain)
+{
+    const Sint16 *src16 = (const Sint16 *) src;
+    const __m256 scale = _mm256_set1_ps(gain * (1.0f / 32768.0f));
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        const __m256 samples = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (src16 + i))));
+        _mm256_storeu_ps(accum + i, _mm256_add_ps(_mm256_loadu_ps(accum + i), _mm256_mul_ps(samples, scale)));
+    }
+    AccumSamples(accum + i, (const Uint8 *) (src16 + i), AUDIO_S16SYS, num - i, gain);
+}
+
+static void SDL_TARGET_AVX2
+Accum_S32_AVX2(float *accum, const Uint8 *src, int num, float gain)
+{
+    const Sint32 *src32 = (const Sint32 *) src;
+    const __m256 scale = _mm256_set1_ps(gain * (1.0f / 2147483648.0f));
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        const __m256 samples = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *) (src32 + i)));
+        _mm256_storeu_ps(accum + i, _mm256_add_ps(_mm256_loadu_ps(accum + i), _mm256_mul_ps(samples, scale)));
+    }
+    AccumSamples(accum + i, (const Uint8 *) (src32 + i), AUDIO_S32SYS, num - i, gain);
+}
+
+static void SDL_TARGET_AVX2
+Accum_F32_AVX2(float *accum, const Uint8 *src, int num, float gain)
+{
+    const float *srcf = (const float *) src;
+    const __m256 scale = _mm256_set1_ps(gain);
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        _mm256_storeu_ps(accum + i, _mm256_add_ps(_mm256_loadu_ps(accum + i), _mm256_mul_ps(_mm256_loadu_ps(srcf + i), scale)));
+    }
+    AccumSamples(accum + i, (const Uint8 *) (srcf + i), AUDIO_F32SYS, num - i, gain);
+}
+
+SDL_FORCE_INLINE __m256i SDL_TARGET_AVX2
+Quantize_AVX2(const __m256 samples, const __m256 scale, const __m256 minval, const __m256 maxval)
+{
+    const __m256 clamped = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(samples, scale), minval), maxval);
+    const __m256 half = _mm256_or_ps(_mm256_and_ps(clamped, _mm256_set1_ps(-0.0f)), _mm256_set1_ps(0.5f));
+    return _mm256_cvttps_epi32(_mm256_add_ps(clamped, half));
+}
+
+static void SDL_TARGET_AVX2
+Store_S16_AVX2(Uint8 *dst, const float *accum, int num)
+{
+    Sint16 *dst16 = (Sint16 *) dst;
+    const __m256 scale = _mm256_set1_ps(32768.0f);
+    const __m256 minval = _mm256_set1_ps(-32768.0f);
+    const __m256 maxval = _mm256_set1_ps(32767.0f);
+    int i;
+
+    for (i = 0; i + 16 <= num; i += 16) {
+        const __m256i lo = Quantize_AVX2(_mm256_loadu_ps(accum + i), scale, minval, maxval);
+        const __m256i hi = Quantize_AVX2(_mm256_loadu_ps(accum + i + 8), scale, minval, maxval);
+        /* The pack interleaves 128-bit lanes, put them back in order */
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *) (dst16 + i), packed);
+    }
+    StoreSamples((Uint8 *) (dst16 + i), accum + i, AUDIO_S16SYS, num - i);
+}
+
+static void SDL_TARGET_AVX2
+Store_S32_AVX2(Uint8 *dst, const float *accum, int num)
+{
+    Sint32 *dst32 = (Sint32 *) dst;
+    const __m256 scale = _mm256_set1_ps(2147483648.0f);
+    const __m256 minval = _mm256_set1_ps(-2147483648.0f);
+    const __m256 maxval = _mm256_set1_ps(MIX_MAX_S32_FLOAT);
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        _mm256_storeu_si256((__m256i *) (dst32 + i), Quantize_AVX2(_mm256_loadu_ps(accum + i), scale, minval, maxval));
+    }
+    StoreSamples((Uint8 *) (dst32 + i), accum + i, AUDIO_S32SYS, num - i);
+}
+
+static void SDL_TARGET_AVX2
+Store_F32_AVX2(Uint8 *dst, const float *accum, int num)
+{
+    float *dstf = (float *) dst;
+    const __m256 minval = _mm256_set1_ps(-1.0f);
+    const __m256 maxval = _mm256_set1_ps(1.0f);
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        _mm256_storeu_ps(dstf + i, _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(accum + i), minval), maxval));
+    }
+    StoreSamples((Uint8 *) (dstf + i), accum + i, AUDIO_F32SYS, num - i);
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+static int
+Mix_S16_NEON(Uint8 *dst, const Uint8 *src, int num, int volume)
+{
+    Sint16 *dst16 = (Sint16 *) dst;
+    const Sint16 *src16 = (const Sint16 *) src;
+    const int16x4_t vol = vdup_n_s16((Sint16) volume);
+    const int32x4_t bias = vdupq_n_s32(SDL_MIX_MAXVOLUME - 1);
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        const int16x8_t samples = vld1q_s16(src16 + i);
+        int32x4_t lo = vmull_s16(vget_low_s16(samples), vol);
+        int32x4_t hi = vmull_s16(vget_high_s16(samples), vol);
+        /* Divide by 128, rounding toward zero like the scalar code */
+        lo = vshrq_n_s32(vaddq_s32(lo, vandq_s32(vshrq_n_s32(lo, 31), bias)), 7);
+        hi = vshrq_n_s32(vaddq_s32(hi, vandq_s32(vshrq_n_s32(hi, 31), bias)), 7);
+        vst1q_s16(dst16 + i, vqaddq_s16(vld1q_s16(dst16 + i), vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi))));
+    }
+    return i;
+}
+
+static int
+Mix_S32_NEON(Uint8 *dst, const Uint8 *src, int num, int volume)
+{
+    Sint32 *dst32 = (Sint32 *) dst;
+    const Sint32 *src32 = (const Sint32 *) src;
+    const int32x2_t vol = vdup_n_s32(volume);
+    const int64x2_t bias = vdupq_n_s64(SDL_MIX_MAXVOLUME - 1);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        const int32x4_t samples = vld1q_s32(src32 + i);
+        const int32x4_t mixed = vld1q_s32(dst32 + i);
+        int64x2_t lo = vmull_s32(vget_low_s32(samples), vol);
+        int64x2_t hi = vmull_s32(vget_high_s32(samples), vol);
+        lo = vshrq_n_s64(vaddq_s64(lo, vandq_s64(vshrq_n_s64(lo, 63), bias)), 7);
+        hi = vshrq_n_s64(vaddq_s64(hi, vandq_s64(vshrq_n_s64(hi, 63), bias)), 7);
+        lo = vaddw_s32(lo, vget_low_s32(mixed));
+        hi = vaddw_s32(hi, vget_high_s32(mixed));
+        vst1q_s32(dst32 + i, vcombine_s32(vqmovn_s64(lo), vqmovn_s64(hi)));
+    }
+    return i;
+}
+
+static int
+Mix_F32_NEON(Uint8 *dst, const Uint8 *src, int num, int volume)
+{
+    float *dstf = (float *) dst;
+    const float *srcf = (const float *) src;
+    const float32x4_t vol = vdupq_n_f32((float) volume);
+    const float32x4_t maxvolume = vdupq_n_f32(1.0f / ((float) SDL_MIX_MAXVOLUME));
+    const float32x4_t maxval = vdupq_n_f32(3.402823466e+38F);
+    const float32x4_t minval = vdupq_n_f32(-3.402823466e+38F);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        const float32x4_t samples = vmulq_f32(vmulq_f32(vld1q_f32(srcf + i), vol), maxvolume);
+        const float32x4_t mixed = vaddq_f32(samples, vld1q_f32(dstf + i));
+        vst1q_f32(dstf + i, vminq_f32(vmaxq_f32(mixed, minval), maxval));
+    }
+    return i;
+}
+
+static void
+Accum_S16_NEON(float *accum, const Uint8 *src, int num, float gain)
+{
+    const Sint16 *src16 = (const Sint16 *) src;
+    const float32x4_t scale = vdupq_n_f32(gain * (1.0f / 32768.0f));
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        const int16x8_t samples = vld1q_s16(src16 + i);
+        const float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples)));
+        const float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples)));
+        vst1q_f32(accum + i, vaddq_f32(vld1q_f32(accum + i), vmulq_f32(lo, scale)));
+        vst1q_f32(accum + i + 4, vaddq_f32(vld1q_f32(accum + i + 4), vmulq_f32(hi, scale)));
+    }
+    AccumSamples(accum + i, (const Uint8 *) (src16 + i), AUDIO_S16SYS, num - i, gain);
+}
+
+static void
+Accum_S32_NEON(float *accum, const Uint8 *src, int num, float gain)
+{
+    const Sint32 *src32 = (const Sint32 *) src;
+    const float32x4_t scale = vdupq_n_f32(gain * (1.0f / 2147483648.0f));
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        const float32x4_t samples = vcvtq_f32_s32(vld1q_s32(src32 + i));
+        vst1q_f32(accum + i, vaddq_f32(vld1q_f32(accum + i), vmulq_f32(samples, scale)));
+    }
+    AccumSamples(accum + i, (const Uint8 *) (src32 + i), AUDIO_S32SYS, num - i, gain);
+}
+
+static void
+Accum_F32_NEON(float *accum, const Uint8 *src, int num, float gain)
+{
+    const float *srcf = (const float *) src;
+    const float32x4_t scale = vdupq_n_f32(gain);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        vst1q_f32(accum + i, vaddq_f32(vld1q_f32(accum + i), vmulq_f32(vld1q_f32(srcf + i), scale)));
+    }
+    AccumSamples(accum + i, (const Uint8 *) (srcf + i), AUDIO_F32SYS, num - i, gain);
+}
+
+SDL_FORCE_INLINE int32x4_t
+Quantize_NEON(const float32x4_t samples, const float32x4_t scale, const float32x4_t minval, const float32x4_t maxval)
+{
+    const float32x4_t clamped = vminq_f32(vmaxq_f32(vmulq_f32(samples, scale), minval), maxval);
+    const uint32x4_t sign = vandq_u32(vreinterpretq_u32_f32(clamped), vdupq_n_u32(0x80000000));
+    const float32x4_t half = vreinterpretq_f32_u32(vorrq_u32(sign, vreinterpretq_u32_f32(vdupq_n_f32(0.5f))));
+    return vcvtq_s32_f32(vaddq_f32(clamped, half));
+}
+
+static void
+Store_S16_NEON(Uint8 *dst, const float *accum, int num)
+{
+    Sint16 *dst16 = (Sint16 *) dst;
+    const float32x4_t scale = vdupq_n_f32(32768.0f);
+    const float32x4_t minval = vdupq_n_f32(-32768.0f);
+    const float32x4_t maxval = vdupq_n_f32(32767.0f);
+    int i;
+
+    for (i = 0; i + 8 <= num; i += 8) {
+        const int32x4_t lo = Quantize_NEON(vld1q_f32(accum + i), scale, minval, maxval);
+        const int32x4_t hi = Quantize_NEON(vld1q_f32(accum + i + 4), scale, minval, maxval);
+        vst1q_s16(dst16 + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+    }
+    StoreSamples((Uint8 *) (dst16 + i), accum + i, AUDIO_S16SYS, num - i);
+}
+
+static void
+Store_S32_NEON(Uint8 *dst, const float *accum, int num)
+{
+    Sint32 *dst32 = (Sint32 *) dst;
+    const float32x4_t scale = vdupq_n_f32(2147483648.0f);
+    const float32x4_t minval = vdupq_n_f32(-2147483648.0f);
+    const float32x4_t maxval = vdupq_n_f32(MIX_MAX_S32_FLOAT);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        vst1q_s32(dst32 + i, Quantize_NEON(vld1q_f32(accum + i), scale, minval, maxval));
+    }
+    StoreSamples((Uint8 *) (dst32 + i), accum + i, AUDIO_S32SYS, num - i);
+}
+
+static void
+Store_F32_NEON(Uint8 *dst, const float *accum, int num)
+{
+    float *dstf = (float *) dst;
+    const float32x4_t minval = vdupq_n_f32(-1.0f);
+    const float32x4_t maxval = vdupq_n_f32(1.0f);
+    int i;
+
+    for (i = 0; i + 4 <= num; i += 4) {
+        vst1q_f32(dstf + i, vminq_f32(vmaxq_f32(vld1q_f32(accum + i), minval), maxval));
+    }
+    StoreSamples((Uint8 *) (dstf + i), accum + i, AUDIO_F32SYS, num - i);
+}
+#endif
+
+/* Function pointers set to a CPU-specific implementation, NULL when there isn't one. */
+static SDL_MixSamplesFunc SDL_Mix_S16 = NULL;
+static SDL_MixSamplesFunc SDL_Mix_S32 = NULL;
+static SDL_MixSamplesFunc SDL_Mix_F32 = NULL;
+static SDL_AccumSamplesFunc SDL_Accum_S16 = NULL;
+static SDL_AccumSamplesFunc SDL_Accum_S32 = NULL;
+static SDL_AccumSamplesFunc SDL_Accum_F32 = NULL;
+static SDL_StoreSamplesFunc SDL_Store_S16 = NULL;
+static SDL_StoreSamplesFunc SDL_Store_S32 = NULL;
+static SDL_StoreSamplesFunc SDL_Store_F32 = NULL;
+
+static void
+ChooseMixers(void)
+{
+    static SDL_bool mixers_chosen = SDL_FALSE;
+
+    if (mixers_chosen) {
+        return;
+    }
+
+#define SET_MIXER_FUNCS(fntype) \
+        SDL_Mix_S16 = Mix_S16_##fntype; \
+        SDL_Mix_S32 = Mix_S32_##fntype; \
+        SDL_Mix_F32 = Mix_F32_##fntype; \
+        SDL_Accum_S16 = Accum_S16_##fntype; \
+        SDL_Accum_S32 = Accum_S32_##fntype; \
+        SDL_Accum_F32 = Accum_F32_##fntype; \
+        SDL_Store_S16 = Store_S16_##fntype; \
+        SDL_Store_S32 = Store_S32_##fntype; \
+        SDL_Store_F32 = Store_F32_##fntype
+
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        SET_MIXER_FUNCS(SSE2);
+    }
+#endif
+#if HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        SET_MIXER_FUNCS(AVX2);
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        SET_MIXER_FUNCS(NEON);
+    }
+#endif
+
+#undef SET_MIXER_FUNCS
+
+    mixers_chosen = SDL_TRUE;
+}
+
+
 
 void
 SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
@@ -94,6 +830,35 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
         return;
     }
 
+    ChooseMixers();
+
+    /* Let the SIMD mixers take what they can, the code below mixes the rest */
+    if (volume <= SDL_MIX_MAXVOLUME) {
+        SDL_MixSamplesFunc mix = NULL;
+
+        switch (format) {
+        case AUDIO_S16SYS:
+            mix = SDL_Mix_S16;
+            break;
+        case AUDIO_S32SYS:
+            mix = SDL_Mix_S32;
+            break;
+        case AUDIO_F32SYS:
+            mix = SDL_Mix_F32;
+            break;
+        default:
+            break;
+        }
+
+        if (mix) {
+            const Uint32 samplesize = SDL_AUDIO_BITSIZE(format) / 8;
+            const Uint32 mixed = (Uint32) mix(dst, src, (int) SDL_min(len / samplesize, SDL_MAX_SINT32), volume) * samplesize;
+            dst += mixed;
+            src += mixed;
+            len -= mixed;
+        }
+    }
+
     switch (format) {
 
     case AUDIO_U8:
@@ -366,4 +1131,94 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
     }
 }
 
+int
+SDL_MixAudioSources(Uint8 * dst, const Uint8 * const * srcs, const int * volumes,
+                    int num_srcs, SDL_AudioFormat format, Uint32 len, Uint32 flags)
+{
+    float accum[MIX_BLOCK_SAMPLES];
+    SDL_AccumSamplesFunc accum_func = NULL;
+    SDL_StoreSamplesFunc store_func = NULL;
+    Uint32 samplesize, total, offset;
+    int i;
+
+    if (!dst) {
+        return SDL_InvalidParamError("dst");
+    }
+    if (num_srcs < 0 || (num_srcs > 0 && !srcs)) {
+        return SDL_InvalidParamError("srcs");
+    }
+    for (i = 0; i < num_srcs; ++i) {
+        if (!srcs[i]) {
+            return SDL_InvalidParamError("srcs");
+        }
+    }
+
+    switch (format) {
+    case AUDIO_U8:
+    case AUDIO_S8:
+    case AUDIO_U16LSB:
+    case AUDIO_U16MSB:
+    case AUDIO_S16LSB:
+    case AUDIO_S16MSB:
+    case AUDIO_S32LSB:
+    case AUDIO_S32MSB:
+    case AUDIO_F32LSB:
+    case AUDIO_F32MSB:
+        break;
+    default:
+        return SDL_SetError("SDL_MixAudioSources(): unknown audio format");
+    }
+
+    ChooseMixers();
+
+    if (format == AUDIO_S16SYS) {
+        accum_func = SDL_Accum_S16;
+        store_func = SDL_Store_S16;
+    } else if (format == AUDIO_S32SYS) {
+        accum_func = SDL_Accum_S32;
+        store_func = SDL_Store_S32;
+    } else if (format == AUDIO_F32SYS) {
+        accum_func = SDL_Accum_F32;
+        store_func = SDL_Store_F32;
+    }
+
+    samplesize = SDL_AUDIO_BITSIZE(format) / 8;
+    total = len / samplesize;
+    for (offset = 0; offset < total; offset += MIX_BLOCK_SAMPLES) {
+        const int num = (int) SDL_min(total - offset, MIX_BLOCK_SAMPLES);
+        Uint8 *block = dst + offset * samplesize;
+
+        SDL_memset(accum, 0, num * sizeof (float));
+        if (accum_func) {
+            accum_func(accum, block, num, 1.0f);
+        } else {
+            AccumSamples(accum, block, format, num, 1.0f);
+        }
+
+        for (i = 0; i < num_srcs; ++i) {
+            const int volume = volumes ? volumes[i] : SDL_MIX_MAXVOLUME;
+            const float gain = (float) volume * (1.0f / SDL_MIX_MAXVOLUME);
+            if (volume == 0) {
+                continue;
+            }
+            if (accum_func) {
+                accum_func(accum, srcs[i] + offset * samplesize, num, gain);
+            } else {
+                AccumSamples(accum, srcs[i] + offset * samplesize, format, num, gain);
+            }
+        }
+
+        if (flags & SDL_MIX_SOFTCLIP) {
+            SoftClipSamples(accum, num);
+        }
+
+        if (store_func) {
+            store_func(block, accum, num);
+        } else {
+            StoreSamples(block, accum, format, num);
+        }
+    }
+    return 0;
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -51,6 +51,12 @@ extern void SDL_RemoveAudioDevice(const int iscapture, void *handle);
    as appropriate so SDL's list of devices is accurate. */
 extern void SDL_OpenedAudioDeviceDisconnected(SDL_AudioDevice *device);
 
+/* Audio targets that set SupportsPullMode call this from their own audio
+   thread for devices opened with pull_mode set. It runs the app's callback
+   into stream, converting if needed, or fills it with silence when the
+   device is paused or closing. */
+extern void SDL_PullAudio(SDL_AudioDevice *device, Uint8 *stream, int len);
+
 /* This is the size of a packet when using SDL_QueueAudio(). We allocate
    these as necessary and pool them, under the assumption that we'll
    eventually end up with a handful that keep recycling, meeting whatever
@@ -86,6 +92,7 @@ typedef struct SDL_AudioDriverImpl
     /* Some flags to push duplicate code into the core and reduce #ifdefs. */
     /* !!! FIXME: these should be SDL_bool */
     int ProvidesOwnCallbackThread;
+    int SupportsPullMode;  /* can call SDL_PullAudio() from its own thread on request */
     int SkipMixerLock;
     int HasCaptureSupport;
     int OnlyHasDefaultOutputDevice;
@@ -148,6 +155,7 @@ struct SDL_AudioDevice
     SDL_atomic_t enabled;  /* true if device is functioning and connected. */
     SDL_atomic_t paused;
     SDL_bool iscapture;
+    SDL_bool pull_mode;  /* no audio thread, the backend calls SDL_PullAudio(). */
 
     /* Scratch buffer used in the bridge between SDL and the user callback. */
     Uint8 *work_buffer;
@@ -162,8 +170,10 @@ struct SDL_AudioDevice
     SDL_Thread *thread;
     SDL_threadID threadid;
 
-    /* Queued buffers (if app not using callback). */
+    /* Queued buffers (if app not using callback). The audio thread is one
+       side of this queue, app threads on the other side take the lock. */
     SDL_DataQueue *buffer_queue;
+    SDL_mutex *buffer_queue_lock;
 
     /* * * */
     /* Data private to this driver */
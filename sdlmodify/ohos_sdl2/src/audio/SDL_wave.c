@@ -37,6 +37,7 @@
 #include "SDL_log.h"
 #include "SDL_hints.h"
 #include "SDL_audio.h"
+#include "SDL_jobs.h"
 #include "SDL_wave.h"
 #include "SDL_audio_c.h"
 
@@ -638,11 +639,58 @@ MS_ADPCM_DecodeBlockData(ADPCM_DecoderState *state)
     return 0;
 }
 
+typedef int (*ADPCM_DecodeFunc)(ADPCM_DecoderState *state);
+
+/* Decodes the ADPCM blocks in state->input into state->output until the input
+ * runs out or state->framesleft reaches zero. Returns 1 if a truncated block
+ * stopped the decoding, 0 if it ran to the end, or -1 on error.
+ */
+static int
+ADPCM_DecodeBlocks(WaveFile *file, ADPCM_DecoderState *state, ADPCM_DecodeFunc decodeheader, ADPCM_DecodeFunc decodedata)
+{
+    size_t bytesleft = state->input.size - state->input.pos;
+
+    /* Decode block by block. A truncated block will stop the decoding. */
+    while (state->framesleft > 0 && bytesleft >= state->blockheadersize) {
+        const Sint64 blockframes = SDL_min((Sint64)state->samplesperblock, state->framesleft);
+
+        state->block.data = state->input.data + state->input.pos;
+        state->block.size = bytesleft < state->blocksize ? bytesleft : state->blocksize;
+        state->block.pos = 0;
+
+        if (state->output.size - state->output.pos < (Uint64)blockframes * state->channels) {
+            /* Somehow didn't allocate enough space for the output. */
+            return SDL_SetError("Unexpected overflow in ADPCM decoder");
+        }
+
+        /* Initialize decoder with the values from the block header. */
+        if (decodeheader(state) < 0) {
+            return -1;
+        }
+
+        /* Decode the block data. It stores the samples directly in the output. */
+        if (decodedata(state) < 0) {
+            /* Unexpected end. Stop decoding and return partial data if necessary. */
+            if (file->trunchint == TruncVeryStrict || file->trunchint == TruncStrict) {
+                return SDL_SetError("Truncated data chunk");
+            } else if (file->trunchint != TruncDropFrame) {
+                state->output.pos -= state->output.pos % (state->samplesperblock * state->channels);
+            }
+            return 1;
+        }
+
+        state->input.pos += state->block.size;
+        bytesleft = state->input.size - state->input.pos;
+    }
+
+    return 0;
+}
+
 static int
 MS_ADPCM_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
 {
     int result;
-    size_t bytesleft, outputsize;
+    size_t outputsize;
     WaveChunk *chunk = &file->chunk;
     ADPCM_DecoderState state;
     MS_ADPCM_ChannelState cstate[2];
@@ -694,42 +742,12 @@ MS_ADPCM_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
 
     state.cstate = cstate;
 
-    /* Decode block by block. A truncated block will stop the decoding. */
-    bytesleft = state.input.size - state.input.pos;
-    while (state.framesleft > 0 && bytesleft >= state.blockheadersize) {
-        state.block.data = state.input.data + state.input.pos;
-        state.block.size = bytesleft < state.blocksize ? bytesleft : state.blocksize;
-        state.block.pos = 0;
-
-        if (state.output.size - state.output.pos < (Uint64)state.framesleft * state.channels) {
-            /* Somehow didn't allocate enough space for the output. */
-            SDL_free(state.output.data);
-            return SDL_SetError("Unexpected overflow in MS ADPCM decoder");
-        }
-
-        /* Initialize decoder with the values from the block header. */
-        result = MS_ADPCM_DecodeBlockHeader(&state);
-        if (result == -1) {
-            SDL_free(state.output.data);
-            return -1;
-        }
-
-        /* Decode the block data. It stores the samples directly in the output. */
-        result = MS_ADPCM_DecodeBlockData(&state);
-        if (result == -1) {
-            /* Unexpected end. Stop decoding and return partial data if necessary. */
-            if (file->trunchint == TruncVeryStrict || file->trunchint == TruncStrict) {
-                SDL_free(state.output.data);
-                return SDL_SetError("Truncated data chunk");
-            } else if (file->trunchint != TruncDropFrame) {
-                state.output.pos -= state.output.pos % (state.samplesperblock * state.channels);
-            }
-            outputsize = state.output.pos * sizeof(Sint16); /* Can't overflow, is always smaller. */
-            break;
-        }
-
-        state.input.pos += state.block.size;
-        bytesleft = state.input.size - state.input.pos;
+    result = ADPCM_DecodeBlocks(file, &state, MS_ADPCM_DecodeBlockHeader, MS_ADPCM_DecodeBlockData);
+    if (result < 0) {
+        SDL_free(state.output.data);
+        return -1;
+    } else if (result == 1) {
+        outputsize = state.output.pos * sizeof(Sint16); /* Can't overflow, is always smaller. */
     }
 
     *audio_buf = (Uint8 *)state.output.data;
@@ -1038,7 +1056,7 @@ static int
 IMA_ADPCM_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
 {
     int result;
-    size_t bytesleft, outputsize;
+    size_t outputsize;
     WaveChunk *chunk = &file->chunk;
     ADPCM_DecoderState state;
     Sint8 *cstate;
@@ -1092,49 +1110,18 @@ IMA_ADPCM_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
     }
     state.cstate = cstate;
 
-    /* Decode block by block. A truncated block will stop the decoding. */
-    bytesleft = state.input.size - state.input.pos;
-    while (state.framesleft > 0 && bytesleft >= state.blockheadersize) {
-        state.block.data = state.input.data + state.input.pos;
-        state.block.size = bytesleft < state.blocksize ? bytesleft : state.blocksize;
-        state.block.pos = 0;
-
-        if (state.output.size - state.output.pos < (Uint64)state.framesleft * state.channels) {
-            /* Somehow didn't allocate enough space for the output. */
-            SDL_free(state.output.data);
-            SDL_free(cstate);
-            return SDL_SetError("Unexpected overflow in IMA ADPCM decoder");
-        }
-
-        /* Initialize decoder with the values from the block header. */
-        result = IMA_ADPCM_DecodeBlockHeader(&state);
-        if (result == 0) {
-            /* Decode the block data. It stores the samples directly in the output. */
-            result = IMA_ADPCM_DecodeBlockData(&state);
-        }
-
-        if (result == -1) {
-            /* Unexpected end. Stop decoding and return partial data if necessary. */
-            if (file->trunchint == TruncVeryStrict || file->trunchint == TruncStrict) {
-                SDL_free(state.output.data);
-                SDL_free(cstate);
-                return SDL_SetError("Truncated data chunk");
-            } else if (file->trunchint != TruncDropFrame) {
-                state.output.pos -= state.output.pos % (state.samplesperblock * state.channels);
-            }
-            outputsize = state.output.pos * sizeof(Sint16); /* Can't overflow, is always smaller. */
-            break;
-        }
-
-        state.input.pos += state.block.size;
-        bytesleft = state.input.size - state.input.pos;
+    result = ADPCM_DecodeBlocks(file, &state, IMA_ADPCM_DecodeBlockHeader, IMA_ADPCM_DecodeBlockData);
+    SDL_free(cstate);
+    if (result < 0) {
+        SDL_free(state.output.data);
+        return -1;
+    } else if (result == 1) {
+        outputsize = state.output.pos * sizeof(Sint16); /* Can't overflow, is always smaller. */
     }
 
     *audio_buf = (Uint8 *)state.output.data;
     *audio_len = (Uint32)outputsize;
 
-    SDL_free(cstate);
-
     return 0;
 }
 
@@ -1167,11 +1154,14 @@ LAW_Init(WaveFile *file, size_t datalength)
     return 0;
 }
 
+/* Expands sample_count A-law or µ-law samples at the start of buf to 16-bit
+ * samples. buf must have room for the expanded samples.
+ */
 static int
-LAW_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
+LAW_Expand(Uint16 encoding, Uint8 *buf, size_t sample_count)
 {
 #ifdef SDL_WAVE_LAW_LUT
-    const Sint16 alaw_lut[256] = {
+    static const Sint16 alaw_lut[256] = {
         -5504, -5248, -6016, -5760, -4480, -4224, -4992, -4736, -7552, -7296, -8064, -7808, -6528, -6272, -7040, -6784, -2752,
         -2624, -3008, -2880, -2240, -2112, -2496, -2368, -3776, -3648, -4032, -3904, -3264, -3136, -3520, -3392, -22016,
         -20992, -24064, -23040, -17920, -16896, -19968, -18944, -30208, -29184, -32256, -31232, -26112, -25088, -28160, -27136, -11008,
@@ -1189,7 +1179,7 @@ LAW_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
         1312, 1504, 1440, 1120, 1056, 1248, 1184, 1888, 1824, 2016, 1952, 1632, 1568, 1760, 1696, 688,
         656, 752, 720, 560, 528, 624, 592, 944, 912, 1008, 976, 816, 784, 880, 848
     };
-    const Sint16 mulaw_lut[256] = {
+    static const Sint16 mulaw_lut[256] = {
         -32124, -31100, -30076, -29052, -28028, -27004, -25980, -24956, -23932, -22908, -21884, -20860, -19836, -18812, -17788, -16764, -15996,
         -15484, -14972, -14460, -13948, -13436, -12924, -12412, -11900, -11388, -10876, -10364, -9852, -9340, -8828, -8316, -7932,
         -7676, -7420, -7164, -6908, -6652, -6396, -6140, -5884, -5628, -5372, -5116, -4860, -4604, -4348, -4092, -3900,
@@ -1208,54 +1198,15 @@ LAW_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
         112, 104, 96, 88, 80, 72, 64, 56, 48, 40, 32, 24, 16, 8, 0
     };
 #endif
-
-    WaveFormat *format = &file->format;
-    WaveChunk *chunk = &file->chunk;
-    size_t i, sample_count, expanded_len;
-    Uint8 *src;
-    Sint16 *dst;
-
-    if (chunk->length != chunk->size) {
-        file->sampleframes = WaveAdjustToFactValue(file, chunk->size / format->blockalign);
-        if (file->sampleframes < 0) {
-            return -1;
-        }
-    }
-
-    /* Nothing to decode, nothing to return. */
-    if (file->sampleframes == 0) {
-        *audio_buf = NULL;
-        *audio_len = 0;
-        return 0;
-    }
-
-    sample_count = (size_t)file->sampleframes;
-    if (SafeMult(&sample_count, format->channels)) {
-        return SDL_OutOfMemory();
-    }
-
-    expanded_len = sample_count;
-    if (SafeMult(&expanded_len, sizeof(Sint16))) {
-        return SDL_OutOfMemory();
-    } else if (expanded_len > SDL_MAX_UINT32 || file->sampleframes > SIZE_MAX) {
-        return SDL_SetError("WAVE file too big");
-    }
-
-    /* 1 to avoid allocating zero bytes, to keep static analysis happy. */
-    src = (Uint8 *)SDL_realloc(chunk->data, expanded_len ? expanded_len : 1);
-    if (src == NULL) {
-        return SDL_OutOfMemory();
-    }
-    chunk->data = NULL;
-    chunk->size = 0;
-
-    dst = (Sint16 *)src;
+    Uint8 *src = buf;
+    Sint16 *dst = (Sint16 *)buf;
+    size_t i;
 
     /* Work backwards, since we're expanding in-place. SDL_AudioSpec.format will
      * inform the caller about the byte order.
      */
     i = sample_count;
-    switch (file->format.encoding) {
+    switch (encoding) {
 #ifdef SDL_WAVE_LAW_LUT
     case ALAW_CODE:
         while (i--) {
@@ -1300,10 +1251,59 @@ LAW_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
         break;
 #endif
     default:
-        SDL_free(src);
         return SDL_SetError("Unknown companded encoding");
     }
 
+    return 0;
+}
+
+static int
+LAW_Decode(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
+{
+    WaveFormat *format = &file->format;
+    WaveChunk *chunk = &file->chunk;
+    size_t sample_count, expanded_len;
+    Uint8 *src;
+
+    if (chunk->length != chunk->size) {
+        file->sampleframes = WaveAdjustToFactValue(file, chunk->size / format->blockalign);
+        if (file->sampleframes < 0) {
+            return -1;
+        }
+    }
+
+    /* Nothing to decode, nothing to return. */
+    if (file->sampleframes == 0) {
+        *audio_buf = NULL;
+        *audio_len = 0;
+        return 0;
+    }
+
+    sample_count = (size_t)file->sampleframes;
+    if (SafeMult(&sample_count, format->channels)) {
+        return SDL_OutOfMemory();
+    }
+
+    expanded_len = sample_count;
+    if (SafeMult(&expanded_len, sizeof(Sint16))) {
+        return SDL_OutOfMemory();
+    } else if (expanded_len > SDL_MAX_UINT32 || file->sampleframes > SIZE_MAX) {
+        return SDL_SetError("WAVE file too big");
+    }
+
+    /* 1 to avoid allocating zero bytes, to keep static analysis happy. */
+    src = (Uint8 *)SDL_realloc(chunk->data, expanded_len ? expanded_len : 1);
+    if (src == NULL) {
+        return SDL_OutOfMemory();
+    }
+    chunk->data = NULL;
+    chunk->size = 0;
+
+    if (LAW_Expand(format->encoding, src, sample_count) < 0) {
+        SDL_free(src);
+        return -1;
+    }
+
     *audio_buf = src;
     *audio_len = (Uint32)expanded_len;
 
@@ -1353,12 +1353,37 @@ PCM_Init(WaveFile *file, size_t datalength)
     return 0;
 }
 
+/* Shifts sample_count 24-bit samples at the start of ptr to 32 bits. ptr must
+ * have room for the expanded samples.
+ */
+static void
+PCM_ExpandSint24(Uint8 *ptr, size_t sample_count)
+{
+    size_t i;
+
+    /* work from end to start, since we're expanding in-place. */
+    for (i = sample_count; i > 0; i--) {
+        const size_t o = i - 1;
+        uint8_t b[4];
+
+        b[0] = 0;
+        b[1] = ptr[o * 3];
+        b[2] = ptr[o * 3 + 1];
+        b[3] = ptr[o * 3 + 2];
+
+        ptr[o * 4 + 0] = b[0];
+        ptr[o * 4 + 1] = b[1];
+        ptr[o * 4 + 2] = b[2];
+        ptr[o * 4 + 3] = b[3];
+    }
+}
+
 static int
 PCM_ConvertSint24ToSint32(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
 {
     WaveFormat *format = &file->format;
     WaveChunk *chunk = &file->chunk;
-    size_t i, expanded_len, sample_count;
+    size_t expanded_len, sample_count;
     Uint8 *ptr;
 
     sample_count = (size_t)file->sampleframes;
@@ -1386,21 +1411,7 @@ PCM_ConvertSint24ToSint32(WaveFile *file, Uint8 **audio_buf, Uint32 *audio_len)
     *audio_buf = ptr;
     *audio_len = (Uint32)expanded_len;
 
-    /* work from end to start, since we're expanding in-place. */
-    for (i = sample_count; i > 0; i--) {
-        const size_t o = i - 1;
-        uint8_t b[4];
-
-        b[0] = 0;
-        b[1] = ptr[o * 3];
-        b[2] = ptr[o * 3 + 1];
-        b[3] = ptr[o * 3 + 2];
-
-        ptr[o * 4 + 0] = b[0];
-        ptr[o * 4 + 1] = b[1];
-        ptr[o * 4 + 2] = b[2];
-        ptr[o * 4 + 3] = b[3];
-    }
+    PCM_ExpandSint24(ptr, sample_count);
 
     return 0;
 }
@@ -1784,8 +1795,12 @@ WaveCheckFormat(WaveFile *file, size_t datalength)
     return 0;
 }
 
+/* Parses the headers of the WAVE file and initializes the decoder. On success,
+ * file->chunk describes the data chunk, without its data read, and endposition
+ * is set to the stream position after the WAVE file.
+ */
 static int
-WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf, Uint32 *audio_len)
+WaveOpen(SDL_RWops *src, WaveFile *file, Sint64 *endposition)
 {
     int result;
     Uint32 chunkcount = 0;
@@ -1793,7 +1808,6 @@ WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf,
     char *envchunkcountlimit;
     Sint64 RIFFstart, RIFFend, lastchunkpos;
     SDL_bool RIFFlengthknown = SDL_FALSE;
-    WaveFormat *format = &file->format;
     WaveChunk *chunk = &file->chunk;
     WaveChunk RIFFchunk;
     WaveChunk fmtchunk;
@@ -1998,55 +2012,26 @@ WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf,
 
     WaveFreeChunkData(chunk);
 
-    /* Process data chunk. */
+    /* The data chunk is read by the caller. */
     *chunk = datachunk;
 
-    if (chunk->length > 0) {
-        result = WaveReadChunkData(src, chunk);
-        if (result == -1) {
-            return -1;
-        } else if (result == -2) {
-            return SDL_SetError("Could not seek data of WAVE data chunk");
-        }
+    if (RIFFlengthknown) {
+        *endposition = RIFFend;
+    } else {
+        *endposition = lastchunkpos;
     }
 
-    if (chunk->length != chunk->size) {
-        /* I/O issues or corrupt file. */
-        if (file->trunchint == TruncVeryStrict || file->trunchint == TruncStrict) {
-            return SDL_SetError("Could not read data of WAVE data chunk");
-        }
-        /* The decoders handle this truncation. */
-    }
+    return 0;
+}
 
-    /* Decode or convert the data if necessary. */
-    switch (format->encoding) {
-    case PCM_CODE:
-    case IEEE_FLOAT_CODE:
-        if (PCM_Decode(file, audio_buf, audio_len) < 0) {
-            return -1;
-        }
-        break;
-    case ALAW_CODE:
-    case MULAW_CODE:
-        if (LAW_Decode(file, audio_buf, audio_len) < 0) {
-            return -1;
-        }
-        break;
-    case MS_ADPCM_CODE:
-        if (MS_ADPCM_Decode(file, audio_buf, audio_len) < 0) {
-            return -1;
-        }
-        break;
-    case IMA_ADPCM_CODE:
-        if (IMA_ADPCM_Decode(file, audio_buf, audio_len) < 0) {
-            return -1;
-        }
-        break;
-    }
+/* Sets up the SDL_AudioSpec for the samples the decoders return. All
+ * unsupported formats were filtered out by WaveCheckFormat.
+ */
+static int
+WaveSetSpec(WaveFile *file, SDL_AudioSpec *spec)
+{
+    WaveFormat *format = &file->format;
 
-    /* Setting up the SDL_AudioSpec. All unsupported formats were filtered out
-     * by checks earlier in this function.
-     */
     SDL_zerop(spec);
     spec->freq = format->frequency;
     spec->channels = (Uint8)format->channels;
@@ -2071,7 +2056,7 @@ WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf,
         case 16:
             spec->format = AUDIO_S16LSB;
             break;
-        case 24: /* Has been shifted to 32 bits. */
+        case 24: /* Gets shifted to 32 bits. */
         case 32:
             spec->format = AUDIO_S32LSB;
             break;
@@ -2084,13 +2069,72 @@ WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf,
 
     spec->silence = SDL_SilenceValueForFormat(spec->format);
 
-    /* Report the end position back to the cleanup code. */
-    if (RIFFlengthknown) {
-        chunk->position = RIFFend;
-    } else {
-        chunk->position = lastchunkpos;
+    return 0;
+}
+
+static int
+WaveLoad(SDL_RWops *src, WaveFile *file, SDL_AudioSpec *spec, Uint8 **audio_buf, Uint32 *audio_len)
+{
+    int result;
+    Sint64 endposition;
+    WaveFormat *format = &file->format;
+    WaveChunk *chunk = &file->chunk;
+
+    if (WaveOpen(src, file, &endposition) < 0) {
+        return -1;
+    }
+
+    /* Process data chunk. */
+    if (chunk->length > 0) {
+        result = WaveReadChunkData(src, chunk);
+        if (result == -1) {
+            return -1;
+        } else if (result == -2) {
+            return SDL_SetError("Could not seek data of WAVE data chunk");
+        }
     }
 
+    if (chunk->length != chunk->size) {
+        /* I/O issues or corrupt file. */
+        if (file->trunchint == TruncVeryStrict || file->trunchint == TruncStrict) {
+            return SDL_SetError("Could not read data of WAVE data chunk");
+        }
+        /* The decoders handle this truncation. */
+    }
+
+    /* Decode or convert the data if necessary. */
+    switch (format->encoding) {
+    case PCM_CODE:
+    case IEEE_FLOAT_CODE:
+        if (PCM_Decode(file, audio_buf, audio_len) < 0) {
+            return -1;
+        }
+        break;
+    case ALAW_CODE:
+    case MULAW_CODE:
+        if (LAW_Decode(file, audio_buf, audio_len) < 0) {
+            return -1;
+        }
+        break;
+    case MS_ADPCM_CODE:
+        if (MS_ADPCM_Decode(file, audio_buf, audio_len) < 0) {
+            return -1;
+        }
+        break;
+    case IMA_ADPCM_CODE:
+        if (IMA_ADPCM_Decode(file, audio_buf, audio_len) < 0) {
+            return -1;
+        }
+        break;
+    }
+
+    if (WaveSetSpec(file, spec) < 0) {
+        return -1;
+    }
+
+    /* Report the end position back to the cleanup code. */
+    chunk->position = endposition;
+
     return 0;
 }
 
@@ -2153,4 +2197,544 @@ SDL_FreeWAV(Uint8 *audio_buf)
     SDL_free(audio_buf);
 }
 
+/* Number of sample frames SDL_WAVDecoder decodes at a time. ADPCM batches are
+ * rounded up to whole blocks.
+ */
+#define WAVE_BATCH_FRAMES 4096
+
+/* A batch of decoded sample frames. */
+typedef struct WaveBatch
+{
+    SDL_WAVDecoder *decoder;
+    Uint8 *input;       /* Raw ADPCM blocks. Not used with the other encodings. */
+    Uint8 *output;      /* Decoded audio. */
+    Sint64 firstframe;  /* Sample frame at the start of output. */
+    size_t length;      /* Bytes of decoded audio in output. */
+    size_t pos;         /* Bytes already returned to the caller. */
+    int status;         /* 0 if more batches follow, 1 at the end of the data, -1 on error. */
+    char error[128];    /* Error message for status -1. May come from a job worker. */
+} WaveBatch;
+
+struct SDL_WAVDecoder
+{
+    SDL_RWops *src;
+    int freesrc;
+    Sint64 endposition;     /* Stream position after the WAVE file. */
+    WaveFile file;
+    size_t datasize;        /* Bytes of the data chunk available in the stream. */
+    size_t outframesize;    /* Size of a decoded sample frame in bytes. */
+    Sint64 batchframes;     /* Sample frames in a full batch. */
+    Sint64 nextframe;       /* First sample frame of the next batch to fill. */
+    Sint64 position;        /* Sample frame the caller gets next. */
+
+    /* The caller reads from batches[current]. With SDL_WAV_DECODE_THREADED,
+     * a job fills the other one in the meantime.
+     */
+    WaveBatch batches[2];
+    int current;
+    SDL_JobCounter *jobs;   /* Non-NULL if decoding on the job workers. */
+    SDL_bool prefetching;   /* A job was started for the other batch. */
+};
+
+static int
+WaveFillPCMBatch(SDL_WAVDecoder *decoder, WaveBatch *batch, Sint64 frames)
+{
+    WaveFile *file = &decoder->file;
+    WaveFormat *format = &file->format;
+    const Sint64 offset = file->chunk.position + batch->firstframe * format->blockalign;
+    const size_t length = (size_t)frames * format->blockalign;
+    size_t readframes;
+
+    if (SDL_RWseek(decoder->src, offset, RW_SEEK_SET) != offset) {
+        return SDL_SetError("Could not seek data of WAVE data chunk");
+    }
+
+    readframes = SDL_RWread(decoder->src, batch->output, 1, length) / format->blockalign;
+    if (readframes < (size_t)frames) {
+        /* I/O issues, or the stream got shorter since it was opened. */
+        if (file->trunchint == TruncVeryStrict || file->trunchint == TruncStrict) {
+            return SDL_SetError("Could not read data of WAVE data chunk");
+        }
+        batch->status = 1;
+    }
+
+    switch (format->encoding) {
+    case ALAW_CODE:
+    case MULAW_CODE:
+        if (LAW_Expand(format->encoding, batch->output, readframes * format->channels) < 0) {
+            return -1;
+        }
+        break;
+    case PCM_CODE:
+        /* 24-bit samples get shifted to 32 bits. */
+        if (format->bitspersample == 24) {
+            PCM_ExpandSint24(batch->output, readframes * format->channels);
+        }
+        break;
+    default:
+        break;
+    }
+
+    batch->length = readframes * decoder->outframesize;
+
+    return 0;
+}
+
+static int
+WaveFillADPCMBatch(SDL_WAVDecoder *decoder, WaveBatch *batch, Sint64 frames)
+{
+    WaveFile *file = &decoder->file;
+    WaveFormat *format = &file->format;
+    const size_t blocks = (size_t)((frames + format->samplesperblock - 1) / format->samplesperblock);
+    const size_t dataoffset = (size_t)(batch->firstframe / format->samplesperblock) * format->blockalign;
+    const Sint64 offset = file->chunk.position + dataoffset;
+    size_t length = blocks * format->blockalign;
+    ADPCM_DecoderState state;
+    MS_ADPCM_ChannelState mscstate[2];
+    Sint8 imacstate[255];
+    int result;
+
+    if (length > decoder->datasize - dataoffset) {
+        length = decoder->datasize - dataoffset;
+    }
+
+    if (SDL_RWseek(decoder->src, offset, RW_SEEK_SET) != offset) {
+        return SDL_SetError("Could not seek data of WAVE data chunk");
+    }
+
+    SDL_zero(state);
+    state.channels = format->channels;
+    state.blocksize = format->blockalign;
+    state.samplesperblock = format->samplesperblock;
+    state.framesize = state.channels * sizeof(Sint16);
+    state.ddata = file->decoderdata;
+    state.framestotal = frames;
+    state.framesleft = frames;
+
+    state.input.data = batch->input;
+    state.input.size = SDL_RWread(decoder->src, batch->input, 1, length);
+    state.input.pos = 0;
+
+    state.output.data = (Sint16 *)batch->output;
+    state.output.size = blocks * format->samplesperblock * format->channels;
+    state.output.pos = 0;
+
+    /* Every block header resets the channel states. */
+    if (format->encoding == MS_ADPCM_CODE) {
+        SDL_zeroa(mscstate);
+        state.blockheadersize = (size_t)state.channels * 7;
+        state.cstate = mscstate;
+        result = ADPCM_DecodeBlocks(file, &state, MS_ADPCM_DecodeBlockHeader, MS_ADPCM_DecodeBlockData);
+    } else {
+        SDL_zeroa(imacstate);
+        state.blockheadersize = (size_t)state.channels * 4;
+        state.cstate = imacstate;
+        result = ADPCM_DecodeBlocks(file, &state, IMA_ADPCM_DecodeBlockHeader, IMA_ADPCM_DecodeBlockData);
+    }
+
+    if (result < 0) {
+        return -1;
+    } else if (result == 1 || state.framesleft > 0) {
+        /* A truncated block, or the stream got shorter since it was opened. */
+        batch->status = 1;
+    }
+
+    batch->length = state.output.pos * sizeof(Sint16);
+
+    return 0;
+}
+
+/* Reads and decodes the batch starting at batch->firstframe. With
+ * SDL_WAV_DECODE_THREADED this runs as a job, while the caller only touches
+ * the other batch and waits for the job before using the data source.
+ */
+static void SDLCALL
+WaveFillBatch(void *data)
+{
+    WaveBatch *batch = (WaveBatch *)data;
+    SDL_WAVDecoder *decoder = batch->decoder;
+    const Sint64 frames = SDL_min(decoder->batchframes, decoder->file.sampleframes - batch->firstframe);
+    int result;
+
+    batch->length = 0;
+    batch->pos = 0;
+    batch->status = 0;
+
+    if (frames <= 0) {
+        batch->status = 1;
+        return;
+    }
+
+    switch (decoder->file.format.encoding) {
+    case MS_ADPCM_CODE:
+    case IMA_ADPCM_CODE:
+        result = WaveFillADPCMBatch(decoder, batch, frames);
+        break;
+    default:
+        result = WaveFillPCMBatch(decoder, batch, frames);
+        break;
+    }
+
+    if (result < 0) {
+        /* The error message is thread-local, keep it for the caller. */
+        SDL_strlcpy(batch->error, SDL_GetError(), sizeof(batch->error));
+        batch->length = 0;
+        batch->status = -1;
+    } else if (batch->firstframe + frames >= decoder->file.sampleframes) {
+        batch->status = 1;
+    }
+}
+
+/* Starts filling the batch the caller isn't using with the sample frames after
+ * the ones already queued.
+ */
+static void
+WaveStartBatch(SDL_WAVDecoder *decoder)
+{
+    WaveBatch *batch = &decoder->batches[decoder->current ^ 1];
+
+    batch->firstframe = decoder->nextframe;
+    decoder->nextframe += decoder->batchframes;
+    decoder->prefetching = SDL_TRUE;
+
+    if (SDL_RunJob(WaveFillBatch, batch, decoder->jobs) < 0) {
+        WaveFillBatch(batch);
+    }
+}
+
+static void
+WaveStopBatch(SDL_WAVDecoder *decoder)
+{
+    if (decoder->prefetching) {
+        SDL_WaitJobCounter(decoder->jobs);
+        decoder->prefetching = SDL_FALSE;
+    }
+}
+
+/* Makes sure the current batch has audio left for the caller. Returns 1 if it
+ * has, 0 at the end of the data, or -1 on error.
+ */
+static int
+WaveNextBatch(SDL_WAVDecoder *decoder, WaveBatch **current)
+{
+    WaveBatch *batch = &decoder->batches[decoder->current];
+
+    while (batch->pos == batch->length) {
+        if (batch->status < 0) {
+            return SDL_SetError("%s", batch->error);
+        } else if (batch->status > 0) {
+            return 0;
+        }
+
+        if (decoder->jobs != NULL) {
+            if (!decoder->prefetching) {
+                WaveStartBatch(decoder);
+            }
+            WaveStopBatch(decoder);
+            decoder->current ^= 1;
+            batch = &decoder->batches[decoder->current];
+            if (batch->status == 0) {
+                WaveStartBatch(decoder);
+            }
+        } else {
+            batch->firstframe = decoder->nextframe;
+            decoder->nextframe += decoder->batchframes;
+            WaveFillBatch(batch);
+        }
+
+        /* Skip to the position after a seek into an ADPCM block. */
+        if (decoder->position > batch->firstframe) {
+            const size_t skip = (size_t)(decoder->position - batch->firstframe) * decoder->outframesize;
+            batch->pos = SDL_min(skip, batch->length);
+        }
+    }
+
+    *current = batch;
+    return 1;
+}
+
+static int
+WaveDecode(SDL_WAVDecoder *decoder, Uint8 *buf, SDL_AudioStream *stream, int len)
+{
+    WaveBatch *batch = NULL;
+    size_t total = 0;
+    size_t wanted;
+    int result;
+
+    if (decoder == NULL) {
+        return SDL_InvalidParamError("decoder");
+    } else if (len < 0) {
+        return SDL_InvalidParamError("len");
+    }
+
+    wanted = (size_t)len - (size_t)len % decoder->outframesize;
+
+    while (total < wanted) {
+        size_t length;
+
+        result = WaveNextBatch(decoder, &batch);
+        if (result < 0) {
+            /* Hand out what was decoded, the error is reported again next time. */
+            return total > 0 ? (int)total : -1;
+        } else if (result == 0) {
+            break;
+        }
+
+        length = SDL_min(batch->length - batch->pos, wanted - total);
+        if (stream != NULL) {
+            if (SDL_AudioStreamPut(stream, batch->output + batch->pos, (int)length) < 0) {
+                return total > 0 ? (int)total : -1;
+            }
+        } else {
+            SDL_memcpy(buf + total, batch->output + batch->pos, length);
+        }
+
+        batch->pos += length;
+        total += length;
+        decoder->position += length / decoder->outframesize;
+    }
+
+    return (int)total;
+}
+
+SDL_WAVDecoder *
+SDL_OpenWAVDecoder_RW(SDL_RWops *src, int freesrc, SDL_AudioSpec *spec, Uint32 flags)
+{
+    SDL_WAVDecoder *decoder;
+    WaveFile *file;
+    WaveFormat *format;
+    WaveChunk *chunk;
+    size_t inputsize = 0, outputsize;
+    Sint64 streamsize;
+    int i;
+
+    /* Make sure we are passed a valid data source */
+    if (src == NULL) {
+        /* Error may come from RWops. */
+        return NULL;
+    } else if (spec == NULL) {
+        SDL_InvalidParamError("spec");
+        if (freesrc) {
+            SDL_RWclose(src);
+        }
+        return NULL;
+    }
+
+    decoder = (SDL_WAVDecoder *)SDL_calloc(1, sizeof(SDL_WAVDecoder));
+    if (decoder == NULL) {
+        SDL_OutOfMemory();
+        if (freesrc) {
+            SDL_RWclose(src);
+        }
+        return NULL;
+    }
+    decoder->src = src;
+    decoder->freesrc = freesrc;
+    decoder->endposition = -1;
+
+    file = &decoder->file;
+    format = &file->format;
+    chunk = &file->chunk;
+    file->riffhint = WaveGetRiffSizeHint();
+    file->trunchint = WaveGetTruncationHint();
+    file->facthint = WaveGetFactChunkHint();
+
+    if (WaveOpen(src, file, &decoder->endposition) < 0) {
+        goto error;
+    }
+
+    /* Only look at the data that's actually there. The decoders in
+     * SDL_LoadWAV_RW do the same with the data they could read.
+     */
+    decoder->datasize = chunk->length;
+    streamsize = SDL_RWsize(src);
+    if (streamsize >= 0 && streamsize - chunk->position < (Sint64)chunk->length) {
+        decoder->datasize = streamsize > chunk->position ? (size_t)(streamsize - chunk->position) : 0;
+    }
+
+    if (decoder->datasize != chunk->length) {
+        /* I/O issues or corrupt file. */
+        if (file->trunchint == TruncVeryStrict || file->trunchint == TruncStrict) {
+            SDL_SetError("Could not read data of WAVE data chunk");
+            goto error;
+        }
+
+        switch (format->encoding) {
+        case MS_ADPCM_CODE:
+            if (MS_ADPCM_CalculateSampleFrames(file, decoder->datasize) < 0) {
+                goto error;
+            }
+            break;
+        case IMA_ADPCM_CODE:
+            if (IMA_ADPCM_CalculateSampleFrames(file, decoder->datasize) < 0) {
+                goto error;
+            }
+            break;
+        default:
+            file->sampleframes = WaveAdjustToFactValue(file, decoder->datasize / format->blockalign);
+            if (file->sampleframes < 0) {
+                goto error;
+            }
+            break;
+        }
+    }
+
+    if (WaveSetSpec(file, spec) < 0) {
+        goto error;
+    }
+    decoder->outframesize = (SDL_AUDIO_BITSIZE(spec->format) / 8) * spec->channels;
+
+    switch (format->encoding) {
+    case MS_ADPCM_CODE:
+    case IMA_ADPCM_CODE:
+        decoder->batchframes = SDL_max(WAVE_BATCH_FRAMES / format->samplesperblock, 1);
+        inputsize = (size_t)decoder->batchframes * format->blockalign;
+        decoder->batchframes *= format->samplesperblock;
+        outputsize = (size_t)decoder->batchframes * decoder->outframesize;
+        break;
+    default:
+        /* The companded and 24-bit samples are expanded in place. */
+        decoder->batchframes = WAVE_BATCH_FRAMES;
+        outputsize = (size_t)decoder->batchframes * SDL_max(format->blockalign, decoder->outframesize);
+        break;
+    }
+
+    for (i = 0; i < ((flags & SDL_WAV_DECODE_THREADED) ? 2 : 1); i++) {
+        WaveBatch *batch = &decoder->batches[i];
+        batch->decoder = decoder;
+        batch->output = (Uint8 *)SDL_malloc(outputsize);
+        if (inputsize > 0) {
+            batch->input = (Uint8 *)SDL_malloc(inputsize);
+        }
+        if (batch->output == NULL || (inputsize > 0 && batch->input == NULL)) {
+            SDL_OutOfMemory();
+            goto error;
+        }
+    }
+
+    if (flags & SDL_WAV_DECODE_THREADED) {
+        decoder->jobs = SDL_CreateJobCounter();
+        if (decoder->jobs == NULL) {
+            goto error;
+        }
+        /* Get the first batch going right away. */
+        WaveStartBatch(decoder);
+    }
+
+    return decoder;
+
+error:
+    SDL_CloseWAVDecoder(decoder);
+    return NULL;
+}
+
+int
+SDL_DecodeWAV(SDL_WAVDecoder *decoder, void *buf, int len)
+{
+    if (buf == NULL) {
+        return SDL_InvalidParamError("buf");
+    }
+    return WaveDecode(decoder, (Uint8 *)buf, NULL, len);
+}
+
+int
+SDL_DecodeWAVToStream(SDL_WAVDecoder *decoder, SDL_AudioStream *stream, int len)
+{
+    if (stream == NULL) {
+        return SDL_InvalidParamError("stream");
+    }
+    return WaveDecode(decoder, NULL, stream, len);
+}
+
+int
+SDL_SeekWAVDecoder(SDL_WAVDecoder *decoder, Sint64 frame)
+{
+    WaveBatch *batch;
+    Sint64 batchend;
+
+    if (decoder == NULL) {
+        return SDL_InvalidParamError("decoder");
+    } else if (frame < 0 || frame > decoder->file.sampleframes) {
+        return SDL_SetError("Seek position out of range");
+    }
+
+    /* Stay in the current batch if it has the sample frame. */
+    batch = &decoder->batches[decoder->current];
+    batchend = batch->firstframe + (Sint64)(batch->length / decoder->outframesize);
+    if (batch->status >= 0 && frame >= batch->firstframe && frame < batchend) {
+        batch->pos = (size_t)(frame - batch->firstframe) * decoder->outframesize;
+        decoder->position = frame;
+        return 0;
+    }
+
+    WaveStopBatch(decoder);
+
+    batch->length = 0;
+    batch->pos = 0;
+    batch->status = 0;
+
+    /* ADPCM can only start decoding at a block header. */
+    decoder->nextframe = frame;
+    switch (decoder->file.format.encoding) {
+    case MS_ADPCM_CODE:
+    case IMA_ADPCM_CODE:
+        decoder->nextframe -= frame % decoder->file.format.samplesperblock;
+        break;
+    }
+    decoder->position = frame;
+
+    if (decoder->jobs != NULL) {
+        WaveStartBatch(decoder);
+    }
+
+    return 0;
+}
+
+Sint64
+SDL_TellWAVDecoder(SDL_WAVDecoder *decoder)
+{
+    if (decoder == NULL) {
+        return SDL_InvalidParamError("decoder");
+    }
+    return decoder->position;
+}
+
+Sint64
+SDL_GetWAVDecoderLength(SDL_WAVDecoder *decoder)
+{
+    if (decoder == NULL) {
+        return SDL_InvalidParamError("decoder");
+    }
+    return decoder->file.sampleframes;
+}
+
+void
+SDL_CloseWAVDecoder(SDL_WAVDecoder *decoder)
+{
+    int i;
+
+    if (decoder == NULL) {
+        return;
+    }
+
+    if (decoder->jobs != NULL) {
+        WaveStopBatch(decoder);
+        SDL_DestroyJobCounter(decoder->jobs);
+    }
+
+    if (decoder->freesrc) {
+        SDL_RWclose(decoder->src);
+    } else if (decoder->endposition >= 0) {
+        SDL_RWseek(decoder->src, decoder->endposition, RW_SEEK_SET);
+    }
+
+    for (i = 0; i < (int)SDL_arraysize(decoder->batches); i++) {
+        SDL_free(decoder->batches[i].input);
+        SDL_free(decoder->batches[i].output);
+    }
+    WaveFreeChunkData(&decoder->file.chunk);
+    SDL_free(decoder->file.decoderdata);
+    SDL_free(decoder);
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
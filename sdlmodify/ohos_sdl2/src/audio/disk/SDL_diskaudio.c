@@ -32,6 +32,7 @@
 #include "SDL_timer.h"
 #include "SDL_audio.h"
 #include "../SDL_audio_c.h"
+#include "../../thread/SDL_systhread.h"
 #include "SDL_diskaudio.h"
 #include "SDL_log.h"
 
@@ -72,6 +73,23 @@ DISKAUDIO_GetDeviceBuf(_THIS)
     return (this->hidden->mixbuf);
 }
 
+/* In pull mode this plays the part of the system's audio callback thread,
+   asking SDL for each buffer right before it is written out. */
+static int SDLCALL
+DISKAUDIO_PullThread(void *data)
+{
+    SDL_AudioDevice *this = (SDL_AudioDevice *) data;
+
+    SDL_SetThreadPriority(SDL_THREAD_PRIORITY_TIME_CRITICAL);
+
+    while (!SDL_AtomicGet(&this->hidden->pull_shutdown)) {
+        SDL_PullAudio(this, this->hidden->mixbuf, this->spec.size);
+        DISKAUDIO_PlayDevice(this);
+        DISKAUDIO_WaitDevice(this);
+    }
+    return 0;
+}
+
 static int
 DISKAUDIO_CaptureFromDevice(_THIS, void *buffer, int buflen)
 {
@@ -106,6 +124,10 @@ DISKAUDIO_FlushCapture(_THIS)
 static void
 DISKAUDIO_CloseDevice(_THIS)
 {
+    if (this->hidden->pull_thread != NULL) {
+        SDL_AtomicSet(&this->hidden->pull_shutdown, 1);
+        SDL_WaitThread(this->hidden->pull_thread, NULL);
+    }
     if (this->hidden->io != NULL) {
         SDL_RWclose(this->hidden->io);
     }
@@ -161,6 +183,13 @@ DISKAUDIO_OpenDevice(_THIS, void *handle, const char *devname, int iscapture)
         SDL_memset(this->hidden->mixbuf, this->spec.silence, this->spec.size);
     }
 
+    if (this->pull_mode) {
+        this->hidden->pull_thread = SDL_CreateThreadInternal(DISKAUDIO_PullThread, "SDLDiskPull", 0, this);
+        if (this->hidden->pull_thread == NULL) {
+            return -1;
+        }
+    }
+
     SDL_LogCritical(SDL_LOG_CATEGORY_AUDIO,
                 "You are using the SDL disk i/o audio driver!\n");
     SDL_LogCritical(SDL_LOG_CATEGORY_AUDIO,
@@ -194,6 +223,7 @@ DISKAUDIO_Init(SDL_AudioDriverImpl * impl)
 
     impl->AllowsArbitraryDeviceNames = 1;
     impl->HasCaptureSupport = SDL_TRUE;
+    impl->SupportsPullMode = 1;
 
     return 1;   /* this audio target is available. */
 }
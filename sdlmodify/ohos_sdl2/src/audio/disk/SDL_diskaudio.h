@@ -35,6 +35,10 @@ struct SDL_PrivateAudioData
     SDL_RWops *io;
     Uint32 io_delay;
     Uint8 *mixbuf;
+
+    /* Pull mode: stands in for the system's audio thread. */
+    SDL_Thread *pull_thread;
+    SDL_atomic_t pull_shutdown;
 };
 
 #endif /* SDL_diskaudio_h_ */
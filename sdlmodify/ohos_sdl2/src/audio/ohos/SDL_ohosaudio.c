@@ -109,6 +109,7 @@ static int OHOSAUDIO_Init(SDL_AudioDriverImpl * impl)
 
     /* and the capabilities */
     impl->HasCaptureSupport = SDL_TRUE;
+    impl->SupportsPullMode = 1;
     impl->OnlyHasDefaultOutputDevice = 0; /*Supports opening multiple output devices.*/
     impl->OnlyHasDefaultCaptureDevice = 1;
 
@@ -22,6 +22,7 @@
 #include <ohaudio/native_audiostreambuilder.h>
 #include <ohaudio/native_audiocapturer.h>
 #include <ohaudio/native_audiorenderer.h>
+#include "SDL_ohosaudiobuffer.h"
 
 #ifdef __cplusplus
 /* *INDENT-OFF* */
@@ -34,12 +35,21 @@ struct SDL_PrivateAudioData {
     OH_AudioStreamBuilder *builder;
     OH_AudioCapturer *audioCapturer;
     OH_AudioRenderer *audioRenderer;
+    OhosAudioCaptureBuffer *captureBuffer;
+    /* Render queue of renderPeriods buffers of ohosFrameSize bytes each. */
     unsigned char *rendererBuffer;
     int ohosFrameSize;
-    SDL_atomic_t stateFlag;
+    int renderPeriods;
+    int renderWritePos;   /* mixer thread only */
+    int renderReadPos;    /* renderer callback only */
+    int renderReadOffset; /* renderer callback only */
+    SDL_atomic_t renderQueued;
+    SDL_atomic_t renderReady;
+    SDL_atomic_t renderWaiting;
+    SDL_atomic_t renderUnderruns;
+    SDL_atomic_t renderSilentBytes;
     SDL_atomic_t isShutDown;
     SDL_mutex *audioPlayLock;
-    SDL_cond *full;
     SDL_cond *empty;
     SDL_cond *bufferCond;
     int resume;
@@ -19,149 +19,180 @@
 
 #include "SDL_stdinc.h"
 #include "SDL_atomic.h"
+#include "SDL_mutex.h"
 #include "SDL_ohosaudiobuffer.h"
 
-#define DEFAULT_MS 2
+/* Upper bound of one wait, so a reader notices shutdown even if the capturer stopped delivering. */
+#define OHOS_CAPTURE_WAIT_MS 100
 
-typedef struct {
+/*
+ * `in` and `out` are free running byte counters; `out - in` is the fill level,
+ * so a full ring is never mistaken for an empty one. The producer only
+ * advances `out` and the consumer only advances `in`. The mutex and condition
+ * are only touched when the reader actually has to sleep.
+ */
+struct OhosAudioCaptureBuffer {
     unsigned char *buffer;
     unsigned int size;
+    unsigned int mask;
     SDL_atomic_t in;
     SDL_atomic_t out;
-} AudioCaptureBuffer;
-
-AudioCaptureBuffer *gCaptureBuffer;
+    SDL_atomic_t waiting;
+    SDL_atomic_t shutdown;
+    SDL_atomic_t overruns;
+    SDL_atomic_t underruns;
+    SDL_atomic_t droppedBytes;
+    SDL_mutex *lock;
+    SDL_cond *dataCond;
+};
+
+static unsigned int OHOS_AUDIOBUFFER_RoundPowerOfTwo(unsigned int value)
+{
+    unsigned int result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
 
-int OHOS_AUDIOBUFFER_InitCapture(unsigned int bufferSize)
+OhosAudioCaptureBuffer *OHOS_AUDIOBUFFER_InitCapture(unsigned int bufferSize)
 {
-    gCaptureBuffer = (AudioCaptureBuffer *)SDL_malloc(sizeof(AudioCaptureBuffer));
-    if (gCaptureBuffer == NULL) {
+    OhosAudioCaptureBuffer *capture = (OhosAudioCaptureBuffer *)SDL_calloc(1, sizeof(OhosAudioCaptureBuffer));
+    if (capture == NULL) {
         SDL_Log("Malloc capture struct failed.");
-        return -1;
+        return NULL;
     }
-    gCaptureBuffer->buffer = (unsigned char *)SDL_malloc(bufferSize);
-    if (gCaptureBuffer->buffer == NULL) {
-        SDL_free(gCaptureBuffer);
+    capture->size = OHOS_AUDIOBUFFER_RoundPowerOfTwo(bufferSize);
+    capture->mask = capture->size - 1;
+    capture->buffer = (unsigned char *)SDL_calloc(1, capture->size);
+    capture->lock = SDL_CreateMutex();
+    capture->dataCond = SDL_CreateCond();
+    if (capture->buffer == NULL || capture->lock == NULL || capture->dataCond == NULL) {
         SDL_Log("Malloc capture buffer failed.");
-        return -1;
+        OHOS_AUDIOBUFFER_DeInitCapture(capture);
+        return NULL;
     }
-    SDL_memset(gCaptureBuffer->buffer, 0, bufferSize);
-
-    gCaptureBuffer->size = bufferSize;
-    SDL_AtomicSet(&gCaptureBuffer->in, 0);
-    SDL_AtomicSet(&gCaptureBuffer->out, 0);
-    return 0;
+    return capture;
 }
 
-int OHOS_AUDIOBUFFER_DeInitCapture(void)
+void OHOS_AUDIOBUFFER_DeInitCapture(OhosAudioCaptureBuffer *capture)
 {
-    if (gCaptureBuffer != NULL) {
-        if (gCaptureBuffer->buffer != NULL) {
-            SDL_free(gCaptureBuffer->buffer);
-        }
-        SDL_free(gCaptureBuffer);
-        gCaptureBuffer = NULL;
+    if (capture == NULL) {
+        return;
+    }
+    if (capture->dataCond != NULL) {
+        SDL_DestroyCond(capture->dataCond);
+    }
+    if (capture->lock != NULL) {
+        SDL_DestroyMutex(capture->lock);
     }
-    return 0;
+    SDL_free(capture->buffer);
+    SDL_free(capture);
 }
 
-static SDL_bool OHOS_AUDIOBUFFER_IsEmpty(unsigned int size)
+/* Copies between the ring and a linear buffer, splitting at the wrap point. */
+static void OHOS_AUDIOBUFFER_CopyOut(OhosAudioCaptureBuffer *capture, unsigned int pos, unsigned char *dst,
+                                     unsigned int len)
 {
-    SDL_bool isEmpty;
-    unsigned int in = (unsigned int)SDL_AtomicGet(&gCaptureBuffer->in);
-    unsigned int out = (unsigned int)SDL_AtomicGet(&gCaptureBuffer->out);
-    if (in == out) {
-        return SDL_TRUE;
-    }
-    if (out > in) {
-        isEmpty = (out - in < size) ? SDL_TRUE : SDL_FALSE;
-    } else {
-        isEmpty = (gCaptureBuffer->size - in + out < size) ? SDL_TRUE : SDL_FALSE;
-    }
-    return isEmpty;
+    unsigned int offset = pos & capture->mask;
+    unsigned int first = SDL_min(len, capture->size - offset);
+    SDL_memcpy(dst, capture->buffer + offset, first);
+    SDL_memcpy(dst + first, capture->buffer, len - first);
 }
 
-int OHOS_AUDIOBUFFER_ReadCaptureBuffer(unsigned char *buffer, unsigned int size)
+static void OHOS_AUDIOBUFFER_CopyIn(OhosAudioCaptureBuffer *capture, unsigned int pos, const unsigned char *src,
+                                    unsigned int len)
 {
-    unsigned char *pDividerBuffer;
-    unsigned char *pIn;
-    unsigned int in;
-    unsigned int out;
-    while (OHOS_AUDIOBUFFER_IsEmpty(size) == SDL_TRUE) {
-        SDL_Delay(DEFAULT_MS);
-    }
-    in = (unsigned int)SDL_AtomicGet(&gCaptureBuffer->in);
-    out = (unsigned int)SDL_AtomicGet(&gCaptureBuffer->out);
-    pIn = gCaptureBuffer->buffer + in;
-    if (out > in) {
-        SDL_memcpy(buffer, pIn, size);
-        SDL_AtomicSet(&gCaptureBuffer->in, in + size);
-    } else {
-        unsigned int len = gCaptureBuffer->size - in;
-        if (len >= size) {
-            SDL_memcpy(buffer, pIn, size);
-            SDL_AtomicSet(&gCaptureBuffer->in, in + size);
-        } else {
-            SDL_memcpy(buffer, pIn, len);
-            pDividerBuffer = buffer + len;
-            SDL_memcpy(pDividerBuffer, gCaptureBuffer->buffer, size - len);
-            SDL_AtomicSet(&gCaptureBuffer->in, size - len);
+    unsigned int offset = pos & capture->mask;
+    unsigned int first = SDL_min(len, capture->size - offset);
+    SDL_memcpy(capture->buffer + offset, src, first);
+    SDL_memcpy(capture->buffer, src + first, len - first);
+}
+
+int OHOS_AUDIOBUFFER_ReadCaptureBuffer(OhosAudioCaptureBuffer *capture, unsigned char *buffer, unsigned int size)
+{
+    unsigned int done = 0;
+    SDL_bool waited = SDL_FALSE;
+
+    while (done < size) {
+        unsigned int in = (unsigned int)SDL_AtomicGet(&capture->in);
+        unsigned int used = (unsigned int)SDL_AtomicGet(&capture->out) - in;
+        unsigned int len;
+
+        if (used == 0) {
+            if (SDL_AtomicGet(&capture->shutdown)) {
+                return -1;
+            }
+            if (!waited) {
+                SDL_AtomicIncRef(&capture->underruns);
+                waited = SDL_TRUE;
+            }
+            SDL_LockMutex(capture->lock);
+            /* Announce the wait before re-checking, the writer signals after publishing `out`. */
+            SDL_AtomicCAS(&capture->waiting, 0, 1);
+            if ((unsigned int)SDL_AtomicGet(&capture->out) == in && !SDL_AtomicGet(&capture->shutdown)) {
+                SDL_CondWaitTimeout(capture->dataCond, capture->lock, OHOS_CAPTURE_WAIT_MS);
+            }
+            SDL_AtomicSet(&capture->waiting, 0);
+            SDL_UnlockMutex(capture->lock);
+            continue;
         }
+
+        SDL_MemoryBarrierAcquire();
+        len = SDL_min(used, size - done);
+        OHOS_AUDIOBUFFER_CopyOut(capture, in, buffer + done, len);
+        SDL_AtomicAdd(&capture->in, (int)len);
+        done += len;
     }
-    return 0;
+    return (int)done;
 }
 
-static SDL_bool OHOS_AUDIOBUFFER_IsFull(unsigned int size)
+int OHOS_AUDIOBUFFER_WriteCaptureBuffer(OhosAudioCaptureBuffer *capture, const unsigned char *buffer,
+                                       unsigned int size)
 {
-    SDL_bool isFull = SDL_FALSE;
-    unsigned int in = (unsigned int)SDL_AtomicGet(&gCaptureBuffer->in);
-    unsigned int out = (unsigned int)SDL_AtomicGet(&gCaptureBuffer->out);
-    if (in == out) {
-        return SDL_FALSE;
+    unsigned int out = (unsigned int)SDL_AtomicGet(&capture->out);
+    unsigned int space = capture->size - (out - (unsigned int)SDL_AtomicGet(&capture->in));
+    unsigned int len = SDL_min(size, space);
+
+    /* Never block the system capture thread, drop what does not fit. */
+    if (len < size) {
+        SDL_AtomicIncRef(&capture->overruns);
+        SDL_AtomicAdd(&capture->droppedBytes, (int)(size - len));
+    }
+    if (len > 0) {
+        SDL_MemoryBarrierAcquire();
+        OHOS_AUDIOBUFFER_CopyIn(capture, out, buffer, len);
+        SDL_AtomicAdd(&capture->out, (int)len);
     }
-    if (out > in) {
-        isFull = (gCaptureBuffer->size - out + in < size) ? SDL_TRUE : SDL_FALSE;
-    } else {
-        isFull = (in - out < size) ? SDL_TRUE : SDL_FALSE;
+
+    if (SDL_AtomicGet(&capture->waiting)) {
+        SDL_LockMutex(capture->lock);
+        SDL_CondSignal(capture->dataCond);
+        SDL_UnlockMutex(capture->lock);
     }
-    return isFull;
+    return (int)len;
 }
 
-int OHOS_AUDIOBUFFER_WriteCaptureBuffer(unsigned char *buffer, unsigned int size)
+/* Consumer side only, the capturer must be paused. */
+void OHOS_AUDIOBUFFER_FlushBuffer(OhosAudioCaptureBuffer *capture)
 {
-    unsigned char *pOut;
-    unsigned char *pDividerBuffer;
-    unsigned int in;
-    unsigned int out;
-    while (OHOS_AUDIOBUFFER_IsFull(size) == SDL_TRUE) {
-        SDL_Delay(DEFAULT_MS);
-    }
-    in = (unsigned int)SDL_AtomicGet(&gCaptureBuffer->in);
-    out = (unsigned int)SDL_AtomicGet(&gCaptureBuffer->out);
-    pOut = gCaptureBuffer->buffer + out;
-    if (out > in) {
-        unsigned int len = gCaptureBuffer->size - out;
-        if (len >= size) {
-            SDL_memcpy(pOut, buffer, size);
-            SDL_AtomicSet(&gCaptureBuffer->out, out + size);
-        } else {
-            SDL_memcpy(pOut, buffer, len);
-            pDividerBuffer = buffer + len;
-            SDL_memcpy(gCaptureBuffer->buffer, pDividerBuffer, size - len);
-            SDL_AtomicSet(&gCaptureBuffer->out, size - len);
-        }
-    } else {
-        SDL_memcpy(pOut, buffer, size);
-        SDL_AtomicSet(&gCaptureBuffer->out, out + size);
-    }
-    return 0;
+    SDL_AtomicSet(&capture->in, SDL_AtomicGet(&capture->out));
+    SDL_MemoryBarrierRelease();
+}
+
+void OHOS_AUDIOBUFFER_ShutdownCapture(OhosAudioCaptureBuffer *capture)
+{
+    SDL_LockMutex(capture->lock);
+    SDL_AtomicSet(&capture->shutdown, 1);
+    SDL_CondSignal(capture->dataCond);
+    SDL_UnlockMutex(capture->lock);
 }
 
-void OHOS_AUDIOBUFFER_FlushBuffer(void)
+void OHOS_AUDIOBUFFER_GetCaptureStats(OhosAudioCaptureBuffer *capture, OhosAudioCaptureStats *stats)
 {
-    SDL_AtomicSet(&gCaptureBuffer->in, 0);
-    SDL_AtomicSet(&gCaptureBuffer->out, 0);
-    SDL_memset(gCaptureBuffer->buffer, 0, gCaptureBuffer->size);
+    stats->overruns = (Uint32)SDL_AtomicGet(&capture->overruns);
+    stats->underruns = (Uint32)SDL_AtomicGet(&capture->underruns);
+    stats->droppedBytes = (Uint32)SDL_AtomicGet(&capture->droppedBytes);
 }
 
 #endif /* SDL_AUDIO_DRIVER_OHOS */
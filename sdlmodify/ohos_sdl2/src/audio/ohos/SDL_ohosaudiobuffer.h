@@ -15,11 +15,28 @@
 #ifndef SDL_OHOSAUDIOBUFFER_H
 #define SDL_OHOSAUDIOBUFFER_H
 
-int OHOS_AUDIOBUFFER_InitCapture(unsigned int bufferSize);
-int OHOS_AUDIOBUFFER_DeInitCapture(void);
-int OHOS_AUDIOBUFFER_ReadCaptureBuffer(unsigned char *buffer, unsigned int size);
-int OHOS_AUDIOBUFFER_WriteCaptureBuffer(unsigned char *buffer, unsigned int size);
-void OHOS_AUDIOBUFFER_FlushBuffer(void);
+#include "SDL_stdinc.h"
+
+/*
+ * Capture ring of one device. The capturer callback is the only writer and
+ * the SDL capture thread the only reader.
+ */
+typedef struct OhosAudioCaptureBuffer OhosAudioCaptureBuffer;
+
+typedef struct OhosAudioCaptureStats {
+    Uint32 overruns;  /* callbacks that found the ring full and dropped data */
+    Uint32 underruns; /* reads that had to wait for the capturer */
+    Uint32 droppedBytes;
+} OhosAudioCaptureStats;
+
+OhosAudioCaptureBuffer *OHOS_AUDIOBUFFER_InitCapture(unsigned int bufferSize);
+void OHOS_AUDIOBUFFER_DeInitCapture(OhosAudioCaptureBuffer *capture);
+int OHOS_AUDIOBUFFER_ReadCaptureBuffer(OhosAudioCaptureBuffer *capture, unsigned char *buffer, unsigned int size);
+int OHOS_AUDIOBUFFER_WriteCaptureBuffer(OhosAudioCaptureBuffer *capture, const unsigned char *buffer,
+                                       unsigned int size);
+void OHOS_AUDIOBUFFER_FlushBuffer(OhosAudioCaptureBuffer *capture);
+void OHOS_AUDIOBUFFER_ShutdownCapture(OhosAudioCaptureBuffer *capture);
+void OHOS_AUDIOBUFFER_GetCaptureStats(OhosAudioCaptureBuffer *capture, OhosAudioCaptureStats *stats);
 
 #endif /* SDL_OHOSAUDIOBUFFER_H */
 
@@ -24,22 +24,21 @@
 #include "../../core/ohos/SDL_ohos.h"
 
 #include "SDL_timer.h"
+#include "SDL_hints.h"
 #include "../SDL_sysaudio.h"
 #include "SDL_ohosaudio.h"
 #include "SDL_ohosaudiobuffer.h"
 #include "SDL_ohosaudiomanager.h"
+#include "../../SDL_trace_c.h"
 
 #define DEFAULT_MS 2
 #define THREAD_MS 10
 
-/*
- * Audio support
- */
-static int captureBufferLength = 0;
-
 static OH_AudioStream_State gAudioRendorStatus;
 
 #define OHOS_RENDER_BUFFER_SHUTDOEN_LEN 1024
+#define OHOS_RENDER_PERIODS_DEFAULT 3
+#define OHOS_RENDER_PERIODS_MAX 16
 
 /*
  * Audio Capturer Callbacks
@@ -47,7 +46,14 @@ static OH_AudioStream_State gAudioRendorStatus;
 static int32_t OHOSAUDIO_AudioCapturer_OnReadData(OH_AudioCapturer *capturer, void *userData,
                                                   void *buffer, int32_t length)
 {
-    OHOS_AUDIOBUFFER_WriteCaptureBuffer(buffer, length);
+    SDL_AudioDevice *device = (SDL_AudioDevice *)userData;
+    struct SDL_PrivateAudioData *private = (struct SDL_PrivateAudioData *)device->hidden;
+    SDL_TRACE_BEGIN("OHOSAUDIO_AudioCapturer_OnReadData");
+    if (private->captureBuffer != NULL && length > 0) {
+        OHOS_AUDIOBUFFER_WriteCaptureBuffer(private->captureBuffer, (const unsigned char *)buffer,
+                                            (unsigned int)length);
+    }
+    SDL_TRACE_END();
     return 0;
 }
 
@@ -70,43 +76,97 @@ static int32_t OHOSAUDIO_AudioCapturer_OnError(OH_AudioCapturer *capturer, void
 
 /*
  * Audio Renderer Callbacks
+ *
+ * The mixer thread and the renderer callback share a queue of renderPeriods
+ * buffers. renderQueued is the number of filled periods: the mixer only
+ * increments it after filling a period and the callback only decrements it
+ * after playing one, so neither side takes a lock on the fast path. The
+ * callback never waits; if the mixer fell behind it plays silence and counts
+ * an underrun. The mixer sleeps on `empty` only while the queue is full.
+ *
+ * In pull mode there is no mixer thread and no queue: the callback has SDL
+ * fill the renderer's buffer directly.
  */
 static int32_t OHOSAUDIO_AudioRenderer_OnWriteData(OH_AudioRenderer *renderer, void *userData, void *buffer,
                                                    int32_t length)
 {
     SDL_AudioDevice *device = (SDL_AudioDevice *)userData;
     struct SDL_PrivateAudioData *private = (struct SDL_PrivateAudioData *)device->hidden;
-    SDL_LockMutex(private->audioPlayLock);
+    unsigned char *dst = (unsigned char *)buffer;
+    int remaining = length;
+    SDL_bool consumed = SDL_FALSE;
+
     if (private->ohosFrameSize == -1 && length > 0) {
+        SDL_LockMutex(private->audioPlayLock);
         private->ohosFrameSize = length;
         SDL_CondBroadcast(private->bufferCond);
+        SDL_UnlockMutex(private->audioPlayLock);
     }
-    while (SDL_AtomicGet(&private->stateFlag) == SDL_FALSE &&
-           SDL_AtomicGet(&private->isShutDown) == SDL_FALSE) {
-        SDL_CondWait(private->full, private->audioPlayLock);
+    if (device->pull_mode) {
+        if (SDL_AtomicGet(&private->isShutDown) == SDL_FALSE) {
+            SDL_PullAudio(device, dst, length);
+        } else {
+            SDL_memset(buffer, device->spec.silence, length);
+        }
+        return 0;
+    }
+    if (SDL_AtomicGet(&private->renderReady) == SDL_FALSE) {
+        SDL_memset(buffer, device->spec.silence, length);
+        return 0;
+    }
+
+    SDL_TRACE_BEGIN("OHOSAUDIO_AudioRenderer_OnWriteData");
+    SDL_TRACE_COUNTER("ohosaudio queued periods", SDL_AtomicGet(&private->renderQueued));
+    while (remaining > 0 && SDL_AtomicGet(&private->renderQueued) > 0) {
+        unsigned char *period;
+        int len;
+        SDL_MemoryBarrierAcquire();
+        period = private->rendererBuffer + private->renderReadPos * private->ohosFrameSize;
+        len = SDL_min(remaining, private->ohosFrameSize - private->renderReadOffset);
+        SDL_memcpy(dst, period + private->renderReadOffset, len);
+        dst += len;
+        remaining -= len;
+        private->renderReadOffset += len;
+        if (private->renderReadOffset == private->ohosFrameSize) {
+            private->renderReadOffset = 0;
+            private->renderReadPos = (private->renderReadPos + 1) % private->renderPeriods;
+            SDL_AtomicDecRef(&private->renderQueued);
+            consumed = SDL_TRUE;
+        }
     }
-    if (SDL_AtomicGet(&private->isShutDown) == SDL_FALSE && private->rendererBuffer != NULL) {
-        SDL_memcpy(buffer, private->rendererBuffer, private->ohosFrameSize);
-        SDL_AtomicSet(&private->stateFlag, SDL_FALSE);
-        SDL_CondBroadcast(private->empty);
-    } else {
-        int value = 0;
-        if (device != NULL) {
-            value = device->spec.silence;
+
+    if (remaining > 0) {
+        SDL_memset(dst, device->spec.silence, remaining);
+        if (SDL_AtomicGet(&private->isShutDown) == SDL_FALSE) {
+            SDL_AtomicIncRef(&private->renderUnderruns);
+            SDL_AtomicAdd(&private->renderSilentBytes, remaining);
+            SDL_TRACE_INSTANT("ohosaudio underrun");
         }
-        SDL_memset(buffer, value, private->ohosFrameSize);
     }
-    SDL_UnlockMutex(private->audioPlayLock);
+
+    if (consumed && SDL_AtomicGet(&private->renderWaiting)) {
+        SDL_LockMutex(private->audioPlayLock);
+        SDL_CondSignal(private->empty);
+        SDL_UnlockMutex(private->audioPlayLock);
+    }
+    SDL_TRACE_END();
     return 0;
 }
 
 void *OHOSAUDIO_NATIVE_GetAudioBuf(SDL_AudioDevice *device)
 {
     struct SDL_PrivateAudioData *private = (struct SDL_PrivateAudioData *)device->hidden;
+    void *period;
     SDL_LockMutex(private->audioPlayLock);
-    while ((private->rendererBuffer == NULL || SDL_AtomicGet(&private->stateFlag) == SDL_TRUE) &&
+    while (SDL_AtomicGet(&private->renderReady) == SDL_TRUE &&
+           SDL_AtomicGet(&private->renderQueued) >= private->renderPeriods &&
            SDL_AtomicGet(&private->isShutDown) == SDL_FALSE) {
-        SDL_CondWait(private->empty, private->audioPlayLock);
+        /* Announce the wait before re-checking, the callback signals after freeing a period. */
+        SDL_AtomicCAS(&private->renderWaiting, 0, 1);
+        if (SDL_AtomicGet(&private->renderQueued) >= private->renderPeriods) {
+            SDL_CondWait(private->empty, private->audioPlayLock);
+        }
+        SDL_AtomicSet(&private->renderWaiting, 0);
     }
     // go here, may is shut down state and ohos render start failed, just init buffer
     // make sure shutdown normal
@@ -114,21 +174,40 @@ void *OHOSAUDIO_NATIVE_GetAudioBuf(SDL_AudioDevice *device)
         private->rendererBuffer = SDL_malloc(OHOS_RENDER_BUFFER_SHUTDOEN_LEN);
         device->callbackspec.size = OHOS_RENDER_BUFFER_SHUTDOEN_LEN;
         device->spec.size = OHOS_RENDER_BUFFER_SHUTDOEN_LEN;
+        period = private->rendererBuffer;
     } else {
         device->callbackspec.size = private->ohosFrameSize;
         device->spec.size = private->ohosFrameSize;
+        period = private->rendererBuffer + private->renderWritePos * private->ohosFrameSize;
     }
     SDL_UnlockMutex(private->audioPlayLock);
-    return private->rendererBuffer;
+    return period;
 }
 
 void OHOSAUDIO_NATIVE_WriteAudioBuf(SDL_AudioDevice *device)
 {
     struct SDL_PrivateAudioData *private = (struct SDL_PrivateAudioData *)device->hidden;
-    SDL_LockMutex(private->audioPlayLock);
-    SDL_AtomicSet(&private->stateFlag, SDL_TRUE);
-    SDL_CondBroadcast(private->full);
-    SDL_UnlockMutex(private->audioPlayLock);
+    /* Only publish a period that GetAudioBuf handed out with space behind it. */
+    if (SDL_AtomicGet(&private->renderReady) == SDL_FALSE || SDL_AtomicGet(&private->isShutDown) == SDL_TRUE ||
+        SDL_AtomicGet(&private->renderQueued) >= private->renderPeriods) {
+        return;
+    }
+    private->renderWritePos = (private->renderWritePos + 1) % private->renderPeriods;
+    SDL_AtomicIncRef(&private->renderQueued);
+}
+
+int OHOSAUDIO_NATIVE_GetRenderStats(SDL_AudioDevice *device, SDL_OHOSAudioRenderStats *stats)
+{
+    struct SDL_PrivateAudioData *private = (struct SDL_PrivateAudioData *)device->hidden;
+    if (device->iscapture || private == NULL) {
+        return SDL_Unsupported();
+    }
+    stats->periods = (Uint32)private->renderPeriods;
+    stats->periodBytes = (Uint32)SDL_max(private->ohosFrameSize, 0);
+    stats->queuedPeriods = (Uint32)SDL_AtomicGet(&private->renderQueued);
+    stats->underruns = (Uint32)SDL_AtomicGet(&private->renderUnderruns);
+    stats->silentBytes = (Uint32)SDL_AtomicGet(&private->renderSilentBytes);
+    return 0;
 }
 
 static int32_t OHOSAUDIO_AudioRenderer_OnStreamEvent(OH_AudioRenderer *renderer,
@@ -275,7 +354,7 @@ static int OHOSAUDIO_SetCapturerCallback(SDL_AudioDevice *device, int iscapture)
         capturerCallbacks.OH_AudioCapturer_OnStreamEvent = OHOSAUDIO_AudioCapturer_OnStreamEvent;
         capturerCallbacks.OH_AudioCapturer_OnInterruptEvent = OHOSAUDIO_AudioCapturer_OnInterruptEvent;
         capturerCallbacks.OH_AudioCapturer_OnError = OHOSAUDIO_AudioCapturer_OnError;
-        iRet = OH_AudioStreamBuilder_SetCapturerCallback(private->builder, capturerCallbacks, NULL);
+        iRet = OH_AudioStreamBuilder_SetCapturerCallback(private->builder, capturerCallbacks, device);
         if (AUDIOSTREAM_SUCCESS != iRet) {
             OH_LOG_Print(LOG_APP, LOG_DEBUG, LOG_DOMAIN, "OpenAudioDevice",
                 "SetCapturerCallback Failed, iscapture=%{public}d, Error=%{public}d.", iscapture, iRet);
@@ -407,6 +486,16 @@ static int OHOSAUDIO_Format2Depth(SDL_AudioSpec *spec, int audioFormat)
     return audioFormatBitDepth;
 }
 
+static int OHOSAUDIO_GetRenderPeriods(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_OHOS_AUDIO_PERIODS);
+    int periods = OHOS_RENDER_PERIODS_DEFAULT;
+    if (hint != NULL && *hint != '\0') {
+        periods = SDL_atoi(hint);
+    }
+    return SDL_max(1, SDL_min(periods, OHOS_RENDER_PERIODS_MAX));
+}
+
 static int OHOSAUDIO_WaitInitRenderBuffer(SDL_AudioDevice *device)
 {
     struct SDL_PrivateAudioData *private = (struct SDL_PrivateAudioData *)device->hidden;
@@ -419,14 +508,34 @@ static int OHOSAUDIO_WaitInitRenderBuffer(SDL_AudioDevice *device)
         SDL_UnlockMutex(private->audioPlayLock);
         return -1;
     }
-    private->rendererBuffer = SDL_malloc(private->ohosFrameSize + 1);
+    if (device->pull_mode) {
+        /* No queue, just match our period to the renderer's. */
+        const int frameBytes = (SDL_AUDIO_BITSIZE(device->spec.format) / 8) * device->spec.channels;
+        private->rendererBuffer = NULL;
+        device->spec.samples = (Uint16)(private->ohosFrameSize / frameBytes);
+        SDL_UnlockMutex(private->audioPlayLock);
+        OH_LOG_Print(LOG_APP, LOG_DEBUG, LOG_DOMAIN, "OpenAudioDevice", "Pull mode, %{public}d bytes per callback.",
+            private->ohosFrameSize);
+        return 0;
+    }
+    private->renderPeriods = OHOSAUDIO_GetRenderPeriods();
+    private->rendererBuffer = SDL_malloc(private->ohosFrameSize * private->renderPeriods);
     if (private->rendererBuffer == NULL) {
         SDL_UnlockMutex(private->audioPlayLock);
         return -1;
     }
-    SDL_memset(private->rendererBuffer, 0, private->ohosFrameSize);
+    /* Start with a full queue of silence so the first mixer hiccup has the whole depth to recover. */
+    SDL_memset(private->rendererBuffer, device->spec.silence, private->ohosFrameSize * private->renderPeriods);
+    private->renderWritePos = 0;
+    private->renderReadPos = 0;
+    private->renderReadOffset = 0;
+    SDL_AtomicSet(&private->renderQueued, private->renderPeriods);
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&private->renderReady, SDL_TRUE);
     SDL_CondBroadcast(private->empty);
     SDL_UnlockMutex(private->audioPlayLock);
+    OH_LOG_Print(LOG_APP, LOG_DEBUG, LOG_DOMAIN, "OpenAudioDevice", "Render queue %{public}d x %{public}d bytes.",
+        private->renderPeriods, private->ohosFrameSize);
     return 0;
 }
 
@@ -436,8 +545,12 @@ static int OHOSAUDIO_Start(SDL_AudioDevice *device, int iscapture, SDL_AudioSpec
     struct SDL_PrivateAudioData *private = (struct SDL_PrivateAudioData *)device->hidden;
     if (iscapture != 0) {
         #define ADDITIONAL_BUFFER_FACTOR 2
-        captureBufferLength = (spec->samples * spec->channels * audioFormatBitDepth) * ADDITIONAL_BUFFER_FACTOR;
-        OHOS_AUDIOBUFFER_InitCapture((unsigned int)captureBufferLength);
+        int captureBufferLength = (spec->samples * spec->channels * audioFormatBitDepth) * ADDITIONAL_BUFFER_FACTOR;
+        private->captureBuffer = OHOS_AUDIOBUFFER_InitCapture((unsigned int)captureBufferLength);
+        if (private->captureBuffer == NULL) {
+            OHOSAUDIO_NATIVE_CloseAudioDevice(device, iscapture);
+            return -1;
+        }
         OH_LOG_Print(LOG_APP, LOG_DEBUG, LOG_DOMAIN, "OpenAudioDevice", "captureBufferLength=%{public}d.",
             captureBufferLength);
 
@@ -446,18 +559,19 @@ static int OHOSAUDIO_Start(SDL_AudioDevice *device, int iscapture, SDL_AudioSpec
             OH_LOG_Print(LOG_APP, LOG_DEBUG, LOG_DOMAIN, "OpenAudioDevice",
                 "Capturer_Start Failed, iscapture=%{public}d, Error=%{public}d.", iscapture, iRet);
             OHOSAUDIO_NATIVE_CloseAudioDevice(device, iscapture);
-            OHOS_AUDIOBUFFER_DeInitCapture();
             return -1;
         }
     } else {
-        SDL_AtomicSet(&private->stateFlag, SDL_FALSE);
         private->audioPlayLock = SDL_CreateMutex();
         private->empty = SDL_CreateCond();
-        private->full = SDL_CreateCond();
         private->bufferCond = SDL_CreateCond();
+        SDL_SetMutexName(private->audioPlayLock, "ohosaudio.audioPlayLock");
+        SDL_SetCondName(private->empty, "ohosaudio.empty");
+        SDL_SetCondName(private->bufferCond, "ohosaudio.bufferCond");
         private->ohosFrameSize = -1;
+        SDL_AtomicSet(&private->renderReady, SDL_FALSE);
+        SDL_AtomicSet(&private->renderQueued, 0);
         SDL_AtomicSet(&private->isShutDown, SDL_FALSE);
-        SDL_AtomicSet(&private->stateFlag, SDL_FALSE);
         iRet = OH_AudioRenderer_Start(private->audioRenderer);
         if (AUDIOSTREAM_SUCCESS != iRet) {
             OH_LOG_Print(LOG_APP, LOG_DEBUG, LOG_DOMAIN, "OpenAudioDevice",
@@ -539,7 +653,10 @@ int OHOSAUDIO_NATIVE_CaptureAudioBuffer(SDL_AudioDevice *device, void *buffer, i
     if (AUDIOSTREAM_STATE_PAUSED == iStatus) {
         OH_AudioCapturer_Start(private->audioCapturer);
     }
-    OHOS_AUDIOBUFFER_ReadCaptureBuffer(buffer, (unsigned int)buflen);
+    if (OHOS_AUDIOBUFFER_ReadCaptureBuffer(private->captureBuffer, buffer, (unsigned int)buflen) < 0) {
+        /* Shutting down, hand back silence instead of stale data. */
+        SDL_memset(buffer, device->spec.silence, buflen);
+    }
     return buflen;
 }
 
@@ -551,7 +668,7 @@ void OHOSAUDIO_NATIVE_FlushCapturedAudio(SDL_AudioDevice *device)
     if (AUDIOSTREAM_STATE_RUNNING == iStatus) {
         OH_AudioCapturer_Pause(private->audioCapturer);
     }
-    OHOS_AUDIOBUFFER_FlushBuffer();
+    OHOS_AUDIOBUFFER_FlushBuffer(private->captureBuffer);
 }
 
 static void OHOSAUDIO_DestroyBuilder(SDL_AudioDevice *device, int iscapture)
@@ -591,15 +708,19 @@ static OHOSAUDIO_NATIVE_CloseRender(SDL_AudioDevice *device)
             OH_LOG_Print(LOG_APP, LOG_INFO, LOG_DOMAIN, "CloseAudioDevice",
                          "SDL audio: OH_AudioRenderer_Stop error,error code = %{public}d", iRet);
         }
-        SDL_CondBroadcast(private->full);
         iRet = OH_AudioRenderer_Release(private->audioRenderer);
-        SDL_AtomicSet(&private->stateFlag, SDL_FALSE);
         if (AUDIOSTREAM_SUCCESS != iRet) {
             OH_LOG_Print(LOG_APP, LOG_INFO, LOG_DOMAIN, "CloseAudioDevice",
                          "SDL audio: OH_AudioRenderer_Release error,error code = %{public}d", iRet);
         }
         private->audioRenderer = NULL;
     }
+    if (SDL_AtomicGet(&private->renderReady) == SDL_TRUE) {
+        OH_LOG_Print(LOG_APP, LOG_INFO, LOG_DOMAIN, "CloseAudioDevice",
+            "Render underruns=%{public}d, silence=%{public}d bytes.",
+            SDL_AtomicGet(&private->renderUnderruns), SDL_AtomicGet(&private->renderSilentBytes));
+    }
+    SDL_AtomicSet(&private->renderReady, SDL_FALSE);
     private->ohosFrameSize = -1;
     if (private->rendererBuffer != NULL) {
         SDL_free(private->rendererBuffer);
@@ -619,15 +740,14 @@ static OHOSAUDIO_NATIVE_CloseRender(SDL_AudioDevice *device)
         SDL_DestroyCond(private->empty);
         private->empty = NULL;
     }
-    if (private->full != NULL) {
-        SDL_DestroyCond(private->full);
-        private->full = NULL;
-    }
 }
 
 void OHOSAUDIO_NATIVE_PrepareClose(SDL_AudioDevice *device)
 {
     struct SDL_PrivateAudioData *private = (struct SDL_PrivateAudioData *)device->hidden;
+    if (private->captureBuffer != NULL) {
+        OHOS_AUDIOBUFFER_ShutdownCapture(private->captureBuffer);
+    }
     SDL_LockMutex(private->audioPlayLock);
     SDL_AtomicSet(&private->isShutDown, SDL_TRUE);
     SDL_CondBroadcast(private->empty);
@@ -656,7 +776,15 @@ void OHOSAUDIO_NATIVE_CloseAudioDevice(SDL_AudioDevice *device, const int iscapt
             }
             private->audioCapturer = NULL;
         }
-        OHOS_AUDIOBUFFER_DeInitCapture();
+        if (private->captureBuffer != NULL) {
+            OhosAudioCaptureStats stats;
+            OHOS_AUDIOBUFFER_GetCaptureStats(private->captureBuffer, &stats);
+            OH_LOG_Print(LOG_APP, LOG_INFO, LOG_DOMAIN, "CloseAudioDevice",
+                "Capture overruns=%{public}u, underruns=%{public}u, dropped=%{public}u bytes.",
+                stats.overruns, stats.underruns, stats.droppedBytes);
+            OHOS_AUDIOBUFFER_DeInitCapture(private->captureBuffer);
+            private->captureBuffer = NULL;
+        }
     } else {
         OHOSAUDIO_NATIVE_CloseRender(device);
     }
@@ -17,6 +17,7 @@
 
 #include "../../SDL_internal.h"
 #include "SDL_audio.h"
+#include "SDL_system.h"
 #include "../SDL_sysaudio.h"
 
 void OHOSAUDIO_PageResume(void);
@@ -30,6 +31,7 @@ extern int OHOSAUDIO_NATIVE_CaptureAudioBuffer(SDL_AudioDevice *device, void *bu
 extern void OHOSAUDIO_NATIVE_FlushCapturedAudio(SDL_AudioDevice *device);
 extern void OHOSAUDIO_NATIVE_CloseAudioDevice(SDL_AudioDevice *device, const int iscapture);
 extern void OHOSAUDIO_NATIVE_PrepareClose(SDL_AudioDevice *device);
+extern int OHOSAUDIO_NATIVE_GetRenderStats(SDL_AudioDevice *device, SDL_OHOSAudioRenderStats *stats);
 
 #endif /* SDL_OHOSAUDIOMANAGER_H */
 
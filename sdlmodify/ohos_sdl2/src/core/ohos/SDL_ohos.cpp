@@ -24,7 +24,6 @@
 #include <unistd.h>
 #include <hilog/log.h>
 #include <dlfcn.h>
-#include "cJSON.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -45,6 +44,7 @@ extern "C" {
 #include "../../audio/ohos/SDL_ohosaudio.h"
 #include "adapter_c/SDL_AdapterC.h"
 #include "SDL_ohosthreadsafe.h"
+#include "SDL_ohostscommand.h"
 #include "SDL_ohos_xcomponent.h"
 #include <map>
 #include <memory>
@@ -121,38 +121,24 @@ SDL_DisplayOrientation OHOS_GetDisplayOrientation()
 
 void OHOS_NAPI_SetWindowResize(int x, int y, int w, int h)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_SET_WINDOWRESIZE);
-    cJSON_AddNumberToObject(root, "x", x);
-    cJSON_AddNumberToObject(root, "y", y);
-    cJSON_AddNumberToObject(root, "w", w);
-    cJSON_AddNumberToObject(root, "h", h);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_SET_WINDOWRESIZE, NULL);
+    command.u.rect.x = x;
+    command.u.rect.y = y;
+    command.u.rect.w = w;
+    command.u.rect.h = h;
+    OHOS_TS_PostCommand(&command);
 }
 
 void OHOS_NAPI_ShowTextInput(int x, int y, int w, int h)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_SHOW_TEXTINPUT);
-    cJSON_AddNumberToObject(root, "x", x);
-    cJSON_AddNumberToObject(root, "y", y);
-    cJSON_AddNumberToObject(root, "w", w);
-    cJSON_AddNumberToObject(root, "h", h);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_SHOW_TEXTINPUT, NULL);
+    command.u.rect.x = x;
+    command.u.rect.y = y;
+    command.u.rect.w = w;
+    command.u.rect.h = h;
+    OHOS_TS_PostCommand(&command);
 }
 
 SDL_bool OHOS_NAPI_RequestPermission(const char *permission)
@@ -163,17 +149,14 @@ SDL_bool OHOS_NAPI_RequestPermission(const char *permission)
     }
     SDL_AtomicSet(&bPermissionRequestPending, SDL_TRUE);
 
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_REQUEST_PERMISSION, NULL);
+    command.text = SDL_strdup(permission);
+    if (!OHOS_TS_PostCommand(&command)) {
+        SDL_free(command.text);
+        SDL_AtomicSet(&bPermissionRequestPending, SDL_FALSE);
         return SDL_FALSE;
     }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_REQUEST_PERMISSION);
-    cJSON_AddStringToObject(root, "permission", permission);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
     /* Wait for the request to complete */
     while (SDL_AtomicGet(&bPermissionRequestPending) == SDL_TRUE) {
         SDL_Delay(OHOS_DELAY_TEN);
@@ -183,286 +166,140 @@ SDL_bool OHOS_NAPI_RequestPermission(const char *permission)
 
 SDL_bool OHOS_NAPI_AddChildNode(void *parent, void **child, char *xcompentId, WindowPosition *windowPosition)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return SDL_FALSE;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_ADD_CHILD_NODE);
-  //  cJSON_AddNumberToObject(root, "parent", (long long)parent.get());
-    unsigned long long parentnode = (unsigned long long)parent;
-    cJSON_AddStringToObject(root, "parent", std::to_string(parentnode).c_str());
-    // cJSON_AddNumberToObject(root, "child", (long long)child);
-    
-        unsigned long long childnode = (unsigned long long)child;
-    cJSON_AddStringToObject(root, "child", std::to_string(childnode).c_str());
-    
-    cJSON_AddStringToObject(root, "xcompentid", xcompentId);
-   // cJSON_AddNumberToObject(root, "position", (long long)windowPosition);
-    
-    unsigned long long position = (unsigned long long)windowPosition;
-      SDL_Log("data->position11111 ======%p.",position);
-    cJSON_AddStringToObject(root, "position", std::to_string(position).c_str());
-    
     ThreadLockInfo *lockInfo = new ThreadLockInfo();
-    unsigned long long lockpo = (unsigned long long)lockInfo;
-    SDL_Log("enter data->position11111 ======%p.",position);
-    cJSON_AddStringToObject(root, OHOS_JSON_ASYN, std::to_string(lockpo).c_str());
-    
-   // std::uintptr_t lockInfoPointer = reinterpret_cast<std::uintptr_t>(lockInfo);
-    //cJSON_AddNumberToObject(root, OHOS_JSON_ASYN, (double)lockInfoPointer);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_ADD_CHILD_NODE, xcompentId);
+    command.u.node.parent = parent;
+    command.u.node.child = child;
+    command.u.node.position = windowPosition;
+    command.u.node.lockInfo = lockInfo;
+    if (!OHOS_TS_PostCommand(&command)) {
         delete lockInfo;
-        cJSON_free(root);
         return SDL_FALSE;
     }
     std::unique_lock<std::mutex> lock(lockInfo->mutex);
     lockInfo->condition.wait_for(lock, std::chrono::seconds(OHOS_INDEX_ARG6), [lockInfo] { return lockInfo->ready; });
+    lock.unlock();
     delete lockInfo;
     return SDL_TRUE;
 }
 
 SDL_bool OHOS_NAPI_RemoveChildNode(char *xcompentId)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return SDL_FALSE;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_REMOVE_CHILD_NODE);
-    cJSON_AddStringToObject(root, "xcompentid", xcompentId);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
-    return SDL_TRUE;
+    return OHOS_TS_PostNodeCommand(NAPI_CALLBACK_REMOVE_CHILD_NODE, xcompentId, 0, 0, 0, 0);
 }
 
 SDL_bool OHOS_NAPI_ResizeNode(char *xcompentId, int width, int height)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return SDL_FALSE;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_RESIZE_NODE);
-    cJSON_AddStringToObject(root, "xcompentid", xcompentId);
-    cJSON_AddNumberToObject(root, "width", width);
-    cJSON_AddNumberToObject(root, "height", height);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
-    return SDL_TRUE;
+    return OHOS_TS_PostNodeCommand(NAPI_CALLBACK_RESIZE_NODE, xcompentId, 0, 0, width, height);
 }
 
 SDL_bool OHOS_NAPI_MoveNode(char *xcompentId, int x, int y)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return SDL_FALSE;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_MOVE_NODE);
-    cJSON_AddStringToObject(root, "xcompentid", xcompentId);
-    cJSON_AddNumberToObject(root, "x", x);
-    cJSON_AddNumberToObject(root, "y", y);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
-    return SDL_TRUE;
+    return OHOS_TS_PostNodeCommand(NAPI_CALLBACK_MOVE_NODE, xcompentId, x, y, 0, 0);
 }
 
 SDL_bool OHOS_NAPI_ShowNode(char *xcompentId)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return SDL_FALSE;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_SHOW_NODE);
-    cJSON_AddStringToObject(root, "xcompentid", xcompentId);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
-    return SDL_TRUE;
+    return OHOS_TS_PostNodeCommand(NAPI_CALLBACK_SHOW_NODE, xcompentId, 0, 0, 0, 0);
 }
 
 SDL_bool OHOS_NAPI_HideNode(char *xcompentId)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return SDL_FALSE;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_HIDE_NODE);
-    cJSON_AddStringToObject(root, "xcompentid", xcompentId);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
-    return SDL_TRUE;
+    return OHOS_TS_PostNodeCommand(NAPI_CALLBACK_HIDE_NODE, xcompentId, 0, 0, 0, 0);
 }
 
 SDL_bool OHOS_NAPI_RaiseNode(char *xcompentId)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return SDL_FALSE;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_RAISE_NODE);
-    cJSON_AddStringToObject(root, "xcompentid", xcompentId);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
-    return SDL_TRUE;
+    return OHOS_TS_PostNodeCommand(NAPI_CALLBACK_RAISE_NODE, xcompentId, 0, 0, 0, 0);
 }
 
 void OHOS_NAPI_HideTextInput(int flag)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_HIDE_TEXTINPUT);
-    cJSON_AddNumberToObject(root, "flag", flag);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_HIDE_TEXTINPUT, NULL);
+    command.u.value = flag;
+    OHOS_TS_PostCommand(&command);
 }
 
 void OHOS_NAPI_ShouldMinimizeOnFocusLoss(int flag)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_SHOULD_MINIMIZEON_FOCUSLOSS);
-    cJSON_AddNumberToObject(root, "flag", flag);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_SHOULD_MINIMIZEON_FOCUSLOSS, NULL);
+    command.u.value = flag;
+    OHOS_TS_PostCommand(&command);
 }
 
 void OHOS_NAPI_SetTitle(const char *title)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_SET_TITLE);
-    cJSON_AddStringToObject(root, "title", title);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_SET_TITLE, NULL);
+    command.text = SDL_strdup(title ? title : "");
+    if (!OHOS_TS_PostCommand(&command)) {
+        SDL_free(command.text);
     }
 }
 
 void OHOS_NAPI_SetWindowStyle(SDL_bool fullscreen)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_SET_WINDOWSTYLE);
-    cJSON_AddBoolToObject(root, "fullscreen", fullscreen);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_SET_WINDOWSTYLE, NULL);
+    command.u.value = fullscreen;
+    OHOS_TS_PostCommand(&command);
 }
 
 void OHOS_NAPI_ShowTextInputKeyboard(SDL_bool isshow)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_SHOW_TEXTINPUTKEYBOARD);
-    cJSON_AddBoolToObject(root, "isshow", isshow);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_SHOW_TEXTINPUTKEYBOARD, NULL);
+    command.u.value = isshow;
+    OHOS_TS_PostCommand(&command);
 }
 
 void OHOS_NAPI_SetOrientation(int w, int h, int resizable, const char *hint)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_SET_ORIENTATION);
-    cJSON_AddNumberToObject(root, "w", w);
-    cJSON_AddNumberToObject(root, "h", h);
-    cJSON_AddNumberToObject(root, "resizable", resizable);
-    cJSON_AddStringToObject(root, "hint", hint);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_SET_ORIENTATION, NULL);
+    command.u.orientation.w = w;
+    command.u.orientation.h = h;
+    command.u.orientation.resizable = resizable;
+    command.text = SDL_strdup(hint ? hint : "");
+    if (!OHOS_TS_PostCommand(&command)) {
+        SDL_free(command.text);
     }
 }
 
 int OHOS_CreateCustomCursor(SDL_Surface *xcomponent, int hotX, int hotY)
 {
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return -1;
-    }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_CREATE_CUSTOMCURSOR);
-    cJSON_AddNumberToObject(root, "hot_x", hotX);
-    cJSON_AddNumberToObject(root, "hot_y", hotY);
-    cJSON_AddNumberToObject(root, "BytesPerPixel", xcomponent->format->BytesPerPixel);
-    cJSON_AddNumberToObject(root, "w", xcomponent->w);
-    cJSON_AddNumberToObject(root, "h", xcomponent->h);
     size_t bufferSize = xcomponent->w * xcomponent->h * xcomponent->format->BytesPerPixel;
     void *buff = SDL_malloc(bufferSize);
+    if (buff == NULL) {
+        return SDL_OutOfMemory();
+    }
     SDL_memcpy(buff, xcomponent->pixels, bufferSize);
-//    long long xcomponentpixel = (long long)buff;
-//    cJSON_AddNumberToObject(root, "xcomponentpixel", (double)xcomponentpixel);
-    
-        unsigned long long xcomponentpixel = (unsigned long long)buff;
-    SDL_Log("xcomponentpixel1111 ======%ld.", xcomponentpixel);
-    SDL_Log("(double)xcomponentpixel1111 ======%s.",std::to_string(xcomponentpixel).c_str());
-    
-   // cJSON_AddNumberToObject(root, "xcomponentpixel", (double)xcomponentpixel);
-    cJSON_AddStringToObject(root, "xcomponentpixel", std::to_string(xcomponentpixel).c_str());
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
+
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_CREATE_CUSTOMCURSOR, NULL);
+    command.u.cursor.pixels = buff;
+    command.u.cursor.hotX = hotX;
+    command.u.cursor.hotY = hotY;
+    command.u.cursor.bytesPerPixel = xcomponent->format->BytesPerPixel;
+    command.u.cursor.w = xcomponent->w;
+    command.u.cursor.h = xcomponent->h;
+    if (!OHOS_TS_PostCommand(&command)) {
+        SDL_free(buff);
+        return -1;
     }
     return 1;
 }
 
 SDL_bool OHOS_SetCustomCursor(int cursorID)
 {
+    /* The ArkTS side only sets a custom cursor as it creates it, there is no way to reselect one. */
+    (void)cursorID;
     if (SDL_AtomicGet(&bQuit) == SDL_TRUE) {
         return SDL_TRUE;
     }
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
-        return SDL_FALSE;
-    }
-    cJSON_AddNumberToObject(root, "cursorID", cursorID);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
     return SDL_FALSE;
 }
 
@@ -471,17 +308,12 @@ SDL_bool OHOS_SetSystemCursor(int cursorID)
     if (SDL_AtomicGet(&bQuit) == SDL_TRUE) {
         return SDL_TRUE;
     }
-    cJSON *root = cJSON_CreateObject();
-    if (root == NULL) {
-        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error creating JSON object.");
+    OhosTSCommand command;
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_SET_SYSTEMCURSOR, NULL);
+    command.u.value = cursorID;
+    if (!OHOS_TS_PostCommand(&command)) {
         return SDL_FALSE;
     }
-    cJSON_AddNumberToObject(root, OHOS_TS_CALLBACK_TYPE, NAPI_CALLBACK_SET_SYSTEMCURSOR);
-    cJSON_AddNumberToObject(root, "cursorID", cursorID);
-    napi_status status = napi_call_threadsafe_function(g_napiCallback->tsfn, root, napi_tsfn_nonblocking);
-    if (status != napi_ok) {
-        cJSON_free(root);
-    }
     return SDL_TRUE;
 }
 
@@ -512,9 +344,8 @@ napi_value SDLNapi::OHOS_SetResourceManager(napi_env env, napi_callback_info inf
     g_path = new char[len + 1];
     napi_get_value_string_utf8(env, args[0], g_path, len + 1, &len);
     
-    gCtx = SDL_AllocRW();
-    NativeResourceManager *nativeResourceManager = OH_ResourceManager_InitNativeResourceManager(env, args[1]);
-    gCtx->hidden.ohosio.nativeResourceManager = nativeResourceManager;
+    /* Not released when replaced, rawfile RWops opened earlier may still use the old one. */
+    g_nativeResourceManager = OH_ResourceManager_InitNativeResourceManager(env, args[1]);
     return nullptr;
 }
 
@@ -675,12 +506,14 @@ napi_value SDLNapi::OHOS_NativeSendQuit(napi_env env, napi_callback_info info)
     while (SDL_SemTryWait(g_ohosPauseSem) == 0) {
     }
     SDL_SemPost(g_ohosResumeSem);
+    SDL_WakeEventWaiters();
     return nullptr;
 }
 
 napi_value SDLNapi::OHOS_NativeResume(napi_env env, napi_callback_info info)
 {
     SDL_SemPost(g_ohosResumeSem);
+    SDL_WakeEventWaiters();
     OHOSAUDIO_PageResume();
     return nullptr;
 }
@@ -688,6 +521,7 @@ napi_value SDLNapi::OHOS_NativeResume(napi_env env, napi_callback_info info)
 napi_value SDLNapi::OHOS_NativePause(napi_env env, napi_callback_info info)
 {
     SDL_SemPost(g_ohosPauseSem);
+    SDL_WakeEventWaiters();
     OHOSAUDIO_PagePause();
     return nullptr;
 }
@@ -771,6 +605,7 @@ static void OHOS_NAPI_NativeSetup(void)
     SDL_AtomicSet(&bQuit, SDL_FALSE);
 
     g_ohosPageMutex = SDL_CreateMutex();
+    SDL_SetMutexName(g_ohosPageMutex, "g_ohosPageMutex");
     g_ohosResizeSync = InitWindowResizeSync();
     return;
 }
@@ -32,7 +32,6 @@
 
 enum NapiCallBackType {
     NAPI_CALLBACK_CREATE_CUSTOMCURSOR,
-    NAPI_CALLBACK_SET_CUSTOMCURSOR,
     NAPI_CALLBACK_SET_SYSTEMCURSOR,
     NAPI_CALLBACK_SET_RELATIVEMOUSEENABLED,
     NAPI_CALLBACK_SET_DISPLAYORIENTATION,
@@ -52,6 +51,7 @@ enum NapiCallBackType {
     NAPI_CALLBACK_SET_ORIENTATION,
     NAPI_CALLBACK_SHOW_TEXTINPUTKEYBOARD,
     NAPI_CALLBACK_SET_WINDOWRESIZE,
+    NAPI_CALLBACK_APPLY_NODE_STATE,
 };
 
 typedef struct {
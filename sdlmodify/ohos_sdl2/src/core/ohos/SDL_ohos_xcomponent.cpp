@@ -37,6 +37,7 @@ extern "C" {
 #endif
 #include "../../events/SDL_events_c.h"
 #include "../../video/SDL_egl_c.h"
+#include "../../SDL_trace_c.h"
 #ifdef __cplusplus
 }
 #endif
@@ -50,6 +51,7 @@ extern "C" {
 #include <sys/types.h>
 #include <unistd.h>
 #include "SDL_ohos_xcomponent.h"
+#include "SDL_ohosinput.h"
 #include "SDL_ohosplugin.h"
 #include "SDL_ohos.h"
 
@@ -152,6 +154,7 @@ static void OnSurfaceChangedCB(OH_NativeXComponent *component, void *window)
     OH_NativeXComponent_GetXComponentOffset(component, window, &offsetX, &offsetY);
     SDL_Log("Xcompent is changeing, xcomponent is %p", component);
 
+    SDL_TRACE_BEGIN("OnSurfaceChangedCB");
     SDL_LockMutex(g_ohosPageMutex);
     SDL_WindowData *data = OhosPluginManager::GetInstance()->GetWindowDataByXComponent(component);
     if (data != nullptr) {
@@ -167,40 +170,68 @@ static void OnSurfaceChangedCB(OH_NativeXComponent *component, void *window)
         SDL_UnlockMutex(g_ohosResizeSync->sizeChangeMutex);
     }
     SDL_UnlockMutex(g_ohosPageMutex);
+    SDL_TRACE_END();
 }
 
 static void OnSurfaceDestroyedCB(OH_NativeXComponent *component, void *window)
 {
 }
 
+static void FillTouchRecord(OhosInputRecord *record, OH_NativeXComponent *component, int64_t deviceId,
+                            int32_t id, int action, float x, float y, float force, int64_t timeStamp)
+{
+    record->kind = OHOS_INPUT_TOUCH;
+    record->component = component;
+    record->timestamp = timeStamp;
+    record->data.touch.touchDeviceIdIn = (int)deviceId;
+    record->data.touch.pointerFingerIdIn = id;
+    record->data.touch.action = action;
+    record->data.touch.x = x;
+    record->data.touch.y = y;
+    record->data.touch.p = force;
+}
+
+/* Runs on the UI thread: convert the whole event, then hand it to the SDL thread in one batch */
 static void DispatchTouchEventCB(OH_NativeXComponent *component, void *window)
 {
     OH_NativeXComponent_TouchEvent touchEvent;
-    float tiltX = 0.0f;
-    float tiltY = 0.0f;
-    OH_NativeXComponent_TouchPointToolType toolType = OH_NATIVEXCOMPONENT_TOOL_TYPE_UNKNOWN;
+    OH_NativeXComponent_HistoricalPoint *history = nullptr;
+    int32_t historySize = 0;
+    OhosInputRecord records[OHOS_INPUT_MAX_BATCH];
+    int count = 0;
 
-    SDL_LockMutex(g_ohosPageMutex);
-    OH_NativeXComponent_GetTouchEvent(component, window, &touchEvent);
-    OH_NativeXComponent_GetTouchPointToolType(component, 0, &toolType);
-    tiltX = touchEvent.x;
-    tiltY = touchEvent.y;
-
-    OhosTouchId ohosTouch;
-    ohosTouch.touchDeviceIdIn = touchEvent.deviceId;
-    ohosTouch.pointerFingerIdIn = touchEvent.id;
-    ohosTouch.action = touchEvent.type;
-    ohosTouch.x = tiltX;
-    ohosTouch.y = tiltY;
-    ohosTouch.p = touchEvent.force;
-
-    SDL_Window *curWindow = GetWindowFromXComponent(component);
-    if (curWindow == nullptr) {
-        SDL_UnlockMutex(g_ohosPageMutex);
+    if (OH_NativeXComponent_GetTouchEvent(component, window, &touchEvent) != OH_NATIVEXCOMPONENT_RESULT_SUCCESS) {
         return;
     }
-    OHOS_OnTouch(curWindow, &ohosTouch);
-    SDL_UnlockMutex(g_ohosPageMutex);
+
+    /* Samples coalesced since the previous move, oldest first */
+    if (touchEvent.type == OH_NATIVEXCOMPONENT_MOVE &&
+        OH_NativeXComponent_GetHistoricalPoints(component, window, &historySize, &history) ==
+        OH_NATIVEXCOMPONENT_RESULT_SUCCESS && history != nullptr) {
+        for (int32_t i = 0; i < historySize && count < OHOS_INPUT_MAX_BATCH; i++) {
+            FillTouchRecord(&records[count++], component, touchEvent.deviceId, history[i].id,
+                            OH_NATIVEXCOMPONENT_MOVE, history[i].x, history[i].y, history[i].force,
+                            history[i].timeStamp);
+        }
+    }
+
+    if (touchEvent.numPoints == 0 || touchEvent.type != OH_NATIVEXCOMPONENT_MOVE) {
+        /* Down, up and cancel only concern the point that changed */
+        if (count < OHOS_INPUT_MAX_BATCH) {
+            FillTouchRecord(&records[count++], component, touchEvent.deviceId, touchEvent.id, touchEvent.type,
+                            touchEvent.x, touchEvent.y, touchEvent.force, touchEvent.timeStamp);
+        }
+    } else {
+        for (uint32_t i = 0; i < touchEvent.numPoints && i < OH_MAX_TOUCH_POINTS_NUMBER &&
+             count < OHOS_INPUT_MAX_BATCH; i++) {
+            const OH_NativeXComponent_TouchPoint *point = &touchEvent.touchPoints[i];
+            FillTouchRecord(&records[count++], component, touchEvent.deviceId, point->id, OH_NATIVEXCOMPONENT_MOVE,
+                            point->x, point->y, point->force, point->timeStamp);
+        }
+    }
+
+    OHOS_StageInput(records, count);
+    SDL_TRACE_COUNTER("OHOS touch records", count);
 }
 
 /* Key */
@@ -227,22 +258,19 @@ void onKeyEvent(OH_NativeXComponent *component, void *window)
 void onNativeMouse(OH_NativeXComponent *component, void *window)
 {
     OH_NativeXComponent_MouseEvent mouseEvent;
-    OHOSWindowSize windowsize;
-    int32_t ret = OH_NativeXComponent_GetMouseEvent(component, window, &mouseEvent);
-    SDL_LockMutex(g_ohosPageMutex);
-    
-    windowsize.action = mouseEvent.action;
-    windowsize.state = mouseEvent.button;
-    windowsize.x = mouseEvent.x;
-    windowsize.y = mouseEvent.y;
-
-    SDL_Window *curWindow = GetWindowFromXComponent(component);
-    if (curWindow == nullptr) {
-        SDL_UnlockMutex(g_ohosPageMutex);
+    OhosInputRecord record;
+    if (OH_NativeXComponent_GetMouseEvent(component, window, &mouseEvent) != OH_NATIVEXCOMPONENT_RESULT_SUCCESS) {
         return;
     }
-    OHOS_OnMouse(curWindow, &windowsize, SDL_TRUE);
-    SDL_UnlockMutex(g_ohosPageMutex);
+
+    record.kind = OHOS_INPUT_MOUSE;
+    record.component = component;
+    record.timestamp = mouseEvent.timestamp;
+    record.data.mouse.action = mouseEvent.action;
+    record.data.mouse.state = mouseEvent.button;
+    record.data.mouse.x = mouseEvent.x;
+    record.data.mouse.y = mouseEvent.y;
+    OHOS_StageInput(&record, 1);
 }
 
 void OnUIInputEventCB(OH_NativeXComponent *component, ArkUI_UIInputEvent *event, ArkUI_UIInputEvent_Type type)
@@ -251,20 +279,13 @@ void OnUIInputEventCB(OH_NativeXComponent *component, ArkUI_UIInputEvent *event,
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "not axis events are not handled.");
         return;
     }
-    double horizontalAxisValue = OH_ArkUI_AxisEvent_GetHorizontalAxisValue(event);
-    double verticalAxisValue = OH_ArkUI_AxisEvent_GetVerticalAxisValue(event);
-    OHOSMouseAxisData mouseAxisData;
-    SDL_LockMutex(g_ohosPageMutex);
-    mouseAxisData.wheelX = horizontalAxisValue;
-    mouseAxisData.wheelY = verticalAxisValue;
-    SDL_Window *curWindow = GetWindowFromXComponent(component);
-    if (curWindow == nullptr) {
-        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Get cur window error");
-        SDL_UnlockMutex(g_ohosPageMutex);
-        return;
-    }
-    OHOS_OnMouseAxis(curWindow, &mouseAxisData);
-    SDL_UnlockMutex(g_ohosPageMutex);
+    OhosInputRecord record;
+    record.kind = OHOS_INPUT_AXIS;
+    record.component = component;
+    record.timestamp = OH_ArkUI_UIInputEvent_GetEventTime(event);
+    record.data.axis.wheelX = OH_ArkUI_AxisEvent_GetHorizontalAxisValue(event);
+    record.data.axis.wheelY = OH_ArkUI_AxisEvent_GetVerticalAxisValue(event);
+    OHOS_StageInput(&record, 1);
 }
 
 void OnHoverEvent(OH_NativeXComponent *component, bool isHover)
@@ -14,67 +14,143 @@
  */
 #include "SDL_ohosfile.h"
 
+#include <sys/mman.h>
+#include <unistd.h>
 #include <rawfile/raw_file_manager.h>
+#include "SDL_hints.h"
+#include "SDL_system.h"
 
-SDL_RWops *gCtx = nullptr;
+/*
+ * Every rawfile RWops keeps its own RawFile, descriptor and position in
+ * ctx->hidden.ohosio, so any number of assets can be open and read from
+ * different threads at once. Only the resource manager itself is shared.
+ */
+void *g_nativeResourceManager = nullptr;
 char *g_path = nullptr;
 
 const char *SDL_OHOSGetInternalStoragePath(void) { return g_path; }
 
+/* Maps the asset's range of the package read-only, reads and seeks then never touch the resource manager. */
+static void OHOS_FileMap(SDL_RWops *ctx, const RawFileDescriptor *descriptor)
+{
+    long pageSize = sysconf(_SC_PAGESIZE);
+    long delta;
+    void *address;
+
+    if (!SDL_GetHintBoolean(SDL_HINT_OHOS_RAWFILE_MMAP, SDL_TRUE) || descriptor->fd < 0 ||
+        descriptor->length <= 0 || pageSize <= 0) {
+        return;
+    }
+    delta = descriptor->start % pageSize;
+    address = mmap(nullptr, (size_t)(descriptor->length + delta), PROT_READ, MAP_PRIVATE, descriptor->fd,
+                   (off_t)(descriptor->start - delta));
+    if (address == MAP_FAILED) {
+        return;
+    }
+    ctx->hidden.ohosio.mapAddress = address;
+    ctx->hidden.ohosio.mapLength = (size_t)(descriptor->length + delta);
+    ctx->hidden.ohosio.mapData = static_cast<const Uint8 *>(address) + delta;
+    ctx->hidden.ohosio.size = descriptor->length;
+    ctx->hidden.ohosio.offset = 0;
+}
+
+const void *SDL_OHOSGetRWopsData(SDL_RWops *context, Sint64 *size)
+{
+    const void *data = nullptr;
+    Sint64 length = 0;
+
+    if (context == nullptr) {
+        SDL_InvalidParamError("context");
+    } else if (context->type == SDL_RWOPS_OHOSFILE && context->hidden.ohosio.mapData != nullptr) {
+        data = context->hidden.ohosio.mapData;
+        length = context->hidden.ohosio.size;
+    } else if (context->type == SDL_RWOPS_MEMORY || context->type == SDL_RWOPS_MEMORY_RO) {
+        data = context->hidden.mem.base;
+        length = context->hidden.mem.stop - context->hidden.mem.base;
+    } else {
+        SDL_SetError("RWops is not memory backed");
+    }
+    if (size != nullptr) {
+        *size = length;
+    }
+    return data;
+}
+
 int OHOS_FileOpen(SDL_RWops *ctx, const char *fileName, const char *mode)
 {
-    gCtx->hidden.ohosio.fileName = (char *)fileName;
-    gCtx->hidden.ohosio.mode = (char *)mode;
-    gCtx->hidden.ohosio.position = 0;
+    ctx->hidden.ohosio.nativeResourceManager = g_nativeResourceManager;
+    ctx->hidden.ohosio.fileNameRef = nullptr;
+    ctx->hidden.ohosio.fileDescriptorRef = nullptr;
+    ctx->hidden.ohosio.fileName = SDL_strdup(fileName);
+    ctx->hidden.ohosio.mode = SDL_strdup(mode);
+    ctx->hidden.ohosio.position = 0;
+    ctx->hidden.ohosio.fd = -1;
+    ctx->hidden.ohosio.mapAddress = nullptr;
+    ctx->hidden.ohosio.mapLength = 0;
+    ctx->hidden.ohosio.mapData = nullptr;
 
     NativeResourceManager *nativeResourceManager =
-        static_cast<NativeResourceManager *>(gCtx->hidden.ohosio.nativeResourceManager);
-    RawFile *rawFile = OH_ResourceManager_OpenRawFile(nativeResourceManager, fileName);
+        static_cast<NativeResourceManager *>(ctx->hidden.ohosio.nativeResourceManager);
+    RawFile *rawFile = nativeResourceManager ? OH_ResourceManager_OpenRawFile(nativeResourceManager, fileName) :
+        nullptr;
 
     if (!rawFile) {
-        return -1;
+        SDL_free(ctx->hidden.ohosio.fileName);
+        SDL_free(ctx->hidden.ohosio.mode);
+        ctx->hidden.ohosio.fileName = nullptr;
+        ctx->hidden.ohosio.mode = nullptr;
+        return SDL_SetError("Couldn't open rawfile %s", fileName);
     }
 
-    gCtx->hidden.ohosio.fileNameRef = rawFile;
+    ctx->hidden.ohosio.fileNameRef = rawFile;
 
     long rawFileSize = OH_ResourceManager_GetRawFileSize(rawFile);
-    gCtx->hidden.ohosio.size = rawFileSize;
+    ctx->hidden.ohosio.size = rawFileSize;
 
-    RawFileDescriptor descriptor;
-    bool result = OH_ResourceManager_GetRawFileDescriptor(rawFile, descriptor);
-    gCtx->hidden.ohosio.fd = descriptor.fd;
-    gCtx->hidden.ohosio.fileDescriptorRef = static_cast<void *>(&descriptor);
+    RawFileDescriptor *descriptor = new RawFileDescriptor();
+    if (OH_ResourceManager_GetRawFileDescriptor(rawFile, *descriptor)) {
+        ctx->hidden.ohosio.fd = descriptor->fd;
+        ctx->hidden.ohosio.fileDescriptorRef = static_cast<void *>(descriptor);
+    } else {
+        delete descriptor;
+    }
 
     long rawFileOffset = OH_ResourceManager_GetRawFileOffset(rawFile);
-    gCtx->hidden.ohosio.offset = rawFileOffset;
-    ctx = gCtx;
+    ctx->hidden.ohosio.offset = rawFileOffset;
+
+    if (ctx->hidden.ohosio.fileDescriptorRef != nullptr) {
+        OHOS_FileMap(ctx, descriptor);
+        if (ctx->hidden.ohosio.mapData != nullptr) {
+            return 0;
+        }
+    }
 
     /* Seek to the correct offset in the file. */
-    int position = OH_ResourceManager_SeekRawFile(rawFile, gCtx->hidden.ohosio.offset, SEEK_SET);
+    OH_ResourceManager_SeekRawFile(rawFile, ctx->hidden.ohosio.offset, SEEK_SET);
 
     return 0;
 }
 
-Sint64 OHOS_FileSize(SDL_RWops *ctx) { return gCtx->hidden.ohosio.size; }
+Sint64 OHOS_FileSize(SDL_RWops *ctx) { return ctx->hidden.ohosio.size; }
 
-size_t OHOS_FileSeekInlineSwitch(Sint64 *offset, int whence)
+size_t OHOS_FileSeekInlineSwitch(SDL_RWops *ctx, Sint64 *offset, int whence)
 {
     switch (whence) {
         case RW_SEEK_SET:
-            if (gCtx->hidden.ohosio.size != -1 && *offset > gCtx->hidden.ohosio.size) {
-                *offset = gCtx->hidden.ohosio.size;
+            if (ctx->hidden.ohosio.size != -1 && *offset > ctx->hidden.ohosio.size) {
+                *offset = ctx->hidden.ohosio.size;
             }
-            *offset += gCtx->hidden.ohosio.offset;
+            *offset += ctx->hidden.ohosio.offset;
             break;
         case RW_SEEK_CUR:
-            *offset += gCtx->hidden.ohosio.position;
-            if (gCtx->hidden.ohosio.size != -1 && *offset > gCtx->hidden.ohosio.size) {
-                *offset = gCtx->hidden.ohosio.size;
+            *offset += ctx->hidden.ohosio.position;
+            if (ctx->hidden.ohosio.size != -1 && *offset > ctx->hidden.ohosio.size) {
+                *offset = ctx->hidden.ohosio.size;
             }
-            *offset += gCtx->hidden.ohosio.offset;
+            *offset += ctx->hidden.ohosio.offset;
             break;
         case RW_SEEK_END:
-            *offset = gCtx->hidden.ohosio.offset + gCtx->hidden.ohosio.size + *offset;
+            *offset = ctx->hidden.ohosio.offset + ctx->hidden.ohosio.size + *offset;
             break;
         default:
             return -1;
@@ -82,17 +158,17 @@ size_t OHOS_FileSeekInlineSwitch(Sint64 *offset, int whence)
     return 0;
 }
 
-size_t OHOS_FileSeekInlineSwitchPos(Sint64 *offset, Sint64 *newPosition, int whence)
+size_t OHOS_FileSeekInlineSwitchPos(SDL_RWops *ctx, Sint64 *offset, Sint64 *newPosition, int whence)
 {
     switch (whence) {
         case RW_SEEK_SET:
             *newPosition = *offset;
             break;
         case RW_SEEK_CUR:
-            *newPosition = gCtx->hidden.ohosio.position + *offset;
+            *newPosition = ctx->hidden.ohosio.position + *offset;
             break;
         case RW_SEEK_END:
-            *newPosition = gCtx->hidden.ohosio.size + *offset;
+            *newPosition = ctx->hidden.ohosio.size + *offset;
             break;
         default:
             return -1;
@@ -102,12 +178,21 @@ size_t OHOS_FileSeekInlineSwitchPos(Sint64 *offset, Sint64 *newPosition, int whe
 
 Sint64 OHOS_FileSeek(SDL_RWops *ctx, Sint64 offset, int whence)
 {
-    if (gCtx->hidden.ohosio.nativeResourceManager) {
-        size_t result = OHOS_FileSeekInlineSwitch(&offset, whence);
+    if (ctx->hidden.ohosio.mapData) {
+        Sint64 newPosition;
+        if (OHOS_FileSeekInlineSwitchPos(ctx, &offset, &newPosition, whence) == -1) {
+            return SDL_SetError("Unknown value for 'whence'");
+        }
+        if (newPosition < 0) {
+            return SDL_Error(SDL_EFSEEK);
+        }
+        ctx->hidden.ohosio.position = (long)SDL_min(newPosition, (Sint64)ctx->hidden.ohosio.size);
+    } else if (ctx->hidden.ohosio.nativeResourceManager) {
+        size_t result = OHOS_FileSeekInlineSwitch(ctx, &offset, whence);
         if (result == -1) {
             return SDL_SetError("Unknown value for 'whence'");
         }
-        RawFile *rawFile = static_cast<RawFile *>(gCtx->hidden.ohosio.fileNameRef);
+        RawFile *rawFile = static_cast<RawFile *>(ctx->hidden.ohosio.fileNameRef);
         int ret = OH_ResourceManager_SeekRawFile(rawFile, offset, SEEK_SET);
         if (ret == -1) {
             return -1;
@@ -115,11 +200,11 @@ Sint64 OHOS_FileSeek(SDL_RWops *ctx, Sint64 offset, int whence)
         if (ret == 0) {
             ret = offset;
         }
-        gCtx->hidden.ohosio.position = ret - gCtx->hidden.ohosio.offset;
+        ctx->hidden.ohosio.position = ret - ctx->hidden.ohosio.offset;
     } else {
         Sint64 newPosition;
         Sint64 movement;
-        size_t result = OHOS_FileSeekInlineSwitchPos(&offset, &newPosition, whence);
+        size_t result = OHOS_FileSeekInlineSwitchPos(ctx, &offset, &newPosition, whence);
         if (result == -1) {
             return SDL_SetError("Unknown value for 'whence'");
         }
@@ -127,27 +212,33 @@ Sint64 OHOS_FileSeek(SDL_RWops *ctx, Sint64 offset, int whence)
         if (newPosition < 0) {
             return SDL_Error(SDL_EFSEEK);
         }
-        if (newPosition > gCtx->hidden.ohosio.size) {
-            newPosition = gCtx->hidden.ohosio.size;
+        if (newPosition > ctx->hidden.ohosio.size) {
+            newPosition = ctx->hidden.ohosio.size;
         }
-        movement = newPosition - gCtx->hidden.ohosio.position;
+        movement = newPosition - ctx->hidden.ohosio.position;
         if (movement > 0) {
-            size_t result = OHOS_FileSeekInline(&movement);
+            size_t result = OHOS_FileSeekInline(ctx, &movement);
             if (result == -1) {
                 return -1;
             }
         } else if (movement < 0) {
             /* We can't seek backwards so we have to reopen the file and seek */
             /* forwards which obviously isn't very efficient */
+            char *fileName = ctx->hidden.ohosio.fileName;
+            char *mode = ctx->hidden.ohosio.mode;
+            ctx->hidden.ohosio.fileName = nullptr;
+            ctx->hidden.ohosio.mode = nullptr;
             OHOS_FileClose(ctx, SDL_FALSE);
-            OHOS_FileOpen(ctx, gCtx->hidden.ohosio.fileName, gCtx->hidden.ohosio.mode);
+            OHOS_FileOpen(ctx, fileName, mode);
+            SDL_free(fileName);
+            SDL_free(mode);
             OHOS_FileSeek(ctx, newPosition, RW_SEEK_SET);
         }
     }
-    return gCtx->hidden.ohosio.position;
+    return ctx->hidden.ohosio.position;
 }
 
-size_t OHOS_FileSeekInline(Sint64 *movement)
+size_t OHOS_FileSeekInline(SDL_RWops *ctx, Sint64 *movement)
 {
     unsigned char buffer[4096];
 
@@ -158,7 +249,7 @@ size_t OHOS_FileSeekInline(Sint64 *movement)
         if (amount > *movement) {
             amount = *movement;
         }
-        result = OHOS_FileRead(gCtx, buffer, 1, (size_t)amount);
+        result = OHOS_FileRead(ctx, buffer, 1, (size_t)amount);
         if (result <= 0) {
             /* Failed to read/skip the required amount, so fail */
             return -1;
@@ -170,17 +261,27 @@ size_t OHOS_FileSeekInline(Sint64 *movement)
 
 size_t OHOS_FileRead(SDL_RWops *ctx, void *buffer, size_t size, size_t maxnum)
 {
-    if (gCtx->hidden.ohosio.nativeResourceManager) {
+    if (ctx->hidden.ohosio.mapData) {
+        size_t avail = (size_t)(ctx->hidden.ohosio.size - ctx->hidden.ohosio.position);
+        size_t num;
+        if (size == 0) {
+            return 0;
+        }
+        num = SDL_min(maxnum, avail / size);
+        SDL_memcpy(buffer, ctx->hidden.ohosio.mapData + ctx->hidden.ohosio.position, num * size);
+        ctx->hidden.ohosio.position += (long)(num * size);
+        return num;
+    } else if (ctx->hidden.ohosio.nativeResourceManager) {
         size_t bytesMax = size * maxnum;
         size_t result;
-        if (gCtx->hidden.ohosio.size != -1 &&
-            gCtx->hidden.ohosio.position + bytesMax > gCtx->hidden.ohosio.size) {
-            bytesMax = gCtx->hidden.ohosio.size - gCtx->hidden.ohosio.position;
+        if (ctx->hidden.ohosio.size != -1 &&
+            ctx->hidden.ohosio.position + bytesMax > ctx->hidden.ohosio.size) {
+            bytesMax = ctx->hidden.ohosio.size - ctx->hidden.ohosio.position;
         }
-        RawFile *rawFile = static_cast<RawFile *>(gCtx->hidden.ohosio.fileNameRef);
+        RawFile *rawFile = static_cast<RawFile *>(ctx->hidden.ohosio.fileNameRef);
         result = OH_ResourceManager_ReadRawFile(rawFile, buffer, bytesMax);
         if (result > 0  && size != 0) {
-            gCtx->hidden.ohosio.position += result;
+            ctx->hidden.ohosio.position += result;
             return result / size;
         } else {
             return -1;
@@ -188,24 +289,24 @@ size_t OHOS_FileRead(SDL_RWops *ctx, void *buffer, size_t size, size_t maxnum)
         return 0;
     } else {
         long bytesRemaining = size * maxnum;
-        long bytesMax = gCtx->hidden.ohosio.size - gCtx->hidden.ohosio.position;
+        long bytesMax = ctx->hidden.ohosio.size - ctx->hidden.ohosio.position;
         int bytesRead = 0;
 
         /* Don't read more bytes than those that remain in the file, otherwise we get an exception */
         if (bytesRemaining > bytesMax) {
             bytesRemaining = bytesMax;
         }
-        unsigned char byteBuffer[bytesRemaining];
+        unsigned char *byteBuffer = static_cast<unsigned char *>(buffer);
         while (bytesRemaining > 0) {
-            RawFile *rawFile = static_cast<RawFile *>(gCtx->hidden.ohosio.fileNameRef);
-            int result = OH_ResourceManager_ReadRawFile(rawFile, byteBuffer, bytesRemaining);
-            if (result < 0) {
+            RawFile *rawFile = static_cast<RawFile *>(ctx->hidden.ohosio.fileNameRef);
+            int result = OH_ResourceManager_ReadRawFile(rawFile, byteBuffer + bytesRead, bytesRemaining);
+            if (result <= 0) {
                 break;
             }
 
             bytesRemaining -= result;
             bytesRead += result;
-            gCtx->hidden.ohosio.position += result;
+            ctx->hidden.ohosio.position += result;
         }
         if (size != 0) {
             return bytesRead / size;
@@ -226,7 +327,11 @@ int OHOS_FileClose(SDL_RWops *ctx, SDL_bool release)
     int result = 0;
 
     if (ctx) {
-        OHOS_CloseResourceManager();
+        OHOS_CloseResourceManager(ctx);
+        SDL_free(ctx->hidden.ohosio.fileName);
+        SDL_free(ctx->hidden.ohosio.mode);
+        ctx->hidden.ohosio.fileName = nullptr;
+        ctx->hidden.ohosio.mode = nullptr;
 
         if (release) {
             SDL_FreeRW(ctx);
@@ -236,15 +341,26 @@ int OHOS_FileClose(SDL_RWops *ctx, SDL_bool release)
     return result;
 }
 
-void OHOS_CloseResourceManager(void)
+void OHOS_CloseResourceManager(SDL_RWops *ctx)
 {
-    RawFile *rawFile = static_cast<RawFile *>(gCtx->hidden.ohosio.fileNameRef);
-    if (rawFile) {
-        OH_ResourceManager_CloseRawFile(rawFile);
+    if (ctx->hidden.ohosio.mapAddress) {
+        munmap(ctx->hidden.ohosio.mapAddress, ctx->hidden.ohosio.mapLength);
+        ctx->hidden.ohosio.mapAddress = nullptr;
+        ctx->hidden.ohosio.mapLength = 0;
+        ctx->hidden.ohosio.mapData = nullptr;
     }
 
-    RawFileDescriptor *descriptor = static_cast<RawFileDescriptor *>(gCtx->hidden.ohosio.fileDescriptorRef);
+    RawFileDescriptor *descriptor = static_cast<RawFileDescriptor *>(ctx->hidden.ohosio.fileDescriptorRef);
     if (descriptor) {
         OH_ResourceManager_ReleaseRawFileDescriptor(*descriptor);
+        delete descriptor;
+        ctx->hidden.ohosio.fileDescriptorRef = nullptr;
+        ctx->hidden.ohosio.fd = -1;
+    }
+
+    RawFile *rawFile = static_cast<RawFile *>(ctx->hidden.ohosio.fileNameRef);
+    if (rawFile) {
+        OH_ResourceManager_CloseRawFile(rawFile);
+        ctx->hidden.ohosio.fileNameRef = nullptr;
     }
 }
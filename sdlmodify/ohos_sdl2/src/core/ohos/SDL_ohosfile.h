@@ -30,13 +30,14 @@ Sint64 OHOS_FileSeek(SDL_RWops *ctx, Sint64 offset, int whence);
 size_t OHOS_FileRead(SDL_RWops *ctx, void *buffer, size_t size, size_t maxnum);
 size_t OHOS_FileWrite(SDL_RWops *ctx, const void *buffer, size_t size, size_t num);
 int OHOS_FileClose(SDL_RWops *ctx, SDL_bool release);
-size_t OHOS_FileSeekInline(Sint64 *movement);
-size_t OHOS_FileSeekInlineSwitch(Sint64 *offset, int whence);
-size_t OHOS_FileSeekInlineSwitchPos(Sint64 *offset, Sint64 *newPosition, int whence);
+size_t OHOS_FileSeekInline(SDL_RWops *ctx, Sint64 *movement);
+size_t OHOS_FileSeekInlineSwitch(SDL_RWops *ctx, Sint64 *offset, int whence);
+size_t OHOS_FileSeekInlineSwitchPos(SDL_RWops *ctx, Sint64 *offset, Sint64 *newPosition, int whence);
 
-extern SDL_RWops *gCtx;
+/* NativeResourceManager shared by every rawfile RWops, set once from ArkTS. */
+extern void *g_nativeResourceManager;
 extern char *g_path;
-void OHOS_CloseResourceManager(void);
+void OHOS_CloseResourceManager(SDL_RWops *ctx);
 void OHOS_NAPI_GetResourceManager(SDL_RWops *ctx, const char *fileName);
 
 /* Ends C function definitions when using C++ */
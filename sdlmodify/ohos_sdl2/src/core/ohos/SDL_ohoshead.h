@@ -16,7 +16,9 @@
 #ifndef SDL_OHOSHEAD_H
 #define SDL_OHOSHEAD_H
 
+#include "SDL_atomic.h"
 #include "SDL_mutex.h"
+#include "SDL_system.h"
 #include "../src/video/SDL_egl_c.h"
 #include <native_window/external_window.h>
 
@@ -29,6 +31,13 @@ typedef struct {
     uint64_t height;
     double x;
     double y;
+    SDL_mutex *surfaceLock; /* Held while the EGL surface is in use, so it can't be destroyed under a swap */
+    SDL_SpinLock statsLock;
+    Uint64 lastPresent;
+    Uint64 pendingInput;    /* Performance counter of the oldest input not presented yet */
+    Uint64 frameTicks;
+    Uint64 inputTicks;
+    SDL_OHOSWindowFrameStats stats;
 } SDL_WindowData;
 
 #endif
\ No newline at end of file
@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2023 Huawei Device Co., Ltd.
+ * Licensed under the Apache License,Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../SDL_internal.h"
+
+#ifdef __OHOS__
+
+#include "SDL_atomic.h"
+#include "SDL_log.h"
+#include "SDL_timer.h"
+#include "SDL_ohosinput.h"
+#include "SDL_ohos_xcomponent.h"
+#include "../../video/ohos/SDL_ohoswindow.h"
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "../../events/SDL_events_c.h"
+#ifdef __cplusplus
+}
+#endif
+
+/* Single producer (the ArkUI thread, which runs every XComponent callback)
+ * and single consumer (the thread pumping SDL events). head and tail are
+ * free running; a slot is only reused once the consumer has moved past it. */
+#define OHOS_INPUT_RING_SIZE 4096
+#define OHOS_INPUT_RING_MASK (OHOS_INPUT_RING_SIZE - 1)
+
+static OhosInputRecord g_inputRing[OHOS_INPUT_RING_SIZE];
+static SDL_atomic_t g_inputHead;
+static SDL_atomic_t g_inputTail;
+static SDL_atomic_t g_inputDropped;
+
+SDL_bool OHOS_StageInput(const OhosInputRecord *records, int count)
+{
+    Uint32 head;
+    Uint32 tail;
+    Uint64 now;
+    int i;
+
+    if (records == NULL || count <= 0) {
+        return SDL_TRUE;
+    }
+
+    head = (Uint32)SDL_AtomicGet(&g_inputHead);
+    tail = (Uint32)SDL_AtomicGet(&g_inputTail);
+    if (head - tail + (Uint32)count > OHOS_INPUT_RING_SIZE) {
+        SDL_AtomicAdd(&g_inputDropped, count);
+        return SDL_FALSE;
+    }
+
+    now = SDL_GetPerformanceCounter();
+    for (i = 0; i < count; i++) {
+        OhosInputRecord *slot = &g_inputRing[(head + i) & OHOS_INPUT_RING_MASK];
+        *slot = records[i];
+        slot->stagedAt = now;
+    }
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&g_inputHead, (int)(head + count));
+    /* Let an SDL_WaitEvent() caller pump this right away */
+    SDL_WakeEventWaiters();
+    return SDL_TRUE;
+}
+
+int OHOS_PumpInput(void)
+{
+    Uint32 head;
+    Uint32 tail;
+    int dropped;
+    void *lastComponent = NULL;
+    SDL_Window *window = NULL;
+
+    tail = (Uint32)SDL_AtomicGet(&g_inputTail);
+    head = (Uint32)SDL_AtomicGet(&g_inputHead);
+    SDL_MemoryBarrierAcquire();
+    if (head == tail) {
+        return 0;
+    }
+
+    dropped = SDL_AtomicSet(&g_inputDropped, 0);
+    if (dropped > 0) {
+        SDL_Log("Input ring full, dropped %d staged records.", dropped);
+    }
+
+    for (Uint32 pos = tail; pos != head; pos++) {
+        OhosInputRecord *record = &g_inputRing[pos & OHOS_INPUT_RING_MASK];
+
+        /* A batch nearly always targets one XComponent, look its window up once */
+        if (record->component != lastComponent) {
+            lastComponent = record->component;
+            window = GetWindowFromXComponent((OH_NativeXComponent *)record->component);
+            /* Records are in staging order, so this is the oldest input of the run */
+            OHOS_NoteWindowInput(window, record->stagedAt);
+        }
+        if (window == NULL) {
+            continue;
+        }
+
+        switch (record->kind) {
+            case OHOS_INPUT_TOUCH:
+                OHOS_OnTouch(window, &record->data.touch);
+                break;
+            case OHOS_INPUT_MOUSE:
+                OHOS_OnMouse(window, &record->data.mouse, SDL_TRUE);
+                break;
+            case OHOS_INPUT_AXIS:
+                OHOS_OnMouseAxis(window, &record->data.axis);
+                break;
+            default:
+                break;
+        }
+    }
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&g_inputTail, (int)head);
+    return (int)(head - tail);
+}
+
+void OHOS_FlushInput(void)
+{
+    SDL_AtomicSet(&g_inputTail, SDL_AtomicGet(&g_inputHead));
+}
+
+#endif /* __OHOS__ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2023 Huawei Device Co., Ltd.
+ * Licensed under the Apache License,Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SDL_OHOSINPUT_H
+#define SDL_OHOSINPUT_H
+
+#include "SDL_stdinc.h"
+#include "../../video/ohos/SDL_ohostouch.h"
+#include "../../video/ohos/SDL_ohosmouse.h"
+
+#ifdef __cplusplus
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/* Input staged by the XComponent callbacks on the UI thread and turned
+ * into SDL events by OHOS_PumpInput() on the SDL thread. */
+typedef enum {
+    OHOS_INPUT_TOUCH,
+    OHOS_INPUT_MOUSE,
+    OHOS_INPUT_AXIS
+} OhosInputKind;
+
+typedef struct OhosInputRecord {
+    OhosInputKind kind;
+    void *component;        /* OH_NativeXComponent the input was delivered to */
+    Sint64 timestamp;       /* nanoseconds, as reported by the XComponent */
+    Uint64 stagedAt;        /* performance counter when the batch was staged, set by OHOS_StageInput */
+    union {
+        OhosTouchId touch;
+        OHOSWindowSize mouse;
+        OHOSMouseAxisData axis;
+    } data;
+} OhosInputRecord;
+
+/* Largest number of records one XComponent callback stages at once */
+#define OHOS_INPUT_MAX_BATCH 64
+
+/* UI thread: publish count records as one batch. Never blocks; if the
+ * ring has no room the whole batch is dropped and SDL_FALSE returned. */
+extern SDL_bool OHOS_StageInput(const OhosInputRecord *records, int count);
+
+/* SDL thread: deliver everything staged so far, returns the record count. */
+extern int OHOS_PumpInput(void);
+
+/* SDL thread: throw away staged input, e.g. when video is shut down. */
+extern void OHOS_FlushInput(void);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif /* SDL_OHOSINPUT_H */
+
+/* vi: set ts=4 sw=4 expandtab: */
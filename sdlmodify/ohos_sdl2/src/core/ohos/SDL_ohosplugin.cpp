@@ -20,6 +20,7 @@
 #include <ace/xcomponent/native_interface_xcomponent.h>
 
 #include "SDL_log.h"
+#include "SDL_timer.h"
 #include "SDL_ohosplugin.h"
 
 OhosPluginManager OhosPluginManager::pluginManager;
@@ -33,6 +34,10 @@ OhosPluginManager::~OhosPluginManager()
         }
     }
     nativeXComponentMap.clear();
+    if (registrationCond != nullptr) {
+        SDL_DestroyCond(registrationCond);
+        registrationCond = nullptr;
+    }
 }
 
 void OhosPluginManager::SetNativeXComponent(std::string &id, OH_NativeXComponent *nativeXComponent)
@@ -42,6 +47,7 @@ void OhosPluginManager::SetNativeXComponent(std::string &id, OH_NativeXComponent
     }
 
     nativeXComponentMap[id] = nativeXComponent;
+    NotifyRegistration();
 }
 
 void OhosPluginManager::AddXcomPomentIdForThread(std::string &xCompentId, pthread_t threadId)
@@ -88,6 +94,7 @@ void OhosPluginManager::SetNativeXComponentList(OH_NativeXComponent *component,
     }
     if (nativeXComponentList.find(component) == nativeXComponentList.end()) {
         nativeXComponentList[component] = data;
+        NotifyRegistration();
         return;
     }
 
@@ -101,6 +108,38 @@ void OhosPluginManager::SetNativeXComponentList(OH_NativeXComponent *component,
     }
 }
 
+void OhosPluginManager::NotifyRegistration()
+{
+    if (registrationCond != nullptr) {
+        SDL_CondBroadcast(registrationCond);
+    }
+}
+
+bool OhosPluginManager::WaitNativeWindow(std::string &id, Uint32 timeoutMs, OH_NativeXComponent **nativeXComponent,
+                                         SDL_WindowData **window)
+{
+    Uint32 deadline = SDL_GetTicks() + timeoutMs;
+    OH_NativeXComponent *component = nullptr;
+    SDL_WindowData *data = nullptr;
+
+    while (!FindNativeXcomPoment(id, &component) || !FindNativeWindow(component, &data)) {
+        Uint32 now = SDL_GetTicks();
+        if (SDL_TICKS_PASSED(now, deadline)) {
+            return false;
+        }
+        if (registrationCond == nullptr) {
+            registrationCond = SDL_CreateCond();
+            if (registrationCond == nullptr) {
+                return false;
+            }
+        }
+        SDL_CondWaitTimeout(registrationCond, g_ohosPageMutex, deadline - now);
+    }
+    *nativeXComponent = component;
+    *window = data;
+    return true;
+}
+
 SDL_WindowData* OhosPluginManager::GetWindowDataByXComponent(OH_NativeXComponent *component)
 {
     if (nullptr == component) {
@@ -44,11 +44,17 @@ public:
 
     SDL_WindowData* GetWindowDataByXComponent(OH_NativeXComponent *component);
 
+    /* Both must be called with g_ohosPageMutex held; waiting releases it until a registration arrives. */
+    void NotifyRegistration();
+    bool WaitNativeWindow(std::string &id, Uint32 timeoutMs, OH_NativeXComponent **nativeXComponent,
+                          SDL_WindowData **window);
+
 private:
     static OhosPluginManager pluginManager;
 
     std::unordered_map<std::string, OH_NativeXComponent *> nativeXComponentMap;
     std::unordered_map<pthread_t, std::vector<std::string>> threadXcompentList;
     std::unordered_map<OH_NativeXComponent *, SDL_WindowData *> nativeXComponentList;
+    SDL_cond *registrationCond = nullptr;
 };
 #endif // SDL_OHOSPLUGIN_H
@@ -48,6 +48,23 @@ bool OHOS_FindNativeWindow(OH_NativeXComponent *nativeXComponent, SDL_WindowData
     return isFind;
 }
 
+bool OHOS_WaitNativeWindow(char *id, Uint32 timeoutMs, OH_NativeXComponent **nativeXComponent,
+                           SDL_WindowData **window)
+{
+    if (id == NULL) {
+        return false;
+    }
+    std::string strId(id);
+    SDL_LockMutex(g_ohosPageMutex);
+    OH_NativeXComponent *tempComponent = nullptr;
+    SDL_WindowData *tempWindow = nullptr;
+    bool isFind = OhosPluginManager::GetInstance()->WaitNativeWindow(strId, timeoutMs, &tempComponent, &tempWindow);
+    *nativeXComponent = tempComponent;
+    *window = tempWindow;
+    SDL_UnlockMutex(g_ohosPageMutex);
+    return isFind;
+}
+
 void OHOS_ClearPluginData(char *xcompentId)
 {
     std::string strId(xcompentId);
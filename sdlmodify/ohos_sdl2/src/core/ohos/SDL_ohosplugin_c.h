@@ -29,6 +29,10 @@ bool OHOS_FindNativeXcomPoment(char *id, OH_NativeXComponent **nativeXComponent)
 
 bool OHOS_FindNativeWindow(OH_NativeXComponent *nativeXComponent, SDL_WindowData **window);
 
+/* Blocks until the xcomponent and its surface are registered for id, or timeoutMs elapses. */
+bool OHOS_WaitNativeWindow(char *id, Uint32 timeoutMs, OH_NativeXComponent **nativeXComponent,
+                           SDL_WindowData **window);
+
 void OHOS_AddXcomPomentIdForThread(char *xCompentId, pthread_t threadId);
 
 void OHOS_ClearPluginData(char *xcompentId);
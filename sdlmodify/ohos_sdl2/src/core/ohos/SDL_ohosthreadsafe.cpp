@@ -20,9 +20,10 @@
 #include <unordered_map>
 #include <set>
 #include "adapter_c/SDL_AdapterC.h"
-#include "cJSON.h"
+#include "SDL_ohostscommand.h"
 extern "C" {
 #include "../../thread/SDL_systhread.h"
+#include "../../SDL_trace_c.h"
 }
 #include <multimedia/image_framework/image_mdk_common.h>
 #include <multimedia/image_framework/image_pixel_map_mdk.h>
@@ -44,26 +45,27 @@ std::unique_ptr<NapiCallbackContext> g_napiCallback = nullptr;
 static int g_threadName = 0;
 static std::set<SDL_Thread *> gSdlMainThreadList;
 
-typedef void (*OHOS_TS_Fuction)(const cJSON *root);
-
-static void OHOS_TS_ShowTextInput(const cJSON *root);
-static void OHOS_TS_RequestPermission(const cJSON *root);
-static void OHOS_TS_AddChildNode(const cJSON *root);
-static void OHOS_TS_RemoveChildNode(const cJSON *root);
-static void OHOS_TS_ResizeNode(const cJSON *root);
-static void OHOS_TS_MoveNode(const cJSON *root);
-static void OHOS_TS_ShowNode(const cJSON *root);
-static void OHOS_TS_HideNode(const cJSON *root);
-static void OHOS_TS_RaiseNode(const cJSON *root);
-static void OHOS_TS_HideTextInput(const cJSON *root);
-static void OHOS_TS_ShouldMinimizeOnFocusLoss(const cJSON *root);
-static void OHOS_TS_SetTitle(const cJSON *root);
-static void OHOS_TS_SetWindowStyle(const cJSON *root);
-static void OHOS_TS_ShowTextInputKeyboard(const cJSON *root);
-static void OHOS_TS_SetOrientation(const cJSON *root);
-static void OHOS_TS_CreateCustomCursor(const cJSON *root);
-static void OHOS_SetSystemCursor(const cJSON *root);
-static void OHOS_TS_SetWindowResize(const cJSON *root);
+typedef void (*OHOS_TS_Fuction)(const OhosTSCommand *command);
+
+static void OHOS_TS_ShowTextInput(const OhosTSCommand *command);
+static void OHOS_TS_RequestPermission(const OhosTSCommand *command);
+static void OHOS_TS_AddChildNode(const OhosTSCommand *command);
+static void OHOS_TS_RemoveChildNode(const OhosTSCommand *command);
+static void OHOS_TS_ResizeNode(const OhosTSCommand *command);
+static void OHOS_TS_MoveNode(const OhosTSCommand *command);
+static void OHOS_TS_ShowNode(const OhosTSCommand *command);
+static void OHOS_TS_HideNode(const OhosTSCommand *command);
+static void OHOS_TS_RaiseNode(const OhosTSCommand *command);
+static void OHOS_TS_ApplyNodeState(const OhosTSCommand *command);
+static void OHOS_TS_HideTextInput(const OhosTSCommand *command);
+static void OHOS_TS_ShouldMinimizeOnFocusLoss(const OhosTSCommand *command);
+static void OHOS_TS_SetTitle(const OhosTSCommand *command);
+static void OHOS_TS_SetWindowStyle(const OhosTSCommand *command);
+static void OHOS_TS_ShowTextInputKeyboard(const OhosTSCommand *command);
+static void OHOS_TS_SetOrientation(const OhosTSCommand *command);
+static void OHOS_TS_CreateCustomCursor(const OhosTSCommand *command);
+static void OHOS_SetSystemCursor(const OhosTSCommand *command);
+static void OHOS_TS_SetWindowResize(const OhosTSCommand *command);
 
 static std::unordered_map<NapiCallBackType, OHOS_TS_Fuction> tsFuctions = {
     {NAPI_CALLBACK_SET_SYSTEMCURSOR, OHOS_SetSystemCursor},
@@ -83,32 +85,18 @@ static std::unordered_map<NapiCallBackType, OHOS_TS_Fuction> tsFuctions = {
     {NAPI_CALLBACK_MOVE_NODE, OHOS_TS_MoveNode},
     {NAPI_CALLBACK_SHOW_NODE, OHOS_TS_ShowNode},
     {NAPI_CALLBACK_HIDE_NODE, OHOS_TS_HideNode},
-    {NAPI_CALLBACK_RAISE_NODE, OHOS_TS_RaiseNode}
+    {NAPI_CALLBACK_RAISE_NODE, OHOS_TS_RaiseNode},
+    {NAPI_CALLBACK_APPLY_NODE_STATE, OHOS_TS_ApplyNodeState}
 };
 
-static void OHOS_TS_SetWindowResize(const cJSON *root)
+static void OHOS_TS_SetWindowResize(const OhosTSCommand *command)
 {
-    int x;
-    int y;
-    int w;
-    int h;
-    cJSON *data = cJSON_GetObjectItem(root, "x");
-    x = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "y");
-    y = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "w");
-    w = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "h");
-    h = data->valueint;
     napi_value argv[OHOS_THREADSAFE_ARG4] = {nullptr};
 
-    napi_create_int32(g_napiCallback->env, x, &argv[OHOS_THREADSAFE_ARG0]);
-    napi_create_int32(g_napiCallback->env, y, &argv[OHOS_THREADSAFE_ARG1]);
-    napi_create_int32(g_napiCallback->env, w, &argv[OHOS_THREADSAFE_ARG2]);
-    napi_create_int32(g_napiCallback->env, h, &argv[OHOS_THREADSAFE_ARG3]);
+    napi_create_int32(g_napiCallback->env, command->u.rect.x, &argv[OHOS_THREADSAFE_ARG0]);
+    napi_create_int32(g_napiCallback->env, command->u.rect.y, &argv[OHOS_THREADSAFE_ARG1]);
+    napi_create_int32(g_napiCallback->env, command->u.rect.w, &argv[OHOS_THREADSAFE_ARG2]);
+    napi_create_int32(g_napiCallback->env, command->u.rect.h, &argv[OHOS_THREADSAFE_ARG3]);
 
     napi_value callback = nullptr;
     napi_get_reference_value(g_napiCallback->env, g_napiCallback->callbackRef, &callback);
@@ -117,32 +105,14 @@ static void OHOS_TS_SetWindowResize(const cJSON *root)
     napi_call_function(g_napiCallback->env, nullptr, jsMethod, OHOS_THREADSAFE_ARG4, argv, nullptr);
 }
 
-static void OHOS_TS_ShowTextInput(const cJSON *root)
+static void OHOS_TS_ShowTextInput(const OhosTSCommand *command)
 {
-    int x;
-    int y;
-    int w;
-    int h;
-    cJSON *data = cJSON_GetObjectItem(root, "x");
-    x = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "y");
-    y = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "w");
-    w = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "h");
-    h = data->valueint;
-
-    size_t argc = OHOS_THREADSAFE_ARG4;
-    napi_value args[OHOS_THREADSAFE_ARG1] = {nullptr};
     napi_value argv[OHOS_THREADSAFE_ARG4] = {nullptr};
 
-    napi_create_int32(g_napiCallback->env, x, &argv[OHOS_THREADSAFE_ARG0]);
-    napi_create_int32(g_napiCallback->env, y, &argv[OHOS_THREADSAFE_ARG1]);
-    napi_create_int32(g_napiCallback->env, w, &argv[OHOS_THREADSAFE_ARG2]);
-    napi_create_int32(g_napiCallback->env, h, &argv[OHOS_THREADSAFE_ARG3]);
+    napi_create_int32(g_napiCallback->env, command->u.rect.x, &argv[OHOS_THREADSAFE_ARG0]);
+    napi_create_int32(g_napiCallback->env, command->u.rect.y, &argv[OHOS_THREADSAFE_ARG1]);
+    napi_create_int32(g_napiCallback->env, command->u.rect.w, &argv[OHOS_THREADSAFE_ARG2]);
+    napi_create_int32(g_napiCallback->env, command->u.rect.h, &argv[OHOS_THREADSAFE_ARG3]);
 
     napi_value callback = nullptr;
     napi_get_reference_value(g_napiCallback->env, g_napiCallback->callbackRef, &callback);
@@ -152,11 +122,10 @@ static void OHOS_TS_ShowTextInput(const cJSON *root)
     return;
 }
 
-static void OHOS_TS_RequestPermission(const cJSON *root)
+static void OHOS_TS_RequestPermission(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "permission");
-    const char *permission = data->valuestring;
-    
+    const char *permission = command->text ? command->text : "";
+
     napi_value argv[OHOS_THREADSAFE_ARG1] = {nullptr};
     napi_create_string_utf8(g_napiCallback->env, permission, NAPI_AUTO_LENGTH, &argv[OHOS_THREADSAFE_ARG0]);
 
@@ -165,136 +134,82 @@ static void OHOS_TS_RequestPermission(const cJSON *root)
     napi_value jsMethod;
     napi_get_named_property(g_napiCallback->env, callback, "requestPermission", &jsMethod);
     napi_call_function(g_napiCallback->env, nullptr, jsMethod, OHOS_THREADSAFE_ARG1, argv, nullptr);
-    
+
     return;
 }
 
-static void OHOS_TS_AddChildNode(const cJSON *root)
+static void OHOS_TS_AddChildNode(const OhosTSCommand *command)
 {
-    long long temp;
-    cJSON *data = cJSON_GetObjectItem(root, "parent");
-    
-    const char *parentnode = (data->valuestring);
-    long long tmp3 = std::stoull(std::string(parentnode), nullptr, 10);
-    SDL_EMBEDDED_WINDOW_ADAPTER::Node* parent1 = reinterpret_cast<SDL_EMBEDDED_WINDOW_ADAPTER::Node*>(tmp3);
-    
-    
-//    temp = static_cast<long long>(data->valuedouble);
-//    void* parent = reinterpret_cast<void *>(temp);
-
-    data = cJSON_GetObjectItem(root, "child");
-//    temp = static_cast<long long>(data->valuedouble);
-//    void *child = reinterpret_cast<void *>(temp);
-    
-        
-    const char *childnode = (data->valuestring);
-    long long tmp4 = std::stoull(std::string(childnode), nullptr, 10);
-    SDL_EMBEDDED_WINDOW_ADAPTER::Node* child = reinterpret_cast<SDL_EMBEDDED_WINDOW_ADAPTER::Node*>(tmp4);
-//    SDL_EMBEDDED_WINDOW_ADAPTER::Node* child1 = reinterpret_cast<SDL_EMBEDDED_WINDOW_ADAPTER::Node*>(tmp4);
-//    
-//    std::shared_ptr<SDL_EMBEDDED_WINDOW_ADAPTER::Node> child2(child1); 
-
-    data = cJSON_GetObjectItem(root, "xcompentid");
-    char *xcompentId = data->valuestring;
-
-    data = cJSON_GetObjectItem(root, "position");
-//    temp = static_cast<long long>(data->valuedouble);
-//    WindowPosition *position = reinterpret_cast<WindowPosition *>(temp);
-    
-        const char *test = (data->valuestring);
-    long long tmp1 = std::stoull(std::string(test), nullptr, 10);
-    WindowPosition *position = reinterpret_cast<WindowPosition *>(tmp1);
-        SDL_Log("data->valuedouble111 ======%p.", data->valuedouble);
-    
-    SDL_Log("data->temp ======%p.", tmp1);
-        SDL_Log("out data->position ======%p.", position);
-    
-
-
-    ThreadLockInfo *lockInfo = nullptr;
-    data = cJSON_GetObjectItem(root, OHOS_JSON_ASYN);
-    
-    
-//    temp = static_cast<long long>(data->valuedouble);
-//    lockInfo = reinterpret_cast<ThreadLockInfo *>(temp);
-    const char *test2 = (data->valuestring);
-    long long tmp2 = std::stoull(std::string(test2), nullptr, 10);
-    lockInfo = reinterpret_cast<ThreadLockInfo *>(tmp2);
-    
-    
-    OHOS_AddChildNode((void *)parent1, (void**)child, xcompentId, position);
+    WindowPosition *position = reinterpret_cast<WindowPosition *>(command->u.node.position);
+    ThreadLockInfo *lockInfo = reinterpret_cast<ThreadLockInfo *>(command->u.node.lockInfo);
+
+    OHOS_AddChildNode(command->u.node.parent, command->u.node.child, const_cast<char *>(command->xcompentId),
+                      position);
 
+    std::lock_guard<std::mutex> lock(lockInfo->mutex);
     lockInfo->ready = true;
     lockInfo->condition.notify_all();
 }
 
-static void OHOS_TS_RemoveChildNode(const cJSON *root)
+static void OHOS_TS_RemoveChildNode(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "xcompentid");
-    char *xcompentId = data->valuestring;
-
-    OHOS_RemoveChildNode(xcompentId);
+    OHOS_RemoveChildNode(const_cast<char *>(command->xcompentId));
 }
 
-static void OHOS_TS_ResizeNode(const cJSON *root)
+static void OHOS_TS_ResizeNode(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "xcompentid");
-    char *xcompentId = data->valuestring;
-
-    data = cJSON_GetObjectItem(root, "width");
-    int width = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "height");
-    int height = data->valueint;
-
-    OHOS_ResizeNode(xcompentId, width, height);
+    OHOS_ResizeNode(const_cast<char *>(command->xcompentId), command->u.rect.w, command->u.rect.h);
 }
 
-static void OHOS_TS_MoveNode(const cJSON *root)
+static void OHOS_TS_MoveNode(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "xcompentid");
-    char *xcompentId = data->valuestring;
-
-    data = cJSON_GetObjectItem(root, "x");
-    int x = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "y");
-    int y = data->valueint;
-
-    OHOS_MoveNode(xcompentId, x, y);
+    OHOS_MoveNode(const_cast<char *>(command->xcompentId), command->u.rect.x, command->u.rect.y);
 }
 
-static void OHOS_TS_ShowNode(const cJSON *root)
+static void OHOS_TS_ShowNode(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "xcompentid");
-    char *xcompentId = data->valuestring;
-
-    OHOS_ShowNode(xcompentId);
+    OHOS_ShowNode(const_cast<char *>(command->xcompentId));
 }
 
-static void OHOS_TS_HideNode(const cJSON *root)
+static void OHOS_TS_HideNode(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "xcompentid");
-    char *xcompentId = data->valuestring;
+    OHOS_HideNode(const_cast<char *>(command->xcompentId));
+}
 
-    OHOS_HideNode(xcompentId);
+static void OHOS_TS_RaiseNode(const OhosTSCommand *command)
+{
+    OHOS_RaiseNode(const_cast<char *>(command->xcompentId));
 }
 
-static void OHOS_TS_RaiseNode(const cJSON *root)
+static void OHOS_TS_ApplyNodeState(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "xcompentid");
-    char *xcompentId = data->valuestring;
+    OhosTSNodeState state;
+    if (!OHOS_TS_TakeNodeState(command, &state)) {
+        return;
+    }
 
-    OHOS_RaiseNode(xcompentId);
+    if (state.dirty & OHOS_TS_NODE_DIRTY_VISIBILITY) {
+        if (state.visible) {
+            OHOS_ShowNode(state.xcompentId);
+        } else {
+            OHOS_HideNode(state.xcompentId);
+        }
+    }
+    if (state.dirty & OHOS_TS_NODE_DIRTY_SIZE) {
+        OHOS_ResizeNode(state.xcompentId, state.width, state.height);
+    }
+    if (state.dirty & OHOS_TS_NODE_DIRTY_POSITION) {
+        OHOS_MoveNode(state.xcompentId, state.x, state.y);
+    }
+    if (state.dirty & OHOS_TS_NODE_DIRTY_RAISE) {
+        OHOS_RaiseNode(state.xcompentId);
+    }
 }
 
-static void OHOS_TS_HideTextInput(const cJSON *root)
+static void OHOS_TS_HideTextInput(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "flag");
-    int flag = data->valueint;
-    size_t argc = OHOS_THREADSAFE_ARG1;
     napi_value argv[OHOS_THREADSAFE_ARG1] = {nullptr};
-    napi_create_int32(g_napiCallback->env, flag, &argv[OHOS_THREADSAFE_ARG0]);
+    napi_create_int32(g_napiCallback->env, command->u.value, &argv[OHOS_THREADSAFE_ARG0]);
 
     napi_value callback = nullptr;
     napi_get_reference_value(g_napiCallback->env, g_napiCallback->callbackRef, &callback);
@@ -303,13 +218,10 @@ static void OHOS_TS_HideTextInput(const cJSON *root)
     napi_call_function(g_napiCallback->env, nullptr, jsMethod, OHOS_THREADSAFE_ARG1, argv, nullptr);
 }
 
-static void OHOS_TS_ShouldMinimizeOnFocusLoss(const cJSON *root)
+static void OHOS_TS_ShouldMinimizeOnFocusLoss(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "flag");
-    int flag = data->valueint;
-    size_t argc = OHOS_THREADSAFE_ARG1;
     napi_value argv[OHOS_THREADSAFE_ARG1] = {nullptr};
-    napi_create_int32(g_napiCallback->env, flag, &argv[OHOS_THREADSAFE_ARG0]);
+    napi_create_int32(g_napiCallback->env, command->u.value, &argv[OHOS_THREADSAFE_ARG0]);
 
     napi_value callback = nullptr;
     napi_get_reference_value(g_napiCallback->env, g_napiCallback->callbackRef, &callback);
@@ -318,12 +230,9 @@ static void OHOS_TS_ShouldMinimizeOnFocusLoss(const cJSON *root)
     napi_call_function(g_napiCallback->env, nullptr, jsMethod, OHOS_THREADSAFE_ARG1, argv, nullptr);
 }
 
-static void OHOS_TS_SetTitle(const cJSON *root)
+static void OHOS_TS_SetTitle(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "title");
-    const char *title = data->valuestring;
-    size_t argc = OHOS_THREADSAFE_ARG1;
-    napi_value args[OHOS_THREADSAFE_ARG1] = {nullptr};
+    const char *title = command->text ? command->text : "";
     napi_value argv[OHOS_THREADSAFE_ARG1] = {nullptr};
     napi_create_string_utf8(g_napiCallback->env, title, NAPI_AUTO_LENGTH, &argv[OHOS_THREADSAFE_ARG0]);
 
@@ -334,15 +243,11 @@ static void OHOS_TS_SetTitle(const cJSON *root)
     napi_call_function(g_napiCallback->env, nullptr, jsMethod, OHOS_THREADSAFE_ARG1, argv, nullptr);
 }
 
-static void OHOS_TS_SetWindowStyle(const cJSON *root)
+static void OHOS_TS_SetWindowStyle(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "fullscreen");
-    SDL_bool fullscreen = (SDL_bool)data->type;
-    size_t argc = OHOS_THREADSAFE_ARG1;
-    napi_value args[OHOS_THREADSAFE_ARG1] = {nullptr};
     napi_value argv[OHOS_THREADSAFE_ARG1] = {nullptr};
 
-    napi_get_boolean(g_napiCallback->env, fullscreen, &argv[OHOS_THREADSAFE_ARG0]);
+    napi_get_boolean(g_napiCallback->env, command->u.value != 0, &argv[OHOS_THREADSAFE_ARG0]);
 
     napi_value callback = nullptr;
     napi_get_reference_value(g_napiCallback->env, g_napiCallback->callbackRef, &callback);
@@ -351,16 +256,11 @@ static void OHOS_TS_SetWindowStyle(const cJSON *root)
     napi_call_function(g_napiCallback->env, nullptr, jsMethod, OHOS_THREADSAFE_ARG1, argv, nullptr);
 }
 
-static void OHOS_TS_ShowTextInputKeyboard(const cJSON *root)
+static void OHOS_TS_ShowTextInputKeyboard(const OhosTSCommand *command)
 {
-    cJSON *data = cJSON_GetObjectItem(root, "isshow");
-    SDL_bool isshow = (SDL_bool)data->type;
-    
-    size_t argc = OHOS_THREADSAFE_ARG1;
-    napi_value args[OHOS_THREADSAFE_ARG1] = {nullptr};
     napi_value argv[OHOS_THREADSAFE_ARG1] = {nullptr};
 
-    napi_get_boolean(g_napiCallback->env, isshow, &argv[OHOS_THREADSAFE_ARG0]);
+    napi_get_boolean(g_napiCallback->env, command->u.value != 0, &argv[OHOS_THREADSAFE_ARG0]);
 
     napi_value callback = nullptr;
     napi_get_reference_value(g_napiCallback->env, g_napiCallback->callbackRef, &callback);
@@ -369,29 +269,14 @@ static void OHOS_TS_ShowTextInputKeyboard(const cJSON *root)
     napi_call_function(g_napiCallback->env, nullptr, jsMethod, OHOS_THREADSAFE_ARG1, argv, nullptr);
 }
 
-static void OHOS_TS_SetOrientation(const cJSON *root)
+static void OHOS_TS_SetOrientation(const OhosTSCommand *command)
 {
-    int w;
-    int h;
-    int resizable;
-    cJSON *data = cJSON_GetObjectItem(root, "w");
-    w = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "h");
-    h = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "resizable");
-    resizable = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "hint");
-    const char *hint = data->valuestring;
-    
-    size_t argc = OHOS_THREADSAFE_ARG4;
-    napi_value args[OHOS_THREADSAFE_ARG4] = {nullptr};
+    const char *hint = command->text ? command->text : "";
+
     napi_value argv[OHOS_THREADSAFE_ARG4] = {nullptr};
-    napi_create_int32(g_napiCallback->env, w, &argv[OHOS_THREADSAFE_ARG0]);
-    napi_create_int32(g_napiCallback->env, h, &argv[OHOS_THREADSAFE_ARG1]);
-    napi_create_int32(g_napiCallback->env, resizable, &argv[OHOS_THREADSAFE_ARG2]);
+    napi_create_int32(g_napiCallback->env, command->u.orientation.w, &argv[OHOS_THREADSAFE_ARG0]);
+    napi_create_int32(g_napiCallback->env, command->u.orientation.h, &argv[OHOS_THREADSAFE_ARG1]);
+    napi_create_int32(g_napiCallback->env, command->u.orientation.resizable, &argv[OHOS_THREADSAFE_ARG2]);
     napi_create_string_utf8(g_napiCallback->env, hint, NAPI_AUTO_LENGTH, &argv[OHOS_THREADSAFE_ARG3]);
 
     napi_value callback = nullptr;
@@ -401,42 +286,15 @@ static void OHOS_TS_SetOrientation(const cJSON *root)
     napi_call_function(g_napiCallback->env, nullptr, jsMethod, OHOS_THREADSAFE_ARG4, argv, nullptr);
 }
 
-static void OHOS_TS_CreateCustomCursor(const cJSON *root)
+static void OHOS_TS_CreateCustomCursor(const OhosTSCommand *command)
 {
-    int hotX;
-    int hotY;
-    int bytesPerPixel;
-    int w;
-    int h;
-    //long long xcomponentPixels;
-    cJSON *data = cJSON_GetObjectItem(root, "xcomponentpixel");
-//    xcomponentPixels = static_cast<long long>(data->valuedouble);
-//    void *xcomponentpixelbuffer = reinterpret_cast<void *>(xcomponentPixels);
-    
-        const char *xcomponentPixels = (data->valuestring);
-    long long tmp = std::stoull(std::string(xcomponentPixels), nullptr, 10);
-    void *xcomponentpixelbuffer = reinterpret_cast<void *>(tmp);
-    SDL_Log("(double)xcomponentpixelbuffer111 ======%p.", xcomponentpixelbuffer);
-
-    data = cJSON_GetObjectItem(root, "hot_x");
-    hotX = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "hot_y");
-    hotY = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "BytesPerPixel");
-    bytesPerPixel = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "w");
-    w = data->valueint;
-
-    data = cJSON_GetObjectItem(root, "h");
-    h = data->valueint;
-    
+    void *xcomponentpixelbuffer = command->u.cursor.pixels;
+    int bytesPerPixel = command->u.cursor.bytesPerPixel;
+
     napi_value argv[OHOS_THREADSAFE_ARG3] = {nullptr};
     OhosPixelMapCreateOps createOps;
-    createOps.width = w;
-    createOps.height = h;
+    createOps.width = command->u.cursor.w;
+    createOps.height = command->u.cursor.h;
     createOps.pixelFormat = bytesPerPixel;
     createOps.alphaType = 0;
     size_t bufferSize = createOps.width * createOps.height * bytesPerPixel;
@@ -445,9 +303,9 @@ static void OHOS_TS_CreateCustomCursor(const cJSON *root)
     if (res != IMAGE_RESULT_SUCCESS || argv[OHOS_THREADSAFE_ARG0] == nullptr) {
         SDL_Log("OH_PixelMap_CreatePixelMap is failed");
     }
-    napi_create_int32(g_napiCallback->env, hotX, &argv[OHOS_THREADSAFE_ARG1]); // coordinate x
-    napi_create_int32(g_napiCallback->env, hotY, &argv[OHOS_THREADSAFE_ARG2]); // coordinate y
-    
+    napi_create_int32(g_napiCallback->env, command->u.cursor.hotX, &argv[OHOS_THREADSAFE_ARG1]); // coordinate x
+    napi_create_int32(g_napiCallback->env, command->u.cursor.hotY, &argv[OHOS_THREADSAFE_ARG2]); // coordinate y
+
     napi_value callback = nullptr;
     napi_get_reference_value(g_napiCallback->env, g_napiCallback->callbackRef, &callback);
     napi_value jsMethod;
@@ -457,19 +315,10 @@ static void OHOS_TS_CreateCustomCursor(const cJSON *root)
     return;
 }
 
-static void OHOS_TS_SetCustomCursor(const cJSON *root)
+static void OHOS_SetSystemCursor(const OhosTSCommand *command)
 {
-    // if use root, delete this line
-    (void)root;
-    return;
-}
-
-static void OHOS_SetSystemCursor(const cJSON *root)
-{
-    cJSON *data = cJSON_GetObjectItem(root, "cursorID");
-    int cursorID = data->valueint;
     napi_value argv[OHOS_THREADSAFE_ARG1] = {nullptr};
-    napi_create_int32(g_napiCallback->env, cursorID, &argv[OHOS_THREADSAFE_ARG0]);
+    napi_create_int32(g_napiCallback->env, command->u.value, &argv[OHOS_THREADSAFE_ARG0]);
     napi_value callback = nullptr;
     napi_get_reference_value(g_napiCallback->env, g_napiCallback->callbackRef, &callback);
     napi_value jsMethod;
@@ -478,22 +327,26 @@ static void OHOS_SetSystemCursor(const cJSON *root)
     return;
 }
 
-void OHOS_TS_Call(napi_env env, napi_value jsCb, void *context, void *data)
+static void OHOS_TS_Dispatch(const OhosTSCommand *command)
 {
-    if (data == nullptr) {
+    auto it = tsFuctions.find(command->type);
+    if (it == tsFuctions.end()) {
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Unhandled threadsafe command type %d.", (int)command->type);
         return;
     }
-    cJSON *root = (cJSON*)data;
-    cJSON *json = cJSON_GetObjectItem(root, OHOS_TS_CALLBACK_TYPE);
-    if (json == nullptr) {
+    SDL_TRACE_BEGIN("OHOS_TS_Dispatch");
+    it->second(command);
+    SDL_TRACE_END();
+}
+
+void OHOS_TS_Call(napi_env env, napi_value jsCb, void *context, void *data)
+{
+    /* One wake-up drains every command posted since the last one, data is unused. */
+    (void)data;
+    if (g_napiCallback == nullptr) {
         return;
     }
-    NapiCallBackType type = static_cast<NapiCallBackType>(json->valueint);
-    OHOS_TS_Fuction fuc = tsFuctions[type];
-    fuc(root);
-    free(data);
-    root = nullptr;
-    json = nullptr;
+    OHOS_TS_DrainCommands(OHOS_TS_Dispatch);
 }
 
 /* The general mixing thread function */
@@ -543,6 +396,7 @@ void OHOS_ThreadExit(void)
         }
     }
     napi_release_threadsafe_function(g_napiCallback->tsfn, napi_tsfn_release);
+    OHOS_TS_DiscardCommands();
     g_napiCallback->tsfn = nullptr;
     g_napiCallback = NULL;
 }
\ No newline at end of file
@@ -19,7 +19,6 @@
 #include "SDL_stdinc.h"
 #include "SDL_atomic.h"
 #include "SDL_surface.h"
-#include "cJSON.h"
 #include "SDL_ohos_tstype.h"
 
 typedef int (*SdlMainFunc)(int argc, char *argv[]);
@@ -42,8 +41,6 @@ SDL_bool OHOS_RunThread(OhosSDLEntryInfo *info);
 
 void OHOS_ThreadExit(void);
 
-void OHOS_TS_GetWindowId(const cJSON *root);
-
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 /* *INDENT-OFF* */
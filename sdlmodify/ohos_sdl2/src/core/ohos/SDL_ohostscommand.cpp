@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2023 Huawei Device Co., Ltd.
+ * Licensed under the Apache License,Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "../../SDL_internal.h"
+
+#ifdef __OHOS__
+
+#include "SDL_atomic.h"
+#include "SDL_log.h"
+#include "SDL_ohostscommand.h"
+extern "C" {
+#include "../../SDL_trace_c.h"
+}
+
+#define OHOS_TS_COMMAND_RING_MASK (OHOS_TS_COMMAND_RING_SIZE - 1)
+
+/*
+ * Single consumer ring (the ArkTS thread). Several SDL threads may post, so
+ * producers are serialized by a spinlock that is only ever held for the copy
+ * of one record; the consumer never takes it.
+ */
+static OhosTSCommand g_commandRing[OHOS_TS_COMMAND_RING_SIZE];
+static SDL_atomic_t g_commandHead;
+static SDL_atomic_t g_commandTail;
+static SDL_SpinLock g_commandProducerLock = 0;
+
+/* Set while a threadsafe function call is in flight, so a burst of posts costs one wake-up. */
+static SDL_atomic_t g_commandWakePending;
+
+/* Guards the node state slots below; taken before g_commandProducerLock. */
+static SDL_SpinLock g_nodeSlotLock = 0;
+
+static void OHOS_TS_CloseNodeStates(void);
+
+static void OHOS_TS_WakeConsumer(void)
+{
+    if (!SDL_AtomicCAS(&g_commandWakePending, 0, 1)) {
+        return;
+    }
+    if (g_napiCallback == nullptr || g_napiCallback->tsfn == nullptr ||
+        napi_call_threadsafe_function(g_napiCallback->tsfn, nullptr, napi_tsfn_nonblocking) != napi_ok) {
+        /* Leave the commands queued, the next post retries the wake-up. */
+        SDL_AtomicSet(&g_commandWakePending, 0);
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Error waking the ArkTS thread.");
+    }
+}
+
+void OHOS_TS_InitCommand(OhosTSCommand *command, NapiCallBackType type, const char *xcompentId)
+{
+    command->type = type;
+    SDL_zero(command->u);
+    command->text = NULL;
+    if (xcompentId != NULL) {
+        SDL_strlcpy(command->xcompentId, xcompentId, sizeof(command->xcompentId));
+    } else {
+        command->xcompentId[0] = '\0';
+    }
+}
+
+/* Copies the command into the ring, the caller wakes the consumer. */
+static SDL_bool OHOS_TS_EnqueueCommand(const OhosTSCommand *command)
+{
+    Uint32 head;
+
+    SDL_AtomicLock(&g_commandProducerLock);
+    head = (Uint32)SDL_AtomicGet(&g_commandHead);
+    if (head - (Uint32)SDL_AtomicGet(&g_commandTail) >= OHOS_TS_COMMAND_RING_SIZE) {
+        SDL_AtomicUnlock(&g_commandProducerLock);
+        return SDL_FALSE;
+    }
+    g_commandRing[head & OHOS_TS_COMMAND_RING_MASK] = *command;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&g_commandHead, (int)(head + 1));
+    SDL_AtomicUnlock(&g_commandProducerLock);
+    SDL_TRACE_COUNTER("OHOS_TS queued commands", (Sint64)(head + 1 - (Uint32)SDL_AtomicGet(&g_commandTail)));
+    return SDL_TRUE;
+}
+
+static SDL_bool OHOS_TS_FinishPost(const OhosTSCommand *command, SDL_bool queued)
+{
+    OHOS_TS_WakeConsumer();
+    if (!queued) {
+        /*
+         * Ring is full. Waiting for room could deadlock (the poster may be the
+         * ArkTS thread itself), so drop the command and let the caller free
+         * whatever payload it owns.
+         */
+        SDL_LogError(SDL_LOG_CATEGORY_ERROR, "Threadsafe command queue is full, dropping command type %d.",
+                     (int)command->type);
+    }
+    return queued;
+}
+
+SDL_bool OHOS_TS_PostCommand(const OhosTSCommand *command)
+{
+    SDL_bool queued;
+
+    if (g_napiCallback == nullptr) {
+        return SDL_FALSE;
+    }
+
+    /* Close pending node state and queue in one step, so nothing merged later is applied before this. */
+    SDL_AtomicLock(&g_nodeSlotLock);
+    OHOS_TS_CloseNodeStates();
+    queued = OHOS_TS_EnqueueCommand(command);
+    SDL_AtomicUnlock(&g_nodeSlotLock);
+
+    return OHOS_TS_FinishPost(command, queued);
+}
+
+int OHOS_TS_DrainCommands(OHOS_TS_CommandHandler handler)
+{
+    Uint32 tail;
+    Uint32 head;
+    int count = 0;
+
+    /* Clear before reading head, a post that races with the drain schedules another wake-up. */
+    SDL_AtomicSet(&g_commandWakePending, 0);
+    SDL_TRACE_BEGIN("OHOS_TS_DrainCommands");
+
+    tail = (Uint32)SDL_AtomicGet(&g_commandTail);
+    head = (Uint32)SDL_AtomicGet(&g_commandHead);
+    SDL_MemoryBarrierAcquire();
+    while (tail != head) {
+        OhosTSCommand *command = &g_commandRing[tail & OHOS_TS_COMMAND_RING_MASK];
+        if (handler != NULL) {
+            handler(command);
+        }
+        if (command->text != NULL) {
+            SDL_free(command->text);
+            command->text = NULL;
+        }
+        ++tail;
+        ++count;
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&g_commandTail, (int)tail);
+        if (tail == head) {
+            head = (Uint32)SDL_AtomicGet(&g_commandHead);
+            SDL_MemoryBarrierAcquire();
+        }
+    }
+    SDL_TRACE_END();
+    return count;
+}
+
+/*
+ * Geometry coalescing. The first move/resize/show/hide/raise for a node
+ * takes a state slot and queues one NAPI_CALLBACK_APPLY_NODE_STATE marker;
+ * following calls for the same node only update that slot until the ArkTS
+ * thread consumes the marker. Any other command closes every open slot, so
+ * merged state never moves past a command that was posted after it. Slots
+ * are opened and closed together with queueing, under g_nodeSlotLock.
+ */
+typedef struct OhosTSNodeSlot {
+    SDL_bool inUse; /* referenced by a queued marker */
+    SDL_bool open;  /* still accepting merges */
+    OhosTSNodeState state;
+} OhosTSNodeSlot;
+
+static OhosTSNodeSlot g_nodeSlots[OHOS_TS_NODE_STATE_MAX];
+/* Number of slots with open set, lets unrelated posts skip the scan. */
+static int g_nodeSlotsOpen = 0;
+static SDL_atomic_t g_nodePosted;
+static SDL_atomic_t g_nodeMerged;
+static SDL_atomic_t g_nodeFlushed;
+
+static void OHOS_TS_MergeNodeState(OhosTSNodeState *state, NapiCallBackType type, int x, int y, int w, int h)
+{
+    switch (type) {
+    case NAPI_CALLBACK_MOVE_NODE:
+        state->dirty |= OHOS_TS_NODE_DIRTY_POSITION;
+        state->x = x;
+        state->y = y;
+        break;
+    case NAPI_CALLBACK_RESIZE_NODE:
+        state->dirty |= OHOS_TS_NODE_DIRTY_SIZE;
+        state->width = w;
+        state->height = h;
+        break;
+    case NAPI_CALLBACK_SHOW_NODE:
+    case NAPI_CALLBACK_HIDE_NODE:
+        state->dirty |= OHOS_TS_NODE_DIRTY_VISIBILITY;
+        state->visible = (type == NAPI_CALLBACK_SHOW_NODE) ? SDL_TRUE : SDL_FALSE;
+        break;
+    case NAPI_CALLBACK_RAISE_NODE:
+        state->dirty |= OHOS_TS_NODE_DIRTY_RAISE;
+        break;
+    default:
+        break;
+    }
+}
+
+/* Caller holds g_nodeSlotLock. */
+static void OHOS_TS_CloseNodeSlot(OhosTSNodeSlot *slot)
+{
+    if (slot->open) {
+        slot->open = SDL_FALSE;
+        --g_nodeSlotsOpen;
+    }
+}
+
+/* Caller holds g_nodeSlotLock. */
+static void OHOS_TS_CloseNodeStates(void)
+{
+    int i;
+
+    for (i = 0; i < OHOS_TS_NODE_STATE_MAX && g_nodeSlotsOpen > 0; ++i) {
+        OHOS_TS_CloseNodeSlot(&g_nodeSlots[i]);
+    }
+}
+
+SDL_bool OHOS_TS_PostNodeCommand(NapiCallBackType type, const char *xcompentId, int x, int y, int w, int h)
+{
+    OhosTSCommand command;
+    OhosTSNodeSlot *slot;
+    SDL_bool queued;
+    int posted, merged;
+    int freeSlot = -1;
+    int i;
+
+    if (xcompentId == NULL) {
+        return SDL_FALSE;
+    }
+
+    if (type == NAPI_CALLBACK_REMOVE_CHILD_NODE) {
+        OHOS_TS_InitCommand(&command, type, xcompentId);
+        return OHOS_TS_PostCommand(&command);
+    }
+
+    if (g_napiCallback == nullptr) {
+        return SDL_FALSE;
+    }
+
+    posted = SDL_AtomicIncRef(&g_nodePosted) + 1;
+    SDL_TRACE_COUNTER("OHOS_TS node commands posted", (Sint64)posted);
+    SDL_AtomicLock(&g_nodeSlotLock);
+    for (i = 0; i < OHOS_TS_NODE_STATE_MAX; ++i) {
+        slot = &g_nodeSlots[i];
+        if (slot->open && SDL_strcmp(slot->state.xcompentId, xcompentId) == 0) {
+            OHOS_TS_MergeNodeState(&slot->state, type, x, y, w, h);
+            SDL_AtomicUnlock(&g_nodeSlotLock);
+            merged = SDL_AtomicIncRef(&g_nodeMerged) + 1;
+            SDL_TRACE_COUNTER("OHOS_TS node commands merged", (Sint64)merged);
+            return SDL_TRUE;
+        }
+        if (freeSlot < 0 && !slot->inUse) {
+            freeSlot = i;
+        }
+    }
+
+    if (freeSlot < 0) {
+        /* Every slot is in flight, send this one through uncoalesced. */
+        SDL_AtomicUnlock(&g_nodeSlotLock);
+        OHOS_TS_InitCommand(&command, type, xcompentId);
+        command.u.rect.x = x;
+        command.u.rect.y = y;
+        command.u.rect.w = w;
+        command.u.rect.h = h;
+        return OHOS_TS_PostCommand(&command);
+    }
+
+    /* The slot only opens once its marker is queued, so no merge can land ahead of the marker. */
+    slot = &g_nodeSlots[freeSlot];
+    slot->state.dirty = 0;
+    SDL_strlcpy(slot->state.xcompentId, xcompentId, sizeof(slot->state.xcompentId));
+    OHOS_TS_MergeNodeState(&slot->state, type, x, y, w, h);
+    OHOS_TS_InitCommand(&command, NAPI_CALLBACK_APPLY_NODE_STATE, xcompentId);
+    command.u.value = freeSlot;
+    queued = OHOS_TS_EnqueueCommand(&command);
+    if (queued) {
+        slot->inUse = SDL_TRUE;
+        slot->open = SDL_TRUE;
+        ++g_nodeSlotsOpen;
+    }
+    SDL_AtomicUnlock(&g_nodeSlotLock);
+
+    return OHOS_TS_FinishPost(&command, queued);
+}
+
+SDL_bool OHOS_TS_TakeNodeState(const OhosTSCommand *command, OhosTSNodeState *state)
+{
+    OhosTSNodeSlot *slot;
+    int flushed;
+
+    if (command->type != NAPI_CALLBACK_APPLY_NODE_STATE ||
+        command->u.value < 0 || command->u.value >= OHOS_TS_NODE_STATE_MAX) {
+        return SDL_FALSE;
+    }
+
+    slot = &g_nodeSlots[command->u.value];
+    SDL_AtomicLock(&g_nodeSlotLock);
+    *state = slot->state;
+    OHOS_TS_CloseNodeSlot(slot);
+    slot->inUse = SDL_FALSE;
+    SDL_AtomicUnlock(&g_nodeSlotLock);
+
+    flushed = SDL_AtomicIncRef(&g_nodeFlushed) + 1;
+    SDL_TRACE_COUNTER("OHOS_TS node states flushed", (Sint64)flushed);
+    return SDL_TRUE;
+}
+
+void OHOS_TS_GetNodeCommandStats(OhosTSNodeCommandStats *stats)
+{
+    stats->posted = (Uint32)SDL_AtomicGet(&g_nodePosted);
+    stats->merged = (Uint32)SDL_AtomicGet(&g_nodeMerged);
+    stats->flushed = (Uint32)SDL_AtomicGet(&g_nodeFlushed);
+}
+
+static void OHOS_TS_ReleaseCommand(const OhosTSCommand *command)
+{
+    OhosTSNodeState state;
+
+    if (command->type == NAPI_CALLBACK_CREATE_CUSTOMCURSOR) {
+        SDL_free(command->u.cursor.pixels);
+    } else if (command->type == NAPI_CALLBACK_APPLY_NODE_STATE) {
+        OHOS_TS_TakeNodeState(command, &state);
+    }
+}
+
+void OHOS_TS_DiscardCommands(void)
+{
+    OHOS_TS_DrainCommands(OHOS_TS_ReleaseCommand);
+}
+
+#endif /* __OHOS__ */
+
+/* vi: set ts=4 sw=4 expandtab: */
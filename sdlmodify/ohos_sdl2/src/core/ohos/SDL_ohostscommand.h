@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2023 Huawei Device Co., Ltd.
+ * Licensed under the Apache License,Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SDL_OHOSTSCOMMAND_H
+#define SDL_OHOSTSCOMMAND_H
+
+#include "SDL_stdinc.h"
+#include <ace/xcomponent/native_interface_xcomponent.h>
+#include "SDL_ohos_tstype.h"
+
+/* Number of records in the command ring, must be a power of two. */
+#define OHOS_TS_COMMAND_RING_SIZE 256
+
+/*
+ * One SDL thread -> ArkTS request. The record is fixed size so posting it
+ * never allocates; only the rare string payloads (title, hint, permission)
+ * are duplicated into `text`, which the consumer frees after dispatch.
+ */
+typedef struct OhosTSCommand {
+    NapiCallBackType type;
+    union {
+        struct {
+            int x;
+            int y;
+            int w;
+            int h;
+        } rect;
+        struct {
+            int w;
+            int h;
+            int resizable;
+        } orientation;
+        struct {
+            void *pixels;
+            int hotX;
+            int hotY;
+            int bytesPerPixel;
+            int w;
+            int h;
+        } cursor;
+        struct {
+            void *parent;
+            void **child;
+            void *position;
+            void *lockInfo;
+        } node;
+        int value;
+    } u;
+    char *text;
+    char xcompentId[OH_XCOMPONENT_ID_LEN_MAX + 1];
+} OhosTSCommand;
+
+typedef void (*OHOS_TS_CommandHandler)(const OhosTSCommand *command);
+
+/* Pending node geometry slots, one per node with an update in flight. */
+#define OHOS_TS_NODE_STATE_MAX 64
+
+#define OHOS_TS_NODE_DIRTY_POSITION   0x01
+#define OHOS_TS_NODE_DIRTY_SIZE       0x02
+#define OHOS_TS_NODE_DIRTY_VISIBILITY 0x04
+#define OHOS_TS_NODE_DIRTY_RAISE      0x08
+
+/* Latest requested state of one node, merged from consecutive move/resize/show/hide/raise calls. */
+typedef struct OhosTSNodeState {
+    Uint32 dirty;
+    int x;
+    int y;
+    int width;
+    int height;
+    SDL_bool visible;
+    char xcompentId[OH_XCOMPONENT_ID_LEN_MAX + 1];
+} OhosTSNodeState;
+
+typedef struct OhosTSNodeCommandStats {
+    Uint32 posted;  /* geometry commands requested by SDL */
+    Uint32 merged;  /* of those, folded into an update that was already pending */
+    Uint32 flushed; /* node updates actually applied on the ArkTS thread */
+} OhosTSNodeCommandStats;
+
+#ifdef __cplusplus
+/* *INDENT-OFF* */
+extern "C" {
+/* *INDENT-ON* */
+#endif
+
+/* Producer side, callable from any SDL thread. */
+void OHOS_TS_InitCommand(OhosTSCommand *command, NapiCallBackType type, const char *xcompentId);
+SDL_bool OHOS_TS_PostCommand(const OhosTSCommand *command);
+SDL_bool OHOS_TS_PostNodeCommand(NapiCallBackType type, const char *xcompentId, int x, int y, int w, int h);
+void OHOS_TS_GetNodeCommandStats(OhosTSNodeCommandStats *stats);
+
+/* Consumer side, ArkTS thread only. Returns the number of commands handled. */
+int OHOS_TS_DrainCommands(OHOS_TS_CommandHandler handler);
+void OHOS_TS_DiscardCommands(void);
+SDL_bool OHOS_TS_TakeNodeState(const OhosTSCommand *command, OhosTSNodeState *state);
+
+/* Ends C function definitions when using C++ */
+#ifdef __cplusplus
+/* *INDENT-OFF* */
+}
+/* *INDENT-ON* */
+#endif
+
+#endif // SDL_OHOSTSCOMMAND_H
@@ -749,3 +749,40 @@
 #define SDL_GetAndroidSDKVersion SDL_GetAndroidSDKVersion_REAL
 #define SDL_isupper SDL_isupper_REAL
 #define SDL_islower SDL_islower_REAL
+#define SDL_RWReadAsync SDL_RWReadAsync_REAL
+#define SDL_RWAsyncWait SDL_RWAsyncWait_REAL
+#define SDL_RWAsyncEventType SDL_RWAsyncEventType_REAL
+#define SDL_RWFromReadAhead SDL_RWFromReadAhead_REAL
+#define SDL_PushEvents SDL_PushEvents_REAL
+#define SDL_AddTimerNS SDL_AddTimerNS_REAL
+#define SDL_GetJobThreadCount SDL_GetJobThreadCount_REAL
+#define SDL_CreateJobCounter SDL_CreateJobCounter_REAL
+#define SDL_DestroyJobCounter SDL_DestroyJobCounter_REAL
+#define SDL_GetJobCounterValue SDL_GetJobCounterValue_REAL
+#define SDL_RunJob SDL_RunJob_REAL
+#define SDL_RunJobAfter SDL_RunJobAfter_REAL
+#define SDL_WaitJobCounter SDL_WaitJobCounter_REAL
+#define SDL_ParallelFor SDL_ParallelFor_REAL
+#define SDL_SetMutexName SDL_SetMutexName_REAL
+#define SDL_SetSemaphoreName SDL_SetSemaphoreName_REAL
+#define SDL_SetCondName SDL_SetCondName_REAL
+#define SDL_GetLockStats SDL_GetLockStats_REAL
+#define SDL_GetLockStatsJSON SDL_GetLockStatsJSON_REAL
+#define SDL_ResetLockStats SDL_ResetLockStats_REAL
+#define SDL_StartTrace SDL_StartTrace_REAL
+#define SDL_StopTrace SDL_StopTrace_REAL
+#define SDL_IsTracing SDL_IsTracing_REAL
+#define SDL_TraceBegin SDL_TraceBegin_REAL
+#define SDL_TraceEnd SDL_TraceEnd_REAL
+#define SDL_TraceInstant SDL_TraceInstant_REAL
+#define SDL_TraceCounter SDL_TraceCounter_REAL
+#define SDL_SaveTrace_RW SDL_SaveTrace_RW_REAL
+#define SDL_SoftStretchLinear SDL_SoftStretchLinear_REAL
+#define SDL_MixAudioSources SDL_MixAudioSources_REAL
+#define SDL_OpenWAVDecoder_RW SDL_OpenWAVDecoder_RW_REAL
+#define SDL_DecodeWAV SDL_DecodeWAV_REAL
+#define SDL_DecodeWAVToStream SDL_DecodeWAVToStream_REAL
+#define SDL_SeekWAVDecoder SDL_SeekWAVDecoder_REAL
+#define SDL_TellWAVDecoder SDL_TellWAVDecoder_REAL
+#define SDL_GetWAVDecoderLength SDL_GetWAVDecoderLength_REAL
+#define SDL_CloseWAVDecoder SDL_CloseWAVDecoder_REAL
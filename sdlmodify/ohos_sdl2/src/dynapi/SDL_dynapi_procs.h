@@ -809,3 +809,40 @@ SDL_DYNAPI_PROC(int,SDL_GetAndroidSDKVersion,(void),(),return)
 #endif
 SDL_DYNAPI_PROC(int,SDL_isupper,(int a),(a),return)
 SDL_DYNAPI_PROC(int,SDL_islower,(int a),(a),return)
+SDL_DYNAPI_PROC(int,SDL_RWReadAsync,(const SDL_RWAsyncRead *a, int b, Uint32 c),(a,b,c),return)
+SDL_DYNAPI_PROC(SDL_bool,SDL_RWAsyncWait,(SDL_RWAsyncResult *a, Sint32 b),(a,b),return)
+SDL_DYNAPI_PROC(Uint32,SDL_RWAsyncEventType,(void),(),return)
+SDL_DYNAPI_PROC(SDL_RWops*,SDL_RWFromReadAhead,(SDL_RWops *a, size_t b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_PushEvents,(SDL_Event *a, int b),(a,b),return)
+SDL_DYNAPI_PROC(SDL_TimerID,SDL_AddTimerNS,(Uint64 a, SDL_NSTimerCallback b, void *c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_GetJobThreadCount,(void),(),return)
+SDL_DYNAPI_PROC(SDL_JobCounter*,SDL_CreateJobCounter,(void),(),return)
+SDL_DYNAPI_PROC(void,SDL_DestroyJobCounter,(SDL_JobCounter *a),(a),)
+SDL_DYNAPI_PROC(int,SDL_GetJobCounterValue,(SDL_JobCounter *a),(a),return)
+SDL_DYNAPI_PROC(int,SDL_RunJob,(SDL_JobFunction a, void *b, SDL_JobCounter *c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_RunJobAfter,(SDL_JobCounter *a, SDL_JobFunction b, void *c, SDL_JobCounter *d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(void,SDL_WaitJobCounter,(SDL_JobCounter *a),(a),)
+SDL_DYNAPI_PROC(int,SDL_ParallelFor,(int a, int b, SDL_ParallelForFunction c, void *d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(void,SDL_SetMutexName,(SDL_mutex *a, const char *b),(a,b),)
+SDL_DYNAPI_PROC(void,SDL_SetSemaphoreName,(SDL_sem *a, const char *b),(a,b),)
+SDL_DYNAPI_PROC(void,SDL_SetCondName,(SDL_cond *a, const char *b),(a,b),)
+SDL_DYNAPI_PROC(int,SDL_GetLockStats,(SDL_LockStats *a, int b),(a,b),return)
+SDL_DYNAPI_PROC(char*,SDL_GetLockStatsJSON,(void),(),return)
+SDL_DYNAPI_PROC(void,SDL_ResetLockStats,(void),(),)
+SDL_DYNAPI_PROC(int,SDL_StartTrace,(void),(),return)
+SDL_DYNAPI_PROC(void,SDL_StopTrace,(void),(),)
+SDL_DYNAPI_PROC(SDL_bool,SDL_IsTracing,(void),(),return)
+SDL_DYNAPI_PROC(void,SDL_TraceBegin,(const char *a),(a),)
+SDL_DYNAPI_PROC(void,SDL_TraceEnd,(void),(),)
+SDL_DYNAPI_PROC(void,SDL_TraceInstant,(const char *a),(a),)
+SDL_DYNAPI_PROC(void,SDL_TraceCounter,(const char *a, Sint64 b),(a,b),)
+SDL_DYNAPI_PROC(int,SDL_SaveTrace_RW,(SDL_RWops *a, int b),(a,b),return)
+SDL_DYNAPI_PROC(int,SDL_SoftStretchLinear,(SDL_Surface *a, const SDL_Rect *b, SDL_Surface *c, const SDL_Rect *d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(int,SDL_MixAudioSources,(Uint8 *a, const Uint8 * const *b, const int *c, int d, SDL_AudioFormat e, Uint32 f, Uint32 g),(a,b,c,d,e,f,g),return)
+SDL_DYNAPI_PROC(SDL_WAVDecoder*,SDL_OpenWAVDecoder_RW,(SDL_RWops *a, int b, SDL_AudioSpec *c, Uint32 d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(int,SDL_DecodeWAV,(SDL_WAVDecoder *a, void *b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_DecodeWAVToStream,(SDL_WAVDecoder *a, SDL_AudioStream *b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_SeekWAVDecoder,(SDL_WAVDecoder *a, Sint64 b),(a,b),return)
+SDL_DYNAPI_PROC(Sint64,SDL_TellWAVDecoder,(SDL_WAVDecoder *a),(a),return)
+SDL_DYNAPI_PROC(Sint64,SDL_GetWAVDecoderLength,(SDL_WAVDecoder *a),(a),return)
+SDL_DYNAPI_PROC(void,SDL_CloseWAVDecoder,(SDL_WAVDecoder *a),(a),)
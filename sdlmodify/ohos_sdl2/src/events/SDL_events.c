@@ -27,6 +27,7 @@
 #include "SDL_thread.h"
 #include "SDL_events_c.h"
 #include "../timer/SDL_timer_c.h"
+#include "../SDL_trace_c.h"
 #if !SDL_JOYSTICK_DISABLED
 #include "../joystick/SDL_joystick_c.h"
 #endif
@@ -78,6 +79,15 @@ typedef struct _SDL_SysWMEntry
     struct _SDL_SysWMEntry *next;
 } SDL_SysWMEntry;
 
+/* Queue entries are carved out of slabs and recycled through the free list */
+#define SDL_EVENT_SLAB_ENTRIES  256
+
+typedef struct _SDL_EventSlab
+{
+    struct _SDL_EventSlab *next;
+    SDL_EventEntry entries[SDL_EVENT_SLAB_ENTRIES];
+} SDL_EventSlab;
+
 static struct
 {
     SDL_mutex *lock;
@@ -87,9 +97,59 @@ static struct
     SDL_EventEntry *head;
     SDL_EventEntry *tail;
     SDL_EventEntry *free;
+    SDL_EventSlab *slabs;
     SDL_SysWMEntry *wmmsg_used;
     SDL_SysWMEntry *wmmsg_free;
-} SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL };
+    SDL_mutex *wait_lock;
+    SDL_cond *wait_cond;
+    SDL_atomic_t waiters;
+    SDL_atomic_t wakeups;
+} SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, { 0 }, { 0 } };
+
+/* Pushed events go through a bounded lock-free ring first, so producers
+   never wait for the queue lock. Whoever takes SDL_EventQ.lock to look at
+   the queue moves the published events onto the list above, which keeps
+   the peek/get/filter semantics unchanged.
+
+   Each slot carries a sequence number: it equals the ring position when
+   the slot is free for that lap, and position+1 once the event in it is
+   published. It is stored relative to the slot index so the zeroed static
+   ring starts out with every slot free. */
+#define SDL_EVENT_RING_SIZE     1024
+#define SDL_EVENT_RING_MASK     (SDL_EVENT_RING_SIZE - 1)
+
+typedef struct
+{
+    SDL_atomic_t sequence;
+    SDL_Event event;
+    SDL_SysWMmsg msg;
+} SDL_EventSlot;
+
+static struct
+{
+    SDL_atomic_t enqueue_pos;
+    char pad0[SDL_CACHELINE_SIZE - sizeof (SDL_atomic_t)];
+    Uint32 dequeue_pos;     /* protected by SDL_EventQ.lock */
+    char pad1[SDL_CACHELINE_SIZE - sizeof (Uint32)];
+    SDL_EventSlot slots[SDL_EVENT_RING_SIZE];
+} SDL_EventRing;
+
+static SDL_INLINE Uint32
+SDL_EventSlotSequence(Uint32 pos)
+{
+    const Uint32 index = pos & SDL_EVENT_RING_MASK;
+    return (Uint32)SDL_AtomicGet(&SDL_EventRing.slots[index].sequence) + index;
+}
+
+static void SDL_DrainEventRing(void);
+
+static SDL_INLINE void
+SDL_SetEventSlotSequence(Uint32 pos, Uint32 sequence)
+{
+    const Uint32 index = pos & SDL_EVENT_RING_MASK;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&SDL_EventRing.slots[index].sequence, (int)(sequence - index));
+}
 
 
 /* 0 (default) means no logging, 1 means logging, 2 means logging with mouse and finger motion */
@@ -348,7 +408,7 @@ SDL_StopEventLoop(void)
 {
     const char *report = SDL_GetHint("SDL_EVENT_QUEUE_STATISTICS");
     int i;
-    SDL_EventEntry *entry;
+    SDL_EventSlab *slab;
     SDL_SysWMEntry *wmmsg;
 
     if (SDL_EventQ.lock) {
@@ -357,21 +417,19 @@ SDL_StopEventLoop(void)
 
     SDL_AtomicSet(&SDL_EventQ.active, 0);
 
+    /* Free the ring slots of anything still in flight */
+    SDL_DrainEventRing();
+
     if (report && SDL_atoi(report)) {
         SDL_Log("SDL EVENT QUEUE: Maximum events in-flight: %d\n",
                 SDL_EventQ.max_events_seen);
     }
 
     /* Clean out EventQ */
-    for (entry = SDL_EventQ.head; entry; ) {
-        SDL_EventEntry *next = entry->next;
-        SDL_free(entry);
-        entry = next;
-    }
-    for (entry = SDL_EventQ.free; entry; ) {
-        SDL_EventEntry *next = entry->next;
-        SDL_free(entry);
-        entry = next;
+    for (slab = SDL_EventQ.slabs; slab; ) {
+        SDL_EventSlab *next = slab->next;
+        SDL_free(slab);
+        slab = next;
     }
     for (wmmsg = SDL_EventQ.wmmsg_used; wmmsg; ) {
         SDL_SysWMEntry *next = wmmsg->next;
@@ -389,6 +447,7 @@ SDL_StopEventLoop(void)
     SDL_EventQ.head = NULL;
     SDL_EventQ.tail = NULL;
     SDL_EventQ.free = NULL;
+    SDL_EventQ.slabs = NULL;
     SDL_EventQ.wmmsg_used = NULL;
     SDL_EventQ.wmmsg_free = NULL;
 
@@ -409,6 +468,15 @@ SDL_StopEventLoop(void)
     }
     SDL_zero(SDL_EventOK);
 
+    if (SDL_EventQ.wait_cond) {
+        SDL_DestroyCond(SDL_EventQ.wait_cond);
+        SDL_EventQ.wait_cond = NULL;
+    }
+    if (SDL_EventQ.wait_lock) {
+        SDL_DestroyMutex(SDL_EventQ.wait_lock);
+        SDL_EventQ.wait_lock = NULL;
+    }
+
     if (SDL_EventQ.lock) {
         SDL_UnlockMutex(SDL_EventQ.lock);
         SDL_DestroyMutex(SDL_EventQ.lock);
@@ -433,6 +501,7 @@ SDL_StartEventLoop(void)
         if (SDL_EventQ.lock == NULL) {
             return -1;
         }
+        SDL_SetMutexName(SDL_EventQ.lock, "SDL_EventQ.lock");
     }
 
     if (!SDL_event_watchers_lock) {
@@ -440,6 +509,22 @@ SDL_StartEventLoop(void)
         if (SDL_event_watchers_lock == NULL) {
             return -1;
         }
+        SDL_SetMutexName(SDL_event_watchers_lock, "SDL_event_watchers_lock");
+    }
+
+    if (!SDL_EventQ.wait_lock) {
+        SDL_EventQ.wait_lock = SDL_CreateMutex();
+        if (SDL_EventQ.wait_lock == NULL) {
+            return -1;
+        }
+        SDL_SetMutexName(SDL_EventQ.wait_lock, "SDL_EventQ.wait_lock");
+    }
+    if (!SDL_EventQ.wait_cond) {
+        SDL_EventQ.wait_cond = SDL_CreateCond();
+        if (SDL_EventQ.wait_cond == NULL) {
+            return -1;
+        }
+        SDL_SetCondName(SDL_EventQ.wait_cond, "SDL_EventQ.wait_cond");
     }
 #endif /* !SDL_THREADS_DISABLED */
 
@@ -458,36 +543,33 @@ SDL_StartEventLoop(void)
 }
 
 
-/* Add an event to the event queue -- called with the queue locked */
+/* Append an event to the list -- called with the queue locked */
 static int
-SDL_AddEvent(SDL_Event * event)
+SDL_AppendEvent(const SDL_Event * event, const SDL_SysWMmsg * msg)
 {
     SDL_EventEntry *entry;
-    const int initial_count = SDL_AtomicGet(&SDL_EventQ.count);
-    int final_count;
-
-    if (initial_count >= SDL_MAX_QUEUED_EVENTS) {
-        SDL_SetError("Event queue is full (%d events)", initial_count);
-        return 0;
-    }
 
     if (SDL_EventQ.free == NULL) {
-        entry = (SDL_EventEntry *)SDL_malloc(sizeof(*entry));
-        if (!entry) {
+        SDL_EventSlab *slab = (SDL_EventSlab *)SDL_malloc(sizeof(*slab));
+        int i;
+
+        if (!slab) {
+            SDL_OutOfMemory();
             return 0;
         }
-    } else {
-        entry = SDL_EventQ.free;
-        SDL_EventQ.free = entry->next;
-    }
-
-    if (SDL_DoEventLogging) {
-        SDL_LogEvent(event);
+        slab->next = SDL_EventQ.slabs;
+        SDL_EventQ.slabs = slab;
+        for (i = 0; i < SDL_EVENT_SLAB_ENTRIES; ++i) {
+            slab->entries[i].next = SDL_EventQ.free;
+            SDL_EventQ.free = &slab->entries[i];
+        }
     }
+    entry = SDL_EventQ.free;
+    SDL_EventQ.free = entry->next;
 
     entry->event = *event;
     if (event->type == SDL_SYSWMEVENT) {
-        entry->msg = *event->syswm.msg;
+        entry->msg = *msg;
         entry->event.syswm.msg = &entry->msg;
     }
 
@@ -503,13 +585,125 @@ SDL_AddEvent(SDL_Event * event)
         entry->prev = NULL;
         entry->next = NULL;
     }
+    return 1;
+}
+
+/* Move the events published in the ring onto the list -- called with the queue locked */
+static void
+SDL_DrainEventRing(void)
+{
+    Uint32 pos = SDL_EventRing.dequeue_pos;
+    int final_count;
+
+    /* Stop at the first slot that isn't published yet, its producer may still be writing it */
+    while (SDL_EventSlotSequence(pos) == pos + 1) {
+        SDL_EventSlot *slot = &SDL_EventRing.slots[pos & SDL_EVENT_RING_MASK];
+
+        SDL_MemoryBarrierAcquire();
+        if (!SDL_AppendEvent(&slot->event, &slot->msg)) {
+            SDL_AtomicAdd(&SDL_EventQ.count, -1);
+        }
+        SDL_SetEventSlotSequence(pos, pos + SDL_EVENT_RING_SIZE);
+        ++pos;
+    }
+    SDL_EventRing.dequeue_pos = pos;
 
-    final_count = SDL_AtomicAdd(&SDL_EventQ.count, 1) + 1;
+    final_count = SDL_AtomicGet(&SDL_EventQ.count);
     if (final_count > SDL_EventQ.max_events_seen) {
         SDL_EventQ.max_events_seen = final_count;
     }
+}
 
-    return 1;
+/* Claim up to numevents consecutive ring slots and publish events in them,
+   returns how many were published before the ring was full */
+static int
+SDL_PublishEvents(const SDL_Event * events, int numevents)
+{
+    int published = 0;
+
+    while (published < numevents) {
+        const Uint32 pos = (Uint32)SDL_AtomicGet(&SDL_EventRing.enqueue_pos);
+        const Sint32 diff = (Sint32)(SDL_EventSlotSequence(pos) - pos);
+        Uint32 want = (Uint32)(numevents - published);
+        Uint32 i;
+
+        if (diff < 0) {
+            break;  /* full, the reader is a whole lap behind */
+        } else if (diff > 0) {
+            continue;  /* another producer claimed pos first */
+        }
+
+        /* The reader frees slots in order, so the batch fits if its last slot is free */
+        while (want > 1 && SDL_EventSlotSequence(pos + want - 1) != pos + want - 1) {
+            want /= 2;
+        }
+        if (!SDL_AtomicCAS(&SDL_EventRing.enqueue_pos, (int)pos, (int)(pos + want))) {
+            continue;
+        }
+
+        for (i = 0; i < want; ++i) {
+            const SDL_Event *event = &events[published + i];
+            SDL_EventSlot *slot = &SDL_EventRing.slots[(pos + i) & SDL_EVENT_RING_MASK];
+
+            slot->event = *event;
+            if (event->type == SDL_SYSWMEVENT) {
+                slot->msg = *event->syswm.msg;
+            }
+            SDL_SetEventSlotSequence(pos + i, pos + i + 1);
+        }
+        published += (int)want;
+    }
+    return published;
+}
+
+/* Add events to the event queue -- called without the queue locked */
+static int
+SDL_AddEvents(const SDL_Event * events, int numevents)
+{
+    const int initial_count = SDL_AtomicAdd(&SDL_EventQ.count, numevents);
+    int added, i;
+
+    /* Reserve room first, so the limit holds however many threads are pushing */
+    if (initial_count + numevents > SDL_MAX_QUEUED_EVENTS) {
+        const int room = SDL_max(SDL_MAX_QUEUED_EVENTS - initial_count, 0);
+        SDL_AtomicAdd(&SDL_EventQ.count, room - numevents);
+        SDL_SetError("Event queue is full (%d events)", initial_count);
+        numevents = room;
+    }
+
+    if (SDL_DoEventLogging) {
+        for (i = 0; i < numevents; ++i) {
+            SDL_LogEvent(&events[i]);
+        }
+    }
+
+    added = SDL_PublishEvents(events, numevents);
+    while (added < numevents) {
+        /* The ring is full: move it onto the list and try again. Queueing
+           the rest directly could overtake events of ours that are still
+           in the ring behind a slot another producer hasn't filled yet. */
+        Uint32 drained;
+        if (SDL_EventQ.lock && SDL_LockMutex(SDL_EventQ.lock) < 0) {
+            break;
+        }
+        drained = SDL_EventRing.dequeue_pos;
+        SDL_DrainEventRing();
+        drained = SDL_EventRing.dequeue_pos - drained;
+        if (SDL_EventQ.lock) {
+            SDL_UnlockMutex(SDL_EventQ.lock);
+        }
+        if (!drained) {
+            SDL_Delay(0);  /* waiting for that producer to finish its slot */
+        }
+        added += SDL_PublishEvents(&events[added], numevents - added);
+    }
+    if (added < numevents) {
+        SDL_AtomicAdd(&SDL_EventQ.count, added - numevents);
+    }
+    if (added > 0) {
+        SDL_WakeEventWaiters();
+    }
+    return added;
 }
 
 /* Remove an event from the queue -- called with the queue locked */
@@ -543,7 +737,10 @@ int
 SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
                Uint32 minType, Uint32 maxType)
 {
-    int i, used;
+    SDL_EventEntry *entry, *next;
+    SDL_SysWMEntry *wmmsg, *wmmsg_next;
+    Uint32 type;
+    int used;
 
     /* Don't look after we've quit */
     if (!SDL_AtomicGet(&SDL_EventQ.active)) {
@@ -553,59 +750,55 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
         }
         return (-1);
     }
+    if (action == SDL_ADDEVENT) {
+        return (numevents > 0) ? SDL_AddEvents(events, numevents) : 0;
+    }
+
     /* Lock the event queue */
     used = 0;
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
-        if (action == SDL_ADDEVENT) {
-            for (i = 0; i < numevents; ++i) {
-                used += SDL_AddEvent(&events[i]);
-            }
-        } else {
-            SDL_EventEntry *entry, *next;
-            SDL_SysWMEntry *wmmsg, *wmmsg_next;
-            Uint32 type;
-
-            if (action == SDL_GETEVENT) {
-                /* Clean out any used wmmsg data
-                   FIXME: Do we want to retain the data for some period of time?
-                 */
-                for (wmmsg = SDL_EventQ.wmmsg_used; wmmsg; wmmsg = wmmsg_next) {
-                    wmmsg_next = wmmsg->next;
-                    wmmsg->next = SDL_EventQ.wmmsg_free;
-                    SDL_EventQ.wmmsg_free = wmmsg;
-                }
-                SDL_EventQ.wmmsg_used = NULL;
+        SDL_DrainEventRing();
+
+        if (action == SDL_GETEVENT) {
+            /* Clean out any used wmmsg data
+               FIXME: Do we want to retain the data for some period of time?
+             */
+            for (wmmsg = SDL_EventQ.wmmsg_used; wmmsg; wmmsg = wmmsg_next) {
+                wmmsg_next = wmmsg->next;
+                wmmsg->next = SDL_EventQ.wmmsg_free;
+                SDL_EventQ.wmmsg_free = wmmsg;
             }
+            SDL_EventQ.wmmsg_used = NULL;
+        }
 
-            for (entry = SDL_EventQ.head; entry && (!events || used < numevents); entry = next) {
-                next = entry->next;
-                type = entry->event.type;
-                if (minType <= type && type <= maxType) {
-                    if (events) {
-                        events[used] = entry->event;
-                        if (entry->event.type == SDL_SYSWMEVENT) {
-                            /* We need to copy the wmmsg somewhere safe.
-                               For now we'll guarantee it's valid at least until
-                               the next call to SDL_PeepEvents()
-                             */
-                            if (SDL_EventQ.wmmsg_free) {
-                                wmmsg = SDL_EventQ.wmmsg_free;
-                                SDL_EventQ.wmmsg_free = wmmsg->next;
-                            } else {
-                                wmmsg = (SDL_SysWMEntry *)SDL_malloc(sizeof(*wmmsg));
-                            }
-                            wmmsg->msg = *entry->event.syswm.msg;
-                            wmmsg->next = SDL_EventQ.wmmsg_used;
-                            SDL_EventQ.wmmsg_used = wmmsg;
-                            events[used].syswm.msg = &wmmsg->msg;
+        for (entry = SDL_EventQ.head; entry && (!events || used < numevents); entry = next) {
+            next = entry->next;
+            type = entry->event.type;
+            if (minType <= type && type <= maxType) {
+                if (events) {
+                    events[used] = entry->event;
+                    if (entry->event.type == SDL_SYSWMEVENT) {
+                        /* We need to copy the wmmsg somewhere safe.
+                           For now we'll guarantee it's valid at least until
+                           the next call to SDL_PeepEvents()
+                         */
+                        if (SDL_EventQ.wmmsg_free) {
+                            wmmsg = SDL_EventQ.wmmsg_free;
+                            SDL_EventQ.wmmsg_free = wmmsg->next;
+                        } else {
+                            wmmsg = (SDL_SysWMEntry *)SDL_malloc(sizeof(*wmmsg));
                         }
+                        wmmsg->msg = *entry->event.syswm.msg;
+                        wmmsg->next = SDL_EventQ.wmmsg_used;
+                        SDL_EventQ.wmmsg_used = wmmsg;
+                        events[used].syswm.msg = &wmmsg->msg;
+                    }
 
-                        if (action == SDL_GETEVENT) {
-                            SDL_CutEvent(entry);
-                        }
+                    if (action == SDL_GETEVENT) {
+                        SDL_CutEvent(entry);
                     }
-                    ++used;
                 }
+                ++used;
             }
         }
         if (SDL_EventQ.lock) {
@@ -659,6 +852,7 @@ SDL_FlushEvents(Uint32 minType, Uint32 maxType)
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
         Uint32 type;
+        SDL_DrainEventRing();
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             type = entry->event.type;
@@ -678,6 +872,8 @@ SDL_PumpEvents(void)
 {
     SDL_VideoDevice *_this = SDL_GetVideoDevice();
 
+    SDL_TRACE_BEGIN("SDL_PumpEvents");
+
     /* Get events from the video subsystem */
     if (_this) {
         _this->PumpEvents(_this);
@@ -697,6 +893,80 @@ SDL_PumpEvents(void)
 #endif
 
     SDL_SendPendingSignalEvents();  /* in case we had a signal handler fire, etc. */
+
+    SDL_TRACE_COUNTER("SDL_EventQ.count", SDL_AtomicGet(&SDL_EventQ.count));
+    SDL_TRACE_END();
+}
+
+/* Wake anything sleeping in SDL_WaitEventTimeout(). The counter lets a
+   waiter notice wakeups that came in after it last looked at the queue
+   but before it went to sleep. */
+void
+SDL_WakeEventWaiters(void)
+{
+    SDL_AtomicIncRef(&SDL_EventQ.wakeups);
+    if (SDL_AtomicGet(&SDL_EventQ.waiters) > 0 && SDL_EventQ.wait_lock) {
+        SDL_LockMutex(SDL_EventQ.wait_lock);
+        SDL_CondBroadcast(SDL_EventQ.wait_cond);
+        SDL_UnlockMutex(SDL_EventQ.wait_lock);
+    }
+}
+
+/* Input that only shows up when polled, so waiting has to wake up for it */
+static SDL_bool
+SDL_EventsNeedPolling(void)
+{
+    SDL_VideoDevice *_this = SDL_GetVideoDevice();
+
+    if (_this && !_this->wakes_event_waiters) {
+        return SDL_TRUE;
+    }
+#if !SDL_JOYSTICK_DISABLED
+    if (SDL_WasInit(SDL_INIT_JOYSTICK) &&
+        (!SDL_disabled_events[SDL_JOYAXISMOTION >> 8] || SDL_JoystickEventState(SDL_QUERY)) &&
+        SDL_NumJoysticks() > 0) {
+        return SDL_TRUE;
+    }
+#endif
+#if !SDL_SENSOR_DISABLED
+    if (SDL_WasInit(SDL_INIT_SENSOR) && !SDL_disabled_events[SDL_SENSORUPDATE >> 8] &&
+        SDL_NumSensors() > 0) {
+        return SDL_TRUE;
+    }
+#endif
+    return SDL_FALSE;
+}
+
+/* Longest a wait sleeps before pumping again for pending signal events */
+#define SDL_EVENT_WAIT_MAX_MS   100
+
+/* Sleep until SDL_WakeEventWaiters() is called after the wakeup count was
+   'wakeups', or timeout milliseconds pass (forever if negative) */
+static void
+SDL_WaitForEvents(int wakeups, int timeout)
+{
+    if (SDL_EventsNeedPolling()) {
+        timeout = (timeout < 0) ? 1 : SDL_min(timeout, 1);
+    } else if (timeout < 0 || timeout > SDL_EVENT_WAIT_MAX_MS) {
+        /* Quit signals can't wake us from the handler, look for them now and then */
+        timeout = SDL_EVENT_WAIT_MAX_MS;
+    }
+    if (!SDL_EventQ.wait_lock) {
+        SDL_Delay(timeout < 0 ? 1 : timeout);
+        return;
+    }
+
+    SDL_LockMutex(SDL_EventQ.wait_lock);
+    SDL_AtomicIncRef(&SDL_EventQ.waiters);
+    if (SDL_AtomicGet(&SDL_EventQ.wakeups) == wakeups) {
+        if (timeout < 0) {
+            SDL_CondWait(SDL_EventQ.wait_cond, SDL_EventQ.wait_lock);
+        } else {
+            SDL_CondWaitTimeout(SDL_EventQ.wait_cond, SDL_EventQ.wait_lock, (Uint32)timeout);
+        }
+    }
+    SDL_AtomicAdd(&SDL_EventQ.waiters, -1);
+    SDL_UnlockMutex(SDL_EventQ.wait_lock);
 }
 
 /* Public functions */
@@ -722,6 +992,9 @@ SDL_WaitEventTimeout(SDL_Event * event, int timeout)
         expiration = SDL_GetTicks() + timeout;
 
     for (;;) {
+        /* Taken before looking, so anything arriving after this wakes us */
+        const int wakeups = SDL_AtomicGet(&SDL_EventQ.wakeups);
+
         SDL_PumpEvents();
         switch (SDL_PeepEvents(event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT)) {
         case -1:
@@ -731,11 +1004,16 @@ SDL_WaitEventTimeout(SDL_Event * event, int timeout)
                 /* Polling and no events, just return */
                 return 0;
             }
-            if (timeout > 0 && SDL_TICKS_PASSED(SDL_GetTicks(), expiration)) {
-                /* Timeout expired and no events */
-                return 0;
+            if (timeout > 0) {
+                const Uint32 now = SDL_GetTicks();
+                if (SDL_TICKS_PASSED(now, expiration)) {
+                    /* Timeout expired and no events */
+                    return 0;
+                }
+                SDL_WaitForEvents(wakeups, (int)(expiration - now));
+            } else {
+                SDL_WaitForEvents(wakeups, -1);
             }
-            SDL_Delay(1);
             break;
         default:
             /* Has events */
@@ -744,18 +1022,17 @@ SDL_WaitEventTimeout(SDL_Event * event, int timeout)
     }
 }
 
-int
-SDL_PushEvent(SDL_Event * event)
+/* Run the event filter and watchers, returns SDL_FALSE if the event was filtered out */
+static SDL_bool
+SDL_DispatchEventWatchers(SDL_Event * event)
 {
-    event->common.timestamp = SDL_GetTicks();
-
     if (SDL_EventOK.callback || SDL_event_watchers_count > 0) {
         if (!SDL_event_watchers_lock || SDL_LockMutex(SDL_event_watchers_lock) == 0) {
             if (SDL_EventOK.callback && !SDL_EventOK.callback(SDL_EventOK.userdata, event)) {
                 if (SDL_event_watchers_lock) {
                     SDL_UnlockMutex(SDL_event_watchers_lock);
                 }
-                return 0;
+                return SDL_FALSE;
             }
 
             if (SDL_event_watchers_count > 0) {
@@ -788,6 +1065,17 @@ SDL_PushEvent(SDL_Event * event)
             }
         }
     }
+    return SDL_TRUE;
+}
+
+int
+SDL_PushEvent(SDL_Event * event)
+{
+    event->common.timestamp = SDL_GetTicks();
+
+    if (!SDL_DispatchEventWatchers(event)) {
+        return 0;
+    }
 
     if (SDL_PeepEvents(event, 1, SDL_ADDEVENT, 0, 0) <= 0) {
         return -1;
@@ -798,6 +1086,49 @@ SDL_PushEvent(SDL_Event * event)
     return 1;
 }
 
+int
+SDL_PushEvents(SDL_Event * events, int numevents)
+{
+    const Uint32 timestamp = SDL_GetTicks();
+    SDL_Event *batch = events;
+    int i, kept = 0, added;
+
+    if (!events || numevents < 0) {
+        return SDL_InvalidParamError("events");
+    }
+
+    for (i = 0; i < numevents; ++i) {
+        events[i].common.timestamp = timestamp;
+    }
+
+    /* Filtered events are dropped, the rest are queued in one go */
+    if (numevents > 0 && (SDL_EventOK.callback || SDL_event_watchers_count > 0)) {
+        batch = (SDL_Event *)SDL_malloc(numevents * sizeof(*batch));
+        if (!batch) {
+            return SDL_OutOfMemory();
+        }
+        for (i = 0; i < numevents; ++i) {
+            if (SDL_DispatchEventWatchers(&events[i])) {
+                batch[kept++] = events[i];
+            }
+        }
+    } else {
+        kept = numevents;
+    }
+
+    added = (kept > 0) ? SDL_PeepEvents(batch, kept, SDL_ADDEVENT, 0, 0) : 0;
+    for (i = 0; i < added; ++i) {
+        SDL_GestureProcessEvent(&batch[i]);
+    }
+    if (batch != events) {
+        SDL_free(batch);
+    }
+    if (added < 0 || (added == 0 && kept > 0)) {
+        return -1;
+    }
+    return added;
+}
+
 void
 SDL_SetEventFilter(SDL_EventFilter filter, void *userdata)
 {
@@ -893,6 +1224,7 @@ SDL_FilterEvents(SDL_EventFilter filter, void *userdata)
 {
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
+        SDL_DrainEventRing();
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             if (!filter(userdata, &entry->event)) {
@@ -54,6 +54,9 @@ extern void SDL_EventsQuit(void);
 
 extern void SDL_SendPendingSignalEvents(void);
 
+/* Wake threads blocked in SDL_WaitEventTimeout() so they pump again */
+extern void SDL_WakeEventWaiters(void);
+
 extern int SDL_QuitInit(void);
 extern void SDL_QuitQuit(void);
 
@@ -0,0 +1,602 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+/* Asynchronous reads on top of SDL_RWops, serviced by a small I/O thread pool. */
+
+#include "SDL_rwops.h"
+#include "SDL_atomic.h"
+#include "SDL_events.h"
+#include "SDL_hints.h"
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
+#include "SDL_timer.h"
+#include "SDL_rwops_c.h"
+
+#define RWASYNC_DEFAULT_THREADS 2
+#define RWASYNC_MAX_THREADS     16
+
+/* Requests on one RWops must not overlap, they share its file position.
+   Contexts are hashed onto a few locks instead of tracking each one. */
+#define RWASYNC_CONTEXT_LOCKS   32
+
+typedef struct SDL_RWAsyncJob
+{
+    SDL_RWAsyncRead request;
+    SDL_RWAsyncResult result;
+    Uint32 flags;
+    struct SDL_RWAsyncJob *next;
+} SDL_RWAsyncJob;
+
+typedef struct SDL_RWAsyncQueue
+{
+    SDL_RWAsyncJob *head;
+    SDL_RWAsyncJob *tail;
+} SDL_RWAsyncQueue;
+
+static SDL_SpinLock rwasync_init_lock = 0;
+static SDL_atomic_t rwasync_initialized;
+static SDL_mutex *rwasync_lock = NULL;
+static SDL_cond *rwasync_job_cond = NULL;
+static SDL_cond *rwasync_done_cond = NULL;
+static SDL_RWAsyncQueue rwasync_jobs;
+static SDL_RWAsyncQueue rwasync_done;
+static SDL_bool rwasync_shutdown = SDL_FALSE;
+static SDL_Thread *rwasync_threads[RWASYNC_MAX_THREADS];
+static int rwasync_num_threads = 0;
+static SDL_mutex *rwasync_context_locks[RWASYNC_CONTEXT_LOCKS];
+static Uint32 rwasync_event_type = 0;
+
+static void
+RWAsync_Push(SDL_RWAsyncQueue *queue, SDL_RWAsyncJob *job)
+{
+    job->next = NULL;
+    if (queue->tail) {
+        queue->tail->next = job;
+    } else {
+        queue->head = job;
+    }
+    queue->tail = job;
+}
+
+static SDL_RWAsyncJob *
+RWAsync_Pop(SDL_RWAsyncQueue *queue)
+{
+    SDL_RWAsyncJob *job = queue->head;
+    if (job) {
+        queue->head = job->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+        }
+    }
+    return job;
+}
+
+static SDL_mutex *
+RWAsync_ContextLock(SDL_RWops *context)
+{
+    const size_t hash = ((size_t)context) >> 4;
+    return rwasync_context_locks[(hash ^ (hash >> 7)) % RWASYNC_CONTEXT_LOCKS];
+}
+
+static void
+RWAsync_Execute(SDL_RWAsyncJob *job)
+{
+    const SDL_RWAsyncRead *request = &job->request;
+    SDL_RWAsyncResult *result = &job->result;
+    SDL_mutex *lock = RWAsync_ContextLock(request->context);
+
+    result->context = request->context;
+    result->offset = request->offset;
+    result->buffer = request->buffer;
+    result->requested = request->size;
+    result->completed = 0;
+    result->status = 0;
+    result->userdata = request->userdata;
+
+    SDL_LockMutex(lock);
+    if (SDL_RWseek(request->context, request->offset, RW_SEEK_SET) < 0) {
+        result->status = -1;
+    } else {
+        while (result->completed < request->size) {
+            size_t got = SDL_RWread(request->context, (Uint8 *)request->buffer + result->completed,
+                                    1, request->size - result->completed);
+            if (got == 0 || got == (size_t)-1) {
+                break;
+            }
+            result->completed += got;
+        }
+    }
+    SDL_UnlockMutex(lock);
+}
+
+static int SDLCALL
+RWAsync_Thread(void *data)
+{
+    for ( ; ; ) {
+        SDL_RWAsyncJob *job;
+
+        SDL_LockMutex(rwasync_lock);
+        while (!rwasync_jobs.head && !rwasync_shutdown) {
+            SDL_CondWait(rwasync_job_cond, rwasync_lock);
+        }
+        job = RWAsync_Pop(&rwasync_jobs);
+        SDL_UnlockMutex(rwasync_lock);
+        if (!job) {
+            break;  /* shutting down and the queue is drained */
+        }
+
+        RWAsync_Execute(job);
+
+        if (job->request.callback) {
+            job->request.callback(&job->result);
+        }
+        if ((job->flags & SDL_RWASYNC_EVENT) && rwasync_event_type != (Uint32)-1) {
+            SDL_Event event;
+            SDL_zero(event);
+            event.type = rwasync_event_type;
+            event.user.code = job->result.status;
+            event.user.data1 = job->result.userdata;
+            event.user.data2 = job->result.buffer;
+            SDL_PushEvent(&event);
+        }
+        if (job->flags & SDL_RWASYNC_POLL) {
+            SDL_LockMutex(rwasync_lock);
+            RWAsync_Push(&rwasync_done, job);
+            SDL_CondBroadcast(rwasync_done_cond);
+            SDL_UnlockMutex(rwasync_lock);
+        } else {
+            SDL_free(job);
+        }
+    }
+    return 0;
+}
+
+static int
+RWAsync_Init(void)
+{
+    const char *hint;
+    int i;
+
+    if (SDL_AtomicGet(&rwasync_initialized)) {
+        return 0;
+    }
+
+    SDL_AtomicLock(&rwasync_init_lock);
+    if (SDL_AtomicGet(&rwasync_initialized)) {
+        SDL_AtomicUnlock(&rwasync_init_lock);
+        return 0;
+    }
+
+    rwasync_lock = SDL_CreateMutex();
+    rwasync_job_cond = SDL_CreateCond();
+    rwasync_done_cond = SDL_CreateCond();
+    SDL_SetMutexName(rwasync_lock, "rwasync_lock");
+    SDL_SetCondName(rwasync_job_cond, "rwasync_job_cond");
+    SDL_SetCondName(rwasync_done_cond, "rwasync_done_cond");
+    for (i = 0; i < RWASYNC_CONTEXT_LOCKS; ++i) {
+        rwasync_context_locks[i] = SDL_CreateMutex();
+    }
+    rwasync_shutdown = SDL_FALSE;
+    rwasync_event_type = SDL_RegisterEvents(1);
+
+    rwasync_num_threads = RWASYNC_DEFAULT_THREADS;
+    hint = SDL_GetHint(SDL_HINT_RWASYNC_THREADS);
+    if (hint && *hint) {
+        rwasync_num_threads = SDL_atoi(hint);
+    }
+    rwasync_num_threads = SDL_max(1, SDL_min(rwasync_num_threads, RWASYNC_MAX_THREADS));
+
+    for (i = 0; i < rwasync_num_threads; ++i) {
+        rwasync_threads[i] = SDL_CreateThread(RWAsync_Thread, "SDLRWAsync", NULL);
+        if (!rwasync_threads[i]) {
+            break;
+        }
+    }
+    rwasync_num_threads = i;
+
+    if (rwasync_num_threads == 0 || !rwasync_lock || !rwasync_job_cond || !rwasync_done_cond) {
+        SDL_AtomicUnlock(&rwasync_init_lock);
+        SDL_RWAsyncQuit();
+        return SDL_SetError("Couldn't start the asynchronous I/O threads");
+    }
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&rwasync_initialized, 1);
+    SDL_AtomicUnlock(&rwasync_init_lock);
+    return 0;
+}
+
+void
+SDL_RWAsyncQuit(void)
+{
+    SDL_RWAsyncJob *job;
+    int i;
+
+    if (rwasync_lock) {
+        SDL_LockMutex(rwasync_lock);
+        rwasync_shutdown = SDL_TRUE;
+        SDL_CondBroadcast(rwasync_job_cond);
+        SDL_UnlockMutex(rwasync_lock);
+    }
+    for (i = 0; i < rwasync_num_threads; ++i) {
+        SDL_WaitThread(rwasync_threads[i], NULL);
+        rwasync_threads[i] = NULL;
+    }
+    rwasync_num_threads = 0;
+
+    while ((job = RWAsync_Pop(&rwasync_done)) != NULL) {
+        SDL_free(job);
+    }
+    for (i = 0; i < RWASYNC_CONTEXT_LOCKS; ++i) {
+        if (rwasync_context_locks[i]) {
+            SDL_DestroyMutex(rwasync_context_locks[i]);
+            rwasync_context_locks[i] = NULL;
+        }
+    }
+    if (rwasync_done_cond) {
+        SDL_DestroyCond(rwasync_done_cond);
+        rwasync_done_cond = NULL;
+    }
+    if (rwasync_job_cond) {
+        SDL_DestroyCond(rwasync_job_cond);
+        rwasync_job_cond = NULL;
+    }
+    if (rwasync_lock) {
+        SDL_DestroyMutex(rwasync_lock);
+        rwasync_lock = NULL;
+    }
+    rwasync_event_type = 0;
+    SDL_AtomicSet(&rwasync_initialized, 0);
+}
+
+int
+SDL_RWReadAsync(const SDL_RWAsyncRead *requests, int count, Uint32 flags)
+{
+    SDL_RWAsyncQueue batch = { NULL, NULL };
+    SDL_RWAsyncJob *job;
+    int i;
+
+    if (!requests || count < 0) {
+        return SDL_InvalidParamError("requests");
+    }
+    for (i = 0; i < count; ++i) {
+        if (!requests[i].context || (!requests[i].buffer && requests[i].size > 0) || requests[i].offset < 0) {
+            return SDL_InvalidParamError("requests");
+        }
+    }
+    if (RWAsync_Init() < 0) {
+        return -1;
+    }
+
+    /* Allocate everything first so a batch is either queued whole or not at all. */
+    for (i = 0; i < count; ++i) {
+        job = (SDL_RWAsyncJob *)SDL_malloc(sizeof (*job));
+        if (!job) {
+            while ((job = RWAsync_Pop(&batch)) != NULL) {
+                SDL_free(job);
+            }
+            return SDL_OutOfMemory();
+        }
+        job->request = requests[i];
+        job->flags = flags;
+        RWAsync_Push(&batch, job);
+    }
+
+    if (batch.head) {
+        SDL_LockMutex(rwasync_lock);
+        if (rwasync_jobs.tail) {
+            rwasync_jobs.tail->next = batch.head;
+        } else {
+            rwasync_jobs.head = batch.head;
+        }
+        rwasync_jobs.tail = batch.tail;
+        SDL_CondBroadcast(rwasync_job_cond);
+        SDL_UnlockMutex(rwasync_lock);
+    }
+    return 0;
+}
+
+SDL_bool
+SDL_RWAsyncWait(SDL_RWAsyncResult *result, Sint32 timeout)
+{
+    SDL_RWAsyncJob *job;
+
+    if (!result) {
+        SDL_InvalidParamError("result");
+        return SDL_FALSE;
+    }
+    if (!SDL_AtomicGet(&rwasync_initialized)) {
+        return SDL_FALSE;
+    }
+
+    SDL_LockMutex(rwasync_lock);
+    if (!rwasync_done.head && timeout != 0) {
+        if (timeout < 0) {
+            while (!rwasync_done.head) {
+                SDL_CondWait(rwasync_done_cond, rwasync_lock);
+            }
+        } else {
+            const Uint32 deadline = SDL_GetTicks() + (Uint32)timeout;
+            while (!rwasync_done.head) {
+                const Uint32 now = SDL_GetTicks();
+                if (SDL_TICKS_PASSED(now, deadline)) {
+                    break;
+                }
+                SDL_CondWaitTimeout(rwasync_done_cond, rwasync_lock, deadline - now);
+            }
+        }
+    }
+    job = RWAsync_Pop(&rwasync_done);
+    SDL_UnlockMutex(rwasync_lock);
+
+    if (!job) {
+        return SDL_FALSE;
+    }
+    *result = job->result;
+    SDL_free(job);
+    return SDL_TRUE;
+}
+
+Uint32
+SDL_RWAsyncEventType(void)
+{
+    if (RWAsync_Init() < 0) {
+        return (Uint32)-1;
+    }
+    return rwasync_event_type;
+}
+
+
+/* Read-ahead: two windows, one being consumed while the other is filled. */
+
+typedef struct SDL_RWReadAheadData
+{
+    SDL_RWops *src;
+    int freesrc;
+    size_t window;
+    Uint8 *buffers[2];
+    int current;
+    Sint64 bufferOffset;    /* stream offset of buffers[current][0] */
+    size_t bufferLength;
+    size_t bufferPos;
+    SDL_bool pending;       /* buffers[!current] is being filled */
+    Sint64 pendingOffset;
+    size_t pendingLength;
+    int pendingStatus;
+    SDL_sem *pendingDone;
+} SDL_RWReadAheadData;
+
+static void SDLCALL
+ReadAhead_Completed(const SDL_RWAsyncResult *result)
+{
+    SDL_RWReadAheadData *data = (SDL_RWReadAheadData *)result->userdata;
+    data->pendingLength = result->completed;
+    data->pendingStatus = result->status;
+    SDL_SemPost(data->pendingDone);
+}
+
+static void
+ReadAhead_Start(SDL_RWReadAheadData *data, Sint64 offset)
+{
+    SDL_RWAsyncRead request;
+
+    request.context = data->src;
+    request.offset = offset;
+    request.buffer = data->buffers[!data->current];
+    request.size = data->window;
+    request.callback = ReadAhead_Completed;
+    request.userdata = data;
+    data->pendingOffset = offset;
+    data->pending = (SDL_RWReadAsync(&request, 1, 0) == 0) ? SDL_TRUE : SDL_FALSE;
+}
+
+static void
+ReadAhead_Finish(SDL_RWReadAheadData *data)
+{
+    if (data->pending) {
+        SDL_SemWait(data->pendingDone);
+        data->pending = SDL_FALSE;
+    }
+}
+
+static Sint64 SDLCALL
+ReadAhead_size(SDL_RWops *context)
+{
+    SDL_RWReadAheadData *data = (SDL_RWReadAheadData *)context->hidden.unknown.data1;
+    SDL_mutex *lock = RWAsync_ContextLock(data->src);
+    Sint64 size;
+
+    SDL_LockMutex(lock);
+    size = SDL_RWsize(data->src);
+    SDL_UnlockMutex(lock);
+    return size;
+}
+
+static Sint64 SDLCALL
+ReadAhead_seek(SDL_RWops *context, Sint64 offset, int whence)
+{
+    SDL_RWReadAheadData *data = (SDL_RWReadAheadData *)context->hidden.unknown.data1;
+    Sint64 target;
+
+    switch (whence) {
+    case RW_SEEK_SET:
+        target = offset;
+        break;
+    case RW_SEEK_CUR:
+        target = data->bufferOffset + (Sint64)data->bufferPos + offset;
+        break;
+    case RW_SEEK_END: {
+        const Sint64 size = ReadAhead_size(context);
+        if (size < 0) {
+            return -1;
+        }
+        target = size + offset;
+        break;
+    }
+    default:
+        return SDL_SetError("Unknown value for 'whence'");
+    }
+    if (target < 0) {
+        return SDL_Error(SDL_EFSEEK);
+    }
+
+    if (target >= data->bufferOffset && target <= data->bufferOffset + (Sint64)data->bufferLength) {
+        data->bufferPos = (size_t)(target - data->bufferOffset);
+        return target;
+    }
+
+    /* Outside the current window: drop it and restart the read-ahead there. */
+    ReadAhead_Finish(data);
+    data->bufferOffset = target;
+    data->bufferLength = 0;
+    data->bufferPos = 0;
+    ReadAhead_Start(data, target);
+    return target;
+}
+
+static size_t SDLCALL
+ReadAhead_read(SDL_RWops *context, void *ptr, size_t size, size_t maxnum)
+{
+    SDL_RWReadAheadData *data = (SDL_RWReadAheadData *)context->hidden.unknown.data1;
+    const size_t total = size * maxnum;
+    size_t copied = 0;
+
+    if (size == 0 || maxnum == 0) {
+        return 0;
+    }
+
+    while (copied < total) {
+        if (data->bufferPos < data->bufferLength) {
+            const size_t len = SDL_min(total - copied, data->bufferLength - data->bufferPos);
+            SDL_memcpy((Uint8 *)ptr + copied, data->buffers[data->current] + data->bufferPos, len);
+            data->bufferPos += len;
+            copied += len;
+            continue;
+        }
+
+        /* Current window used up, switch to the one read in the background. */
+        if (!data->pending) {
+            ReadAhead_Start(data, data->bufferOffset + (Sint64)data->bufferLength);
+            if (!data->pending) {
+                break;
+            }
+        }
+        ReadAhead_Finish(data);
+        if (data->pendingStatus < 0 || data->pendingLength == 0) {
+            break;
+        }
+        data->current = !data->current;
+        data->bufferOffset = data->pendingOffset;
+        data->bufferLength = data->pendingLength;
+        data->bufferPos = 0;
+        if (data->pendingLength == data->window) {
+            ReadAhead_Start(data, data->bufferOffset + (Sint64)data->bufferLength);
+        }
+    }
+    return copied / size;
+}
+
+static size_t SDLCALL
+ReadAhead_write(SDL_RWops *context, const void *ptr, size_t size, size_t num)
+{
+    SDL_SetError("Can't write to read-ahead stream");
+    return 0;
+}
+
+static int SDLCALL
+ReadAhead_close(SDL_RWops *context)
+{
+    SDL_RWReadAheadData *data = (SDL_RWReadAheadData *)context->hidden.unknown.data1;
+    int status = 0;
+
+    ReadAhead_Finish(data);
+    if (data->freesrc) {
+        status = SDL_RWclose(data->src);
+    }
+    SDL_DestroySemaphore(data->pendingDone);
+    SDL_free(data->buffers[0]);
+    SDL_free(data);
+    SDL_FreeRW(context);
+    return status;
+}
+
+SDL_RWops *
+SDL_RWFromReadAhead(SDL_RWops *src, size_t window, int freesrc)
+{
+    SDL_RWReadAheadData *data;
+    SDL_RWops *rwops;
+    Sint64 position;
+
+    if (!src) {
+        SDL_InvalidParamError("src");
+        return NULL;
+    }
+    if (window == 0) {
+        SDL_InvalidParamError("window");
+        return NULL;
+    }
+    position = SDL_RWtell(src);
+    if (position < 0) {
+        position = 0;
+    }
+
+    data = (SDL_RWReadAheadData *)SDL_calloc(1, sizeof (*data));
+    rwops = SDL_AllocRW();
+    if (!data || !rwops) {
+        SDL_free(data);
+        if (rwops) {
+            SDL_FreeRW(rwops);
+        }
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    data->buffers[0] = (Uint8 *)SDL_malloc(window * 2);
+    data->pendingDone = SDL_CreateSemaphore(0);
+    if (!data->buffers[0] || !data->pendingDone) {
+        SDL_free(data->buffers[0]);
+        if (data->pendingDone) {
+            SDL_DestroySemaphore(data->pendingDone);
+        }
+        SDL_free(data);
+        SDL_FreeRW(rwops);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    data->buffers[1] = data->buffers[0] + window;
+    data->src = src;
+    data->freesrc = freesrc;
+    data->window = window;
+    data->bufferOffset = position;
+
+    rwops->size = ReadAhead_size;
+    rwops->seek = ReadAhead_seek;
+    rwops->read = ReadAhead_read;
+    rwops->write = ReadAhead_write;
+    rwops->close = ReadAhead_close;
+    rwops->type = SDL_RWOPS_UNKNOWN;
+    rwops->hidden.unknown.data1 = data;
+
+    ReadAhead_Start(data, position);
+    return rwops;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -28,6 +28,7 @@
 #include "SDL_render.h"
 #include "SDL_sysrender.h"
 #include "software/SDL_render_sw_c.h"
+#include "../SDL_trace_c.h"
 #ifdef __OHOS__
 #include "../core/ohos/SDL_ohos.h"
 #endif
@@ -220,6 +221,7 @@ FlushRenderCommands(SDL_Renderer *renderer)
         return 0;
     }
 
+    SDL_TRACE_BEGIN("FlushRenderCommands");
     DebugLogRenderCommands(renderer->render_commands);
 
     retval = renderer->RunCommandQueue(renderer, renderer->render_commands, renderer->vertex_data, renderer->vertex_data_used);
@@ -236,6 +238,7 @@ FlushRenderCommands(SDL_Renderer *renderer)
     renderer->color_queued = SDL_FALSE;
     renderer->viewport_queued = SDL_FALSE;
     renderer->cliprect_queued = SDL_FALSE;
+    SDL_TRACE_END();
     return retval;
 }
 
@@ -858,6 +861,7 @@ SDL_CreateRenderer(SDL_Window * window, int index, Uint32 flags)
     renderer->magic = &renderer_magic;
     renderer->window = window;
     renderer->target_mutex = SDL_CreateMutex();
+    SDL_SetMutexName(renderer->target_mutex, "SDL_Renderer.target_mutex");
     renderer->scale.x = 1.0f;
     renderer->scale.y = 1.0f;
     renderer->dpi_scale.x = 1.0f;
@@ -921,6 +925,8 @@ SDL_CreateSoftwareRenderer(SDL_Surface * surface)
         VerifyDrawQueueFunctions(renderer);
         renderer->magic = &renderer_magic;
         renderer->target_mutex = SDL_CreateMutex();
+        SDL_SetMutexName(renderer->target_mutex, "SDL_Renderer.target_mutex");
+    SDL_SetMutexName(renderer->target_mutex, "SDL_Renderer.target_mutex");
         renderer->scale.x = 1.0f;
         renderer->scale.y = 1.0f;
 
@@ -3162,13 +3168,14 @@ SDL_RenderPresent(SDL_Renderer * renderer)
 {
     CHECK_RENDERER_MAGIC(renderer, );
 
+    SDL_TRACE_BEGIN("SDL_RenderPresent");
     FlushRenderCommands(renderer);  /* time to send everything to the GPU! */
 
     /* Don't present while we're hidden */
-    if (renderer->hidden) {
-        return;
+    if (!renderer->hidden) {
+        renderer->RenderPresent(renderer);
     }
-    renderer->RenderPresent(renderer);
+    SDL_TRACE_END();
 }
 
 void
@@ -25,6 +25,7 @@
 #include "../SDL_sysrender.h"
 #include "SDL_render_sw_c.h"
 #include "SDL_hints.h"
+#include "SDL_jobs.h"
 #include "SDL_assert.h"
 
 #include "SDL_draw.h"
@@ -34,9 +35,45 @@
 #include "SDL_drawline.h"
 #include "SDL_drawpoint.h"
 #include "SDL_rotate.h"
+#include "../../video/SDL_pixels_c.h"
+#include "../../SDL_trace_c.h"
 
 /* SDL surface based renderer implementation */
 
+/* Clears, points, rectangle fills and unscaled copies are queued up as
+   tile items and drawn in bands of SW_TILE_HEIGHT rows on the job system's
+   worker threads. Each band draws whole rows of every item that touches
+   it, so the blitters see exactly the row spans they would in a serial
+   draw and the output is the same. Batches touching fewer than
+   SW_TILE_MIN_PIXELS pixels are drawn on the calling thread. */
+#define SW_TILE_HEIGHT      32
+#define SW_TILE_MIN_PIXELS  (256 * 256)
+#define SW_TILE_MAX_POINTS  64
+
+typedef enum
+{
+    SW_TILE_FILL_RECT,
+    SW_TILE_BLEND_RECT,
+    SW_TILE_DRAW_POINTS,
+    SW_TILE_BLEND_POINTS,
+    SW_TILE_COPY
+} SW_TileOp;
+
+typedef struct
+{
+    SW_TileOp op;
+    SDL_Rect bounds;            /* clipped destination area */
+    const SDL_Point *points;
+    int count;
+    Uint32 color;
+    SDL_BlendMode blend;
+    Uint8 r, g, b, a;
+    SDL_Surface *src;
+    int src_x, src_y;           /* source pixel drawn at bounds.x, bounds.y */
+    SDL_BlitFunc blit;
+    SDL_BlitInfo info;          /* copy of src->map->info when queued */
+} SW_TileItem;
+
 typedef struct
 {
     const SDL_Rect *viewport;
@@ -48,6 +85,16 @@ typedef struct
 {
     SDL_Surface *surface;
     SDL_Surface *window;
+    SDL_bool tiled;
+    SW_TileItem *tile_items;
+    int num_tile_items;
+    int max_tile_items;
+    Sint64 tile_pixels;
+    int *tile_bins;
+    int max_tile_bins;
+    int *tile_start;
+    int max_tile_start;
+    SDL_Surface *tile_surface;
 } SW_RenderData;
 
 
@@ -435,7 +482,7 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Surface *surface, SDL_Texture * tex
             retval = -1;
         } else {
             SDL_SetSurfaceBlendMode(src_clone, SDL_BLENDMODE_NONE);
-            retval = SDL_BlitScaled(src_clone, srcrect, src_scaled, &scale_rect);
+            retval = SDL_PrivateUpperBlitScaled(src_clone, srcrect, src_scaled, &scale_rect, texture->scaleMode);
             SDL_FreeSurface(src_clone);
             src_clone = src_scaled;
             src_scaled = NULL;
@@ -608,16 +655,413 @@ SetDrawState(SDL_Surface *surface, SW_DrawStateCache *drawstate)
     }
 }
 
+static SW_TileItem *
+SW_AllocTileItems(SW_RenderData *data, int count)
+{
+    SW_TileItem *items;
+
+    if (data->num_tile_items + count > data->max_tile_items) {
+        int max_items = SDL_max(data->max_tile_items * 2, 256);
+        while (max_items < data->num_tile_items + count) {
+            max_items *= 2;
+        }
+        items = (SW_TileItem *) SDL_realloc(data->tile_items, max_items * sizeof (*items));
+        if (!items) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        data->tile_items = items;
+        data->max_tile_items = max_items;
+    }
+    items = &data->tile_items[data->num_tile_items];
+    data->num_tile_items += count;
+    return items;
+}
+
+static int
+SW_QueueTileRects(SW_RenderData *data, SDL_Surface *surface, const SDL_Rect *rects, int count,
+                  SDL_BlendMode blend, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+    SW_TileItem *items = SW_AllocTileItems(data, count);
+    const Uint32 color = SDL_MapRGBA(surface->format, r, g, b, a);
+    int i, num_items = 0;
+
+    if (!items) {
+        return -1;
+    }
+
+    for (i = 0; i < count; ++i) {
+        SW_TileItem *item = &items[num_items];
+        if (!SDL_IntersectRect(&rects[i], &surface->clip_rect, &item->bounds)) {
+            continue;
+        }
+        item->op = (blend == SDL_BLENDMODE_NONE) ? SW_TILE_FILL_RECT : SW_TILE_BLEND_RECT;
+        item->color = color;
+        item->blend = blend;
+        item->r = r;
+        item->g = g;
+        item->b = b;
+        item->a = a;
+        data->tile_pixels += (Sint64) item->bounds.w * item->bounds.h;
+        ++num_items;
+    }
+    data->num_tile_items -= (count - num_items);
+    return 0;
+}
+
+static int
+SW_QueueTilePoints(SW_RenderData *data, SDL_Surface *surface, const SDL_Point *points, int count,
+                   SDL_BlendMode blend, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+    const SDL_Rect *clip = &surface->clip_rect;
+    int minx = clip->x + clip->w, miny = clip->y + clip->h;
+    int maxx = clip->x - 1, maxy = clip->y - 1;
+    SW_TileItem *item;
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        const int x = points[i].x;
+        const int y = points[i].y;
+        if (x < clip->x || x >= clip->x + clip->w || y < clip->y || y >= clip->y + clip->h) {
+            continue;
+        }
+        minx = SDL_min(minx, x);
+        miny = SDL_min(miny, y);
+        maxx = SDL_max(maxx, x);
+        maxy = SDL_max(maxy, y);
+    }
+    if (maxx < minx) {
+        return 0;  /* nothing visible */
+    }
+
+    item = SW_AllocTileItems(data, 1);
+    if (!item) {
+        return -1;
+    }
+    item->op = (blend == SDL_BLENDMODE_NONE) ? SW_TILE_DRAW_POINTS : SW_TILE_BLEND_POINTS;
+    item->bounds.x = minx;
+    item->bounds.y = miny;
+    item->bounds.w = maxx - minx + 1;
+    item->bounds.h = maxy - miny + 1;
+    item->points = points;
+    item->count = count;
+    item->color = SDL_MapRGBA(surface->format, r, g, b, a);
+    item->blend = blend;
+    item->r = r;
+    item->g = g;
+    item->b = b;
+    item->a = a;
+    data->tile_pixels += count;
+    return 0;
+}
+
+/* Whether SW_QueueTileCopy() can take a copy from this texture surface.
+   RLE and palette blits keep state outside the blit info, and a locked
+   surface can't be blitted at all, so those go through SDL_BlitSurface(). */
+static SDL_bool
+SW_CanTileCopy(SDL_Surface *src)
+{
+    if (src->locked || src->format->palette) {
+        return SDL_FALSE;
+    }
+    if ((src->flags & SDL_RLEACCEL) || (src->map->info.flags & SDL_COPY_RLE_DESIRED)) {
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+
+static int
+SW_QueueTileCopy(SW_RenderData *data, SDL_Surface *src, const SDL_Rect *srcrect,
+                 SDL_Surface *surface, const SDL_Rect *dstrect)
+{
+    const SDL_Rect *clip = &surface->clip_rect;
+    SW_TileItem *item;
+    int srcx, srcy, dstx, dsty, w, h, maxw, maxh, dx, dy;
+
+    /* Clip the same way SDL_UpperBlit() does */
+    srcx = srcrect->x;
+    dstx = dstrect->x;
+    w = srcrect->w;
+    if (srcx < 0) {
+        w += srcx;
+        dstx -= srcx;
+        srcx = 0;
+    }
+    maxw = src->w - srcx;
+    if (maxw < w) {
+        w = maxw;
+    }
+
+    srcy = srcrect->y;
+    dsty = dstrect->y;
+    h = srcrect->h;
+    if (srcy < 0) {
+        h += srcy;
+        dsty -= srcy;
+        srcy = 0;
+    }
+    maxh = src->h - srcy;
+    if (maxh < h) {
+        h = maxh;
+    }
+
+    dx = clip->x - dstx;
+    if (dx > 0) {
+        w -= dx;
+        dstx += dx;
+        srcx += dx;
+    }
+    dx = dstx + w - clip->x - clip->w;
+    if (dx > 0) {
+        w -= dx;
+    }
+
+    dy = clip->y - dsty;
+    if (dy > 0) {
+        h -= dy;
+        dsty += dy;
+        srcy += dy;
+    }
+    dy = dsty + h - clip->y - clip->h;
+    if (dy > 0) {
+        h -= dy;
+    }
+
+    /* Switch back to a fast blit if we were previously stretching */
+    if (src->map->info.flags & SDL_COPY_NEAREST) {
+        src->map->info.flags &= ~SDL_COPY_NEAREST;
+        SDL_InvalidateMap(src->map);
+    }
+
+    if (w <= 0 || h <= 0) {
+        return 0;
+    }
+
+    if (src->map->dst != surface) {
+        if (SDL_MapSurface(src, surface) < 0) {
+            return 0;  /* SDL_BlitSurface() would fail the same way */
+        }
+    }
+
+    item = SW_AllocTileItems(data, 1);
+    if (!item) {
+        return -1;
+    }
+    item->op = SW_TILE_COPY;
+    item->bounds.x = dstx;
+    item->bounds.y = dsty;
+    item->bounds.w = w;
+    item->bounds.h = h;
+    item->src = src;
+    item->src_x = srcx;
+    item->src_y = srcy;
+    item->blit = (SDL_BlitFunc) src->map->data;
+    item->info = src->map->info;
+    data->tile_pixels += (Sint64) w * h;
+    return 0;
+}
+
+static void
+SW_DrawTilePoints(SDL_Surface *surface, const SW_TileItem *item, const SDL_Point *points, int count)
+{
+    if (item->op == SW_TILE_DRAW_POINTS) {
+        SDL_DrawPoints(surface, points, count, item->color);
+    } else {
+        SDL_BlendPoints(surface, points, count, item->blend, item->r, item->g, item->b, item->a);
+    }
+}
+
+static void
+SW_DrawTileItem(SDL_Surface *surface, const SW_TileItem *item, const SDL_Rect *tile)
+{
+    SDL_Rect rect;
+
+    if (!SDL_IntersectRect(&item->bounds, tile, &rect)) {
+        return;
+    }
+
+    switch (item->op) {
+        case SW_TILE_FILL_RECT:
+            SDL_FillRect(surface, &rect, item->color);
+            break;
+
+        case SW_TILE_BLEND_RECT:
+            SDL_BlendFillRect(surface, &rect, item->blend, item->r, item->g, item->b, item->a);
+            break;
+
+        case SW_TILE_DRAW_POINTS:
+        case SW_TILE_BLEND_POINTS: {
+            SDL_Point points[SW_TILE_MAX_POINTS];
+            int i, count = 0;
+
+            for (i = 0; i < item->count; ++i) {
+                const SDL_Point *point = &item->points[i];
+                if (point->x < rect.x || point->x >= rect.x + rect.w ||
+                    point->y < rect.y || point->y >= rect.y + rect.h) {
+                    continue;
+                }
+                points[count++] = *point;
+                if (count == SW_TILE_MAX_POINTS) {
+                    SW_DrawTilePoints(surface, item, points, count);
+                    count = 0;
+                }
+            }
+            if (count > 0) {
+                SW_DrawTilePoints(surface, item, points, count);
+            }
+            break;
+        }
+
+        case SW_TILE_COPY: {
+            /* Set up a private copy of the blit info, as SDL_SoftBlit() would */
+            SDL_BlitInfo info = item->info;
+            SDL_Surface *src = item->src;
+            const int srcx = item->src_x + (rect.x - item->bounds.x);
+            const int srcy = item->src_y + (rect.y - item->bounds.y);
+
+            info.src = (Uint8 *) src->pixels +
+                (Uint16) srcy * src->pitch +
+                (Uint16) srcx * info.src_fmt->BytesPerPixel;
+            info.src_w = rect.w;
+            info.src_h = rect.h;
+            info.src_pitch = src->pitch;
+            info.src_skip = info.src_pitch - info.src_w * info.src_fmt->BytesPerPixel;
+            info.dst = (Uint8 *) surface->pixels +
+                (Uint16) rect.y * surface->pitch +
+                (Uint16) rect.x * info.dst_fmt->BytesPerPixel;
+            info.dst_w = rect.w;
+            info.dst_h = rect.h;
+            info.dst_pitch = surface->pitch;
+            info.dst_skip = info.dst_pitch - info.dst_w * info.dst_fmt->BytesPerPixel;
+            item->blit(&info);
+            break;
+        }
+    }
+}
+
+static void SDLCALL
+SW_DrawTiles(int start, int end, void *userdata)
+{
+    SW_RenderData *data = (SW_RenderData *) userdata;
+    SDL_Surface *surface = data->tile_surface;
+    int tile, i;
+
+    for (tile = start; tile < end; ++tile) {
+        SDL_Rect rect;
+        rect.x = 0;
+        rect.y = tile * SW_TILE_HEIGHT;
+        rect.w = surface->w;
+        rect.h = SDL_min(SW_TILE_HEIGHT, surface->h - rect.y);
+        for (i = data->tile_start[tile]; i < data->tile_start[tile + 1]; ++i) {
+            SW_DrawTileItem(surface, &data->tile_items[data->tile_bins[i]], &rect);
+        }
+    }
+}
+
+/* Sort the items into per tile lists, keeping them in queue order */
+static int
+SW_BinTileItems(SW_RenderData *data, int num_tiles)
+{
+    int *tile_start = data->tile_start;
+    int *tile_bins = data->tile_bins;
+    int num_bins = 0;
+    int i, tile;
+
+    for (i = 0; i < data->num_tile_items; ++i) {
+        const SDL_Rect *bounds = &data->tile_items[i].bounds;
+        num_bins += ((bounds->y + bounds->h - 1) / SW_TILE_HEIGHT) - (bounds->y / SW_TILE_HEIGHT) + 1;
+    }
+
+    if (num_tiles + 1 > data->max_tile_start) {
+        tile_start = (int *) SDL_realloc(tile_start, (num_tiles + 1) * sizeof (*tile_start));
+        if (!tile_start) {
+            return SDL_OutOfMemory();
+        }
+        data->tile_start = tile_start;
+        data->max_tile_start = num_tiles + 1;
+    }
+    if (num_bins > data->max_tile_bins) {
+        tile_bins = (int *) SDL_realloc(tile_bins, num_bins * sizeof (*tile_bins));
+        if (!tile_bins) {
+            return SDL_OutOfMemory();
+        }
+        data->tile_bins = tile_bins;
+        data->max_tile_bins = num_bins;
+    }
+
+    SDL_memset(tile_start, 0, (num_tiles + 1) * sizeof (*tile_start));
+    for (i = 0; i < data->num_tile_items; ++i) {
+        const SDL_Rect *bounds = &data->tile_items[i].bounds;
+        const int last = (bounds->y + bounds->h - 1) / SW_TILE_HEIGHT;
+        for (tile = bounds->y / SW_TILE_HEIGHT; tile <= last; ++tile) {
+            ++tile_start[tile + 1];
+        }
+    }
+    for (tile = 0; tile < num_tiles; ++tile) {
+        tile_start[tile + 1] += tile_start[tile];
+    }
+    for (i = 0; i < data->num_tile_items; ++i) {
+        const SDL_Rect *bounds = &data->tile_items[i].bounds;
+        const int last = (bounds->y + bounds->h - 1) / SW_TILE_HEIGHT;
+        for (tile = bounds->y / SW_TILE_HEIGHT; tile <= last; ++tile) {
+            tile_bins[tile_start[tile]++] = i;
+        }
+    }
+    /* Each start now points at the next tile's start, shift them back */
+    for (tile = num_tiles; tile > 0; --tile) {
+        tile_start[tile] = tile_start[tile - 1];
+    }
+    tile_start[0] = 0;
+    return 0;
+}
+
+static void
+SW_FlushTiles(SW_RenderData *data, SDL_Surface *surface, SW_DrawStateCache *drawstate)
+{
+    const int num_tiles = (surface->h + SW_TILE_HEIGHT - 1) / SW_TILE_HEIGHT;
+    int i;
+
+    if (data->num_tile_items == 0) {
+        return;
+    }
+
+    SDL_TRACE_BEGIN("SW_FlushTiles");
+
+    /* The items are clipped already and were queued under different clip rects */
+    SDL_SetClipRect(surface, NULL);
+    drawstate->surface_cliprect_dirty = SDL_TRUE;
+
+    if (data->tile_pixels >= SW_TILE_MIN_PIXELS && num_tiles > 1 &&
+        SDL_GetJobThreadCount() > 0 && SW_BinTileItems(data, num_tiles) == 0) {
+        data->tile_surface = surface;
+        SDL_ParallelFor(num_tiles, 0, SW_DrawTiles, data);
+        data->tile_surface = NULL;
+    } else {
+        for (i = 0; i < data->num_tile_items; ++i) {
+            SW_DrawTileItem(surface, &data->tile_items[i], &surface->clip_rect);
+        }
+    }
+
+    data->num_tile_items = 0;
+    data->tile_pixels = 0;
+
+    SDL_TRACE_END();
+}
+
 static int
 SW_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertices, size_t vertsize)
 {
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
     SDL_Surface *surface = SW_ActivateRenderer(renderer);
     SW_DrawStateCache drawstate;
+    SDL_bool tiled;
 
     if (!surface) {
         return -1;
     }
 
+    tiled = data->tiled && !SDL_MUSTLOCK(surface) && !surface->format->palette;
+
     drawstate.viewport = NULL;
     drawstate.cliprect = NULL;
     drawstate.surface_cliprect_dirty = SDL_TRUE;
@@ -647,8 +1091,12 @@ SW_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertic
                 const Uint8 a = cmd->data.color.a;
                 /* By definition the clear ignores the clip rect */
                 SDL_SetClipRect(surface, NULL);
-                SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, r, g, b, a));
                 drawstate.surface_cliprect_dirty = SDL_TRUE;
+                if (tiled && SW_QueueTileRects(data, surface, &surface->clip_rect, 1, SDL_BLENDMODE_NONE, r, g, b, a) == 0) {
+                    break;
+                }
+                SW_FlushTiles(data, surface, &drawstate);
+                SDL_FillRect(surface, NULL, SDL_MapRGBA(surface->format, r, g, b, a));
                 break;
             }
 
@@ -661,6 +1109,11 @@ SW_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertic
                 const SDL_Point *verts = (SDL_Point *) (((Uint8 *) vertices) + cmd->data.draw.first);
                 const SDL_BlendMode blend = cmd->data.draw.blend;
                 SetDrawState(surface, &drawstate);
+                if (tiled && SW_QueueTilePoints(data, surface, verts, count, blend, r, g, b, a) == 0) {
+                    break;
+                }
+                SW_FlushTiles(data, surface, &drawstate);
+                SetDrawState(surface, &drawstate);
                 if (blend == SDL_BLENDMODE_NONE) {
                     SDL_DrawPoints(surface, verts, count, SDL_MapRGBA(surface->format, r, g, b, a));
                 } else {
@@ -677,6 +1130,7 @@ SW_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertic
                 const int count = (int) cmd->data.draw.count;
                 const SDL_Point *verts = (SDL_Point *) (((Uint8 *) vertices) + cmd->data.draw.first);
                 const SDL_BlendMode blend = cmd->data.draw.blend;
+                SW_FlushTiles(data, surface, &drawstate);
                 SetDrawState(surface, &drawstate);
                 if (blend == SDL_BLENDMODE_NONE) {
                     SDL_DrawLines(surface, verts, count, SDL_MapRGBA(surface->format, r, g, b, a));
@@ -695,6 +1149,11 @@ SW_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertic
                 const SDL_Rect *verts = (SDL_Rect *) (((Uint8 *) vertices) + cmd->data.draw.first);
                 const SDL_BlendMode blend = cmd->data.draw.blend;
                 SetDrawState(surface, &drawstate);
+                if (tiled && SW_QueueTileRects(data, surface, verts, count, blend, r, g, b, a) == 0) {
+                    break;
+                }
+                SW_FlushTiles(data, surface, &drawstate);
+                SetDrawState(surface, &drawstate);
                 if (blend == SDL_BLENDMODE_NONE) {
                     SDL_FillRects(surface, verts, count, SDL_MapRGBA(surface->format, r, g, b, a));
                 } else {
@@ -714,6 +1173,13 @@ SW_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertic
 
                 PrepTextureForCopy(cmd);
 
+                if (tiled && srcrect->w == dstrect->w && srcrect->h == dstrect->h && SW_CanTileCopy(src) &&
+                    SW_QueueTileCopy(data, src, srcrect, surface, dstrect) == 0) {
+                    break;
+                }
+                SW_FlushTiles(data, surface, &drawstate);
+                SetDrawState(surface, &drawstate);
+
                 if ( srcrect->w == dstrect->w && srcrect->h == dstrect->h ) {
                     SDL_BlitSurface(src, srcrect, surface, dstrect);
                 } else {
@@ -721,13 +1187,14 @@ SW_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertic
                      * to avoid potentially frequent RLE encoding/decoding.
                      */
                     SDL_SetSurfaceRLE(surface, 0);
-                    SDL_BlitScaled(src, srcrect, surface, dstrect);
+                    SDL_PrivateUpperBlitScaled(src, srcrect, surface, dstrect, texture->scaleMode);
                 }
                 break;
             }
 
             case SDL_RENDERCMD_COPY_EX: {
                 const CopyExData *copydata = (CopyExData *) (((Uint8 *) vertices) + cmd->data.draw.first);
+                SW_FlushTiles(data, surface, &drawstate);
                 SetDrawState(surface, &drawstate);
                 PrepTextureForCopy(cmd);
                 SW_RenderCopyEx(renderer, surface, cmd->data.draw.texture, &copydata->srcrect,
@@ -742,6 +1209,8 @@ SW_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertic
         cmd = cmd->next;
     }
 
+    SW_FlushTiles(data, surface, &drawstate);
+
     return 0;
 }
 
@@ -799,6 +1268,11 @@ SW_DestroyRenderer(SDL_Renderer * renderer)
 {
     SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
 
+    if (data) {
+        SDL_free(data->tile_items);
+        SDL_free(data->tile_bins);
+        SDL_free(data->tile_start);
+    }
     SDL_free(data);
     SDL_free(renderer);
 }
@@ -828,6 +1302,7 @@ SW_CreateRendererForSurface(SDL_Surface * surface)
     }
     data->surface = surface;
     data->window = surface;
+    data->tiled = SDL_GetHintBoolean(SDL_HINT_RENDER_SOFTWARE_TILED, SDL_TRUE);
 
     renderer->WindowEvent = SW_WindowEvent;
     renderer->GetOutputSize = SW_GetOutputSize;
@@ -0,0 +1,701 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+/* The SDL job system */
+
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_hints.h"
+#include "SDL_jobs.h"
+#include "SDL_thread.h"
+#include "SDL_systhread.h"
+#include "SDL_jobs_c.h"
+#include "../SDL_trace_c.h"
+
+#define SDL_MAX_JOB_THREADS     64
+#define SDL_JOB_DEQUE_SIZE      4096    /* must be a power of two */
+#define SDL_JOB_DEQUE_MASK      (SDL_JOB_DEQUE_SIZE - 1)
+
+typedef struct SDL_Job
+{
+    SDL_JobFunction function;
+    void *data;
+    SDL_JobCounter *counter;
+    SDL_bool allocated;         /* freed once it has run */
+    struct SDL_Job *next;       /* in the shared queue or a dependents list */
+} SDL_Job;
+
+struct SDL_JobCounter
+{
+    SDL_atomic_t value;
+    SDL_SpinLock lock;          /* held while the last job finishes */
+    SDL_Job *dependents;        /* queued when value drops to zero */
+};
+
+/* Chase-Lev work-stealing deque: the worker owning it pushes and pops jobs
+   at the bottom, any other thread steals them from the top. Positions are
+   free running and compared as wrapping differences. */
+typedef struct
+{
+    SDL_atomic_t top;
+    char pad0[SDL_CACHELINE_SIZE - sizeof (SDL_atomic_t)];
+    SDL_atomic_t bottom;
+    char pad1[SDL_CACHELINE_SIZE - sizeof (SDL_atomic_t)];
+    SDL_Job *slots[SDL_JOB_DEQUE_SIZE];
+} SDL_JobDeque;
+
+typedef struct
+{
+    SDL_JobDeque deque;
+    SDL_Thread *thread;
+    Uint32 seed;                /* picks whom to steal from */
+} SDL_JobWorker;
+
+typedef struct
+{
+    SDL_Job job;
+    SDL_ParallelForFunction function;
+    void *data;
+    int start;
+    int end;
+} SDL_ParallelForJob;
+
+static struct
+{
+    SDL_SpinLock init_lock;
+    SDL_atomic_t active;
+    int num_workers;
+    SDL_JobWorker *workers;
+    SDL_TLSID worker_tls;       /* 1 + index of the worker on this thread */
+
+    /* Jobs from threads that aren't workers, or that didn't fit in a deque */
+    SDL_mutex *queue_lock;
+    SDL_Job *queue_head;
+    SDL_Job *queue_tail;
+    SDL_atomic_t queued;
+
+    /* Idle workers, and threads waiting on a counter, sleep here */
+    SDL_mutex *wait_lock;
+    SDL_cond *wait_cond;
+    SDL_atomic_t sleepers;
+} SDL_jobs;
+
+static SDL_INLINE int
+SDL_DequeSize(SDL_JobDeque *deque)
+{
+    return (int)((Uint32)SDL_AtomicGet(&deque->bottom) - (Uint32)SDL_AtomicGet(&deque->top));
+}
+
+/* Owner only */
+static SDL_bool
+SDL_PushJob(SDL_JobDeque *deque, SDL_Job *job)
+{
+    const Uint32 bottom = (Uint32)SDL_AtomicGet(&deque->bottom);
+    const Uint32 top = (Uint32)SDL_AtomicGet(&deque->top);
+
+    if (bottom - top >= SDL_JOB_DEQUE_SIZE) {
+        return SDL_FALSE;
+    }
+    deque->slots[bottom & SDL_JOB_DEQUE_MASK] = job;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&deque->bottom, (int)(bottom + 1));
+    return SDL_TRUE;
+}
+
+/* Owner only */
+static SDL_Job *
+SDL_PopJob(SDL_JobDeque *deque)
+{
+    /* The atomic add orders the bottom update before reading top */
+    const Uint32 bottom = (Uint32)SDL_AtomicAdd(&deque->bottom, -1) - 1;
+    const Uint32 top = (Uint32)SDL_AtomicGet(&deque->top);
+    SDL_Job *job = NULL;
+
+    if ((Sint32)(bottom - top) >= 0) {
+        job = deque->slots[bottom & SDL_JOB_DEQUE_MASK];
+        if (bottom != top) {
+            return job;
+        }
+        /* Last one, a thief might be taking it too */
+        if (!SDL_AtomicCAS(&deque->top, (int)top, (int)(top + 1))) {
+            job = NULL;
+        }
+    }
+    SDL_AtomicSet(&deque->bottom, (int)(bottom + 1));
+    return job;
+}
+
+/* Any thread */
+static SDL_Job *
+SDL_StealJob(SDL_JobDeque *deque)
+{
+    const Uint32 top = (Uint32)SDL_AtomicGet(&deque->top);
+    const Uint32 bottom = (Uint32)SDL_AtomicGet(&deque->bottom);
+    SDL_Job *job;
+
+    if ((Sint32)(bottom - top) <= 0) {
+        return NULL;
+    }
+    job = (SDL_Job *)SDL_AtomicGetPtr((void **)&deque->slots[top & SDL_JOB_DEQUE_MASK]);
+    if (!SDL_AtomicCAS(&deque->top, (int)top, (int)(top + 1))) {
+        return NULL;
+    }
+    return job;
+}
+
+static SDL_Job *
+SDL_TakeQueuedJob(void)
+{
+    SDL_Job *job;
+
+    if (SDL_AtomicGet(&SDL_jobs.queued) == 0) {
+        return NULL;
+    }
+    SDL_LockMutex(SDL_jobs.queue_lock);
+    job = SDL_jobs.queue_head;
+    if (job) {
+        SDL_jobs.queue_head = job->next;
+        if (!SDL_jobs.queue_head) {
+            SDL_jobs.queue_tail = NULL;
+        }
+        SDL_AtomicAdd(&SDL_jobs.queued, -1);
+    }
+    SDL_UnlockMutex(SDL_jobs.queue_lock);
+    return job;
+}
+
+static SDL_bool
+SDL_JobsAvailable(void)
+{
+    int i;
+
+    if (SDL_AtomicGet(&SDL_jobs.queued) > 0) {
+        return SDL_TRUE;
+    }
+    for (i = 0; i < SDL_jobs.num_workers; ++i) {
+        if (SDL_DequeSize(&SDL_jobs.workers[i].deque) > 0) {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+/* Index of the worker running on this thread, or -1 */
+static SDL_INLINE int
+SDL_GetJobWorker(void)
+{
+    return (int)(intptr_t)SDL_TLSGet(SDL_jobs.worker_tls) - 1;
+}
+
+/* Own jobs first, then the shared queue, then steal from the others */
+static SDL_Job *
+SDL_FindJob(int self)
+{
+    SDL_Job *job;
+    Uint32 start;
+    int i;
+
+    if (self >= 0) {
+        job = SDL_PopJob(&SDL_jobs.workers[self].deque);
+        if (job) {
+            return job;
+        }
+    }
+
+    job = SDL_TakeQueuedJob();
+    if (job) {
+        return job;
+    }
+
+    if (self >= 0) {
+        Uint32 seed = SDL_jobs.workers[self].seed;
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        SDL_jobs.workers[self].seed = seed;
+        start = seed;
+    } else {
+        start = (Uint32)SDL_ThreadID();
+    }
+    for (i = 0; i < SDL_jobs.num_workers; ++i) {
+        const int victim = (int)((start + i) % SDL_jobs.num_workers);
+        if (victim != self) {
+            job = SDL_StealJob(&SDL_jobs.workers[victim].deque);
+            if (job) {
+                return job;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Wake one sleeping thread per new job, or all of them if count is negative */
+static void
+SDL_WakeJobThreads(int count)
+{
+    /* A full barrier, so this can't be read before the jobs were published */
+    const int sleepers = SDL_AtomicAdd(&SDL_jobs.sleepers, 0);
+
+    if (sleepers > 0) {
+        SDL_LockMutex(SDL_jobs.wait_lock);
+        if (count < 0 || count >= sleepers) {
+            SDL_CondBroadcast(SDL_jobs.wait_cond);
+        } else {
+            while (count-- > 0) {
+                SDL_CondSignal(SDL_jobs.wait_cond);
+            }
+        }
+        SDL_UnlockMutex(SDL_jobs.wait_lock);
+    }
+}
+
+/* Sleep until there is a job to run, or until counter reaches zero */
+static void
+SDL_SleepForJobs(SDL_JobCounter *counter)
+{
+    SDL_LockMutex(SDL_jobs.wait_lock);
+    SDL_AtomicIncRef(&SDL_jobs.sleepers);
+    if (SDL_AtomicGet(&SDL_jobs.active) && !SDL_JobsAvailable() &&
+        (!counter || SDL_AtomicGet(&counter->value) > 0)) {
+        SDL_CondWait(SDL_jobs.wait_cond, SDL_jobs.wait_lock);
+    }
+    SDL_AtomicAdd(&SDL_jobs.sleepers, -1);
+    SDL_UnlockMutex(SDL_jobs.wait_lock);
+}
+
+/* Queue a list of count jobs, linked through next */
+static void
+SDL_QueueJobs(SDL_Job *first, SDL_Job *last, int count)
+{
+    const int self = SDL_GetJobWorker();
+
+    if (self >= 0) {
+        SDL_JobDeque *deque = &SDL_jobs.workers[self].deque;
+        while (first && SDL_PushJob(deque, first)) {
+            if (first == last) {
+                first = NULL;
+            } else {
+                first = first->next;
+            }
+        }
+    }
+
+    if (first) {
+        /* Not on a worker, or its deque is full */
+        int queued = 1;
+        SDL_Job *job;
+
+        for (job = first; job != last; job = job->next) {
+            ++queued;
+        }
+        last->next = NULL;
+        SDL_LockMutex(SDL_jobs.queue_lock);
+        if (SDL_jobs.queue_tail) {
+            SDL_jobs.queue_tail->next = first;
+        } else {
+            SDL_jobs.queue_head = first;
+        }
+        SDL_jobs.queue_tail = last;
+        SDL_AtomicAdd(&SDL_jobs.queued, queued);
+        SDL_UnlockMutex(SDL_jobs.queue_lock);
+    }
+
+    SDL_WakeJobThreads(count);
+}
+
+static void
+SDL_FinishJob(SDL_JobCounter *counter)
+{
+    SDL_Job *dependents = NULL;
+    SDL_Job *last;
+    SDL_bool done = SDL_FALSE;
+    int count = 0;
+
+    /* Waiters take the lock once they see zero, so the counter can't
+       go away while we're still looking at it */
+    SDL_AtomicLock(&counter->lock);
+    if (SDL_AtomicAdd(&counter->value, -1) == 1) {
+        dependents = counter->dependents;
+        counter->dependents = NULL;
+        done = SDL_TRUE;
+    }
+    SDL_AtomicUnlock(&counter->lock);
+
+    if (!done) {
+        /* Nobody can be waiting for a counter that is still running */
+        return;
+    }
+    if (dependents) {
+        for (last = dependents; last->next; last = last->next) {
+            ++count;
+        }
+        SDL_QueueJobs(dependents, last, count + 1);
+    }
+    /* Wake anyone waiting for the counter */
+    SDL_WakeJobThreads(-1);
+}
+
+static void
+SDL_RunJobNow(SDL_Job *job)
+{
+    SDL_JobCounter *counter = job->counter;
+
+    SDL_TRACE_BEGIN("SDL_Job");
+    job->function(job->data);
+    SDL_TRACE_END();
+    if (job->allocated) {
+        SDL_free(job);
+    }
+    if (counter) {
+        SDL_FinishJob(counter);
+    }
+}
+
+static int SDLCALL
+SDL_JobThread(void *data)
+{
+    const int self = (int)(intptr_t)data;
+
+    SDL_TLSSet(SDL_jobs.worker_tls, (void *)(intptr_t)(self + 1), NULL);
+
+    while (SDL_AtomicGet(&SDL_jobs.active)) {
+        SDL_Job *job = SDL_FindJob(self);
+        if (job) {
+            SDL_RunJobNow(job);
+        } else {
+            SDL_SleepForJobs(NULL);
+        }
+    }
+    return 0;
+}
+
+static void
+SDL_FreeJobs(SDL_Job *job)
+{
+    while (job) {
+        SDL_Job *next = job->next;
+        if (job->allocated) {
+            SDL_free(job);
+        }
+        job = next;
+    }
+}
+
+static int
+SDL_InitJobs(void)
+{
+    const char *hint;
+    int num_workers, i;
+
+    if (SDL_AtomicGet(&SDL_jobs.active)) {
+        return 0;
+    }
+
+    SDL_AtomicLock(&SDL_jobs.init_lock);
+    if (SDL_AtomicGet(&SDL_jobs.active)) {
+        SDL_AtomicUnlock(&SDL_jobs.init_lock);
+        return 0;
+    }
+
+    hint = SDL_GetHint(SDL_HINT_JOB_THREADS);
+    num_workers = (hint && *hint) ? SDL_atoi(hint) : SDL_GetCPUCount();
+    num_workers = SDL_max(num_workers, 1);
+    num_workers = SDL_min(num_workers, SDL_MAX_JOB_THREADS);
+
+    if (!SDL_jobs.worker_tls) {
+        SDL_jobs.worker_tls = SDL_TLSCreate();
+    }
+    SDL_jobs.queue_lock = SDL_CreateMutex();
+    SDL_jobs.wait_lock = SDL_CreateMutex();
+    SDL_jobs.wait_cond = SDL_CreateCond();
+    SDL_SetMutexName(SDL_jobs.queue_lock, "SDL_jobs.queue_lock");
+    SDL_SetMutexName(SDL_jobs.wait_lock, "SDL_jobs.wait_lock");
+    SDL_SetCondName(SDL_jobs.wait_cond, "SDL_jobs.wait_cond");
+    SDL_jobs.workers = (SDL_JobWorker *)SDL_calloc(num_workers, sizeof (*SDL_jobs.workers));
+    if (!SDL_jobs.worker_tls || !SDL_jobs.queue_lock || !SDL_jobs.wait_lock ||
+        !SDL_jobs.wait_cond || !SDL_jobs.workers) {
+        if (!SDL_jobs.workers) {
+            SDL_OutOfMemory();
+        }
+        SDL_AtomicUnlock(&SDL_jobs.init_lock);
+        SDL_JobsQuit();
+        return -1;
+    }
+    SDL_jobs.num_workers = num_workers;
+
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&SDL_jobs.active, 1);
+
+    for (i = 0; i < num_workers; ++i) {
+        SDL_JobWorker *worker = &SDL_jobs.workers[i];
+        worker->seed = 0x9E3779B9u * (Uint32)(i + 1);
+        /* Jobs are callbacks into the app, so we can't set a limited stack size here. */
+        worker->thread = SDL_CreateThreadInternal(SDL_JobThread, "SDLJob", 0, (void *)(intptr_t)i);
+        if (!worker->thread) {
+            SDL_AtomicUnlock(&SDL_jobs.init_lock);
+            SDL_JobsQuit();
+            return -1;
+        }
+    }
+    SDL_AtomicUnlock(&SDL_jobs.init_lock);
+    return 0;
+}
+
+void
+SDL_JobsQuit(void)
+{
+    int i;
+
+    SDL_AtomicLock(&SDL_jobs.init_lock);
+
+    SDL_AtomicSet(&SDL_jobs.active, 0);
+    if (SDL_jobs.wait_lock) {
+        SDL_LockMutex(SDL_jobs.wait_lock);
+        SDL_CondBroadcast(SDL_jobs.wait_cond);
+        SDL_UnlockMutex(SDL_jobs.wait_lock);
+    }
+
+    if (SDL_jobs.workers) {
+        for (i = 0; i < SDL_jobs.num_workers; ++i) {
+            SDL_JobWorker *worker = &SDL_jobs.workers[i];
+            Uint32 pos;
+
+            if (worker->thread) {
+                SDL_WaitThread(worker->thread, NULL);
+            }
+            /* Jobs that never got to run */
+            for (pos = (Uint32)SDL_AtomicGet(&worker->deque.top);
+                 pos != (Uint32)SDL_AtomicGet(&worker->deque.bottom); ++pos) {
+                SDL_Job *job = worker->deque.slots[pos & SDL_JOB_DEQUE_MASK];
+                job->next = NULL;
+                SDL_FreeJobs(job);
+            }
+        }
+        SDL_free(SDL_jobs.workers);
+        SDL_jobs.workers = NULL;
+    }
+    SDL_jobs.num_workers = 0;
+
+    SDL_FreeJobs(SDL_jobs.queue_head);
+    SDL_jobs.queue_head = NULL;
+    SDL_jobs.queue_tail = NULL;
+    SDL_AtomicSet(&SDL_jobs.queued, 0);
+
+    if (SDL_jobs.wait_cond) {
+        SDL_DestroyCond(SDL_jobs.wait_cond);
+        SDL_jobs.wait_cond = NULL;
+    }
+    if (SDL_jobs.wait_lock) {
+        SDL_DestroyMutex(SDL_jobs.wait_lock);
+        SDL_jobs.wait_lock = NULL;
+    }
+    if (SDL_jobs.queue_lock) {
+        SDL_DestroyMutex(SDL_jobs.queue_lock);
+        SDL_jobs.queue_lock = NULL;
+    }
+
+    SDL_AtomicUnlock(&SDL_jobs.init_lock);
+}
+
+/* Public functions */
+
+int
+SDL_GetJobThreadCount(void)
+{
+    if (SDL_InitJobs() < 0) {
+        return -1;
+    }
+    return SDL_jobs.num_workers;
+}
+
+SDL_JobCounter *
+SDL_CreateJobCounter(void)
+{
+    SDL_JobCounter *counter = (SDL_JobCounter *)SDL_calloc(1, sizeof (*counter));
+    if (!counter) {
+        SDL_OutOfMemory();
+    }
+    return counter;
+}
+
+void
+SDL_DestroyJobCounter(SDL_JobCounter *counter)
+{
+    if (counter) {
+        /* Let the thread that finished the last job let go of it */
+        SDL_AtomicLock(&counter->lock);
+        SDL_AtomicUnlock(&counter->lock);
+        SDL_free(counter);
+    }
+}
+
+int
+SDL_GetJobCounterValue(SDL_JobCounter *counter)
+{
+    if (!counter) {
+        return SDL_InvalidParamError("counter");
+    }
+    return SDL_AtomicGet(&counter->value);
+}
+
+int
+SDL_RunJobAfter(SDL_JobCounter *dependency, SDL_JobFunction function, void *data,
+                SDL_JobCounter *counter)
+{
+    SDL_Job *job;
+
+    if (!function) {
+        return SDL_InvalidParamError("function");
+    }
+    if (SDL_InitJobs() < 0) {
+        return -1;
+    }
+
+    job = (SDL_Job *)SDL_malloc(sizeof (*job));
+    if (!job) {
+        return SDL_OutOfMemory();
+    }
+    job->function = function;
+    job->data = data;
+    job->counter = counter;
+    job->allocated = SDL_TRUE;
+    job->next = NULL;
+    if (counter) {
+        SDL_AtomicIncRef(&counter->value);
+    }
+
+    if (dependency) {
+        SDL_AtomicLock(&dependency->lock);
+        if (SDL_AtomicGet(&dependency->value) > 0) {
+            job->next = dependency->dependents;
+            dependency->dependents = job;
+            SDL_AtomicUnlock(&dependency->lock);
+            return 0;
+        }
+        SDL_AtomicUnlock(&dependency->lock);
+    }
+
+    SDL_QueueJobs(job, job, 1);
+    return 0;
+}
+
+int
+SDL_RunJob(SDL_JobFunction function, void *data, SDL_JobCounter *counter)
+{
+    return SDL_RunJobAfter(NULL, function, data, counter);
+}
+
+void
+SDL_WaitJobCounter(SDL_JobCounter *counter)
+{
+    int self;
+
+    if (!counter) {
+        return;
+    }
+
+    self = SDL_GetJobWorker();
+    while (SDL_AtomicGet(&counter->value) > 0) {
+        SDL_Job *job;
+
+        if (!SDL_AtomicGet(&SDL_jobs.active)) {
+            /* Nothing is going to run them */
+            break;
+        }
+        job = SDL_FindJob(self);
+        if (job) {
+            SDL_RunJobNow(job);
+        } else {
+            SDL_SleepForJobs(counter);
+        }
+    }
+
+    /* Make sure the thread that finished the last job let go of it */
+    SDL_AtomicLock(&counter->lock);
+    SDL_AtomicUnlock(&counter->lock);
+}
+
+static void SDLCALL
+SDL_RunParallelForJob(void *data)
+{
+    SDL_ParallelForJob *piece = (SDL_ParallelForJob *)data;
+    piece->function(piece->start, piece->end, piece->data);
+}
+
+int
+SDL_ParallelFor(int count, int grain, SDL_ParallelForFunction function, void *data)
+{
+    SDL_ParallelForJob *pieces;
+    SDL_JobCounter counter;
+    int num_pieces, i;
+
+    if (!function) {
+        return SDL_InvalidParamError("function");
+    }
+    if (count <= 0) {
+        return 0;
+    }
+
+    if (SDL_InitJobs() < 0) {
+        function(0, count, data);
+        return 0;
+    }
+    if (grain <= 0) {
+        grain = SDL_max(count / (SDL_jobs.num_workers * 4), 1);
+    }
+    num_pieces = (count / grain) + ((count % grain) ? 1 : 0);
+    if (num_pieces <= 1) {
+        function(0, count, data);
+        return 0;
+    }
+
+    pieces = (SDL_ParallelForJob *)SDL_malloc(num_pieces * sizeof (*pieces));
+    if (!pieces) {
+        function(0, count, data);
+        return 0;
+    }
+
+    SDL_zero(counter);
+    SDL_AtomicSet(&counter.value, num_pieces - 1);
+    for (i = 0; i < num_pieces; ++i) {
+        SDL_ParallelForJob *piece = &pieces[i];
+        piece->job.function = SDL_RunParallelForJob;
+        piece->job.data = piece;
+        piece->job.counter = &counter;
+        piece->job.allocated = SDL_FALSE;
+        piece->job.next = (i + 1 < num_pieces) ? &pieces[i + 1].job : NULL;
+        piece->function = function;
+        piece->data = data;
+        piece->start = i * grain;
+        piece->end = SDL_min(piece->start + grain, count);
+    }
+
+    /* Hand out all but the first piece, which this thread does itself */
+    SDL_QueueJobs(&pieces[1].job, &pieces[num_pieces - 1].job, num_pieces - 1);
+    function(pieces[0].start, pieces[0].end, data);
+    SDL_WaitJobCounter(&counter);
+
+    SDL_free(pieces);
+    return 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,390 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+/* Lock profiling, see SDL_GetLockStats() */
+
+#include "SDL_atomic.h"
+#include "SDL_mutex.h"
+#include "SDL_timer.h"
+#include "SDL_lockprof_c.h"
+#include "../SDL_trace_c.h"
+
+#if SDL_LOCK_PROFILING
+
+#define SDL_MAX_LOCK_PROFILES   256
+
+struct SDL_LockProfile
+{
+    Uint64 acquires;
+    Uint64 contended;
+    Uint64 wait_total;          /* in performance counter ticks */
+    Uint64 wait_max;
+    Uint64 hold_total;
+    Uint64 hold_max;
+    SDL_LockStatsType type;
+    char name[sizeof (((SDL_LockStats *)0)->name)];
+};
+
+/* Entries are never removed, so locks can keep pointing at them. The first
+   few are for the locks that haven't been given a name. */
+static SDL_LockProfile SDL_lock_profiles[SDL_MAX_LOCK_PROFILES];
+static SDL_atomic_t SDL_num_lock_profiles;
+static SDL_SpinLock SDL_lock_profiles_lock;
+
+static const char *SDL_unnamed_locks[] = { "SDL_mutex", "SDL_sem", "SDL_cond" };
+static const char *SDL_lock_type_names[] = { "mutex", "semaphore", "condition" };
+
+#ifdef __GCC_HAVE_SYNC_COMPARE_AND_SWAP_8
+static SDL_INLINE void
+SDL_LockStatAdd(Uint64 *stat, Uint64 value)
+{
+    __atomic_fetch_add(stat, value, __ATOMIC_RELAXED);
+}
+
+static SDL_INLINE void
+SDL_LockStatMax(Uint64 *stat, Uint64 value)
+{
+    Uint64 current = __atomic_load_n(stat, __ATOMIC_RELAXED);
+    while (value > current &&
+           !__atomic_compare_exchange_n(stat, &current, value, SDL_TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static SDL_INLINE Uint64
+SDL_LockStatGet(Uint64 *stat)
+{
+    return __atomic_load_n(stat, __ATOMIC_RELAXED);
+}
+
+static SDL_INLINE void
+SDL_LockStatClear(Uint64 *stat)
+{
+    __atomic_store_n(stat, 0, __ATOMIC_RELAXED);
+}
+#else
+/* No 64-bit atomics here, take turns instead */
+static SDL_SpinLock SDL_lock_stats_lock;
+
+static void
+SDL_LockStatAdd(Uint64 *stat, Uint64 value)
+{
+    SDL_AtomicLock(&SDL_lock_stats_lock);
+    *stat += value;
+    SDL_AtomicUnlock(&SDL_lock_stats_lock);
+}
+
+static void
+SDL_LockStatMax(Uint64 *stat, Uint64 value)
+{
+    SDL_AtomicLock(&SDL_lock_stats_lock);
+    if (value > *stat) {
+        *stat = value;
+    }
+    SDL_AtomicUnlock(&SDL_lock_stats_lock);
+}
+
+static Uint64
+SDL_LockStatGet(Uint64 *stat)
+{
+    Uint64 value;
+    SDL_AtomicLock(&SDL_lock_stats_lock);
+    value = *stat;
+    SDL_AtomicUnlock(&SDL_lock_stats_lock);
+    return value;
+}
+
+static void
+SDL_LockStatClear(Uint64 *stat)
+{
+    SDL_AtomicLock(&SDL_lock_stats_lock);
+    *stat = 0;
+    SDL_AtomicUnlock(&SDL_lock_stats_lock);
+}
+#endif /* __GCC_HAVE_SYNC_COMPARE_AND_SWAP_8 */
+
+/* Call with SDL_lock_profiles_lock held */
+static SDL_LockProfile *
+SDL_FindLockProfile(SDL_LockStatsType type, const char *name)
+{
+    const int count = SDL_AtomicGet(&SDL_num_lock_profiles);
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        SDL_LockProfile *profile = &SDL_lock_profiles[i];
+        if (profile->type == type &&
+            SDL_strncmp(profile->name, name, sizeof (profile->name) - 1) == 0) {
+            return profile;
+        }
+    }
+    return NULL;
+}
+
+/* Call with SDL_lock_profiles_lock held */
+static SDL_LockProfile *
+SDL_AddLockProfile(SDL_LockStatsType type, const char *name)
+{
+    const int count = SDL_AtomicGet(&SDL_num_lock_profiles);
+    SDL_LockProfile *profile;
+
+    if (count == SDL_MAX_LOCK_PROFILES) {
+        return NULL;
+    }
+    profile = &SDL_lock_profiles[count];
+    profile->type = type;
+    SDL_strlcpy(profile->name, name, sizeof (profile->name));
+
+    /* Readers don't take the lock, publish the entry after filling it in */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&SDL_num_lock_profiles, count + 1);
+    return profile;
+}
+
+SDL_LockProfile *
+SDL_GetLockProfile(SDL_LockStatsType type, const char *name)
+{
+    SDL_LockProfile *profile;
+    int i;
+
+    SDL_AtomicLock(&SDL_lock_profiles_lock);
+    if (SDL_AtomicGet(&SDL_num_lock_profiles) == 0) {
+        for (i = 0; i < SDL_arraysize(SDL_unnamed_locks); ++i) {
+            SDL_AddLockProfile((SDL_LockStatsType)i, SDL_unnamed_locks[i]);
+        }
+    }
+    if (!name || !*name) {
+        name = SDL_unnamed_locks[type];
+    }
+    profile = SDL_FindLockProfile(type, name);
+    if (!profile) {
+        profile = SDL_AddLockProfile(type, name);
+        if (!profile) {
+            /* Out of room, count it with the unnamed ones */
+            profile = &SDL_lock_profiles[type];
+        }
+    }
+    SDL_AtomicUnlock(&SDL_lock_profiles_lock);
+
+    return profile;
+}
+
+Uint64
+SDL_LockProfileAcquired(SDL_LockProfile *profile, Uint64 wait_start)
+{
+    const Uint64 now = SDL_GetPerformanceCounter();
+
+    SDL_LockStatAdd(&profile->acquires, 1);
+    if (wait_start) {
+        const Uint64 waited = now - wait_start;
+        SDL_LockStatAdd(&profile->contended, 1);
+        SDL_LockStatAdd(&profile->wait_total, waited);
+        SDL_LockStatMax(&profile->wait_max, waited);
+    }
+    return now;
+}
+
+void
+SDL_LockProfileReleased(SDL_LockProfile *profile, Uint64 acquired)
+{
+    const Uint64 held = SDL_GetPerformanceCounter() - acquired;
+
+    SDL_LockStatAdd(&profile->hold_total, held);
+    SDL_LockStatMax(&profile->hold_max, held);
+}
+
+static Uint64
+SDL_LockTicksToNS(Uint64 ticks)
+{
+    static Uint64 frequency = 0;
+
+    if (!frequency) {
+        frequency = SDL_GetPerformanceFrequency();
+    }
+    return (Uint64)((double)ticks * 1000000000.0 / (double)frequency);
+}
+
+int
+SDL_GetLockStats(SDL_LockStats * stats, int maxstats)
+{
+    const int count = SDL_AtomicGet(&SDL_num_lock_profiles);
+    int i;
+
+    if (stats) {
+        for (i = 0; i < count && i < maxstats; ++i) {
+            SDL_LockProfile *profile = &SDL_lock_profiles[i];
+            SDL_LockStats *entry = &stats[i];
+
+            SDL_strlcpy(entry->name, profile->name, sizeof (entry->name));
+            entry->type = profile->type;
+            entry->acquires = SDL_LockStatGet(&profile->acquires);
+            entry->contended = SDL_LockStatGet(&profile->contended);
+            entry->wait_total_ns = SDL_LockTicksToNS(SDL_LockStatGet(&profile->wait_total));
+            entry->wait_max_ns = SDL_LockTicksToNS(SDL_LockStatGet(&profile->wait_max));
+            entry->hold_total_ns = SDL_LockTicksToNS(SDL_LockStatGet(&profile->hold_total));
+            entry->hold_max_ns = SDL_LockTicksToNS(SDL_LockStatGet(&profile->hold_max));
+        }
+    }
+    return count;
+}
+
+typedef struct
+{
+    char *data;
+    size_t length;
+    size_t size;
+} SDL_LockStatsJSON;
+
+static SDL_bool
+SDL_AppendLockStatsJSON(SDL_LockStatsJSON *json, const char *fmt, ...)
+{
+    va_list ap;
+    int length;
+
+    for ( ; ; ) {
+        va_start(ap, fmt);
+        length = SDL_vsnprintf(json->data + json->length, json->size - json->length, fmt, ap);
+        va_end(ap);
+        if (length < 0) {
+            return SDL_FALSE;
+        }
+        if (json->length + length < json->size) {
+            json->length += length;
+            return SDL_TRUE;
+        } else {
+            const size_t size = SDL_max(json->size * 2, json->length + length + 1);
+            char *data = (char *)SDL_realloc(json->data, size);
+            if (!data) {
+                SDL_OutOfMemory();
+                return SDL_FALSE;
+            }
+            json->data = data;
+            json->size = size;
+        }
+    }
+}
+
+char *
+SDL_GetLockStatsJSON(void)
+{
+    SDL_LockStats *stats;
+    SDL_LockStatsJSON json;
+    int count = SDL_GetLockStats(NULL, 0);
+    int i;
+
+    SDL_zero(json);
+    json.size = 256 + count * 256;
+    json.data = (char *)SDL_malloc(json.size);
+    stats = (SDL_LockStats *)SDL_malloc(SDL_max(count, 1) * sizeof (*stats));
+    if (!json.data || !stats) {
+        SDL_free(json.data);
+        SDL_free(stats);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    count = SDL_min(SDL_GetLockStats(stats, count), count);
+    json.data[0] = '\0';
+
+    if (!SDL_AppendLockStatsJSON(&json, "{\"locks\":[")) {
+        goto error;
+    }
+    for (i = 0; i < count; ++i) {
+        const SDL_LockStats *entry = &stats[i];
+        char name[sizeof (entry->name) * 6];
+
+        if (!SDL_AppendLockStatsJSON(&json,
+                "%s\n{\"name\":\"%s\",\"type\":\"%s\",\"acquires\":%" SDL_PRIu64 ",\"contended\":%" SDL_PRIu64
+                ",\"wait_total_ns\":%" SDL_PRIu64 ",\"wait_max_ns\":%" SDL_PRIu64
+                ",\"hold_total_ns\":%" SDL_PRIu64 ",\"hold_max_ns\":%" SDL_PRIu64 "}",
+                i ? "," : "", SDL_EscapeJSONString(entry->name, name, sizeof (name)), SDL_lock_type_names[entry->type],
+                entry->acquires, entry->contended, entry->wait_total_ns, entry->wait_max_ns,
+                entry->hold_total_ns, entry->hold_max_ns)) {
+            goto error;
+        }
+    }
+    if (!SDL_AppendLockStatsJSON(&json, "\n]}\n")) {
+        goto error;
+    }
+    SDL_free(stats);
+    return json.data;
+
+error:
+    SDL_free(stats);
+    SDL_free(json.data);
+    return NULL;
+}
+
+void
+SDL_ResetLockStats(void)
+{
+    const int count = SDL_AtomicGet(&SDL_num_lock_profiles);
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        SDL_LockProfile *profile = &SDL_lock_profiles[i];
+        SDL_LockStatClear(&profile->acquires);
+        SDL_LockStatClear(&profile->contended);
+        SDL_LockStatClear(&profile->wait_total);
+        SDL_LockStatClear(&profile->wait_max);
+        SDL_LockStatClear(&profile->hold_total);
+        SDL_LockStatClear(&profile->hold_max);
+    }
+}
+
+#else /* !SDL_LOCK_PROFILING */
+
+/* The thread backends set the names when profiling is built in */
+
+void
+SDL_SetMutexName(SDL_mutex * mutex, const char *name)
+{
+}
+
+void
+SDL_SetSemaphoreName(SDL_sem * sem, const char *name)
+{
+}
+
+void
+SDL_SetCondName(SDL_cond * cond, const char *name)
+{
+}
+
+int
+SDL_GetLockStats(SDL_LockStats * stats, int maxstats)
+{
+    return SDL_Unsupported();
+}
+
+char *
+SDL_GetLockStatsJSON(void)
+{
+    SDL_Unsupported();
+    return NULL;
+}
+
+void
+SDL_ResetLockStats(void)
+{
+}
+
+#endif /* SDL_LOCK_PROFILING */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,52 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+#ifndef SDL_lockprof_c_h_
+#define SDL_lockprof_c_h_
+
+/* Contention statistics for the thread backends, see SDL_GetLockStats().
+   Everything here only exists when SDL_LOCK_PROFILING is set. */
+
+#if SDL_LOCK_PROFILING
+
+#include "SDL_mutex.h"
+#include "SDL_timer.h"
+
+/* Statistics shared by all the locks with the same name and type */
+typedef struct SDL_LockProfile SDL_LockProfile;
+
+/* Find or add the entry for a name, NULL gives the one for unnamed locks */
+extern SDL_LockProfile *SDL_GetLockProfile(SDL_LockStatsType type, const char *name);
+
+/* Count an acquire, wait_start is the performance counter when the thread
+   started waiting, or 0 if it didn't have to. Returns the current counter,
+   for measuring how long the lock is held. */
+extern Uint64 SDL_LockProfileAcquired(SDL_LockProfile *profile, Uint64 wait_start);
+
+/* Count the time a mutex was held since acquired */
+extern void SDL_LockProfileReleased(SDL_LockProfile *profile, Uint64 acquired);
+
+#endif /* SDL_LOCK_PROFILING */
+
+#endif /* SDL_lockprof_c_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -28,6 +28,7 @@
 #include "SDL_systhread.h"
 #include "SDL_hints.h"
 #include "../SDL_error_c.h"
+#include "../SDL_trace_c.h"
 
 
 SDL_TLSID
@@ -83,6 +84,18 @@ SDL_TLSSet(SDL_TLSID id, const void *value, void (SDLCALL *destructor)(void *))
     return 0;
 }
 
+static void
+SDL_TLSCallDestructors(SDL_TLSData *storage)
+{
+    unsigned int i;
+
+    for (i = 0; i < storage->limit; ++i) {
+        if (storage->array[i].destructor) {
+            storage->array[i].destructor(storage->array[i].data);
+        }
+    }
+}
+
 static void
 SDL_TLSCleanup()
 {
@@ -90,17 +103,22 @@ SDL_TLSCleanup()
 
     storage = SDL_SYS_GetTLSData();
     if (storage) {
-        unsigned int i;
-        for (i = 0; i < storage->limit; ++i) {
-            if (storage->array[i].destructor) {
-                storage->array[i].destructor(storage->array[i].data);
-            }
-        }
+        SDL_TLSCallDestructors(storage);
         SDL_SYS_SetTLSData(NULL);
         SDL_free(storage);
     }
 }
 
+/* Called by the system when a thread SDL didn't create exits with storage */
+void
+SDL_TLSDestroyData(void *data)
+{
+    SDL_TLSData *storage = (SDL_TLSData *)data;
+
+    SDL_TLSCallDestructors(storage);
+    SDL_free(storage);
+}
+
 
 /* This is a generic implementation of thread-local storage which doesn't
    require additional OS support.
@@ -281,6 +299,7 @@ SDL_RunThread(void *data)
 
     /* Get the thread id */
     thread->threadid = SDL_ThreadID();
+    SDL_TraceThreadStarted(thread->name);
 
     /* Wake up the parent thread */
     SDL_SemPost(args->wait);
@@ -75,6 +75,10 @@ typedef struct {
     } array[1];
 } SDL_TLSData;
 
+/* Run the destructors and free the storage of a thread that has exited
+   without going through SDL_RunThread(), for systems that can tell us. */
+extern void SDL_TLSDestroyData(void *data);
+
 /* This is how many TLS entries we allocate at once */
 #define TLS_ALLOC_CHUNKSIZE 4
 
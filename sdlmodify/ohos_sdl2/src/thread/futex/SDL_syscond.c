@@ -0,0 +1,148 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+/* Condition variable on a Linux futex. The futex word is a sequence number
+   bumped by every signal, so a waiter can't miss one that comes in between
+   unlocking the mutex and going to sleep. */
+
+#include "SDL_thread.h"
+#include "SDL_sysfutex_c.h"
+#include "../SDL_lockprof_c.h"
+
+struct SDL_cond
+{
+    SDL_atomic_t sequence;
+    SDL_atomic_t waiters;
+#if SDL_LOCK_PROFILING
+    SDL_LockProfile *profile;
+#endif
+};
+
+/* Create a condition variable */
+SDL_cond *
+SDL_CreateCond(void)
+{
+    SDL_cond *cond;
+
+    cond = (SDL_cond *) SDL_calloc(1, sizeof(SDL_cond));
+    if (cond) {
+#if SDL_LOCK_PROFILING
+        cond->profile = SDL_GetLockProfile(SDL_LOCKSTATS_CONDITION, NULL);
+#endif
+    } else {
+        SDL_OutOfMemory();
+    }
+    return (cond);
+}
+
+/* Destroy a condition variable */
+void
+SDL_DestroyCond(SDL_cond * cond)
+{
+    if (cond) {
+        SDL_free(cond);
+    }
+}
+
+static int
+SDL_WakeCond(SDL_cond * cond, int count)
+{
+    if (!cond) {
+        return SDL_SetError("Passed a NULL condition variable");
+    }
+
+    SDL_AtomicIncRef(&cond->sequence);
+    if (SDL_AtomicAdd(&cond->waiters, 0) > 0) {
+        SDL_FutexWake(&cond->sequence, count);
+    }
+    return 0;
+}
+
+/* Restart one of the threads that are waiting on the condition variable */
+int
+SDL_CondSignal(SDL_cond * cond)
+{
+    return SDL_WakeCond(cond, 1);
+}
+
+/* Restart all threads that are waiting on the condition variable */
+int
+SDL_CondBroadcast(SDL_cond * cond)
+{
+    return SDL_WakeCond(cond, INT_MAX);
+}
+
+/* Wait on the condition variable for at most 'ms' milliseconds.
+   The mutex must be locked before entering this function!
+   The mutex is unlocked during the wait, and locked again after the wait.
+ */
+int
+SDL_CondWaitTimeout(SDL_cond * cond, SDL_mutex * mutex, Uint32 ms)
+{
+    int sequence;
+    int retval;
+#if SDL_LOCK_PROFILING
+    Uint64 wait_start;
+#endif
+
+    if (!cond) {
+        return SDL_SetError("Passed a NULL condition variable");
+    }
+
+    sequence = SDL_AtomicGet(&cond->sequence);
+    SDL_AtomicIncRef(&cond->waiters);
+    if (SDL_UnlockMutex(mutex) < 0) {
+        SDL_AtomicAdd(&cond->waiters, -1);
+        return -1;
+    }
+
+#if SDL_LOCK_PROFILING
+    wait_start = SDL_GetPerformanceCounter();
+#endif
+    retval = SDL_FutexWait(&cond->sequence, sequence, SDL_FutexDeadline(ms));
+#if SDL_LOCK_PROFILING
+    SDL_LockProfileAcquired(cond->profile, wait_start);
+#endif
+
+    SDL_AtomicAdd(&cond->waiters, -1);
+    SDL_LockMutex(mutex);
+    return retval;
+}
+
+/* Wait on the condition variable forever */
+int
+SDL_CondWait(SDL_cond * cond, SDL_mutex * mutex)
+{
+    return SDL_CondWaitTimeout(cond, mutex, SDL_MUTEX_MAXWAIT);
+}
+
+#if SDL_LOCK_PROFILING
+void
+SDL_SetCondName(SDL_cond * cond, const char *name)
+{
+    if (cond) {
+        cond->profile = SDL_GetLockProfile(SDL_LOCKSTATS_CONDITION, name);
+    }
+}
+#endif
+
+/* vi: set ts=4 sw=4 expandtab: */
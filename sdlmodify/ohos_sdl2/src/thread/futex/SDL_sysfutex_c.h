@@ -0,0 +1,108 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#ifndef SDL_sysfutex_c_h_
+#define SDL_sysfutex_c_h_
+
+/* Thin wrappers around the Linux futex system call */
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "SDL_atomic.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_mutex.h"
+
+/* How many times a mutex or semaphore may poll before going to sleep */
+#define SDL_FUTEX_MAX_SPIN  100
+
+/* Spinning only helps if the thread we're waiting on can run meanwhile */
+static SDL_INLINE SDL_bool
+SDL_FutexShouldSpin(void)
+{
+    static int num_cpus = 0;
+
+    if (num_cpus == 0) {
+        num_cpus = SDL_GetCPUCount();
+    }
+    return (num_cpus > 1) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Nanoseconds on the monotonic clock, for timeouts */
+static SDL_INLINE Sint64
+SDL_FutexNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((Sint64)now.tv_sec * 1000000000) + now.tv_nsec;
+}
+
+/* Deadline for a timeout in milliseconds, -1 for SDL_MUTEX_MAXWAIT */
+static SDL_INLINE Sint64
+SDL_FutexDeadline(Uint32 ms)
+{
+    if (ms == SDL_MUTEX_MAXWAIT) {
+        return -1;
+    }
+    return SDL_FutexNow() + (Sint64)ms * 1000000;
+}
+
+/* Sleep while the value is still `expected`, until woken or the deadline.
+   Returns 0 when it should look again, SDL_MUTEX_TIMEDOUT once the deadline
+   has passed. Like any futex wait, this may return for no reason. */
+static SDL_INLINE int
+SDL_FutexWait(SDL_atomic_t *futex, int expected, Sint64 deadline)
+{
+    struct timespec timeout;
+    struct timespec *ptimeout = NULL;
+
+    if (deadline >= 0) {
+        const Sint64 remaining = deadline - SDL_FutexNow();
+        if (remaining <= 0) {
+            return SDL_MUTEX_TIMEDOUT;
+        }
+        timeout.tv_sec = (time_t)(remaining / 1000000000);
+        timeout.tv_nsec = (long)(remaining % 1000000000);
+        ptimeout = &timeout;
+    }
+
+    /* The timeout is relative and measured on the monotonic clock */
+    if (syscall(SYS_futex, &futex->value, FUTEX_WAIT_PRIVATE, expected, ptimeout, NULL, 0) < 0 &&
+        errno == ETIMEDOUT) {
+        return SDL_MUTEX_TIMEDOUT;
+    }
+    return 0;
+}
+
+static SDL_INLINE void
+SDL_FutexWake(SDL_atomic_t *futex, int count)
+{
+    syscall(SYS_futex, &futex->value, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+}
+
+#endif /* SDL_sysfutex_c_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,183 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+/* Recursive mutex on a Linux futex: spin a little, then sleep in the kernel */
+
+#include "SDL_thread.h"
+#include "SDL_sysfutex_c.h"
+#include "SDL_sysmutex_c.h"
+#include "../../atomic/SDL_atomic_c.h"
+
+SDL_mutex *
+SDL_CreateMutex(void)
+{
+    SDL_mutex *mutex;
+
+    /* Allocate the structure */
+    mutex = (SDL_mutex *) SDL_calloc(1, sizeof(*mutex));
+    if (mutex) {
+#if SDL_LOCK_PROFILING
+        mutex->profile = SDL_GetLockProfile(SDL_LOCKSTATS_MUTEX, NULL);
+#endif
+    } else {
+        SDL_OutOfMemory();
+    }
+    return (mutex);
+}
+
+void
+SDL_DestroyMutex(SDL_mutex * mutex)
+{
+    if (mutex) {
+        SDL_free(mutex);
+    }
+}
+
+static void
+SDL_LockMutexContended(SDL_mutex * mutex)
+{
+    /* Adaptive spinning: try for a while longer than it usually takes,
+       and keep a running average of how long that was. */
+    if (SDL_FutexShouldSpin()) {
+        const int max_spin = SDL_min(mutex->spin * 2 + 10, SDL_FUTEX_MAX_SPIN);
+        int spin;
+
+        for (spin = 0; spin < max_spin; ++spin) {
+            PAUSE_INSTRUCTION();
+            if (SDL_AtomicGet(&mutex->state) == 0 && SDL_AtomicCAS(&mutex->state, 0, 1)) {
+                mutex->spin += (spin - mutex->spin) / 8;
+                return;
+            }
+        }
+        mutex->spin += (max_spin - mutex->spin) / 8;
+    }
+
+    /* Mark it as having sleepers, whoever unlocks it will wake one of us */
+    while (SDL_AtomicSet(&mutex->state, 2) != 0) {
+        SDL_FutexWait(&mutex->state, 2, -1);
+    }
+}
+
+/* Lock the mutex */
+int
+SDL_LockMutex(SDL_mutex * mutex)
+{
+    SDL_threadID this_thread;
+
+    if (mutex == NULL) {
+        return SDL_SetError("Passed a NULL mutex");
+    }
+
+    this_thread = SDL_ThreadID();
+    if (mutex->owner == this_thread) {
+        ++mutex->recursive;
+    } else {
+#if SDL_LOCK_PROFILING
+        Uint64 wait_start = 0;
+#endif
+        /* The order of operations is important.
+           We set the locking thread id after we obtain the lock
+           so unlocks from other threads will fail.
+         */
+        if (!SDL_AtomicCAS(&mutex->state, 0, 1)) {
+#if SDL_LOCK_PROFILING
+            wait_start = SDL_GetPerformanceCounter();
+#endif
+            SDL_LockMutexContended(mutex);
+        }
+        mutex->owner = this_thread;
+        mutex->recursive = 0;
+#if SDL_LOCK_PROFILING
+        mutex->acquired = SDL_LockProfileAcquired(mutex->profile, wait_start);
+#endif
+    }
+    return 0;
+}
+
+int
+SDL_TryLockMutex(SDL_mutex * mutex)
+{
+    SDL_threadID this_thread;
+
+    if (mutex == NULL) {
+        return SDL_SetError("Passed a NULL mutex");
+    }
+
+    this_thread = SDL_ThreadID();
+    if (mutex->owner == this_thread) {
+        ++mutex->recursive;
+    } else if (SDL_AtomicCAS(&mutex->state, 0, 1)) {
+        mutex->owner = this_thread;
+        mutex->recursive = 0;
+#if SDL_LOCK_PROFILING
+        mutex->acquired = SDL_LockProfileAcquired(mutex->profile, 0);
+#endif
+    } else {
+        return SDL_MUTEX_TIMEDOUT;
+    }
+    return 0;
+}
+
+int
+SDL_UnlockMutex(SDL_mutex * mutex)
+{
+    if (mutex == NULL) {
+        return SDL_SetError("Passed a NULL mutex");
+    }
+
+    /* We can only unlock the mutex if we own it */
+    if (SDL_ThreadID() != mutex->owner) {
+        return SDL_SetError("mutex not owned by this thread");
+    }
+
+    if (mutex->recursive) {
+        --mutex->recursive;
+    } else {
+        /* The order of operations is important.
+           First reset the owner so another thread doesn't lock
+           the mutex and set the ownership before we reset it,
+           then release the lock.
+         */
+#if SDL_LOCK_PROFILING
+        SDL_LockProfileReleased(mutex->profile, mutex->acquired);
+#endif
+        mutex->owner = 0;
+        if (SDL_AtomicAdd(&mutex->state, -1) != 1) {
+            /* Somebody is sleeping on it */
+            SDL_AtomicSet(&mutex->state, 0);
+            SDL_FutexWake(&mutex->state, 1);
+        }
+    }
+    return 0;
+}
+
+#if SDL_LOCK_PROFILING
+void
+SDL_SetMutexName(SDL_mutex * mutex, const char *name)
+{
+    if (mutex) {
+        mutex->profile = SDL_GetLockProfile(SDL_LOCKSTATS_MUTEX, name);
+    }
+}
+#endif
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,183 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+/* Semaphore on a Linux futex, the count is the futex word */
+
+#include "SDL_thread.h"
+#include "SDL_sysfutex_c.h"
+#include "../SDL_lockprof_c.h"
+#include "../../atomic/SDL_atomic_c.h"
+
+struct SDL_semaphore
+{
+    SDL_atomic_t count;
+    SDL_atomic_t sleepers;
+#if SDL_LOCK_PROFILING
+    SDL_LockProfile *profile;
+#endif
+};
+
+/* Create a semaphore, initialized with value */
+SDL_sem *
+SDL_CreateSemaphore(Uint32 initial_value)
+{
+    SDL_sem *sem = (SDL_sem *) SDL_calloc(1, sizeof(SDL_sem));
+    if (sem) {
+        SDL_AtomicSet(&sem->count, (int)initial_value);
+#if SDL_LOCK_PROFILING
+        sem->profile = SDL_GetLockProfile(SDL_LOCKSTATS_SEMAPHORE, NULL);
+#endif
+    } else {
+        SDL_OutOfMemory();
+    }
+    return sem;
+}
+
+void
+SDL_DestroySemaphore(SDL_sem * sem)
+{
+    if (sem) {
+        SDL_free(sem);
+    }
+}
+
+int
+SDL_SemTryWait(SDL_sem * sem)
+{
+    int count;
+
+    if (!sem) {
+        return SDL_SetError("Passed a NULL semaphore");
+    }
+
+    while ((count = SDL_AtomicGet(&sem->count)) > 0) {
+        if (SDL_AtomicCAS(&sem->count, count, count - 1)) {
+            return 0;
+        }
+    }
+    return SDL_MUTEX_TIMEDOUT;
+}
+
+int
+SDL_SemWaitTimeout(SDL_sem * sem, Uint32 timeout)
+{
+    Sint64 deadline;
+    int retval;
+#if SDL_LOCK_PROFILING
+    Uint64 wait_start;
+#endif
+
+    /* Try the easy cases first */
+    retval = SDL_SemTryWait(sem);
+    if (retval != SDL_MUTEX_TIMEDOUT || timeout == 0) {
+#if SDL_LOCK_PROFILING
+        if (retval == 0) {
+            SDL_LockProfileAcquired(sem->profile, 0);
+        }
+#endif
+        return retval;
+    }
+
+#if SDL_LOCK_PROFILING
+    wait_start = SDL_GetPerformanceCounter();
+#endif
+
+    /* The post is often only a moment away */
+    if (SDL_FutexShouldSpin()) {
+        int spin;
+        for (spin = 0; spin < SDL_FUTEX_MAX_SPIN; ++spin) {
+            PAUSE_INSTRUCTION();
+            if (SDL_AtomicGet(&sem->count) > 0 && SDL_SemTryWait(sem) == 0) {
+#if SDL_LOCK_PROFILING
+                SDL_LockProfileAcquired(sem->profile, wait_start);
+#endif
+                return 0;
+            }
+        }
+    }
+
+    /* Posters only make the system call when somebody is asleep */
+    deadline = SDL_FutexDeadline(timeout);
+    SDL_AtomicIncRef(&sem->sleepers);
+    while ((retval = SDL_SemTryWait(sem)) == SDL_MUTEX_TIMEDOUT) {
+        if (SDL_FutexWait(&sem->count, 0, deadline) == SDL_MUTEX_TIMEDOUT) {
+            /* One last look, a post may have raced the timeout */
+            retval = SDL_SemTryWait(sem);
+            break;
+        }
+    }
+    SDL_AtomicAdd(&sem->sleepers, -1);
+
+#if SDL_LOCK_PROFILING
+    if (retval == 0) {
+        SDL_LockProfileAcquired(sem->profile, wait_start);
+    }
+#endif
+    return retval;
+}
+
+int
+SDL_SemWait(SDL_sem * sem)
+{
+    return SDL_SemWaitTimeout(sem, SDL_MUTEX_MAXWAIT);
+}
+
+Uint32
+SDL_SemValue(SDL_sem * sem)
+{
+    int ret = 0;
+    if (sem) {
+        ret = SDL_AtomicGet(&sem->count);
+        if (ret < 0) {
+            ret = 0;
+        }
+    }
+    return (Uint32) ret;
+}
+
+int
+SDL_SemPost(SDL_sem * sem)
+{
+    if (!sem) {
+        return SDL_SetError("Passed a NULL semaphore");
+    }
+
+    /* Both atomics are full barriers, so either the sleeper sees the new
+       count before it sleeps or we see that it's asleep */
+    SDL_AtomicIncRef(&sem->count);
+    if (SDL_AtomicAdd(&sem->sleepers, 0) > 0) {
+        SDL_FutexWake(&sem->count, 1);
+    }
+    return 0;
+}
+
+#if SDL_LOCK_PROFILING
+void
+SDL_SetSemaphoreName(SDL_sem * sem, const char *name)
+{
+    if (sem) {
+        sem->profile = SDL_GetLockProfile(SDL_LOCKSTATS_SEMAPHORE, name);
+    }
+}
+#endif
+
+/* vi: set ts=4 sw=4 expandtab: */
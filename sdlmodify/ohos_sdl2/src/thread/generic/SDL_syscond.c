@@ -217,4 +217,12 @@ SDL_CondWait(SDL_cond * cond, SDL_mutex * mutex)
     return SDL_CondWaitTimeout(cond, mutex, SDL_MUTEX_MAXWAIT);
 }
 
+#if SDL_LOCK_PROFILING
+/* Not profiled itself, the mutex and semaphores it uses are */
+void
+SDL_SetCondName(SDL_cond * cond, const char *name)
+{
+}
+#endif
+
 /* vi: set ts=4 sw=4 expandtab: */
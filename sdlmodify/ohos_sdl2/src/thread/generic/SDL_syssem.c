@@ -214,4 +214,12 @@ SDL_SemPost(SDL_sem * sem)
 }
 
 #endif /* SDL_THREADS_DISABLED */
+#if SDL_LOCK_PROFILING
+/* Not profiled itself, the mutex and condition variable it uses are */
+void
+SDL_SetSemaphoreName(SDL_sem * sem, const char *name)
+{
+}
+#endif
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -32,6 +32,9 @@
 struct SDL_cond
 {
     pthread_cond_t cond;
+#if SDL_LOCK_PROFILING
+    SDL_LockProfile *profile;
+#endif
 };
 
 /* Create a condition variable */
@@ -47,6 +50,11 @@ SDL_CreateCond(void)
             SDL_free(cond);
             cond = NULL;
         }
+#if SDL_LOCK_PROFILING
+        if (cond) {
+            cond->profile = SDL_GetLockProfile(SDL_LOCKSTATS_CONDITION, NULL);
+        }
+#endif
     }
     return (cond);
 }
@@ -103,6 +111,9 @@ SDL_CondWaitTimeout(SDL_cond * cond, SDL_mutex * mutex, Uint32 ms)
     struct timeval delta;
 #endif
     struct timespec abstime;
+#if SDL_LOCK_PROFILING
+    Uint64 wait_start;
+#endif
 
     if (!cond) {
         return SDL_SetError("Passed a NULL condition variable");
@@ -124,6 +135,11 @@ SDL_CondWaitTimeout(SDL_cond * cond, SDL_mutex * mutex, Uint32 ms)
         abstime.tv_nsec -= 1000000000;
     }
 
+#if SDL_LOCK_PROFILING
+    /* The mutex isn't held while waiting */
+    SDL_LockProfileReleased(mutex->profile, mutex->acquired);
+    wait_start = SDL_GetPerformanceCounter();
+#endif
   tryagain:
     retval = pthread_cond_timedwait(&cond->cond, &mutex->id, &abstime);
     switch (retval) {
@@ -138,6 +154,9 @@ SDL_CondWaitTimeout(SDL_cond * cond, SDL_mutex * mutex, Uint32 ms)
     default:
         retval = SDL_SetError("pthread_cond_timedwait() failed");
     }
+#if SDL_LOCK_PROFILING
+    mutex->acquired = SDL_LockProfileAcquired(cond->profile, wait_start);
+#endif
     return retval;
 }
 
@@ -147,12 +166,36 @@ SDL_CondWaitTimeout(SDL_cond * cond, SDL_mutex * mutex, Uint32 ms)
 int
 SDL_CondWait(SDL_cond * cond, SDL_mutex * mutex)
 {
+    int result;
+#if SDL_LOCK_PROFILING
+    Uint64 wait_start;
+#endif
+
     if (!cond) {
         return SDL_SetError("Passed a NULL condition variable");
-    } else if (pthread_cond_wait(&cond->cond, &mutex->id) != 0) {
+    }
+#if SDL_LOCK_PROFILING
+    SDL_LockProfileReleased(mutex->profile, mutex->acquired);
+    wait_start = SDL_GetPerformanceCounter();
+#endif
+    result = pthread_cond_wait(&cond->cond, &mutex->id);
+#if SDL_LOCK_PROFILING
+    mutex->acquired = SDL_LockProfileAcquired(cond->profile, wait_start);
+#endif
+    if (result != 0) {
         return SDL_SetError("pthread_cond_wait() failed");
     }
     return 0;
 }
 
+#if SDL_LOCK_PROFILING
+void
+SDL_SetCondName(SDL_cond * cond, const char *name)
+{
+    if (cond) {
+        cond->profile = SDL_GetLockProfile(SDL_LOCKSTATS_CONDITION, name);
+    }
+}
+#endif
+
 /* vi: set ts=4 sw=4 expandtab: */
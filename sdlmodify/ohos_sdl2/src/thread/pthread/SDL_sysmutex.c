@@ -24,20 +24,7 @@
 #include <pthread.h>
 
 #include "SDL_thread.h"
-
-#if !SDL_THREAD_PTHREAD_RECURSIVE_MUTEX && \
-    !SDL_THREAD_PTHREAD_RECURSIVE_MUTEX_NP
-#define FAKE_RECURSIVE_MUTEX 1
-#endif
-
-struct SDL_mutex
-{
-    pthread_mutex_t id;
-#if FAKE_RECURSIVE_MUTEX
-    int recursive;
-    pthread_t owner;
-#endif
-};
+#include "SDL_sysmutex_c.h"
 
 SDL_mutex *
 SDL_CreateMutex(void)
@@ -49,18 +36,23 @@ SDL_CreateMutex(void)
     mutex = (SDL_mutex *) SDL_calloc(1, sizeof(*mutex));
     if (mutex) {
         pthread_mutexattr_init(&attr);
-#if SDL_THREAD_PTHREAD_RECURSIVE_MUTEX
+#if FAKE_RECURSIVE_MUTEX
+        /* No extra attributes necessary */
+#elif SDL_THREAD_PTHREAD_RECURSIVE_MUTEX
         pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
 #elif SDL_THREAD_PTHREAD_RECURSIVE_MUTEX_NP
         pthread_mutexattr_setkind_np(&attr, PTHREAD_MUTEX_RECURSIVE_NP);
-#else
-        /* No extra attributes necessary */
 #endif
         if (pthread_mutex_init(&mutex->id, &attr) != 0) {
             SDL_SetError("pthread_mutex_init() failed");
             SDL_free(mutex);
             mutex = NULL;
         }
+#if SDL_LOCK_PROFILING
+        if (mutex) {
+            mutex->profile = SDL_GetLockProfile(SDL_LOCKSTATS_MUTEX, NULL);
+        }
+#endif
     } else {
         SDL_OutOfMemory();
     }
@@ -97,12 +89,22 @@ SDL_LockMutex(SDL_mutex * mutex)
            We set the locking thread id after we obtain the lock
            so unlocks from other threads will fail.
          */
-        if (pthread_mutex_lock(&mutex->id) == 0) {
-            mutex->owner = this_thread;
-            mutex->recursive = 0;
-        } else {
+#if SDL_LOCK_PROFILING
+        Uint64 wait_start = 0;
+        if (pthread_mutex_trylock(&mutex->id) != 0) {
+            wait_start = SDL_GetPerformanceCounter();
+            if (pthread_mutex_lock(&mutex->id) != 0) {
+                return SDL_SetError("pthread_mutex_lock() failed");
+            }
+        }
+        mutex->acquired = SDL_LockProfileAcquired(mutex->profile, wait_start);
+#else
+        if (pthread_mutex_lock(&mutex->id) != 0) {
             return SDL_SetError("pthread_mutex_lock() failed");
         }
+#endif
+        mutex->owner = this_thread;
+        mutex->recursive = 0;
     }
 #else
     if (pthread_mutex_lock(&mutex->id) != 0) {
@@ -139,6 +141,9 @@ SDL_TryLockMutex(SDL_mutex * mutex)
         if (result == 0) {
             mutex->owner = this_thread;
             mutex->recursive = 0;
+#if SDL_LOCK_PROFILING
+            mutex->acquired = SDL_LockProfileAcquired(mutex->profile, 0);
+#endif
         } else if (result == EBUSY) {
             retval = SDL_MUTEX_TIMEDOUT;
         } else {
@@ -176,6 +181,9 @@ SDL_UnlockMutex(SDL_mutex * mutex)
                the mutex and set the ownership before we reset it,
                then release the lock semaphore.
              */
+#if SDL_LOCK_PROFILING
+            SDL_LockProfileReleased(mutex->profile, mutex->acquired);
+#endif
             mutex->owner = 0;
             pthread_mutex_unlock(&mutex->id);
         }
@@ -192,4 +200,14 @@ SDL_UnlockMutex(SDL_mutex * mutex)
     return 0;
 }
 
+#if SDL_LOCK_PROFILING
+void
+SDL_SetMutexName(SDL_mutex * mutex, const char *name)
+{
+    if (mutex) {
+        mutex->profile = SDL_GetLockProfile(SDL_LOCKSTATS_MUTEX, name);
+    }
+}
+#endif
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -23,9 +23,25 @@
 #ifndef SDL_mutex_c_h_
 #define SDL_mutex_c_h_
 
+#include "../SDL_lockprof_c.h"
+
+/* Profiling has to know which lock is the outermost one */
+#if !SDL_THREAD_PTHREAD_RECURSIVE_MUTEX && \
+    !SDL_THREAD_PTHREAD_RECURSIVE_MUTEX_NP || SDL_LOCK_PROFILING
+#define FAKE_RECURSIVE_MUTEX 1
+#endif
+
 struct SDL_mutex
 {
     pthread_mutex_t id;
+#if FAKE_RECURSIVE_MUTEX
+    int recursive;
+    pthread_t owner;
+#endif
+#if SDL_LOCK_PROFILING
+    SDL_LockProfile *profile;
+    Uint64 acquired;            /* when the owner got it */
+#endif
 };
 
 #endif /* SDL_mutex_c_h_ */
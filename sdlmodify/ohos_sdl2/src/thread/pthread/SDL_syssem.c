@@ -28,6 +28,7 @@
 
 #include "SDL_thread.h"
 #include "SDL_timer.h"
+#include "../SDL_lockprof_c.h"
 
 /* Wrapper around POSIX 1003.1b semaphores */
 
@@ -39,6 +40,9 @@
 struct SDL_semaphore
 {
     sem_t sem;
+#if SDL_LOCK_PROFILING
+    SDL_LockProfile *profile;
+#endif
 };
 
 /* Create a semaphore, initialized with value */
@@ -52,6 +56,11 @@ SDL_CreateSemaphore(Uint32 initial_value)
             SDL_free(sem);
             sem = NULL;
         }
+#if SDL_LOCK_PROFILING
+        if (sem) {
+            sem->profile = SDL_GetLockProfile(SDL_LOCKSTATS_SEMAPHORE, NULL);
+        }
+#endif
     } else {
         SDL_OutOfMemory();
     }
@@ -86,11 +95,22 @@ int
 SDL_SemWait(SDL_sem * sem)
 {
     int retval;
+#if SDL_LOCK_PROFILING
+    Uint64 wait_start;
+#endif
 
     if (!sem) {
         return SDL_SetError("Passed a NULL semaphore");
     }
 
+#if SDL_LOCK_PROFILING
+    if (sem_trywait(&sem->sem) == 0) {
+        SDL_LockProfileAcquired(sem->profile, 0);
+        return 0;
+    }
+    wait_start = SDL_GetPerformanceCounter();
+#endif
+
     do {
         retval = sem_wait(&sem->sem);
     } while (retval < 0 && errno == EINTR);
@@ -98,6 +118,11 @@ SDL_SemWait(SDL_sem * sem)
     if (retval < 0) {
         retval = SDL_SetError("sem_wait() failed");
     }
+#if SDL_LOCK_PROFILING
+    else {
+        SDL_LockProfileAcquired(sem->profile, wait_start);
+    }
+#endif
     return retval;
 }
 
@@ -113,6 +138,9 @@ SDL_SemWaitTimeout(SDL_sem * sem, Uint32 timeout)
 #else
     Uint32 end;
 #endif
+#if SDL_LOCK_PROFILING
+    Uint64 wait_start;
+#endif
 
     if (!sem) {
         return SDL_SetError("Passed a NULL semaphore");
@@ -126,6 +154,14 @@ SDL_SemWaitTimeout(SDL_sem * sem, Uint32 timeout)
         return SDL_SemWait(sem);
     }
 
+#if SDL_LOCK_PROFILING
+    if (sem_trywait(&sem->sem) == 0) {
+        SDL_LockProfileAcquired(sem->profile, 0);
+        return 0;
+    }
+    wait_start = SDL_GetPerformanceCounter();
+#endif
+
 #ifdef HAVE_SEM_TIMEDWAIT
     /* Setup the timeout. sem_timedwait doesn't wait for
     * a lapse of time, but until we reach a certain time.
@@ -173,6 +209,11 @@ SDL_SemWaitTimeout(SDL_sem * sem, Uint32 timeout)
     }
 #endif /* HAVE_SEM_TIMEDWAIT */
 
+#if SDL_LOCK_PROFILING
+    if (retval == 0) {
+        SDL_LockProfileAcquired(sem->profile, wait_start);
+    }
+#endif
     return retval;
 }
 
@@ -205,5 +246,15 @@ SDL_SemPost(SDL_sem * sem)
     return retval;
 }
 
+#if SDL_LOCK_PROFILING
+void
+SDL_SetSemaphoreName(SDL_sem * sem, const char *name)
+{
+    if (sem) {
+        sem->profile = SDL_GetLockProfile(SDL_LOCKSTATS_SEMAPHORE, name);
+    }
+}
+#endif
+
 #endif /* __MACOSX__ */
 /* vi: set ts=4 sw=4 expandtab: */
@@ -39,7 +39,8 @@ SDL_SYS_GetTLSData(void)
         SDL_AtomicLock(&lock);
         if (thread_local_storage == INVALID_PTHREAD_KEY && !generic_local_storage) {
             pthread_key_t storage;
-            if (pthread_key_create(&storage, NULL) == 0) {
+            /* Threads created outside of SDL never call SDL_TLSCleanup() */
+            if (pthread_key_create(&storage, SDL_TLSDestroyData) == 0) {
                 SDL_MemoryBarrierRelease();
                 thread_local_storage = storage;
             } else {
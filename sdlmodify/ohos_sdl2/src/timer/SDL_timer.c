@@ -28,15 +28,43 @@
 
 /* #define DEBUG_TIMERS */
 
+#if SDL_TIMER_UNIX && HAVE_NANOSLEEP
+#include <errno.h>
+#include <time.h>
+#endif
+
+/* Timers live in a hierarchical timing wheel: SDL_TIMER_WHEEL_LEVELS levels
+ * of SDL_TIMER_WHEEL_SLOTS slots each. A timer due within 256 ticks goes in
+ * a level 0 slot, one due within 256*256 ticks in a level 1 slot, and so on.
+ * Each time the wheel reaches the start of a higher level slot, that slot is
+ * cascaded down, so adding and removing a timer are both O(1).
+ */
+#define SDL_TIMER_WHEEL_HZ      10000   /* one tick is 0.1 ms */
+#define SDL_TIMER_WHEEL_BITS    8
+#define SDL_TIMER_WHEEL_SLOTS   (1 << SDL_TIMER_WHEEL_BITS)
+#define SDL_TIMER_WHEEL_MASK    (SDL_TIMER_WHEEL_SLOTS - 1)
+#define SDL_TIMER_WHEEL_LEVELS  4
+#define SDL_TIMER_WHEEL_SPAN    ((Uint64)1 << (SDL_TIMER_WHEEL_LEVELS * SDL_TIMER_WHEEL_BITS))
+#define SDL_TIMER_NEVER         (~(Uint64)0)
+
+#define SDL_TIMER_MAP_SIZE      4096
+#define SDL_TIMER_MAP_MASK      (SDL_TIMER_MAP_SIZE - 1)
+
 typedef struct _SDL_Timer
 {
     int timerID;
     SDL_TimerCallback callback;
+    SDL_NSTimerCallback callback_ns;
     void *param;
-    Uint32 interval;
-    Uint32 scheduled;
+    Uint32 interval;            /* milliseconds, passed to callback */
+    Uint64 interval_ns;         /* nanoseconds, passed to callback_ns */
+    Uint64 expires;             /* wheel tick the timer is due at */
     SDL_atomic_t canceled;
+    int level;                  /* wheel slot, level is -1 when not in the wheel */
+    int slot;
     struct _SDL_Timer *next;
+    struct _SDL_Timer *prev;
+    struct _SDL_Timer *next_canceled;
 } SDL_Timer;
 
 typedef struct _SDL_TimerMap
@@ -46,13 +74,20 @@ typedef struct _SDL_TimerMap
     struct _SDL_TimerMap *next;
 } SDL_TimerMap;
 
-/* The timers are kept in a sorted list */
+typedef struct {
+    SDL_Timer *slots[SDL_TIMER_WHEEL_SLOTS];
+    int count;
+} SDL_TimerWheelLevel;
+
 typedef struct {
     /* Data used by the main thread */
     SDL_Thread *thread;
     SDL_atomic_t nextID;
-    SDL_TimerMap *timermap;
+    SDL_TimerMap *timermap[SDL_TIMER_MAP_SIZE];
     SDL_mutex *timermap_lock;
+    Uint64 frequency;
+    Uint64 counts_per_tick;
+    Uint64 tick_ns;
 
     /* Padding to separate cache lines between threads */
     char cache_pad[SDL_CACHELINE_SIZE];
@@ -61,40 +96,218 @@ typedef struct {
     SDL_SpinLock lock;
     SDL_sem *sem;
     SDL_Timer *pending;
+    SDL_Timer *canceled;
     SDL_Timer *freelist;
+    Uint64 wake_tick;           /* when the sleeping timer thread wakes up, 0 while it runs */
     SDL_atomic_t active;
 
-    /* List of timers - this is only touched by the timer thread */
-    SDL_Timer *timers;
+    /* The wheel - this is only touched by the timer thread */
+    Uint64 clock;               /* next tick to process */
+    SDL_TimerWheelLevel wheel[SDL_TIMER_WHEEL_LEVELS];
 } SDL_TimerData;
 
 static SDL_TimerData SDL_timer_data;
 
 /* The idea here is that any thread might add a timer, but a single
- * thread manages the active timer queue, sorted by scheduling time.
+ * thread manages the timing wheel.
  *
- * Timers are removed by simply setting a canceled flag
+ * Timers are removed by setting a canceled flag and handing them to the
+ * timer thread, which takes them out of the wheel the next time it runs.
+ * Whoever sets the flag, SDL_RemoveTimer() or the timer thread when the
+ * callback returns 0, owns the timer from then on.
  */
 
+static SDL_INLINE Uint64
+SDL_TimerNow(SDL_TimerData *data)
+{
+    return SDL_GetPerformanceCounter() / data->counts_per_tick;
+}
+
+static SDL_INLINE Uint64
+SDL_TimerTicksFromNS(SDL_TimerData *data, Uint64 ns)
+{
+    return (ns / data->tick_ns) + ((ns % data->tick_ns) ? 1 : 0);
+}
+
+static SDL_INLINE Uint64
+SDL_TimerTicksFromMS(SDL_TimerData *data, Uint32 ms)
+{
+    return SDL_TimerTicksFromNS(data, (Uint64)ms * 1000000);
+}
+
 static void
-SDL_AddTimerInternal(SDL_TimerData *data, SDL_Timer *timer)
+SDL_LinkTimer(SDL_TimerData *data, SDL_Timer *timer)
 {
-    SDL_Timer *prev, *curr;
+    SDL_TimerWheelLevel *wheel;
+    Uint64 expires = timer->expires;
+    Uint64 delta;
+    int level;
 
-    prev = NULL;
-    for (curr = data->timers; curr; prev = curr, curr = curr->next) {
-        if ((Sint32)(timer->scheduled-curr->scheduled) < 0) {
+    if (expires < data->clock) {
+        expires = data->clock;
+    }
+    delta = expires - data->clock;
+    if (delta >= SDL_TIMER_WHEEL_SPAN) {
+        /* Park it in the slot furthest out, it's placed again from there */
+        expires = data->clock + SDL_TIMER_WHEEL_SPAN - 1;
+        delta = SDL_TIMER_WHEEL_SPAN - 1;
+    }
+    for (level = 0; level < SDL_TIMER_WHEEL_LEVELS - 1; ++level) {
+        if (delta < ((Uint64)1 << ((level + 1) * SDL_TIMER_WHEEL_BITS))) {
             break;
         }
     }
 
-    /* Insert the timer here! */
-    if (prev) {
-        prev->next = timer;
+    wheel = &data->wheel[level];
+    timer->level = level;
+    timer->slot = (int)((expires >> (level * SDL_TIMER_WHEEL_BITS)) & SDL_TIMER_WHEEL_MASK);
+    timer->prev = NULL;
+    timer->next = wheel->slots[timer->slot];
+    if (timer->next) {
+        timer->next->prev = timer;
+    }
+    wheel->slots[timer->slot] = timer;
+    ++wheel->count;
+}
+
+static void
+SDL_UnlinkTimer(SDL_TimerData *data, SDL_Timer *timer)
+{
+    SDL_TimerWheelLevel *wheel = &data->wheel[timer->level];
+
+    if (timer->prev) {
+        timer->prev->next = timer->next;
     } else {
-        data->timers = timer;
+        wheel->slots[timer->slot] = timer->next;
+    }
+    if (timer->next) {
+        timer->next->prev = timer->prev;
+    }
+    --wheel->count;
+    timer->level = -1;
+}
+
+/* Next tick at or after data->clock where a level 0 slot is due or a
+ * higher level slot has to be cascaded, SDL_TIMER_NEVER if the wheel is empty */
+static Uint64
+SDL_NextTimerTick(SDL_TimerData *data)
+{
+    Uint64 next = SDL_TIMER_NEVER;
+    int level, i;
+
+    if (data->wheel[0].count > 0) {
+        const int index = (int)(data->clock & SDL_TIMER_WHEEL_MASK);
+        for (i = 0; i < SDL_TIMER_WHEEL_SLOTS; ++i) {
+            if (data->wheel[0].slots[(index + i) & SDL_TIMER_WHEEL_MASK]) {
+                /* A cascade can still come first */
+                next = data->clock + i;
+                break;
+            }
+        }
+    }
+
+    for (level = 1; level < SDL_TIMER_WHEEL_LEVELS; ++level) {
+        const int shift = level * SDL_TIMER_WHEEL_BITS;
+        const Uint64 unit = (Uint64)1 << shift;
+        const Uint64 base = (data->clock + unit - 1) & ~(unit - 1);
+        const int index = (int)((base >> shift) & SDL_TIMER_WHEEL_MASK);
+
+        if (data->wheel[level].count == 0) {
+            continue;
+        }
+        for (i = 0; i < SDL_TIMER_WHEEL_SLOTS; ++i) {
+            if (data->wheel[level].slots[(index + i) & SDL_TIMER_WHEEL_MASK]) {
+                const Uint64 tick = base + ((Uint64)i << shift);
+                if (tick < next) {
+                    next = tick;
+                }
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+/* Move the wheel up to and including tick 'now', appending every timer
+ * that comes due to the list at *tail */
+static void
+SDL_AdvanceTimerWheel(SDL_TimerData *data, Uint64 now, SDL_Timer ***tail)
+{
+    for ( ; ; ) {
+        const Uint64 tick = SDL_NextTimerTick(data);
+        SDL_Timer *current;
+        int level, slot;
+
+        if (tick > now) {
+            /* Nothing happens in between, skip straight past it */
+            data->clock = now + 1;
+            break;
+        }
+        data->clock = tick;
+
+        /* Cascade the higher level slots that start at this tick */
+        for (level = 1; level < SDL_TIMER_WHEEL_LEVELS; ++level) {
+            const int shift = level * SDL_TIMER_WHEEL_BITS;
+            SDL_TimerWheelLevel *wheel = &data->wheel[level];
+
+            if (tick & (((Uint64)1 << shift) - 1)) {
+                break;
+            }
+            slot = (int)((tick >> shift) & SDL_TIMER_WHEEL_MASK);
+            current = wheel->slots[slot];
+            wheel->slots[slot] = NULL;
+            while (current) {
+                SDL_Timer *next = current->next;
+                --wheel->count;
+                SDL_LinkTimer(data, current);
+                current = next;
+            }
+        }
+
+        /* Everything in this level 0 slot is due */
+        slot = (int)(tick & SDL_TIMER_WHEEL_MASK);
+        for (current = data->wheel[0].slots[slot]; current; current = current->next) {
+            current->level = -1;
+            --data->wheel[0].count;
+            **tail = current;
+            *tail = &current->next;
+        }
+        data->wheel[0].slots[slot] = NULL;
+        data->clock = tick + 1;
+    }
+}
+
+/* Sleep until wheel tick 'tick', or until a new timer is due sooner */
+static void
+SDL_TimerSleep(SDL_TimerData *data, Uint64 tick)
+{
+    Uint64 now, remaining, ms;
+
+    if (tick == SDL_TIMER_NEVER) {
+        SDL_SemWaitTimeout(data->sem, SDL_MUTEX_MAXWAIT);
+        return;
+    }
+
+    now = SDL_GetPerformanceCounter();
+    if (tick * data->counts_per_tick <= now) {
+        return;
+    }
+    remaining = tick * data->counts_per_tick - now;
+    ms = (remaining * 1000) / data->frequency;
+    if (ms > 0) {
+        SDL_SemWaitTimeout(data->sem, (Uint32)SDL_min(ms, SDL_MUTEX_MAXWAIT - 1));
+    } else {
+        /* Less than a millisecond, which semaphores can't wait for */
+#if SDL_TIMER_UNIX && HAVE_NANOSLEEP
+        struct timespec tv;
+        tv.tv_sec = 0;
+        tv.tv_nsec = (long)((remaining * 1000000000) / data->frequency);
+        while (nanosleep(&tv, &tv) && errno == EINTR) {
+        }
+#else
+        SDL_SemWaitTimeout(data->sem, 1);
+#endif
     }
-    timer->next = curr;
 }
 
 static int SDLCALL
@@ -102,23 +315,29 @@ SDL_TimerThread(void *_data)
 {
     SDL_TimerData *data = (SDL_TimerData *)_data;
     SDL_Timer *pending;
+    SDL_Timer *canceled;
     SDL_Timer *current;
+    SDL_Timer *dispatch;
+    SDL_Timer **tail;
     SDL_Timer *freelist_head = NULL;
     SDL_Timer *freelist_tail = NULL;
-    Uint32 tick, now, interval, delay;
+    Uint64 now, next;
 
     /* Threaded timer loop:
-     *  1. Queue timers added by other threads
-     *  2. Handle any timers that should dispatch this cycle
+     *  1. Queue timers added by other threads, drop the removed ones
+     *  2. Collect all timers due by now, then run their callbacks
      *  3. Wait until next dispatch time or new timer arrives
      */
     for ( ; ; ) {
         /* Pending and freelist maintenance */
         SDL_AtomicLock(&data->lock);
         {
-            /* Get any timers ready to be queued */
+            /* Get any timers ready to be queued or removed */
             pending = data->pending;
             data->pending = NULL;
+            canceled = data->canceled;
+            data->canceled = NULL;
+            data->wake_tick = 0;
 
             /* Make any unused timer structures available */
             if (freelist_head) {
@@ -128,50 +347,79 @@ SDL_TimerThread(void *_data)
         }
         SDL_AtomicUnlock(&data->lock);
 
-        /* Sort the pending timers into our list */
+        freelist_head = NULL;
+        freelist_tail = NULL;
+
+        /* Put the pending timers in the wheel */
         while (pending) {
             current = pending;
             pending = pending->next;
-            SDL_AddTimerInternal(data, current);
+            SDL_LinkTimer(data, current);
+        }
+
+        /* Take the removed ones out again, they can be reused */
+        while (canceled) {
+            current = canceled;
+            canceled = canceled->next_canceled;
+            if (current->level >= 0) {
+                SDL_UnlinkTimer(data, current);
+            }
+            current->next = freelist_head;
+            freelist_head = current;
+            if (!freelist_tail) {
+                freelist_tail = current;
+            }
         }
-        freelist_head = NULL;
-        freelist_tail = NULL;
 
         /* Check to see if we're still running, after maintenance */
         if (!SDL_AtomicGet(&data->active)) {
+            /* Hand back what was just canceled, SDL_TimerQuit() frees the free list */
+            if (freelist_head) {
+                SDL_AtomicLock(&data->lock);
+                freelist_tail->next = data->freelist;
+                data->freelist = freelist_head;
+                SDL_AtomicUnlock(&data->lock);
+            }
             break;
         }
 
-        /* Initial delay if there are no timers */
-        delay = SDL_MUTEX_MAXWAIT;
+        /* Gather everything that's due, then dispatch it as one batch */
+        now = SDL_TimerNow(data);
+        dispatch = NULL;
+        tail = &dispatch;
+        SDL_AdvanceTimerWheel(data, now, &tail);
+        *tail = NULL;
 
-        tick = SDL_GetTicks();
+        while (dispatch) {
+            Uint64 delay = 0;
 
-        /* Process all the pending timers for this tick */
-        while (data->timers) {
-            current = data->timers;
+            current = dispatch;
+            dispatch = current->next;
 
-            if ((Sint32)(tick-current->scheduled) < 0) {
-                /* Scheduled for the future, wait a bit */
-                delay = (current->scheduled - tick);
-                break;
+            if (SDL_AtomicGet(&current->canceled)) {
+                /* SDL_RemoveTimer() has handed it to us to clean up */
+                continue;
             }
 
-            /* We're going to do something with this timer */
-            data->timers = current->next;
-
-            if (SDL_AtomicGet(&current->canceled)) {
-                interval = 0;
+            if (current->callback_ns) {
+                current->interval_ns = current->callback_ns(current->interval_ns, current->param);
+                if (current->interval_ns > 0) {
+                    delay = SDL_TimerTicksFromNS(data, current->interval_ns);
+                }
             } else {
-                interval = current->callback(current->interval, current->param);
+                current->interval = current->callback(current->interval, current->param);
+                if (current->interval > 0) {
+                    delay = SDL_TimerTicksFromMS(data, current->interval);
+                }
             }
 
-            if (interval > 0) {
-                /* Reschedule this timer */
-                current->interval = interval;
-                current->scheduled = tick + interval;
-                SDL_AddTimerInternal(data, current);
-            } else {
+            if (delay > 0) {
+                /* Reschedule this timer, unless it was removed meanwhile */
+                if (!SDL_AtomicGet(&current->canceled)) {
+                    current->expires = now + delay;
+                    SDL_LinkTimer(data, current);
+                }
+            } else if (SDL_AtomicCAS(&current->canceled, 0, 1)) {
                 if (!freelist_head) {
                     freelist_head = current;
                 }
@@ -179,26 +427,24 @@ SDL_TimerThread(void *_data)
                     freelist_tail->next = current;
                 }
                 freelist_tail = current;
-
-                SDL_AtomicSet(&current->canceled, 1);
+                current->next = NULL;
             }
         }
 
-        /* Adjust the delay based on processing time */
-        now = SDL_GetTicks();
-        interval = (now - tick);
-        if (interval > delay) {
-            delay = 0;
-        } else {
-            delay -= interval;
+        /* Only sleep when nobody added a timer while we were busy */
+        SDL_AtomicLock(&data->lock);
+        if (data->pending) {
+            SDL_AtomicUnlock(&data->lock);
+            continue;
         }
+        next = SDL_NextTimerTick(data);
+        data->wake_tick = next;
+        SDL_AtomicUnlock(&data->lock);
 
-        /* Note that each time a timer is added, this will return
-           immediately, but we process the timers added all at once.
-           That's okay, it just means we run through the loop a few
-           extra times.
+        /* Note that a timer added due before 'next' wakes us up, but we
+           process all the timers added by then at once.
          */
-        SDL_SemWaitTimeout(data->sem, delay);
+        SDL_TimerSleep(data, next);
     }
     return 0;
 }
@@ -214,12 +460,19 @@ SDL_TimerInit(void)
         if (!data->timermap_lock) {
             return -1;
         }
+        SDL_SetMutexName(data->timermap_lock, "SDLTimer.timermap_lock");
 
         data->sem = SDL_CreateSemaphore(0);
         if (!data->sem) {
             SDL_DestroyMutex(data->timermap_lock);
             return -1;
         }
+        SDL_SetSemaphoreName(data->sem, "SDLTimer.sem");
+
+        data->frequency = SDL_GetPerformanceFrequency();
+        data->counts_per_tick = SDL_max(data->frequency / SDL_TIMER_WHEEL_HZ, 1);
+        data->tick_ns = SDL_max((data->counts_per_tick * 1000000000) / data->frequency, 1);
+        data->clock = SDL_TimerNow(data);
 
         SDL_AtomicSet(&data->active, 1);
 
@@ -241,6 +494,7 @@ SDL_TimerQuit(void)
     SDL_TimerData *data = &SDL_timer_data;
     SDL_Timer *timer;
     SDL_TimerMap *entry;
+    int level, i;
 
     if (SDL_AtomicCAS(&data->active, 1, 0)) {  /* active? Move to inactive. */
         /* Shutdown the timer thread */
@@ -254,9 +508,19 @@ SDL_TimerQuit(void)
         data->sem = NULL;
 
         /* Clean up the timer entries */
-        while (data->timers) {
-            timer = data->timers;
-            data->timers = timer->next;
+        for (level = 0; level < SDL_TIMER_WHEEL_LEVELS; ++level) {
+            for (i = 0; i < SDL_TIMER_WHEEL_SLOTS; ++i) {
+                while (data->wheel[level].slots[i]) {
+                    timer = data->wheel[level].slots[i];
+                    data->wheel[level].slots[i] = timer->next;
+                    SDL_free(timer);
+                }
+            }
+            data->wheel[level].count = 0;
+        }
+        while (data->pending) {
+            timer = data->pending;
+            data->pending = timer->next;
             SDL_free(timer);
         }
         while (data->freelist) {
@@ -264,10 +528,16 @@ SDL_TimerQuit(void)
             data->freelist = timer->next;
             SDL_free(timer);
         }
-        while (data->timermap) {
-            entry = data->timermap;
-            data->timermap = entry->next;
-            SDL_free(entry);
+        /* The timer thread took everything canceled before it exited, so
+           anything left here is still in the wheel or pending and freed above */
+        data->canceled = NULL;
+
+        for (i = 0; i < SDL_TIMER_MAP_SIZE; ++i) {
+            while (data->timermap[i]) {
+                entry = data->timermap[i];
+                data->timermap[i] = entry->next;
+                SDL_free(entry);
+            }
         }
 
         SDL_DestroyMutex(data->timermap_lock);
@@ -275,12 +545,14 @@ SDL_TimerQuit(void)
     }
 }
 
-SDL_TimerID
-SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
+static SDL_TimerID
+SDL_CreateTimer(Uint32 interval, SDL_TimerCallback callback,
+                Uint64 interval_ns, SDL_NSTimerCallback callback_ns, void *param)
 {
     SDL_TimerData *data = &SDL_timer_data;
     SDL_Timer *timer;
     SDL_TimerMap *entry;
+    SDL_bool wake;
 
     SDL_AtomicLock(&data->lock);
     if (!SDL_AtomicGet(&data->active)) {
@@ -307,9 +579,16 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     }
     timer->timerID = SDL_AtomicIncRef(&data->nextID);
     timer->callback = callback;
+    timer->callback_ns = callback_ns;
     timer->param = param;
     timer->interval = interval;
-    timer->scheduled = SDL_GetTicks() + interval;
+    timer->interval_ns = interval_ns;
+    if (callback_ns) {
+        timer->expires = SDL_TimerNow(data) + SDL_TimerTicksFromNS(data, interval_ns);
+    } else {
+        timer->expires = SDL_TimerNow(data) + SDL_TimerTicksFromMS(data, interval);
+    }
+    timer->level = -1;
     SDL_AtomicSet(&timer->canceled, 0);
 
     entry = (SDL_TimerMap *)SDL_malloc(sizeof(*entry));
@@ -322,51 +601,77 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     entry->timerID = timer->timerID;
 
     SDL_LockMutex(data->timermap_lock);
-    entry->next = data->timermap;
-    data->timermap = entry;
+    entry->next = data->timermap[entry->timerID & SDL_TIMER_MAP_MASK];
+    data->timermap[entry->timerID & SDL_TIMER_MAP_MASK] = entry;
     SDL_UnlockMutex(data->timermap_lock);
 
     /* Add the timer to the pending list for the timer thread */
     SDL_AtomicLock(&data->lock);
     timer->next = data->pending;
     data->pending = timer;
+    wake = (timer->expires < data->wake_tick);
+    if (wake) {
+        data->wake_tick = timer->expires;
+    }
     SDL_AtomicUnlock(&data->lock);
 
-    /* Wake up the timer thread if necessary */
-    SDL_SemPost(data->sem);
+    /* Wake up the timer thread if it would sleep past this timer */
+    if (wake) {
+        SDL_SemPost(data->sem);
+    }
 
     return entry->timerID;
 }
 
+SDL_TimerID
+SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
+{
+    return SDL_CreateTimer(interval, callback, 0, NULL, param);
+}
+
+SDL_TimerID
+SDL_AddTimerNS(Uint64 interval, SDL_NSTimerCallback callback, void *param)
+{
+    if (!callback) {
+        SDL_InvalidParamError("callback");
+        return 0;
+    }
+    return SDL_CreateTimer(0, NULL, interval, callback, param);
+}
+
 SDL_bool
 SDL_RemoveTimer(SDL_TimerID id)
 {
     SDL_TimerData *data = &SDL_timer_data;
     SDL_TimerMap *prev, *entry;
     SDL_bool canceled = SDL_FALSE;
+    const int bucket = id & SDL_TIMER_MAP_MASK;
 
     /* Find the timer */
     SDL_LockMutex(data->timermap_lock);
     prev = NULL;
-    for (entry = data->timermap; entry; prev = entry, entry = entry->next) {
+    for (entry = data->timermap[bucket]; entry; prev = entry, entry = entry->next) {
         if (entry->timerID == id) {
             if (prev) {
                 prev->next = entry->next;
             } else {
-                data->timermap = entry->next;
+                data->timermap[bucket] = entry->next;
             }
             break;
         }
     }
-    SDL_UnlockMutex(data->timermap_lock);
 
-    if (entry) {
-        if (!SDL_AtomicGet(&entry->timer->canceled)) {
-            SDL_AtomicSet(&entry->timer->canceled, 1);
-            canceled = SDL_TRUE;
-        }
-        SDL_free(entry);
+    /* Cancel it while it can't be reused yet, and let the timer thread drop it */
+    if (entry && SDL_AtomicCAS(&entry->timer->canceled, 0, 1)) {
+        SDL_AtomicLock(&data->lock);
+        entry->timer->next_canceled = data->canceled;
+        data->canceled = entry->timer;
+        SDL_AtomicUnlock(&data->lock);
+        canceled = SDL_TRUE;
     }
+    SDL_UnlockMutex(data->timermap_lock);
+
+    SDL_free(entry);
     return canceled;
 }
 
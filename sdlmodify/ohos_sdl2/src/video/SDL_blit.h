@@ -25,6 +25,7 @@
 
 #include "SDL_cpuinfo.h"
 #include "SDL_endian.h"
+#include "SDL_render.h"
 #include "SDL_surface.h"
 
 /* Table to do pixel byte expansion */
@@ -107,6 +108,15 @@ extern SDL_BlitFunc SDL_CalculateBlit1(SDL_Surface * surface);
 extern SDL_BlitFunc SDL_CalculateBlitN(SDL_Surface * surface);
 extern SDL_BlitFunc SDL_CalculateBlitA(SDL_Surface * surface);
 
+/* Functions found in SDL_surface.c, scaled blits with a choice of filter.
+   SDL_UpperBlitScaled() and SDL_LowerBlitScaled() use SDL_ScaleModeNearest. */
+extern int SDL_PrivateUpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
+                                      SDL_Surface * dst, SDL_Rect * dstrect,
+                                      SDL_ScaleMode scaleMode);
+extern int SDL_PrivateLowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
+                                      SDL_Surface * dst, SDL_Rect * dstrect,
+                                      SDL_ScaleMode scaleMode);
+
 /*
  * Useful macros for blitting routines
  */
@@ -20,333 +20,641 @@
 */
 #include "../SDL_internal.h"
 
-/* This a stretch blit implementation based on ideas given to me by
-   Tomasz Cejner - thanks! :)
+/* Stretch blits between two surfaces of the same format.
 
-   April 27, 2000 - Sam Lantinga
+   Both filters work out the source column of every destination column
+   once per blit. Nearest sampling steps through the source in 16.16 fixed
+   point exactly like the original row copier, and copies the previous
+   destination row when two rows sample the same source row. Linear
+   filtering samples pixel centers, scales the two source rows around each
+   destination row horizontally into a pair of cached rows, then blends
+   those vertically. 32-bit formats with 8-bit channels are filtered in
+   place; 16 and 24-bit formats are expanded to 8888 rows first and packed
+   again afterwards. The SIMD kernels do the same integer math as the C
+   ones, so the output doesn't depend on the CPU.
 */
 
 #include "SDL_video.h"
+#include "SDL_cpuinfo.h"
 #include "SDL_blit.h"
 
-/* This isn't ready for general consumption yet - it should be folded
-   into the general blitting mechanism.
-*/
-
-#if ((defined(_MSC_VER) && defined(_M_IX86))    || \
-     (defined(__WATCOMC__) && defined(__386__)) || \
-     (defined(__GNUC__) && defined(__i386__))) && SDL_ASSEMBLY_ROUTINES
-/* There's a bug with gcc 4.4.1 and -O2 where srcp doesn't get the correct
- * value after the first scanline.  FIXME? */
-/* #define USE_ASM_STRETCH */
+#ifdef __ARM_NEON
+#define HAVE_NEON_INTRINSICS 1
 #endif
 
-#ifdef USE_ASM_STRETCH
-
-#ifdef HAVE_MPROTECT
-#include <sys/types.h>
-#include <sys/mman.h>
-#endif
-#ifdef __GNUC__
-#define PAGE_ALIGNED __attribute__((__aligned__(4096)))
-#else
-#define PAGE_ALIGNED
+#ifdef __SSE2__
+#define HAVE_SSE2_INTRINSICS 1
 #endif
 
-#if defined(_M_IX86) || defined(__i386__) || defined(__386__)
-#define PREFIX16    0x66
-#define STORE_BYTE  0xAA
-#define STORE_WORD  0xAB
-#define LOAD_BYTE   0xAC
-#define LOAD_WORD   0xAD
-#define RETURN      0xC3
-#else
-#error Need assembly opcodes for this architecture
+#if defined(HAVE_IMMINTRIN_H) && !defined(SDL_DISABLE_IMMINTRIN_H) && \
+    defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HAVE_AVX2_INTRINSICS 1
+#define SDL_TARGET_AVX2 __attribute__((target("avx2")))
 #endif
 
-static unsigned char copy_row[4096] PAGE_ALIGNED;
+/* Weights are 0 to 256, so a channel times a weight fits in 16 bits */
+#define WEIGHT_BITS 8
+#define WEIGHT_ONE  (1 << WEIGHT_BITS)
+
+typedef void (*SDL_StretchRowLinearFunc)(const Uint8 *src, Uint8 *dst, int dst_w,
+                                         const int *xofs, const Uint16 *xweights);
+typedef void (*SDL_BlendRowsFunc)(const Uint8 *src0, const Uint8 *src1, Uint8 *dst,
+                                  int len, int weight);
+typedef void (*SDL_StretchRowNearest32Func)(const Uint32 *src, Uint32 *dst, int dst_w,
+                                            const int *xofs);
 
 static int
-generate_rowbytes(int src_w, int dst_w, int bpp)
+SDL_CheckStretchRects(SDL_Surface * src, const SDL_Rect ** srcrect, SDL_Rect * full_src,
+                      SDL_Surface * dst, const SDL_Rect ** dstrect, SDL_Rect * full_dst)
 {
-    static struct
-    {
-        int bpp;
-        int src_w;
-        int dst_w;
-        int status;
-    } last;
+    if (src->format->format != dst->format->format) {
+        return SDL_SetError("Only works with same format surfaces");
+    }
 
-    int i;
-    int pos, inc;
-    unsigned char *eip, *fence;
-    unsigned char load, store;
-
-    /* See if we need to regenerate the copy buffer */
-    if ((src_w == last.src_w) && (dst_w == last.dst_w) && (bpp == last.bpp)) {
-        return (last.status);
-    }
-    last.bpp = bpp;
-    last.src_w = src_w;
-    last.dst_w = dst_w;
-    last.status = -1;
-
-    switch (bpp) {
-    case 1:
-        load = LOAD_BYTE;
-        store = STORE_BYTE;
-        break;
-    case 2:
-    case 4:
-        load = LOAD_WORD;
-        store = STORE_WORD;
-        break;
-    default:
-        return SDL_SetError("ASM stretch of %d bytes isn't supported", bpp);
-    }
-#ifdef HAVE_MPROTECT
-    /* Make the code writeable */
-    if (mprotect(copy_row, sizeof(copy_row), PROT_READ | PROT_WRITE) < 0) {
-        return SDL_SetError("Couldn't make copy buffer writeable");
+    /* Verify the blit rectangles */
+    if (*srcrect) {
+        if (((*srcrect)->x < 0) || ((*srcrect)->y < 0) ||
+            (((*srcrect)->x + (*srcrect)->w) > src->w) ||
+            (((*srcrect)->y + (*srcrect)->h) > src->h)) {
+            return SDL_SetError("Invalid source blit rectangle");
+        }
+    } else {
+        full_src->x = 0;
+        full_src->y = 0;
+        full_src->w = src->w;
+        full_src->h = src->h;
+        *srcrect = full_src;
     }
-#endif
-    pos = 0x10000;
-    inc = (src_w << 16) / dst_w;
-    eip = copy_row;
-    fence = copy_row + sizeof(copy_row)-2;
-    for (i = 0; i < dst_w; ++i) {
-        while (pos >= 0x10000L) {
-            if (eip == fence) {
-                return -1;
-            }
-            if (bpp == 2) {
-                *eip++ = PREFIX16;
-            }
-            *eip++ = load;
-            pos -= 0x10000L;
+    if (*dstrect) {
+        if (((*dstrect)->x < 0) || ((*dstrect)->y < 0) ||
+            (((*dstrect)->x + (*dstrect)->w) > dst->w) ||
+            (((*dstrect)->y + (*dstrect)->h) > dst->h)) {
+            return SDL_SetError("Invalid destination blit rectangle");
         }
-        if (eip == fence) {
-            return -1;
+    } else {
+        full_dst->x = 0;
+        full_dst->y = 0;
+        full_dst->w = dst->w;
+        full_dst->h = dst->h;
+        *dstrect = full_dst;
+    }
+    return 0;
+}
+
+static int
+SDL_LockStretchSurfaces(SDL_Surface * src, SDL_Surface * dst, int *src_locked, int *dst_locked)
+{
+    /* Lock the destination if it's in hardware */
+    *dst_locked = 0;
+    if (SDL_MUSTLOCK(dst)) {
+        if (SDL_LockSurface(dst) < 0) {
+            return SDL_SetError("Unable to lock destination surface");
         }
-        if (bpp == 2) {
-            *eip++ = PREFIX16;
+        *dst_locked = 1;
+    }
+    /* Lock the source if it's in hardware */
+    *src_locked = 0;
+    if (SDL_MUSTLOCK(src)) {
+        if (SDL_LockSurface(src) < 0) {
+            if (*dst_locked) {
+                SDL_UnlockSurface(dst);
+            }
+            return SDL_SetError("Unable to lock source surface");
         }
-        *eip++ = store;
-        pos += inc;
+        *src_locked = 1;
     }
-    *eip++ = RETURN;
+    return 0;
+}
 
-#ifdef HAVE_MPROTECT
-    /* Make the code executable but not writeable */
-    if (mprotect(copy_row, sizeof(copy_row), PROT_READ | PROT_EXEC) < 0) {
-        return SDL_SetError("Couldn't make copy buffer executable");
+static void
+SDL_UnlockStretchSurfaces(SDL_Surface * src, SDL_Surface * dst, int src_locked, int dst_locked)
+{
+    if (dst_locked) {
+        SDL_UnlockSurface(dst);
+    }
+    if (src_locked) {
+        SDL_UnlockSurface(src);
     }
-#endif
-    last.status = 0;
-    return (0);
 }
 
-#endif /* USE_ASM_STRETCH */
-
-#define DEFINE_COPY_ROW(name, type)         \
-static void name(type *src, int src_w, type *dst, int dst_w)    \
-{                                           \
-    int i;                                  \
-    int pos, inc;                           \
-    type pixel = 0;                         \
-                                            \
-    pos = 0x10000;                          \
-    inc = (src_w << 16) / dst_w;            \
-    for ( i=dst_w; i>0; --i ) {             \
-        while ( pos >= 0x10000L ) {         \
-            pixel = *src++;                 \
-            pos -= 0x10000L;                \
-        }                                   \
-        *dst++ = pixel;                     \
-        pos += inc;                         \
-    }                                       \
+/* Nearest sampling */
+
+static void
+stretch_row_nearest1(const Uint8 *src, Uint8 *dst, int dst_w, const int *xofs)
+{
+    int i;
+
+    for (i = 0; i < dst_w; ++i) {
+        dst[i] = src[xofs[i]];
+    }
 }
-/* *INDENT-OFF* */
-DEFINE_COPY_ROW(copy_row1, Uint8)
-DEFINE_COPY_ROW(copy_row2, Uint16)
-DEFINE_COPY_ROW(copy_row4, Uint32)
-/* *INDENT-ON* */
 
-/* The ASM code doesn't handle 24-bpp stretch blits */
 static void
-copy_row3(Uint8 * src, int src_w, Uint8 * dst, int dst_w)
+stretch_row_nearest2(const Uint16 *src, Uint16 *dst, int dst_w, const int *xofs)
 {
     int i;
-    int pos, inc;
-    Uint8 pixel[3] = { 0, 0, 0 };
-
-    pos = 0x10000;
-    inc = (src_w << 16) / dst_w;
-    for (i = dst_w; i > 0; --i) {
-        while (pos >= 0x10000L) {
-            pixel[0] = *src++;
-            pixel[1] = *src++;
-            pixel[2] = *src++;
-            pos -= 0x10000L;
-        }
+
+    for (i = 0; i < dst_w; ++i) {
+        dst[i] = src[xofs[i]];
+    }
+}
+
+static void
+stretch_row_nearest3(const Uint8 *src, Uint8 *dst, int dst_w, const int *xofs)
+{
+    int i;
+
+    for (i = 0; i < dst_w; ++i) {
+        const Uint8 *pixel = src + xofs[i] * 3;
         *dst++ = pixel[0];
         *dst++ = pixel[1];
         *dst++ = pixel[2];
-        pos += inc;
     }
 }
 
+static void
+stretch_row_nearest4(const Uint32 *src, Uint32 *dst, int dst_w, const int *xofs)
+{
+    int i;
+
+    for (i = 0; i < dst_w; ++i) {
+        dst[i] = src[xofs[i]];
+    }
+}
+
+#if HAVE_AVX2_INTRINSICS
+static void SDL_TARGET_AVX2
+stretch_row_nearest4_AVX2(const Uint32 *src, Uint32 *dst, int dst_w, const int *xofs)
+{
+    int i = 0;
+
+    for (; i + 8 <= dst_w; i += 8) {
+        const __m256i index = _mm256_loadu_si256((const __m256i *) &xofs[i]);
+        _mm256_storeu_si256((__m256i *) &dst[i], _mm256_i32gather_epi32((const int *) src, index, 4));
+    }
+    for (; i < dst_w; ++i) {
+        dst[i] = src[xofs[i]];
+    }
+}
+#endif
+
 /* Perform a stretch blit between two surfaces of the same format.
-   NOTE:  This function is not safe to call from multiple threads!
+   The rows and columns sampled are the same as those of the original
+   row copier: destination pixel i comes from source pixel (i * inc) >> 16
+   with inc = (src_w << 16) / dst_w.
 */
 int
 SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
                 SDL_Surface * dst, const SDL_Rect * dstrect)
 {
+    SDL_StretchRowNearest32Func stretch_row4 = stretch_row_nearest4;
     int src_locked;
     int dst_locked;
-    int pos, inc;
-    int dst_maxrow;
-    int src_row, dst_row;
-    Uint8 *srcp = NULL;
+    int pos, inc, xpos, xinc;
+    int dst_row, dst_maxrow, src_row, last_src_row;
+    int *xofs;
+    int i;
+    const Uint8 *srcp;
     Uint8 *dstp;
     SDL_Rect full_src;
     SDL_Rect full_dst;
-#ifdef USE_ASM_STRETCH
-    SDL_bool use_asm = SDL_TRUE;
-#ifdef __GNUC__
-    int u1, u2;
-#endif
-#endif /* USE_ASM_STRETCH */
     const int bpp = dst->format->BytesPerPixel;
 
-    if (src->format->format != dst->format->format) {
-        return SDL_SetError("Only works with same format surfaces");
+    if (SDL_CheckStretchRects(src, &srcrect, &full_src, dst, &dstrect, &full_dst) < 0) {
+        return -1;
+    }
+    if (dstrect->w <= 0 || dstrect->h <= 0 || srcrect->w <= 0 || srcrect->h <= 0) {
+        return 0;
     }
 
-    /* Verify the blit rectangles */
-    if (srcrect) {
-        if ((srcrect->x < 0) || (srcrect->y < 0) ||
-            ((srcrect->x + srcrect->w) > src->w) ||
-            ((srcrect->y + srcrect->h) > src->h)) {
-            return SDL_SetError("Invalid source blit rectangle");
-        }
-    } else {
-        full_src.x = 0;
-        full_src.y = 0;
-        full_src.w = src->w;
-        full_src.h = src->h;
-        srcrect = &full_src;
-    }
-    if (dstrect) {
-        if ((dstrect->x < 0) || (dstrect->y < 0) ||
-            ((dstrect->x + dstrect->w) > dst->w) ||
-            ((dstrect->y + dstrect->h) > dst->h)) {
-            return SDL_SetError("Invalid destination blit rectangle");
-        }
-    } else {
-        full_dst.x = 0;
-        full_dst.y = 0;
-        full_dst.w = dst->w;
-        full_dst.h = dst->h;
-        dstrect = &full_dst;
+    xofs = (int *) SDL_malloc(dstrect->w * sizeof (*xofs));
+    if (!xofs) {
+        return SDL_OutOfMemory();
+    }
+    xpos = 0;
+    xinc = (srcrect->w << 16) / dstrect->w;
+    for (i = 0; i < dstrect->w; ++i) {
+        xofs[i] = xpos >> 16;
+        xpos += xinc;
     }
 
-    /* Lock the destination if it's in hardware */
-    dst_locked = 0;
-    if (SDL_MUSTLOCK(dst)) {
-        if (SDL_LockSurface(dst) < 0) {
-            return SDL_SetError("Unable to lock destination surface");
-        }
-        dst_locked = 1;
+#if HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        stretch_row4 = stretch_row_nearest4_AVX2;
     }
-    /* Lock the source if it's in hardware */
-    src_locked = 0;
-    if (SDL_MUSTLOCK(src)) {
-        if (SDL_LockSurface(src) < 0) {
-            if (dst_locked) {
-                SDL_UnlockSurface(dst);
-            }
-            return SDL_SetError("Unable to lock source surface");
-        }
-        src_locked = 1;
+#endif
+
+    if (SDL_LockStretchSurfaces(src, dst, &src_locked, &dst_locked) < 0) {
+        SDL_free(xofs);
+        return -1;
     }
 
     /* Set up the data... */
-    pos = 0x10000;
+    pos = 0;
     inc = (srcrect->h << 16) / dstrect->h;
-    src_row = srcrect->y;
+    last_src_row = -1;
     dst_row = dstrect->y;
 
-#ifdef USE_ASM_STRETCH
-    /* Write the opcodes for this stretch */
-    if ((bpp == 3) || (generate_rowbytes(srcrect->w, dstrect->w, bpp) < 0)) {
-        use_asm = SDL_FALSE;
-    }
-#endif
-
     /* Perform the stretch blit */
     for (dst_maxrow = dst_row + dstrect->h; dst_row < dst_maxrow; ++dst_row) {
         dstp = (Uint8 *) dst->pixels + (dst_row * dst->pitch)
             + (dstrect->x * bpp);
-        while (pos >= 0x10000L) {
-            srcp = (Uint8 *) src->pixels + (src_row * src->pitch)
+        src_row = srcrect->y + (pos >> 16);
+        if (src_row == last_src_row) {
+            SDL_memcpy(dstp, dstp - dst->pitch, dstrect->w * bpp);
+        } else {
+            srcp = (const Uint8 *) src->pixels + (src_row * src->pitch)
                 + (srcrect->x * bpp);
-            ++src_row;
-            pos -= 0x10000L;
-        }
-#ifdef USE_ASM_STRETCH
-        if (use_asm) {
-#ifdef __GNUC__
-            __asm__ __volatile__("call *%4":"=&D"(u1), "=&S"(u2)
-                                 :"0"(dstp), "1"(srcp), "r"(copy_row)
-                                 :"memory");
-#elif defined(_MSC_VER) || defined(__WATCOMC__)
-            /* *INDENT-OFF* */
-            {
-                void *code = copy_row;
-                __asm {
-                    push edi
-                    push esi
-                    mov edi, dstp
-                    mov esi, srcp
-                    call dword ptr code
-                    pop esi
-                    pop edi
-                }
-            }
-            /* *INDENT-ON* */
-#else
-#error Need inline assembly for this compiler
-#endif
-        } else
-#endif
             switch (bpp) {
             case 1:
-                copy_row1(srcp, srcrect->w, dstp, dstrect->w);
+                stretch_row_nearest1(srcp, dstp, dstrect->w, xofs);
                 break;
             case 2:
-                copy_row2((Uint16 *) srcp, srcrect->w,
-                          (Uint16 *) dstp, dstrect->w);
+                stretch_row_nearest2((const Uint16 *) srcp, (Uint16 *) dstp, dstrect->w, xofs);
                 break;
             case 3:
-                copy_row3(srcp, srcrect->w, dstp, dstrect->w);
+                stretch_row_nearest3(srcp, dstp, dstrect->w, xofs);
                 break;
             case 4:
-                copy_row4((Uint32 *) srcp, srcrect->w,
-                          (Uint32 *) dstp, dstrect->w);
+                stretch_row4((const Uint32 *) srcp, (Uint32 *) dstp, dstrect->w, xofs);
                 break;
             }
+            last_src_row = src_row;
+        }
         pos += inc;
     }
 
-    /* We need to unlock the surfaces if they're locked */
-    if (dst_locked) {
-        SDL_UnlockSurface(dst);
+    SDL_UnlockStretchSurfaces(src, dst, src_locked, dst_locked);
+    SDL_free(xofs);
+    return (0);
+}
+
+/* Linear filtering */
+
+/* Blend each pair of 8888 pixels src[xofs[i]], src[xofs[i] + 1] into dst[i].
+   xweights holds the weights of the two pixels, four times each. */
+static void
+stretch_row_linear(const Uint8 *src, Uint8 *dst, int dst_w, const int *xofs, const Uint16 *xweights)
+{
+    int i, c;
+
+    for (i = 0; i < dst_w; ++i, xweights += 8) {
+        const Uint8 *pixel = src + xofs[i] * 4;
+        for (c = 0; c < 4; ++c) {
+            *dst++ = (Uint8) ((pixel[c] * xweights[0] + pixel[c + 4] * xweights[4] + (WEIGHT_ONE / 2)) >> WEIGHT_BITS);
+        }
     }
-    if (src_locked) {
-        SDL_UnlockSurface(src);
+}
+
+static void
+blend_rows(const Uint8 *src0, const Uint8 *src1, Uint8 *dst, int len, int weight)
+{
+    const int weight0 = WEIGHT_ONE - weight;
+    int i;
+
+    for (i = 0; i < len; ++i) {
+        dst[i] = (Uint8) ((src0[i] * weight0 + src1[i] * weight + (WEIGHT_ONE / 2)) >> WEIGHT_BITS);
+    }
+}
+
+#if HAVE_SSE2_INTRINSICS
+static void
+stretch_row_linear_SSE2(const Uint8 *src, Uint8 *dst, int dst_w, const int *xofs, const Uint16 *xweights)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(WEIGHT_ONE / 2);
+    int i = 0;
+
+    for (; i + 2 <= dst_w; i += 2, xweights += 16) {
+        /* The two source pixels of each destination pixel, widened to 16 bits */
+        const __m128i pair0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (src + xofs[i] * 4)), zero);
+        const __m128i pair1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *) (src + xofs[i + 1] * 4)), zero);
+        const __m128i sum0 = _mm_mullo_epi16(pair0, _mm_loadu_si128((const __m128i *) xweights));
+        const __m128i sum1 = _mm_mullo_epi16(pair1, _mm_loadu_si128((const __m128i *) (xweights + 8)));
+        __m128i result = _mm_unpacklo_epi64(_mm_add_epi16(sum0, _mm_srli_si128(sum0, 8)),
+                                            _mm_add_epi16(sum1, _mm_srli_si128(sum1, 8)));
+        result = _mm_srli_epi16(_mm_add_epi16(result, half), WEIGHT_BITS);
+        _mm_storel_epi64((__m128i *) (dst + i * 4), _mm_packus_epi16(result, result));
+    }
+    if (i < dst_w) {
+        stretch_row_linear(src, dst + i * 4, dst_w - i, xofs + i, xweights);
+    }
+}
+
+static void
+blend_rows_SSE2(const Uint8 *src0, const Uint8 *src1, Uint8 *dst, int len, int weight)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi16(WEIGHT_ONE / 2);
+    const __m128i weight0 = _mm_set1_epi16((short) (WEIGHT_ONE - weight));
+    const __m128i weight1 = _mm_set1_epi16((short) weight);
+    int i = 0;
+
+    for (; i + 16 <= len; i += 16) {
+        const __m128i a = _mm_loadu_si128((const __m128i *) (src0 + i));
+        const __m128i b = _mm_loadu_si128((const __m128i *) (src1 + i));
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), weight0),
+                                   _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), weight1));
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), weight0),
+                                   _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), weight1));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, half), WEIGHT_BITS);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, half), WEIGHT_BITS);
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+    if (i < len) {
+        blend_rows(src0 + i, src1 + i, dst + i, len - i, weight);
+    }
+}
+#endif
+
+#if HAVE_AVX2_INTRINSICS
+static void SDL_TARGET_AVX2
+blend_rows_AVX2(const Uint8 *src0, const Uint8 *src1, Uint8 *dst, int len, int weight)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i half = _mm256_set1_epi16(WEIGHT_ONE / 2);
+    const __m256i weight0 = _mm256_set1_epi16((short) (WEIGHT_ONE - weight));
+    const __m256i weight1 = _mm256_set1_epi16((short) weight);
+    int i = 0;
+
+    /* Unpacking and packing both work within 128-bit lanes, so the bytes
+       come back out in order */
+    for (; i + 32 <= len; i += 32) {
+        const __m256i a = _mm256_loadu_si256((const __m256i *) (src0 + i));
+        const __m256i b = _mm256_loadu_si256((const __m256i *) (src1 + i));
+        __m256i lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(a, zero), weight0),
+                                      _mm256_mullo_epi16(_mm256_unpacklo_epi8(b, zero), weight1));
+        __m256i hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(a, zero), weight0),
+                                      _mm256_mullo_epi16(_mm256_unpackhi_epi8(b, zero), weight1));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, half), WEIGHT_BITS);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, half), WEIGHT_BITS);
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    if (i < len) {
+        blend_rows(src0 + i, src1 + i, dst + i, len - i, weight);
+    }
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+static void
+stretch_row_linear_NEON(const Uint8 *src, Uint8 *dst, int dst_w, const int *xofs, const Uint16 *xweights)
+{
+    int i = 0;
+
+    for (; i + 2 <= dst_w; i += 2, xweights += 16) {
+        const uint16x8_t sum0 = vmulq_u16(vmovl_u8(vld1_u8(src + xofs[i] * 4)), vld1q_u16(xweights));
+        const uint16x8_t sum1 = vmulq_u16(vmovl_u8(vld1_u8(src + xofs[i + 1] * 4)), vld1q_u16(xweights + 8));
+        const uint16x8_t result = vcombine_u16(vadd_u16(vget_low_u16(sum0), vget_high_u16(sum0)),
+                                               vadd_u16(vget_low_u16(sum1), vget_high_u16(sum1)));
+        /* Rounding narrow, (x + 128) >> 8 */
+        vst1_u8(dst + i * 4, vrshrn_n_u16(result, WEIGHT_BITS));
+    }
+    if (i < dst_w) {
+        stretch_row_linear(src, dst + i * 4, dst_w - i, xofs + i, xweights);
+    }
+}
+
+static void
+blend_rows_NEON(const Uint8 *src0, const Uint8 *src1, Uint8 *dst, int len, int weight)
+{
+    const uint8x8_t weight0 = vdup_n_u8((Uint8) (WEIGHT_ONE - weight));
+    const uint8x8_t weight1 = vdup_n_u8((Uint8) weight);
+    int i = 0;
+
+    /* A weight of 256 doesn't fit in a byte, copy that row instead */
+    if (weight == 0) {
+        SDL_memcpy(dst, src0, len);
+        return;
+    }
+
+    for (; i + 16 <= len; i += 16) {
+        const uint8x16_t a = vld1q_u8(src0 + i);
+        const uint8x16_t b = vld1q_u8(src1 + i);
+        const uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(a), weight0), vget_low_u8(b), weight1);
+        const uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(a), weight0), vget_high_u8(b), weight1);
+        vst1q_u8(dst + i, vcombine_u8(vrshrn_n_u16(lo, WEIGHT_BITS), vrshrn_n_u16(hi, WEIGHT_BITS)));
+    }
+    if (i < len) {
+        blend_rows(src0 + i, src1 + i, dst + i, len - i, weight);
     }
+}
+#endif
+
+/* Convert a row of 16 or 24-bit pixels to 8888, repeating the last pixel
+   once so the filter can always read a pixel's right hand neighbour */
+static void
+expand_row(const Uint8 *src, Uint8 *dst, int w, SDL_PixelFormat * fmt)
+{
+    const int bpp = fmt->BytesPerPixel;
+    int i;
+
+    if (bpp == 2) {
+        const Uint16 *src16 = (const Uint16 *) src;
+        const Uint8 *Rexpand = SDL_expand_byte[fmt->Rloss];
+        const Uint8 *Gexpand = SDL_expand_byte[fmt->Gloss];
+        const Uint8 *Bexpand = SDL_expand_byte[fmt->Bloss];
+        const Uint8 *Aexpand = SDL_expand_byte[fmt->Aloss];
+        for (i = 0; i < w; ++i, dst += 4) {
+            const Uint32 Pixel = src16[i];
+            dst[0] = Rexpand[(Pixel & fmt->Rmask) >> fmt->Rshift];
+            dst[1] = Gexpand[(Pixel & fmt->Gmask) >> fmt->Gshift];
+            dst[2] = Bexpand[(Pixel & fmt->Bmask) >> fmt->Bshift];
+            dst[3] = Aexpand[(Pixel & fmt->Amask) >> fmt->Ashift];
+        }
+    } else {
+        Uint32 Pixel;
+        unsigned r, g, b, a;
+        for (i = 0; i < w; ++i, src += bpp, dst += 4) {
+            DISEMBLE_RGBA(src, bpp, fmt, Pixel, r, g, b, a);
+            dst[0] = (Uint8) r;
+            dst[1] = (Uint8) g;
+            dst[2] = (Uint8) b;
+            dst[3] = (Uint8) a;
+        }
+    }
+    SDL_memcpy(dst, dst - 4, 4);
+}
+
+static void
+pack_row(const Uint8 *src, Uint8 *dst, int w, SDL_PixelFormat * fmt)
+{
+    const int bpp = fmt->BytesPerPixel;
+    int i;
+
+    if (bpp == 2) {
+        Uint16 *dst16 = (Uint16 *) dst;
+        for (i = 0; i < w; ++i, src += 4) {
+            Uint32 Pixel;
+            PIXEL_FROM_RGBA(Pixel, fmt, src[0], src[1], src[2], src[3]);
+            dst16[i] = (Uint16) Pixel;
+        }
+    } else {
+        for (i = 0; i < w; ++i, src += 4, dst += bpp) {
+            ASSEMBLE_RGBA(dst, bpp, fmt, src[0], src[1], src[2], src[3]);
+        }
+    }
+}
+
+static SDL_bool
+SDL_CanStretchLinear(SDL_PixelFormat * fmt)
+{
+    if (SDL_ISPIXELFORMAT_INDEXED(fmt->format) || SDL_ISPIXELFORMAT_FOURCC(fmt->format)) {
+        return SDL_FALSE;
+    }
+    if (fmt->BytesPerPixel < 2 || fmt->format == SDL_PIXELFORMAT_ARGB2101010) {
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+
+/* Perform a bilinear filtered stretch blit between two surfaces of the
+   same format.
+*/
+int
+SDL_SoftStretchLinear(SDL_Surface * src, const SDL_Rect * srcrect,
+                      SDL_Surface * dst, const SDL_Rect * dstrect)
+{
+    SDL_StretchRowLinearFunc stretch_row = stretch_row_linear;
+    SDL_BlendRowsFunc blend = blend_rows;
+    SDL_Rect full_src;
+    SDL_Rect full_dst;
+    int src_locked;
+    int dst_locked;
+    int src_w, src_h, dst_w, dst_h;
+    int *xofs;
+    Uint16 *xweights;
+    Uint8 *rows[2], *expanded, *packed, *buffer;
+    int cached[2];
+    SDL_bool convert;
+    Sint64 pos, step;
+    int i, j;
+    const int bpp = dst->format->BytesPerPixel;
+
+    if (SDL_CheckStretchRects(src, &srcrect, &full_src, dst, &dstrect, &full_dst) < 0) {
+        return -1;
+    }
+    if (!SDL_CanStretchLinear(src->format)) {
+        return SDL_SetError("Linear stretching isn't supported for %s",
+                            SDL_GetPixelFormatName(src->format->format));
+    }
+    src_w = srcrect->w;
+    src_h = srcrect->h;
+    dst_w = dstrect->w;
+    dst_h = dstrect->h;
+    if (dst_w <= 0 || dst_h <= 0 || src_w <= 0 || src_h <= 0) {
+        return 0;
+    }
+
+    /* Source rows are read in place if they are 8888 and at least two pixels wide */
+    convert = (bpp != 4 || src_w == 1) ? SDL_TRUE : SDL_FALSE;
+
+    buffer = (Uint8 *) SDL_SIMDAlloc(dst_w * sizeof (int) + dst_w * 8 * sizeof (Uint16) +
+                                     3 * dst_w * 4 + (src_w + 1) * 4);
+    if (!buffer) {
+        return SDL_OutOfMemory();
+    }
+    xweights = (Uint16 *) buffer;
+    xofs = (int *) (xweights + dst_w * 8);
+    rows[0] = (Uint8 *) (xofs + dst_w);
+    rows[1] = rows[0] + dst_w * 4;
+    packed = rows[1] + dst_w * 4;
+    expanded = packed + dst_w * 4;
+
+    /* Sample at pixel centers. A weight of 256 on the right hand pixel
+       keeps the last column from reading past the end of the row. */
+    step = ((Sint64) src_w << 16) / dst_w;
+    pos = step / 2 - 0x8000;
+    for (i = 0; i < dst_w; ++i, pos += step) {
+        const Sint64 x = SDL_max(pos, 0);
+        int index = (int) (x >> 16);
+        int weight = (int) ((x >> (16 - WEIGHT_BITS)) & (WEIGHT_ONE - 1));
+        if (index >= src_w - 1) {
+            index = SDL_max(src_w - 2, 0);
+            weight = (src_w > 1) ? WEIGHT_ONE : 0;
+        }
+        xofs[i] = index;
+        xweights[i * 8 + 0] = xweights[i * 8 + 1] = xweights[i * 8 + 2] = xweights[i * 8 + 3] = (Uint16) (WEIGHT_ONE - weight);
+        xweights[i * 8 + 4] = xweights[i * 8 + 5] = xweights[i * 8 + 6] = xweights[i * 8 + 7] = (Uint16) weight;
+    }
+
+#if HAVE_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        stretch_row = stretch_row_linear_SSE2;
+        blend = blend_rows_SSE2;
+    }
+#endif
+#if HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        blend = blend_rows_AVX2;
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        stretch_row = stretch_row_linear_NEON;
+        blend = blend_rows_NEON;
+    }
+#endif
+
+    if (SDL_LockStretchSurfaces(src, dst, &src_locked, &dst_locked) < 0) {
+        SDL_SIMDFree(buffer);
+        return -1;
+    }
+
+    cached[0] = cached[1] = -1;
+    step = ((Sint64) src_h << 16) / dst_h;
+    pos = step / 2 - 0x8000;
+    for (j = 0; j < dst_h; ++j, pos += step) {
+        const Sint64 y = SDL_max(pos, 0);
+        int src_row = (int) (y >> 16);
+        int weight = (int) ((y >> (16 - WEIGHT_BITS)) & (WEIGHT_ONE - 1));
+        Uint8 *dstp = (Uint8 *) dst->pixels + (dstrect->y + j) * dst->pitch + dstrect->x * bpp;
+        int k;
+
+        if (src_row >= src_h - 1) {
+            src_row = src_h - 1;
+            weight = 0;
+        }
+
+        /* Scale the two source rows horizontally, reusing what we can */
+        if (cached[1] == src_row) {
+            Uint8 *tmp = rows[0];
+            rows[0] = rows[1];
+            rows[1] = tmp;
+            cached[0] = src_row;
+            cached[1] = -1;
+        }
+        for (k = 0; k < 2; ++k) {
+            const int row = src_row + k;
+            const Uint8 *srcp;
+            if (cached[k] == row || (k == 1 && weight == 0)) {
+                continue;
+            }
+            srcp = (const Uint8 *) src->pixels + (srcrect->y + row) * src->pitch + srcrect->x * bpp;
+            if (convert) {
+                expand_row(srcp, expanded, src_w, src->format);
+                srcp = expanded;
+            }
+            stretch_row(srcp, rows[k], dst_w, xofs, xweights);
+            cached[k] = row;
+        }
+
+        if (convert) {
+            if (weight) {
+                blend(rows[0], rows[1], packed, dst_w * 4, weight);
+                pack_row(packed, dstp, dst_w, dst->format);
+            } else {
+                pack_row(rows[0], dstp, dst_w, dst->format);
+            }
+        } else if (weight) {
+            blend(rows[0], rows[1], dstp, dst_w * 4, weight);
+        } else {
+            SDL_memcpy(dstp, rows[0], dst_w * 4);
+        }
+    }
+
+    SDL_UnlockStretchSurfaces(src, dst, src_locked, dst_locked);
+    SDL_SIMDFree(buffer);
     return (0);
 }
 
@@ -26,6 +26,7 @@
 #include "SDL_RLEaccel_c.h"
 #include "SDL_pixels_c.h"
 #include "SDL_yuv_c.h"
+#include "../SDL_trace_c.h"
 
 
 /* Check to make sure we can safely check multiplication of surface w and pitch and it won't overflow size_t */
@@ -602,6 +603,8 @@ int
 SDL_LowerBlit(SDL_Surface * src, SDL_Rect * srcrect,
               SDL_Surface * dst, SDL_Rect * dstrect)
 {
+    int retval;
+
     /* Check to make sure the blit mapping is valid */
     if ((src->map->dst != dst) ||
         (dst->format->palette &&
@@ -617,7 +620,10 @@ SDL_LowerBlit(SDL_Surface * src, SDL_Rect * srcrect,
 /*              src, dst->flags, src->map->info.flags, dst, dst->flags, */
 /*              dst->map->info.flags, src->map->blit); */
     }
-    return (src->map->blit(src, srcrect, dst, dstrect));
+    SDL_TRACE_BEGIN("SDL_LowerBlit");
+    retval = src->map->blit(src, srcrect, dst, dstrect);
+    SDL_TRACE_END();
+    return retval;
 }
 
 
@@ -723,6 +729,13 @@ SDL_UpperBlit(SDL_Surface * src, const SDL_Rect * srcrect,
 int
 SDL_UpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
               SDL_Surface * dst, SDL_Rect * dstrect)
+{
+    return SDL_PrivateUpperBlitScaled(src, srcrect, dst, dstrect, SDL_ScaleModeNearest);
+}
+
+int
+SDL_PrivateUpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
+                           SDL_Surface * dst, SDL_Rect * dstrect, SDL_ScaleMode scaleMode)
 {
     double src_x0, src_y0, src_x1, src_y1;
     double dst_x0, dst_y0, dst_x1, dst_y1;
@@ -867,7 +880,7 @@ SDL_UpperBlitScaled(SDL_Surface * src, const SDL_Rect * srcrect,
         return 0;
     }
 
-    return SDL_LowerBlitScaled(src, &final_src, dst, &final_dst);
+    return SDL_PrivateLowerBlitScaled(src, &final_src, dst, &final_dst, scaleMode);
 }
 
 /**
@@ -878,11 +891,106 @@ int
 SDL_LowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
                 SDL_Surface * dst, SDL_Rect * dstrect)
 {
-    static const Uint32 complex_copy_flags = (
-        SDL_COPY_MODULATE_COLOR | SDL_COPY_MODULATE_ALPHA |
-        SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD | SDL_COPY_MUL |
-        SDL_COPY_COLORKEY
-    );
+    return SDL_PrivateLowerBlitScaled(src, srcrect, dst, dstrect, SDL_ScaleModeNearest);
+}
+
+static const Uint32 complex_copy_flags = (
+    SDL_COPY_MODULATE_COLOR | SDL_COPY_MODULATE_ALPHA |
+    SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD | SDL_COPY_MUL |
+    SDL_COPY_COLORKEY
+);
+
+/* Filter a plain copy of the source rectangle into an ARGB8888 surface the
+   size of the destination rectangle, then blit that with the source's
+   blend mode and modulation. Colorkeyed pixels turn transparent, so this
+   is only used for colorkeys together with a blend mode. */
+static int
+SDL_LowerBlitScaledLinearConverted(SDL_Surface * src, SDL_Rect * srcrect,
+                                   SDL_Surface * dst, SDL_Rect * dstrect)
+{
+    SDL_Surface *clone = NULL, *unscaled = NULL, *scaled = NULL;
+    SDL_Rect rect;
+    SDL_BlendMode blendMode;
+    Uint8 r, g, b, a;
+    Uint32 colorkey = 0;
+    int src_locked = 0;
+    int retval = -1;
+
+    SDL_GetSurfaceColorMod(src, &r, &g, &b);
+    SDL_GetSurfaceAlphaMod(src, &a);
+    SDL_GetSurfaceBlendMode(src, &blendMode);
+
+    /* Blit from a clone sharing the source pixels, so the source map is left alone */
+    if (SDL_MUSTLOCK(src)) {
+        if (SDL_LockSurface(src) < 0) {
+            return -1;
+        }
+        src_locked = 1;
+    }
+    clone = SDL_CreateRGBSurfaceWithFormatFrom(src->pixels, src->w, src->h,
+                                               src->format->BitsPerPixel, src->pitch,
+                                               src->format->format);
+    unscaled = SDL_CreateRGBSurfaceWithFormat(0, srcrect->w, srcrect->h, 32, SDL_PIXELFORMAT_ARGB8888);
+    scaled = SDL_CreateRGBSurfaceWithFormat(0, dstrect->w, dstrect->h, 32, SDL_PIXELFORMAT_ARGB8888);
+    if (clone && unscaled && scaled) {
+        if (src->format->palette) {
+            SDL_SetSurfacePalette(clone, src->format->palette);
+        }
+        if (SDL_GetColorKey(src, &colorkey) == 0) {
+            SDL_SetColorKey(clone, SDL_TRUE, colorkey);
+        }
+        SDL_SetSurfaceBlendMode(clone, SDL_BLENDMODE_NONE);
+
+        rect.x = 0;
+        rect.y = 0;
+        rect.w = srcrect->w;
+        rect.h = srcrect->h;
+        if (SDL_LowerBlit(clone, srcrect, unscaled, &rect) == 0 &&
+            SDL_SoftStretchLinear(unscaled, NULL, scaled, NULL) == 0) {
+            SDL_SetSurfaceColorMod(scaled, r, g, b);
+            SDL_SetSurfaceAlphaMod(scaled, a);
+            SDL_SetSurfaceBlendMode(scaled, blendMode);
+            rect.w = dstrect->w;
+            rect.h = dstrect->h;
+            retval = SDL_LowerBlit(scaled, &rect, dst, dstrect);
+        }
+    }
+
+    SDL_FreeSurface(scaled);
+    SDL_FreeSurface(unscaled);
+    SDL_FreeSurface(clone);
+    if (src_locked) {
+        SDL_UnlockSurface(src);
+    }
+    return retval;
+}
+
+int
+SDL_PrivateLowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
+                           SDL_Surface * dst, SDL_Rect * dstrect, SDL_ScaleMode scaleMode)
+{
+    /* Without blending a filtered colorkey edge has nothing to fade into,
+       keep the keyed pixels out of the destination by sampling nearest */
+    if (scaleMode != SDL_ScaleModeNearest &&
+        (src->map->info.flags & (SDL_COPY_COLORKEY | SDL_COPY_BLEND | SDL_COPY_ADD | SDL_COPY_MOD | SDL_COPY_MUL)) == SDL_COPY_COLORKEY) {
+        scaleMode = SDL_ScaleModeNearest;
+    }
+
+    if (scaleMode != SDL_ScaleModeNearest) {
+        int retval;
+        SDL_TRACE_BEGIN("SDL_SoftStretchLinear");
+        if (!(src->map->info.flags & complex_copy_flags) &&
+            src->format->format == dst->format->format &&
+            !SDL_ISPIXELFORMAT_INDEXED(src->format->format) &&
+            src->format->BytesPerPixel >= 2 &&
+            src->format->format != SDL_PIXELFORMAT_ARGB2101010) {
+            retval = SDL_SoftStretchLinear(src, srcrect, dst, dstrect);
+        } else {
+            retval = SDL_LowerBlitScaledLinearConverted(src, srcrect, dst, dstrect);
+        }
+        SDL_TRACE_END();
+        return retval;
+    }
 
     if (!(src->map->info.flags & SDL_COPY_NEAREST)) {
         src->map->info.flags |= SDL_COPY_NEAREST;
@@ -892,7 +1000,11 @@ SDL_LowerBlitScaled(SDL_Surface * src, SDL_Rect * srcrect,
     if ( !(src->map->info.flags & complex_copy_flags) &&
          src->format->format == dst->format->format &&
          !SDL_ISPIXELFORMAT_INDEXED(src->format->format) ) {
-        return SDL_SoftStretch( src, srcrect, dst, dstrect );
+        int retval;
+        SDL_TRACE_BEGIN("SDL_SoftStretch");
+        retval = SDL_SoftStretch( src, srcrect, dst, dstrect );
+        SDL_TRACE_END();
+        return retval;
     } else {
         return SDL_LowerBlit( src, srcrect, dst, dstrect );
     }
@@ -323,6 +323,7 @@ struct SDL_VideoDevice
     /* * * */
     /* Data common to all drivers */
     SDL_bool is_dummy;
+    SDL_bool wakes_event_waiters;   /* calls SDL_WakeEventWaiters() when PumpEvents() has new input */
     SDL_bool suspend_screensaver;
     int num_displays;
     SDL_VideoDisplay *displays;
@@ -3791,6 +3791,28 @@ SDL_GetWindowWMInfo(SDL_Window * window, struct SDL_SysWMinfo *info)
     return (_this->GetWindowWMInfo(_this, window, info));
 }
 
+#ifdef __OHOS__
+#if SDL_VIDEO_DRIVER_OHOS
+extern int OHOS_GetWindowFrameStats(SDL_Window *window, SDL_OHOSWindowFrameStats *stats);
+#endif
+
+int
+SDL_OHOSGetWindowFrameStats(SDL_Window * window, SDL_OHOSWindowFrameStats *stats)
+{
+    CHECK_WINDOW_MAGIC(window, -1);
+
+    if (!stats) {
+        return SDL_InvalidParamError("stats");
+    }
+#if SDL_VIDEO_DRIVER_OHOS
+    if (SDL_strcmp(_this->name, "OHOS") == 0) {
+        return OHOS_GetWindowFrameStats(window, stats);
+    }
+#endif
+    return SDL_Unsupported();
+}
+#endif /* __OHOS__ */
+
 void
 SDL_StartTextInput(void)
 {
@@ -290,6 +290,115 @@ static SDL_bool yuv_rgb_sse(
     return SDL_FALSE;
 }
 
+static SDL_bool yuv_rgb_neon(
+    Uint32 src_format, Uint32 dst_format,
+    Uint32 width, Uint32 height, 
+    const Uint8 *y, const Uint8 *u, const Uint8 *v, Uint32 y_stride, Uint32 uv_stride, 
+    Uint8 *rgb, Uint32 rgb_stride, 
+    YCbCrType yuv_type)
+{
+#ifdef __ARM_NEON
+    if (!SDL_HasNEON()) {
+        return SDL_FALSE;
+    }
+
+    if (src_format == SDL_PIXELFORMAT_YV12 ||
+        src_format == SDL_PIXELFORMAT_IYUV) {
+
+        switch (dst_format) {
+        case SDL_PIXELFORMAT_RGB565:
+            yuv420_rgb565_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB24:
+            yuv420_rgb24_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGBX8888:
+        case SDL_PIXELFORMAT_RGBA8888:
+            yuv420_rgba_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGRX8888:
+        case SDL_PIXELFORMAT_BGRA8888:
+            yuv420_bgra_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB888:
+        case SDL_PIXELFORMAT_ARGB8888:
+            yuv420_argb_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGR888:
+        case SDL_PIXELFORMAT_ABGR8888:
+            yuv420_abgr_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        default:
+            break;
+        }
+    }
+
+    if (src_format == SDL_PIXELFORMAT_YUY2 ||
+        src_format == SDL_PIXELFORMAT_UYVY ||
+        src_format == SDL_PIXELFORMAT_YVYU) {
+
+        switch (dst_format) {
+        case SDL_PIXELFORMAT_RGB565:
+            yuv422_rgb565_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB24:
+            yuv422_rgb24_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGBX8888:
+        case SDL_PIXELFORMAT_RGBA8888:
+            yuv422_rgba_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGRX8888:
+        case SDL_PIXELFORMAT_BGRA8888:
+            yuv422_bgra_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB888:
+        case SDL_PIXELFORMAT_ARGB8888:
+            yuv422_argb_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGR888:
+        case SDL_PIXELFORMAT_ABGR8888:
+            yuv422_abgr_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        default:
+            break;
+        }
+    }
+
+    if (src_format == SDL_PIXELFORMAT_NV12 ||
+        src_format == SDL_PIXELFORMAT_NV21) {
+
+        switch (dst_format) {
+        case SDL_PIXELFORMAT_RGB565:
+            yuvnv12_rgb565_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB24:
+            yuvnv12_rgb24_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGBX8888:
+        case SDL_PIXELFORMAT_RGBA8888:
+            yuvnv12_rgba_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGRX8888:
+        case SDL_PIXELFORMAT_BGRA8888:
+            yuvnv12_bgra_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB888:
+        case SDL_PIXELFORMAT_ARGB8888:
+            yuvnv12_argb_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGR888:
+        case SDL_PIXELFORMAT_ABGR8888:
+            yuvnv12_abgr_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        default:
+            break;
+        }
+    }
+#endif
+    return SDL_FALSE;
+}
+
 static SDL_bool yuv_rgb_std(
     Uint32 src_format, Uint32 dst_format,
     Uint32 width, Uint32 height, 
@@ -417,6 +526,10 @@ SDL_ConvertPixels_YUV_to_RGB(int width, int height,
         return 0;
     }
 
+    if (yuv_rgb_neon(src_format, dst_format, width, height, y, u, v, y_stride, uv_stride, (Uint8*)dst, dst_pitch, yuv_type)) {
+        return 0;
+    }
+
     if (yuv_rgb_std(src_format, dst_format, width, height, y, u, v, y_stride, uv_stride, (Uint8*)dst, dst_pitch, yuv_type)) {
         return 0;
     }
@@ -966,6 +1079,9 @@ SDL_ConvertPixels_PackUVPlanes_to_NV(int width, int height, const void *src, int
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     /* Skip the Y plane */
     src = (const Uint8 *)src + height * src_pitch;
@@ -1008,6 +1124,20 @@ SDL_ConvertPixels_PackUVPlanes_to_NV(int width, int height, const void *src, int
                 x -= 16;
             }
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            while (x >= 16) {
+                uint8x16x2_t uv;
+                uv.val[0] = vld1q_u8(src1);
+                uv.val[1] = vld1q_u8(src2);
+                vst2q_u8(dstUV, uv);
+                src1 += 16;
+                src2 += 16;
+                dstUV += 32;
+                x -= 16;
+            }
+        }
 #endif
         while (x--) {
             *dstUV++ = *src1++;
@@ -1040,6 +1170,9 @@ SDL_ConvertPixels_SplitNV_to_UVPlanes(int width, int height, const void *src, in
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     /* Skip the Y plane */
     src = (const Uint8 *)src + height * src_pitch;
@@ -1087,6 +1220,19 @@ SDL_ConvertPixels_SplitNV_to_UVPlanes(int width, int height, const void *src, in
                 x -= 16;
             }
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            while (x >= 16) {
+                uint8x16x2_t uv = vld2q_u8(srcUV);
+                vst1q_u8(dst1, uv.val[0]);
+                vst1q_u8(dst2, uv.val[1]);
+                srcUV += 32;
+                dst1 += 16;
+                dst2 += 16;
+                x -= 16;
+            }
+        }
 #endif
         while (x--) {
             *dst1++ = *srcUV++;
@@ -1118,6 +1264,9 @@ SDL_ConvertPixels_SwapNV(int width, int height, const void *src, int src_pitch,
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     /* Skip the Y plane */
     src = (const Uint8 *)src + height * src_pitch;
@@ -1141,6 +1290,17 @@ SDL_ConvertPixels_SwapNV(int width, int height, const void *src, int src_pitch,
                 x -= 8;
             }
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            while (x >= 8) {
+                uint8x16_t uv = vld1q_u8((const Uint8 *)srcUV);
+                vst1q_u8((Uint8 *)dstUV, vrev16q_u8(uv));
+                srcUV += 8;
+                dstUV += 8;
+                x -= 8;
+            }
+        }
 #endif
         while (x--) {
             *dstUV++ = SDL_Swap16(*srcUV++);
@@ -1242,6 +1402,24 @@ SDL_ConvertPixels_Planar2x2_to_Planar2x2(int width, int height,
 
 #endif
 
+#ifdef __ARM_NEON
+/* Byte N of each output macropixel is byte sN of the input one */
+#define PACKED4_TO_PACKED4_ROW_NEON(s0, s1, s2, s3)                                                 \
+    while (x >= 16) {                                                                               \
+        uint8x16x4_t yuv = vld4q_u8(srcYUV);                                                        \
+        uint8x16x4_t out;                                                                           \
+        out.val[0] = yuv.val[s0];                                                                   \
+        out.val[1] = yuv.val[s1];                                                                   \
+        out.val[2] = yuv.val[s2];                                                                   \
+        out.val[3] = yuv.val[s3];                                                                   \
+        vst4q_u8(dstYUV, out);                                                                      \
+        srcYUV += 64;                                                                               \
+        dstYUV += 64;                                                                               \
+        x -= 16;                                                                                    \
+    }                                                                                               \
+
+#endif
+
 static int
 SDL_ConvertPixels_YUY2_to_UYVY(int width, int height, const void *src, int src_pitch, void *dst, int dst_pitch)
 {
@@ -1254,6 +1432,9 @@ SDL_ConvertPixels_YUY2_to_UYVY(int width, int height, const void *src, int src_p
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
@@ -1262,6 +1443,11 @@ SDL_ConvertPixels_YUY2_to_UYVY(int width, int height, const void *src, int src_p
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(2, 3, 0, 1));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(1, 0, 3, 2);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1296,6 +1482,9 @@ SDL_ConvertPixels_YUY2_to_YVYU(int width, int height, const void *src, int src_p
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
@@ -1304,6 +1493,11 @@ SDL_ConvertPixels_YUY2_to_YVYU(int width, int height, const void *src, int src_p
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(1, 2, 3, 0));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(0, 3, 2, 1);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1338,6 +1532,9 @@ SDL_ConvertPixels_UYVY_to_YUY2(int width, int height, const void *src, int src_p
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
@@ -1346,6 +1543,11 @@ SDL_ConvertPixels_UYVY_to_YUY2(int width, int height, const void *src, int src_p
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(2, 3, 0, 1));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(1, 0, 3, 2);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1380,6 +1582,9 @@ SDL_ConvertPixels_UYVY_to_YVYU(int width, int height, const void *src, int src_p
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
@@ -1388,6 +1593,11 @@ SDL_ConvertPixels_UYVY_to_YVYU(int width, int height, const void *src, int src_p
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(0, 3, 2, 1));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(1, 2, 3, 0);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1422,6 +1632,9 @@ SDL_ConvertPixels_YVYU_to_YUY2(int width, int height, const void *src, int src_p
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
@@ -1430,6 +1643,11 @@ SDL_ConvertPixels_YVYU_to_YUY2(int width, int height, const void *src, int src_p
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(1, 2, 3, 0));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(0, 3, 2, 1);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1464,6 +1682,9 @@ SDL_ConvertPixels_YVYU_to_UYVY(int width, int height, const void *src, int src_p
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
@@ -1472,6 +1693,11 @@ SDL_ConvertPixels_YVYU_to_UYVY(int width, int height, const void *src, int src_p
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(2, 1, 0, 3));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(3, 0, 1, 2);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
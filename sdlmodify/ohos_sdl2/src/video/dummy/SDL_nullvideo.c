@@ -85,6 +85,7 @@ DUMMY_CreateDevice(int devindex)
         return (0);
     }
     device->is_dummy = SDL_TRUE;
+    device->wakes_event_waiters = SDL_TRUE;
 
     /* Set the function pointers */
     device->VideoInit = DUMMY_VideoInit;
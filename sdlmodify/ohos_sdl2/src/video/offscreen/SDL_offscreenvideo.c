@@ -81,6 +81,7 @@ OFFSCREEN_CreateDevice(int devindex)
     device->VideoQuit = OFFSCREEN_VideoQuit;
     device->SetDisplayMode = OFFSCREEN_SetDisplayMode;
     device->PumpEvents = OFFSCREEN_PumpEvents;
+    device->wakes_event_waiters = SDL_TRUE;
     device->CreateWindowFramebuffer = SDL_OFFSCREEN_CreateWindowFramebuffer;
     device->UpdateWindowFramebuffer = SDL_OFFSCREEN_UpdateWindowFramebuffer;
     device->DestroyWindowFramebuffer = SDL_OFFSCREEN_DestroyWindowFramebuffer;
@@ -24,6 +24,8 @@
 #include "../SDL_sysvideo.h"
 #include "../../events/SDL_events_c.h"
 #include "../../core/ohos/SDL_ohoshead.h"
+#include "../../core/ohos/SDL_ohosinput.h"
+#include "SDL_ohoswindow.h"
 
 /* Can't include sysaudio "../../audio/ohos/SDL_ohosaudio.h"
  * because of THIS redefinition */
@@ -79,13 +81,17 @@ void OHOS_PUMPEVENTS_Blocking(SDL_VideoDevice *thisDevice)
 {
     SDL_Window *ohosWindow = thisDevice->windows;
     SDL_VideoData *videodata = (SDL_VideoData *)thisDevice->driverdata;
+
+    /* Deliver touch and mouse input staged by the UI thread */
+    OHOS_PumpInput();
+
     if (videodata->isPaused) {
         SDL_bool isContextExternal = SDL_IsVideoContextExternal();
         /* Make sure this is the last thing we do before pausing */
         if (!isContextExternal) {
-            SDL_LockMutex(g_ohosPageMutex);
+            OHOS_LockWindowSurface(ohosWindow);
             OHOS_EGL_context_backup(ohosWindow);
-            SDL_UnlockMutex(g_ohosPageMutex);
+            OHOS_UnlockWindowSurface(ohosWindow);
         }
 
         OHOSAUDIO_PauseDevices();
@@ -104,9 +110,9 @@ void OHOS_PUMPEVENTS_Blocking(SDL_VideoDevice *thisDevice)
 
             /* Restore the GL Context from here, as this operation is thread dependent */
             if (!isContextExternal && !SDL_HasEvent(SDL_QUIT)) {
-                SDL_LockMutex(g_ohosPageMutex);
+                OHOS_LockWindowSurface(ohosWindow);
                 OHOS_EGL_context_restore(ohosWindow);
-                SDL_UnlockMutex(g_ohosPageMutex);
+                OHOS_UnlockWindowSurface(ohosWindow);
             }
 
             /* Make sure SW Keyboard is restored when an app becomes foreground */
@@ -130,6 +136,8 @@ void OHOS_PUMPEVENTS_Blocking(SDL_VideoDevice *thisDevice)
             } else {
                 videodata->isPausing = 0;
                 videodata->isPaused = 1;
+                /* Pump once more to actually pause, even if the app is waiting */
+                SDL_WakeEventWaiters();
             }
         }
     }
@@ -141,13 +149,15 @@ void OHOS_PUMPEVENTS_NonBlocking(SDL_VideoDevice *thisDevice)
     SDL_VideoData *videodata = (SDL_VideoData *)thisDevice->driverdata;
     static int backup_context = 0;
 
+    OHOS_PumpInput();
+
     if (videodata->isPaused) {
         SDL_bool isContextExternal = SDL_IsVideoContextExternal();
         if (backup_context) {
             if (!isContextExternal) {
-                SDL_LockMutex(g_ohosPageMutex);
+                OHOS_LockWindowSurface(ohosWindow);
                 OHOS_EGL_context_backup(ohosWindow);
-                SDL_UnlockMutex(g_ohosPageMutex);
+                OHOS_UnlockWindowSurface(ohosWindow);
             }
 
             OHOSAUDIO_PauseDevices();
@@ -168,9 +178,9 @@ void OHOS_PUMPEVENTS_NonBlocking(SDL_VideoDevice *thisDevice)
 
             /* Restore the GL Context from here, as this operation is thread dependent */
             if (!isContextExternal && !SDL_HasEvent(SDL_QUIT)) {
-                SDL_LockMutex(g_ohosPageMutex);
+                OHOS_LockWindowSurface(ohosWindow);
                 OHOS_EGL_context_restore(ohosWindow);
-                SDL_UnlockMutex(g_ohosPageMutex);
+                OHOS_UnlockWindowSurface(ohosWindow);
             }
 
             /* Make sure SW Keyboard is restored when an app becomes foreground */
@@ -195,6 +205,7 @@ void OHOS_PUMPEVENTS_NonBlocking(SDL_VideoDevice *thisDevice)
                 videodata->isPausing = 0;
                 videodata->isPaused = 1;
                 backup_context = 1;
+                SDL_WakeEventWaiters();
             }
         }
     }
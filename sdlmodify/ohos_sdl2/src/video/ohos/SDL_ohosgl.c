@@ -29,6 +29,8 @@
 #include "SDL_ohosgl.h"
 #include "../../core/ohos/SDL_ohos.h"
 
+#include "SDL_timer.h"
+
 #include <dlfcn.h>
 
 int OHOS_GLES_MakeCurrent(SDL_VideoDevice *thisDevice, SDL_Window * window, SDL_GLContext context)
@@ -51,21 +53,64 @@ SDL_GLContext OHOS_GLES_CreateContext(SDL_VideoDevice *thisDevice, SDL_Window *
 }
 
 
+static void OHOS_GLES_UpdateFrameStats(SDL_WindowData *data, Uint64 swapStart, Uint64 now)
+{
+    const double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    SDL_OHOSWindowFrameStats *stats = &data->stats;
+
+    SDL_AtomicLock(&data->statsLock);
+    stats->frames++;
+    stats->lastSwapMs = (float)((now - swapStart) * msPerTick);
+    if (data->lastPresent != 0) {
+        stats->lastFrameMs = (float)((now - data->lastPresent) * msPerTick);
+        data->frameTicks += now - data->lastPresent;
+        stats->averageFrameMs = (float)(data->frameTicks * msPerTick / (stats->frames - 1));
+        if (stats->lastFrameMs > stats->maxFrameMs) {
+            stats->maxFrameMs = stats->lastFrameMs;
+        }
+    }
+    data->lastPresent = now;
+    if (data->pendingInput != 0) {
+        stats->inputFrames++;
+        stats->lastInputLatencyMs = (float)((now - data->pendingInput) * msPerTick);
+        data->inputTicks += now - data->pendingInput;
+        stats->averageInputLatencyMs = (float)(data->inputTicks * msPerTick / stats->inputFrames);
+        if (stats->lastInputLatencyMs > stats->maxInputLatencyMs) {
+            stats->maxInputLatencyMs = stats->lastInputLatencyMs;
+        }
+        data->pendingInput = 0;
+    }
+    SDL_AtomicUnlock(&data->statsLock);
+}
+
 int OHOS_GLES_SwapWindow(SDL_VideoDevice *thisDevice, SDL_Window * window)
 {
+    SDL_WindowData *data = (SDL_WindowData *)window->driverdata;
+    Uint64 start;
     int retval;
-    SDL_LockMutex(g_ohosPageMutex);
-    /* The following two calls existed in the original Java code
-     * If you happen to have a device that's affected by their removal,
-     * please report to Bugzilla. -- Gabriel
-     */
-    retval = SDL_EGL_SwapBuffers(thisDevice, ((SDL_WindowData *) window->driverdata)->egl_xcomponent);
-    SDL_UnlockMutex(g_ohosPageMutex);
 
+    if (data == NULL) {
+        return SDL_SetError("Window has no EGL surface");
+    }
+
+    /* Only the surface needs protecting here: the page mutex is left to
+     * input and lifecycle callbacks, which must not wait for a vsync. */
+    SDL_LockMutex(data->surfaceLock);
+    if (data->egl_xcomponent == EGL_NO_SURFACE) {
+        SDL_UnlockMutex(data->surfaceLock);
+        SDL_AtomicLock(&data->statsLock);
+        data->stats.skippedFrames++;
+        SDL_AtomicUnlock(&data->statsLock);
+        return SDL_SetError("Window EGL surface has been destroyed");
+    }
+    start = SDL_GetPerformanceCounter();
+    retval = SDL_EGL_SwapBuffers(thisDevice, data->egl_xcomponent);
+    SDL_UnlockMutex(data->surfaceLock);
+
+    OHOS_GLES_UpdateFrameStats(data, start, SDL_GetPerformanceCounter());
     return retval;
 }
 
-
 int OHOS_GLES_LoadLibrary(SDL_VideoDevice *thisDevice, const char *path)
 {
     return SDL_EGL_LoadLibrary(thisDevice, path, (NativeDisplayType) 0, 0);
@@ -28,6 +28,7 @@
 #include "../../events/SDL_events_c.h"
 #include "../../events/SDL_windowevents_c.h"
 #include "../../core/ohos/SDL_ohos.h"
+#include "../../core/ohos/SDL_ohosinput.h"
 #include "SDL_ohosgl.h"
 #include "SDL_ohoswindow.h"
 #include "SDL_keyboard.h"
@@ -91,6 +92,8 @@ static void OHOS_SetDevice(SDL_VideoDevice *device)
     } else {
         device->PumpEvents = OHOS_PUMPEVENTS_NonBlocking;
     }
+    /* Input and lifecycle changes come from the UI thread, which wakes waiters */
+    device->wakes_event_waiters = SDL_TRUE;
 
     device->GetDisplayDPI = OHOS_GetDisplayDPI;
     device->CreateSDLWindow = OHOS_CreateWindow;
@@ -194,6 +197,7 @@ int OHOS_VideoInit(SDL_VideoDevice *_this)
 
 void OHOS_VideoQuit(SDL_VideoDevice *_this)
 {
+    OHOS_FlushInput();
     OHOS_QuitMouse();
     OHOS_QuitTouch();
 }
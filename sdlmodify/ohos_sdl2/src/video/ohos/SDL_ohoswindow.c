@@ -26,8 +26,8 @@
 #define OHOS_GETWINDOW_DELAY_TIME 2
 #define TIMECONSTANT 3000
 #define OHOS_XCOMPONENT_STRING "SDL2_XComponent"
-#define OHOS_WAIT_COUNT 700
-#define OHOS_WAIT_TIME 10
+/* Upper bound for the ArkTS side to hand over the xcomponent surface of a new window. */
+#define OHOS_WAIT_TIMEOUT 7000
 
 #ifdef SDL_VIDEO_DRIVER_OHOS
 #if SDL_VIDEO_DRIVER_OHOS
@@ -40,6 +40,7 @@
 #include "../../events/SDL_keyboard_c.h"
 #include "../../events/SDL_mouse_c.h"
 #include "../../events/SDL_windowevents_c.h"
+#include "../../SDL_trace_c.h"
 #include "../../core/ohos/SDL_ohos.h"
 #include "../../core/ohos/SDL_ohosplugin_c.h"
 
@@ -84,8 +85,7 @@ int OHOS_CreateWindow(SDL_VideoDevice *thisDevice, SDL_Window * window)
     } else {
         parentWindowNode = window->ohosHandle;
     }
-    OHOS_CreateWindowFrom(thisDevice, window, parentWindowNode);
-    return 0;
+    return OHOS_CreateWindowFrom(thisDevice, window, parentWindowNode);
 }
 
 void OHOS_SetWindowTitle(SDL_VideoDevice *thisDevice, SDL_Window *window)
@@ -137,17 +137,20 @@ void OHOS_DestroyWindow(SDL_VideoDevice *thisDevice, SDL_Window *window)
         }
     }
 
+    SDL_UnlockMutex(g_ohosPageMutex);
+
     if (window->driverdata) {
         SDL_WindowData *data = (SDL_WindowData *)window->driverdata;
+        SDL_LockMutex(data->surfaceLock);
         if (data->egl_xcomponent != EGL_NO_SURFACE) {
             SDL_EGL_DestroySurface(thisDevice, data->egl_xcomponent);
             data->egl_xcomponent = EGL_NO_SURFACE;
         }
+        SDL_UnlockMutex(data->surfaceLock);
+        SDL_DestroyMutex(data->surfaceLock);
         SDL_free(window->driverdata);
         window->driverdata = NULL;
     }
-
-    SDL_UnlockMutex(g_ohosPageMutex);
 }
 
 SDL_bool OHOS_GetWindowWMInfo(SDL_VideoDevice *thisDevice, SDL_Window *window, SDL_SysWMinfo *info)
@@ -209,31 +212,6 @@ void OHOS_RaiseWindow(SDL_VideoDevice *thisDevice, SDL_Window *window)
     SDL_UnlockMutex(g_ohosPageMutex);
 }
 
-static void OHOS_WaitGetNativeXcompent(const char *strID, pthread_t tid, OH_NativeXComponent **nativeXComponent)
-{
-    int cnt = OHOS_WAIT_COUNT;
-    while (!OHOS_FindNativeXcomPoment(strID, nativeXComponent)) {
-        if (cnt-- == 0) {
-            break;
-        }
-        SDL_Delay(OHOS_WAIT_TIME);
-    }
-}
-
-static void OHOS_WaitGetNativeWindow(const char *strID, pthread_t tid, SDL_WindowData **windowData,
-    OH_NativeXComponent *nativeXComponent)
-{
-    int cnt = OHOS_WAIT_COUNT;
-    while (!OHOS_FindNativeWindow(nativeXComponent, windowData)) {
-        if (cnt-- == 0) {
-            SDL_Log("Failed get native window.");
-            break;
-        }
-        SDL_Delay(OHOS_WAIT_TIME);
-    }
-    SDL_Log("Successful get native window.");
-}
-
 static void OHOS_SetRealWindowPosition(SDL_Window *window, SDL_WindowData *windowData)
 {
     window->x = windowData->x;
@@ -242,8 +220,14 @@ static void OHOS_SetRealWindowPosition(SDL_Window *window, SDL_WindowData *windo
     window->h = windowData->height;
 }
 
+static double OHOS_ElapsedMs(Uint64 start)
+{
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
 int OHOS_CreateWindowFrom(SDL_VideoDevice *thisDevice, SDL_Window *window, const void *data)
 {
+    Uint64 start = SDL_GetPerformanceCounter();
     WindowPosition *windowPosition = NULL;
     char *strID = NULL;
     pthread_t tid;
@@ -263,19 +247,27 @@ int OHOS_CreateWindowFrom(SDL_VideoDevice *thisDevice, SDL_Window *window, const
     }
 
     strID = window->xcompentId;
-    OHOS_FindNativeXcomPoment(strID, &nativeXComponent);
     if ((window->flags & SDL_WINDOW_RECREATE) == 0) {
         tid = pthread_self();
         SDL_Log("Successful get windowdata, native_window22222222222222222333367666 1=.");
         OHOS_AddXcomPomentIdForThread(strID, tid);
         SDL_Log("Successful get windowdata, native_window222222222222222223333 1=.");
-        OHOS_WaitGetNativeWindow(strID, tid, &windowData, nativeXComponent);
+        SDL_TRACE_BEGIN("OHOS_WaitNativeWindow");
+        if (!OHOS_WaitNativeWindow(strID, OHOS_WAIT_TIMEOUT, &nativeXComponent, &windowData)) {
+            SDL_TRACE_END();
+            return SDL_SetError("%s timed out waiting for XComponent after %.2f ms", strID, OHOS_ElapsedMs(start));
+        }
+        SDL_TRACE_END();
+        SDL_Log("Window %s ready after %.2f ms.", strID, OHOS_ElapsedMs(start));
     } else {
         SDL_Log("Successful get windowdata, native_window222222222222222224444 1=.");
-        OHOS_FindNativeWindow(nativeXComponent, &windowData);
+        OHOS_FindNativeXcomPoment(strID, &nativeXComponent);
+        if (!OHOS_FindNativeWindow(nativeXComponent, &windowData)) {
+            return SDL_SetError("Failed get native window of %s", strID);
+        }
     }
   //  SDL_Log("Successful get windowdata, native_window222222222222222224444333 1=%d.",windowData->x);
-    sdlWindowData = (SDL_WindowData *)SDL_malloc(sizeof(SDL_WindowData));
+    sdlWindowData = (SDL_WindowData *)SDL_calloc(1, sizeof(SDL_WindowData));
     SDL_LockMutex(g_ohosPageMutex);
     OHOS_SetRealWindowPosition(window, windowData);
     sdlWindowData->native_window = windowData->native_window;
@@ -296,6 +288,8 @@ int OHOS_CreateWindowFrom(SDL_VideoDevice *thisDevice, SDL_Window *window, const
             goto endfunction;
         }
     }
+    sdlWindowData->surfaceLock = SDL_CreateMutex();
+    SDL_SetMutexName(sdlWindowData->surfaceLock, "SDL_WindowData.surfaceLock");
     window->driverdata = sdlWindowData;
 endfunction:
      SDL_UnlockMutex(g_ohosPageMutex);
@@ -313,6 +307,47 @@ char *OHOS_GetWindowTitle(SDL_VideoDevice *thisDevice, SDL_Window *window)
         return "Title is NULL";
     }
 }
+void OHOS_LockWindowSurface(SDL_Window *window)
+{
+    if (window && window->driverdata) {
+        SDL_LockMutex(((SDL_WindowData *)window->driverdata)->surfaceLock);
+    }
+}
+
+void OHOS_UnlockWindowSurface(SDL_Window *window)
+{
+    if (window && window->driverdata) {
+        SDL_UnlockMutex(((SDL_WindowData *)window->driverdata)->surfaceLock);
+    }
+}
+
+void OHOS_NoteWindowInput(SDL_Window *window, Uint64 stagedAt)
+{
+    SDL_WindowData *data;
+
+    if (!window || !window->driverdata) {
+        return;
+    }
+    data = (SDL_WindowData *)window->driverdata;
+    SDL_AtomicLock(&data->statsLock);
+    if (data->pendingInput == 0) {
+        data->pendingInput = stagedAt;
+    }
+    SDL_AtomicUnlock(&data->statsLock);
+}
+
+int OHOS_GetWindowFrameStats(SDL_Window *window, SDL_OHOSWindowFrameStats *stats)
+{
+    SDL_WindowData *data = (SDL_WindowData *)window->driverdata;
+
+    if (!data) {
+        return SDL_SetError("Window has no EGL surface");
+    }
+    SDL_AtomicLock(&data->statsLock);
+    *stats = data->stats;
+    SDL_AtomicUnlock(&data->statsLock);
+    return 0;
+}
 #endif /* SDL_VIDEO_DRIVER_OHOS */
 
 /* vi: set ts=4 sw=4 expandtab: */
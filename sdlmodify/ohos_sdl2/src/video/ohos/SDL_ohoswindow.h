@@ -44,6 +44,13 @@ extern int OHOS_CreateWindowFrom(SDL_VideoDevice *thisDevice, SDL_Window *window
 extern char *OHOS_GetWindowTitle(SDL_VideoDevice *thisDevice, SDL_Window *window);
 extern int SetupWindowData(SDL_VideoDevice *thisDevice, SDL_Window *window, SDL_Window *w, SDL_WindowData *data);
 
+/* Per-window EGL surface lock, taken instead of the page mutex around swaps and context switches */
+extern void OHOS_LockWindowSurface(SDL_Window *window);
+extern void OHOS_UnlockWindowSurface(SDL_Window *window);
+/* Input for the window was staged by the UI thread at stagedAt (performance counter) */
+extern void OHOS_NoteWindowInput(SDL_Window *window, Uint64 stagedAt);
+extern int OHOS_GetWindowFrameStats(SDL_Window *window, SDL_OHOSWindowFrameStats *stats);
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 /* *INDENT-OFF* */
@@ -73,7 +73,6 @@ static const RGB2YUVParam RGB2YUV[3] = {
 #define RGB_FORMAT_ABGR		6
 
 // divide by PRECISION_FACTOR and clamp to [0:255] interval
-// input must be in the [-128*PRECISION_FACTOR:384*PRECISION_FACTOR] range
 static uint8_t clampU8(int32_t v)
 {
 	static const uint8_t lut[512] = 
@@ -91,7 +90,14 @@ static uint8_t clampU8(int32_t v)
 	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,
 	255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255,255
 	};
-	return lut[(v+128*PRECISION_FACTOR)>>PRECISION];
+	int32_t index = (v+128*PRECISION_FACTOR)>>PRECISION;
+	// saturated colors can leave the table range, those clamp like the rest
+	if (index < 0) {
+		index = 0;
+	} else if (index > 511) {
+		index = 511;
+	}
+	return lut[index];
 }
 
 
@@ -687,4 +693,116 @@ void rgb24_yuv420_sseu(uint32_t width, uint32_t height,
 
 #endif //__SSE2__
 
+#ifdef __ARM_NEON
+
+#define NEON_FUNCTION_NAME	yuv420_rgb565_neon
+#define STD_FUNCTION_NAME	yuv420_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_rgb24_neon
+#define STD_FUNCTION_NAME	yuv420_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_rgba_neon
+#define STD_FUNCTION_NAME	yuv420_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_bgra_neon
+#define STD_FUNCTION_NAME	yuv420_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_argb_neon
+#define STD_FUNCTION_NAME	yuv420_argb_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_abgr_neon
+#define STD_FUNCTION_NAME	yuv420_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_rgb565_neon
+#define STD_FUNCTION_NAME	yuv422_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_rgb24_neon
+#define STD_FUNCTION_NAME	yuv422_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_rgba_neon
+#define STD_FUNCTION_NAME	yuv422_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_bgra_neon
+#define STD_FUNCTION_NAME	yuv422_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_argb_neon
+#define STD_FUNCTION_NAME	yuv422_argb_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_abgr_neon
+#define STD_FUNCTION_NAME	yuv422_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_rgb565_neon
+#define STD_FUNCTION_NAME	yuvnv12_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_rgb24_neon
+#define STD_FUNCTION_NAME	yuvnv12_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_rgba_neon
+#define STD_FUNCTION_NAME	yuvnv12_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_bgra_neon
+#define STD_FUNCTION_NAME	yuvnv12_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_argb_neon
+#define STD_FUNCTION_NAME	yuvnv12_argb_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_abgr_neon
+#define STD_FUNCTION_NAME	yuvnv12_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_neon_func.h"
+
+#endif //__ARM_NEON
+
 #endif /* SDL_HAVE_YUV */
@@ -0,0 +1,269 @@
+// NEON version of yuv_rgb_sse_func.h
+// Distributed under BSD 3-Clause License
+
+/* You need to define the following macros before including this file:
+	NEON_FUNCTION_NAME
+	STD_FUNCTION_NAME
+	YUV_FORMAT
+	RGB_FORMAT
+*/
+
+/* 16 pixels are converted at a time. Even and odd pixels share the same U
+   and V sample, so they're deinterleaved when loaded, converted separately
+   and zipped back together when stored. The arithmetic is done on 16 bits
+   with saturation, which gives the same result as the std version. */
+
+#define UV2RGB_8(U,V) \
+	u_16 = vreinterpretq_s16_u16(vsubl_u8(U, vdup_n_u8(128))); \
+	v_16 = vreinterpretq_s16_u16(vsubl_u8(V, vdup_n_u8(128))); \
+	r_uv = vmulq_n_s16(v_16, param->v_r_factor); \
+	g_uv = vmlaq_n_s16(vmulq_n_s16(u_16, param->u_g_factor), v_16, param->v_g_factor); \
+	b_uv = vmulq_n_s16(u_16, param->u_b_factor); \
+
+#define Y2RGB_8(Y,R,G,B) \
+{ \
+	const int16x8_t y_16 = vmulq_n_s16(vreinterpretq_s16_u16(vsubl_u8(Y, vdup_n_u8(param->y_shift))), param->y_factor); \
+	R = vqshrun_n_s16(vqaddq_s16(y_16, r_uv), PRECISION); \
+	G = vqshrun_n_s16(vqaddq_s16(y_16, g_uv), PRECISION); \
+	B = vqshrun_n_s16(vqaddq_s16(y_16, b_uv), PRECISION); \
+}
+
+#if RGB_FORMAT == RGB_FORMAT_RGB565
+
+#define PACK_RGB565_8(R, G, B, rgb_ptr) \
+{ \
+	uint16x8_t rgb = vshll_n_u8(R, 8); \
+	rgb = vsriq_n_u16(rgb, vshll_n_u8(G, 8), 5); \
+	rgb = vsriq_n_u16(rgb, vshll_n_u8(B, 8), 11); \
+	vst1q_u16((uint16_t *)(rgb_ptr), rgb); \
+}
+
+#define SAVE_PIXELS(rgb_ptr, R, G, B) \
+	PACK_RGB565_8(R.val[0], G.val[0], B.val[0], rgb_ptr) \
+	PACK_RGB565_8(R.val[1], G.val[1], B.val[1], rgb_ptr+16) \
+
+#elif RGB_FORMAT == RGB_FORMAT_RGB24
+
+#define SAVE_PIXELS(rgb_ptr, R, G, B) \
+{ \
+	uint8x16x3_t rgb; \
+	rgb.val[0] = vcombine_u8(R.val[0], R.val[1]); \
+	rgb.val[1] = vcombine_u8(G.val[0], G.val[1]); \
+	rgb.val[2] = vcombine_u8(B.val[0], B.val[1]); \
+	vst3q_u8(rgb_ptr, rgb); \
+}
+
+#elif RGB_FORMAT == RGB_FORMAT_RGBA || RGB_FORMAT == RGB_FORMAT_BGRA || \
+      RGB_FORMAT == RGB_FORMAT_ARGB || RGB_FORMAT == RGB_FORMAT_ABGR
+
+#define COMBINE_16(X) vcombine_u8(X.val[0], X.val[1])
+
+#define PACK_RGBA_16(rgb_ptr, C0, C1, C2, C3) \
+{ \
+	uint8x16x4_t rgb; \
+	rgb.val[0] = C0; \
+	rgb.val[1] = C1; \
+	rgb.val[2] = C2; \
+	rgb.val[3] = C3; \
+	vst4q_u8(rgb_ptr, rgb); \
+}
+
+/* The 32-bit formats are written in memory byte order, little endian */
+#if RGB_FORMAT == RGB_FORMAT_RGBA
+#define SAVE_PIXELS(rgb_ptr, R, G, B) \
+	PACK_RGBA_16(rgb_ptr, vdupq_n_u8(0xFF), COMBINE_16(B), COMBINE_16(G), COMBINE_16(R))
+#elif RGB_FORMAT == RGB_FORMAT_BGRA
+#define SAVE_PIXELS(rgb_ptr, R, G, B) \
+	PACK_RGBA_16(rgb_ptr, vdupq_n_u8(0xFF), COMBINE_16(R), COMBINE_16(G), COMBINE_16(B))
+#elif RGB_FORMAT == RGB_FORMAT_ARGB
+#define SAVE_PIXELS(rgb_ptr, R, G, B) \
+	PACK_RGBA_16(rgb_ptr, COMBINE_16(B), COMBINE_16(G), COMBINE_16(R), vdupq_n_u8(0xFF))
+#else
+#define SAVE_PIXELS(rgb_ptr, R, G, B) \
+	PACK_RGBA_16(rgb_ptr, COMBINE_16(R), COMBINE_16(G), COMBINE_16(B), vdupq_n_u8(0xFF))
+#endif
+
+#else
+#error PACK_PIXEL unimplemented
+#endif
+
+#if YUV_FORMAT == YUV_FORMAT_420
+
+#define READ_UV \
+	u = vld1_u8(u_ptr); \
+	v = vld1_u8(v_ptr); \
+
+#define READ_Y(y_ptr) \
+{ \
+	const uint8x8x2_t y = vld2_u8(y_ptr); \
+	y_even = y.val[0]; \
+	y_odd = y.val[1]; \
+}
+
+#elif YUV_FORMAT == YUV_FORMAT_422
+
+/* Load whole macropixels and pick the channels out of them */
+#define READ_UV \
+	yuv = vld4_u8(y_ptr1 - y_offset); \
+	u = yuv.val[u_offset]; \
+	v = yuv.val[v_offset]; \
+
+#define READ_Y(y_ptr) \
+	y_even = yuv.val[y_offset]; \
+	y_odd = yuv.val[y_offset + 2]; \
+
+#elif YUV_FORMAT == YUV_FORMAT_NV12
+
+/* Load from whichever of U and V comes first, so NV21 doesn't read past the row */
+#define READ_UV \
+{ \
+	const uint8x8x2_t uv = vld2_u8(u_ptr - u_offset); \
+	u = uv.val[u_offset]; \
+	v = uv.val[v_offset]; \
+}
+
+#define READ_Y(y_ptr) \
+{ \
+	const uint8x8x2_t y = vld2_u8(y_ptr); \
+	y_even = y.val[0]; \
+	y_odd = y.val[1]; \
+}
+
+#else
+#error READ_UV unimplemented
+#endif
+
+#define CONVERT_LINE(y_ptr, rgb_ptr) \
+{ \
+	uint8x8_t y_even, y_odd; \
+	uint8x8_t r_even, g_even, b_even, r_odd, g_odd, b_odd; \
+	uint8x8x2_t r, g, b; \
+	\
+	READ_Y(y_ptr) \
+	Y2RGB_8(y_even, r_even, g_even, b_even) \
+	Y2RGB_8(y_odd, r_odd, g_odd, b_odd) \
+	r = vzip_u8(r_even, r_odd); \
+	g = vzip_u8(g_even, g_odd); \
+	b = vzip_u8(b_even, b_odd); \
+	SAVE_PIXELS(rgb_ptr, r, g, b) \
+}
+
+
+void NEON_FUNCTION_NAME(uint32_t width, uint32_t height,
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride,
+	uint8_t *RGB, uint32_t RGB_stride,
+	YCbCrType yuv_type)
+{
+	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
+#if YUV_FORMAT == YUV_FORMAT_420
+	const int y_pixel_stride = 1;
+	const int uv_pixel_stride = 1;
+	const int uv_x_sample_interval = 2;
+	const int uv_y_sample_interval = 2;
+#elif YUV_FORMAT == YUV_FORMAT_422
+	const int y_pixel_stride = 2;
+	const int uv_pixel_stride = 4;
+	const int uv_x_sample_interval = 2;
+	const int uv_y_sample_interval = 1;
+	const uint8_t *base = SDL_min(Y, SDL_min(U, V));
+	const int y_offset = (int)(Y - base);
+	const int u_offset = (int)(U - base);
+	const int v_offset = (int)(V - base);
+#elif YUV_FORMAT == YUV_FORMAT_NV12
+	const int y_pixel_stride = 1;
+	const int uv_pixel_stride = 2;
+	const int uv_x_sample_interval = 2;
+	const int uv_y_sample_interval = 2;
+	const int u_offset = (U > V);
+	const int v_offset = (V > U);
+#endif
+#if RGB_FORMAT == RGB_FORMAT_RGB565
+	const int rgb_pixel_stride = 2;
+#elif RGB_FORMAT == RGB_FORMAT_RGB24
+	const int rgb_pixel_stride = 3;
+#elif RGB_FORMAT == RGB_FORMAT_RGBA || RGB_FORMAT == RGB_FORMAT_BGRA || \
+      RGB_FORMAT == RGB_FORMAT_ARGB || RGB_FORMAT == RGB_FORMAT_ABGR
+	const int rgb_pixel_stride = 4;
+#else
+#error Unknown RGB pixel size
+#endif
+
+	if (width >= 16) {
+		uint32_t xpos, ypos;
+		for(ypos=0; ypos<(height-(uv_y_sample_interval-1)); ypos+=uv_y_sample_interval)
+		{
+			const uint8_t *y_ptr1=Y+ypos*Y_stride,
+				*y_ptr2=Y+(ypos+1)*Y_stride,
+				*u_ptr=U+(ypos/uv_y_sample_interval)*UV_stride,
+				*v_ptr=V+(ypos/uv_y_sample_interval)*UV_stride;
+
+			uint8_t *rgb_ptr1=RGB+ypos*RGB_stride,
+				*rgb_ptr2=RGB+(ypos+1)*RGB_stride;
+
+			for(xpos=0; xpos<(width-15); xpos+=16)
+			{
+				uint8x8_t u, v;
+				int16x8_t u_16, v_16, r_uv, g_uv, b_uv;
+#if YUV_FORMAT == YUV_FORMAT_422
+				uint8x8x4_t yuv;
+#endif
+
+				READ_UV
+				UV2RGB_8(u, v)
+				CONVERT_LINE(y_ptr1, rgb_ptr1)
+				if (uv_y_sample_interval > 1)
+				{
+					CONVERT_LINE(y_ptr2, rgb_ptr2)
+				}
+
+				y_ptr1+=16*y_pixel_stride;
+				y_ptr2+=16*y_pixel_stride;
+				u_ptr+=16*uv_pixel_stride/uv_x_sample_interval;
+				v_ptr+=16*uv_pixel_stride/uv_x_sample_interval;
+				rgb_ptr1+=16*rgb_pixel_stride;
+				rgb_ptr2+=16*rgb_pixel_stride;
+			}
+		}
+
+		/* Catch the last line, if needed */
+		if (uv_y_sample_interval == 2 && ypos == (height-1))
+		{
+			const uint8_t *y_ptr=Y+ypos*Y_stride,
+				*u_ptr=U+(ypos/uv_y_sample_interval)*UV_stride,
+				*v_ptr=V+(ypos/uv_y_sample_interval)*UV_stride;
+
+			uint8_t *rgb_ptr=RGB+ypos*RGB_stride;
+
+			STD_FUNCTION_NAME(width, 1, y_ptr, u_ptr, v_ptr, Y_stride, UV_stride, rgb_ptr, RGB_stride, yuv_type);
+		}
+	}
+
+	/* Catch the right column, if needed */
+	{
+		uint32_t converted = (width & ~15);
+		if (converted != width)
+		{
+			const uint8_t *y_ptr=Y+converted*y_pixel_stride,
+				*u_ptr=U+converted*uv_pixel_stride/uv_x_sample_interval,
+				*v_ptr=V+converted*uv_pixel_stride/uv_x_sample_interval;
+
+			uint8_t *rgb_ptr=RGB+converted*rgb_pixel_stride;
+
+			STD_FUNCTION_NAME(width-converted, height, y_ptr, u_ptr, v_ptr, Y_stride, UV_stride, rgb_ptr, RGB_stride, yuv_type);
+		}
+	}
+}
+
+#undef NEON_FUNCTION_NAME
+#undef STD_FUNCTION_NAME
+#undef YUV_FORMAT
+#undef RGB_FORMAT
+#undef UV2RGB_8
+#undef Y2RGB_8
+#undef PACK_RGB565_8
+#undef COMBINE_16
+#undef PACK_RGBA_16
+#undef SAVE_PIXELS
+#undef READ_UV
+#undef READ_Y
+#undef CONVERT_LINE
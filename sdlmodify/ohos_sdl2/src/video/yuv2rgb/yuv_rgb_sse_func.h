@@ -41,12 +41,12 @@
 	Y1 = _mm_mullo_epi16(_mm_sub_epi16(Y1, _mm_set1_epi16(param->y_shift)), _mm_set1_epi16(param->y_factor)); \
 	Y2 = _mm_mullo_epi16(_mm_sub_epi16(Y2, _mm_set1_epi16(param->y_shift)), _mm_set1_epi16(param->y_factor)); \
 	\
-	R1 = _mm_srai_epi16(_mm_add_epi16(R1, Y1), PRECISION); \
-	G1 = _mm_srai_epi16(_mm_add_epi16(G1, Y1), PRECISION); \
-	B1 = _mm_srai_epi16(_mm_add_epi16(B1, Y1), PRECISION); \
-	R2 = _mm_srai_epi16(_mm_add_epi16(R2, Y2), PRECISION); \
-	G2 = _mm_srai_epi16(_mm_add_epi16(G2, Y2), PRECISION); \
-	B2 = _mm_srai_epi16(_mm_add_epi16(B2, Y2), PRECISION); \
+	R1 = _mm_srai_epi16(_mm_adds_epi16(R1, Y1), PRECISION); \
+	G1 = _mm_srai_epi16(_mm_adds_epi16(G1, Y1), PRECISION); \
+	B1 = _mm_srai_epi16(_mm_adds_epi16(B1, Y1), PRECISION); \
+	R2 = _mm_srai_epi16(_mm_adds_epi16(R2, Y2), PRECISION); \
+	G2 = _mm_srai_epi16(_mm_adds_epi16(G2, Y2), PRECISION); \
+	B2 = _mm_srai_epi16(_mm_adds_epi16(B2, Y2), PRECISION); \
 
 #define PACK_RGB565_32(R1, R2, G1, G2, B1, B2, RGB1, RGB2, RGB3, RGB4) \
 { \
@@ -0,0 +1,250 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Compares audio pull mode (SDL_HINT_AUDIO_PULL_MODE) with the usual SDL
+   audio thread, on the disk audio driver.
+
+   Every frame the callback writes is a running count, and the output file
+   must contain exactly that sequence, in both modes. Without --check-only
+   it also reports:
+   - the cost per period with no i/o delay: wall time, time spent in the
+     callback, and process CPU time;
+   - how regularly the callback fires in real time. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "SDL.h"
+
+#define FREQ            48000
+#define CHANNELS        2
+#define PERIOD_FRAMES   512
+
+#define OUTFILE "testaudiopull-out.raw"
+
+typedef struct
+{
+    Uint32 next;            /* count for the next frame */
+    SDL_atomic_t frames;
+    Uint32 callbacks;
+    Uint64 in_callback;     /* performance counter ticks */
+    Uint64 last_start;
+    Uint64 intervals;
+    Uint64 worst_interval;
+} PullState;
+
+typedef struct
+{
+    double period_us;
+    double callback_us;
+    double cpu_us;
+    double interval_ms;
+    double worst_interval_ms;
+} PullResult;
+
+static Sint16
+frame_value(Uint32 count)
+{
+    return (Sint16) (1 + (count % 32000));
+}
+
+static void SDLCALL
+fill_audio(void *userdata, Uint8 *stream, int len)
+{
+    PullState *state = (PullState *) userdata;
+    const Uint64 start = SDL_GetPerformanceCounter();
+    Sint16 *samples = (Sint16 *) stream;
+    const int frames = len / (CHANNELS * sizeof (Sint16));
+    int i, j;
+
+    if (state->callbacks > 0) {
+        const Uint64 interval = start - state->last_start;
+        state->intervals += interval;
+        state->worst_interval = SDL_max(state->worst_interval, interval);
+    }
+    state->last_start = start;
+
+    for (i = 0; i < frames; ++i) {
+        const Sint16 value = frame_value(state->next++);
+        for (j = 0; j < CHANNELS; ++j) {
+            *(samples++) = value;
+        }
+    }
+
+    state->callbacks++;
+    state->in_callback += SDL_GetPerformanceCounter() - start;
+    SDL_AtomicAdd(&state->frames, frames);
+}
+
+/* The output must be some silence, then every frame the callback made, in order. */
+static int
+check_output(const PullState *state, const char *mode)
+{
+    SDL_RWops *rw = SDL_RWFromFile(OUTFILE, "rb");
+    Sint16 frame[CHANNELS];
+    SDL_bool started = SDL_FALSE;
+    Uint32 count = 0;
+    int failed = 0;
+    int j;
+
+    if (!rw) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't read %s: %s\n", OUTFILE, SDL_GetError());
+        return 1;
+    }
+
+    while (!failed && SDL_RWread(rw, frame, sizeof (frame), 1) == 1) {
+        if (!started && frame[0] == 0) {
+            continue;
+        }
+        started = SDL_TRUE;
+        for (j = 0; j < CHANNELS; ++j) {
+            if (frame[j] != frame_value(count)) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: frame %u is %d, expected %d\n",
+                             mode, (unsigned int) count, (int) frame[j], (int) frame_value(count));
+                failed = 1;
+                break;
+            }
+        }
+        count++;
+    }
+    SDL_RWclose(rw);
+    remove(OUTFILE);
+
+    if (!failed && count != state->next) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: wrote %u frames of %u\n",
+                     mode, (unsigned int) count, (unsigned int) state->next);
+        failed = 1;
+    }
+    return failed;
+}
+
+static int
+run_mode(SDL_bool pull, int io_delay, int periods, PullResult *result)
+{
+    const char *mode = pull ? "Pull mode" : "Audio thread";
+    const double freq = (double) SDL_GetPerformanceFrequency();
+    PullState state;
+    SDL_AudioSpec spec;
+    SDL_AudioDeviceID dev;
+    Uint64 start, elapsed;
+    clock_t cpu;
+    char delay[16];
+
+    SDL_zero(state);
+    SDL_SetHint(SDL_HINT_AUDIO_PULL_MODE, pull ? "1" : "0");
+    SDL_snprintf(delay, sizeof (delay), "%d", io_delay);
+    SDL_setenv("SDL_DISKAUDIODELAY", delay, 1);
+
+    SDL_zero(spec);
+    spec.freq = FREQ;
+    spec.format = AUDIO_S16SYS;
+    spec.channels = CHANNELS;
+    spec.samples = PERIOD_FRAMES;
+    spec.callback = fill_audio;
+    spec.userdata = &state;
+
+    dev = SDL_OpenAudioDevice(OUTFILE, 0, &spec, NULL, 0);
+    if (!dev) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open %s: %s\n", OUTFILE, SDL_GetError());
+        return 1;
+    }
+
+    start = SDL_GetPerformanceCounter();
+    cpu = clock();
+    SDL_PauseAudioDevice(dev, 0);
+    while (SDL_AtomicGet(&state.frames) < periods * PERIOD_FRAMES) {
+        SDL_Delay(1);
+    }
+    elapsed = SDL_GetPerformanceCounter() - start;
+    cpu = clock() - cpu;
+    SDL_CloseAudioDevice(dev);
+
+    result->period_us = elapsed * 1000000.0 / freq / state.callbacks;
+    result->callback_us = state.in_callback * 1000000.0 / freq / state.callbacks;
+    result->cpu_us = cpu * 1000000.0 / CLOCKS_PER_SEC / state.callbacks;
+    result->interval_ms = state.intervals * 1000.0 / freq / SDL_max(state.callbacks - 1, 1);
+    result->worst_interval_ms = state.worst_interval * 1000.0 / freq;
+
+    return check_output(&state, mode);
+}
+
+static int
+run_comparison(SDL_bool benchmark)
+{
+    const int fast_periods = benchmark ? 20000 : 200;
+    PullResult result[2];
+    int failed = 0;
+    int pull;
+
+    for (pull = 0; pull <= 1; ++pull) {
+        failed |= run_mode(pull ? SDL_TRUE : SDL_FALSE, 0, fast_periods, &result[pull]);
+    }
+    if (failed || !benchmark) {
+        return failed;
+    }
+
+    SDL_Log("%d periods of %d frames, no i/o delay:\n", fast_periods, PERIOD_FRAMES);
+    for (pull = 0; pull <= 1; ++pull) {
+        SDL_Log("  %-12s %7.2f us per period, %6.2f us in the callback, %7.2f us CPU\n",
+                pull ? "Pull mode" : "Audio thread",
+                result[pull].period_us, result[pull].callback_us, result[pull].cpu_us);
+    }
+
+    for (pull = 0; pull <= 1; ++pull) {
+        failed |= run_mode(pull ? SDL_TRUE : SDL_FALSE, PERIOD_FRAMES * 1000 / FREQ, 200, &result[pull]);
+    }
+    if (failed) {
+        return failed;
+    }
+
+    SDL_Log("200 periods in real time, %.2f ms each:\n", PERIOD_FRAMES * 1000.0 / FREQ);
+    for (pull = 0; pull <= 1; ++pull) {
+        SDL_Log("  %-12s callback every %.2f ms on average, %.2f ms at worst, %7.2f us CPU per period\n",
+                pull ? "Pull mode" : "Audio thread",
+                result[pull].interval_ms, result[pull].worst_interval_ms, result[pull].cpu_us);
+    }
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_bool benchmark = SDL_TRUE;
+    int failed;
+    int i;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--check-only") == 0) {
+            benchmark = SDL_FALSE;
+        } else {
+            SDL_Log("Usage: %s [--check-only]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SDL_setenv("SDL_AUDIODRIVER", "disk", 1);
+    if (SDL_Init(SDL_INIT_AUDIO) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize the disk audio driver: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    failed = run_comparison(benchmark);
+    SDL_Log("Pull mode checks %s\n", failed ? "FAILED" : "passed");
+
+    SDL_Quit();
+    return failed ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
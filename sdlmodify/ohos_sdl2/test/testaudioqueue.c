@@ -0,0 +1,389 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* SDL_QueueAudio / SDL_DequeueAudio stress test.
+
+   Runs on the disk audio driver, which plays to and captures from files in
+   real time. Every sample is a running count, so the test can check that
+   what comes out is exactly what went in, in order.
+
+   Playback: a thread keeps a few periods queued in randomly sized pieces
+   while another thread polls SDL_GetQueuedAudioSize(). Afterwards the output
+   file must hold the whole count in order, and any silence in between is
+   reported as a glitch.
+
+   Capture: a thread dequeues randomly sized pieces as the device captures
+   a counting file, and must get every sample in order.
+
+   Both directions also check that queueing and dequeueing don't wait while
+   another thread holds the device lock, which blocks the audio thread. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define FREQ            48000
+#define PERIOD_FRAMES   256
+#define TARGET_PERIODS  8
+#define RUN_MS          2000
+#define LOCK_HOLD_MS    50
+#define MAX_WAIT_MS     20  /* slowest queue call allowed while the lock is held */
+
+#define OUTFILE "testaudioqueue-out.raw"
+#define INFILE  "testaudioqueue-in.raw"
+
+typedef struct
+{
+    SDL_AudioDeviceID dev;
+    SDL_atomic_t done;
+    SDL_atomic_t locked;    /* another thread holds the device lock */
+    Uint32 next;            /* next count to queue or expect */
+    Uint32 calls;
+    Uint64 worst;           /* slowest call, in performance counter ticks */
+    Uint64 total;
+    Uint32 seed;
+    SDL_bool failed;
+} QueueState;
+
+static Uint32
+random_u32(Uint32 *seed)
+{
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 17;
+    *seed ^= *seed << 5;
+    return *seed;
+}
+
+static double
+ticks_to_ms(Uint64 ticks)
+{
+    return (double) ticks * 1000.0 / SDL_GetPerformanceFrequency();
+}
+
+static void
+note_call(QueueState *state, Uint64 start)
+{
+    const Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+    state->worst = SDL_max(state->worst, elapsed);
+    state->total += elapsed;
+    state->calls++;
+}
+
+static int SDLCALL
+producer_thread(void *data)
+{
+    QueueState *state = (QueueState *) data;
+    Sint32 samples[PERIOD_FRAMES];
+
+    while (!SDL_AtomicGet(&state->done)) {
+        /* Keep queueing while the device is locked, the audio thread can't drain meanwhile. */
+        const SDL_bool locked = SDL_AtomicGet(&state->locked) ? SDL_TRUE : SDL_FALSE;
+        if (locked || SDL_GetQueuedAudioSize(state->dev) < TARGET_PERIODS * PERIOD_FRAMES * sizeof (Sint32)) {
+            const int count = 1 + (int) (random_u32(&state->seed) % PERIOD_FRAMES);
+            Uint64 start;
+            int i;
+
+            for (i = 0; i < count; ++i) {
+                samples[i] = (Sint32) state->next++;
+            }
+            start = SDL_GetPerformanceCounter();
+            if (SDL_QueueAudio(state->dev, samples, count * sizeof (Sint32)) < 0) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_QueueAudio failed: %s\n", SDL_GetError());
+                state->failed = SDL_TRUE;
+                break;
+            }
+            note_call(state, start);
+            if (locked) {
+                SDL_Delay(1);
+            }
+        } else {
+            SDL_Delay(1);
+        }
+    }
+    return 0;
+}
+
+static int SDLCALL
+consumer_thread(void *data)
+{
+    QueueState *state = (QueueState *) data;
+    Sint32 samples[PERIOD_FRAMES];
+
+    while (!SDL_AtomicGet(&state->done)) {
+        const int count = 1 + (int) (random_u32(&state->seed) % PERIOD_FRAMES);
+        const Uint64 start = SDL_GetPerformanceCounter();
+        const Uint32 got = SDL_DequeueAudio(state->dev, samples, count * sizeof (Sint32)) / sizeof (Sint32);
+        Uint32 i;
+
+        note_call(state, start);
+        for (i = 0; i < got; ++i) {
+            if (samples[i] == 0) {
+                continue;  /* the input file ran out. */
+            }
+            if ((Uint32) samples[i] != state->next) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Capture: got %u, expected %u\n",
+                             (unsigned int) samples[i], (unsigned int) state->next);
+                state->failed = SDL_TRUE;
+                return 0;
+            }
+            state->next++;
+        }
+        if (got == 0) {
+            SDL_Delay(1);
+        }
+    }
+    return 0;
+}
+
+static int SDLCALL
+poll_thread(void *data)
+{
+    QueueState *state = (QueueState *) data;
+    Uint32 polls = 0;
+
+    while (!SDL_AtomicGet(&state->done)) {
+        (void) SDL_GetQueuedAudioSize(state->dev);
+        if ((++polls % 64) == 0) {
+            SDL_Delay(0);
+        }
+    }
+    return 0;
+}
+
+/* Holds the device lock for a while, and returns how long the queue calls
+   made meanwhile took at worst, or -1 if there weren't any. */
+static double
+hold_device_lock(QueueState *state)
+{
+    Uint32 calls;
+    Uint64 worst;
+
+    SDL_LockAudioDevice(state->dev);
+    SDL_AtomicSet(&state->locked, 1);
+    calls = state->calls;
+    state->worst = 0;
+    SDL_Delay(LOCK_HOLD_MS);
+    worst = state->worst;
+    calls = state->calls - calls;
+    SDL_AtomicSet(&state->locked, 0);
+    SDL_UnlockAudioDevice(state->dev);
+    return calls ? ticks_to_ms(worst) : -1.0;
+}
+
+static SDL_AudioDeviceID
+open_device(const char *file, SDL_bool iscapture)
+{
+    SDL_AudioSpec spec;
+    SDL_AudioDeviceID dev;
+
+    SDL_zero(spec);
+    spec.freq = FREQ;
+    spec.format = AUDIO_S32SYS;
+    spec.channels = 1;
+    spec.samples = PERIOD_FRAMES;
+    spec.callback = NULL;
+
+    dev = SDL_OpenAudioDevice(file, iscapture, &spec, NULL, 0);
+    if (!dev) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open %s: %s\n", file, SDL_GetError());
+    }
+    return dev;
+}
+
+static int
+run_playback(void)
+{
+    QueueState state;
+    SDL_Thread *producer, *poller;
+    SDL_RWops *rw;
+    Sint32 *output;
+    Sint64 size;
+    Uint32 expected = 1;
+    int glitches = 0;
+    double locked_ms;
+    Sint64 i;
+
+    SDL_zero(state);
+    state.next = 1;
+    state.seed = 0x2545F491;
+    state.dev = open_device(OUTFILE, SDL_FALSE);
+    if (!state.dev) {
+        return 1;
+    }
+
+    producer = SDL_CreateThread(producer_thread, "producer", &state);
+    poller = SDL_CreateThread(poll_thread, "poller", &state);
+    while (SDL_GetQueuedAudioSize(state.dev) == 0) {
+        SDL_Delay(1);
+    }
+    SDL_PauseAudioDevice(state.dev, 0);
+
+    SDL_Delay(RUN_MS / 2);
+    locked_ms = hold_device_lock(&state);
+    SDL_Delay(RUN_MS / 2);
+
+    SDL_AtomicSet(&state.done, 1);
+    SDL_WaitThread(producer, NULL);
+    SDL_WaitThread(poller, NULL);
+    while (SDL_GetQueuedAudioSize(state.dev) > 0) {
+        SDL_Delay(1);
+    }
+    SDL_Delay(4 * PERIOD_FRAMES * 1000 / FREQ);
+    SDL_CloseAudioDevice(state.dev);
+
+    if (state.failed) {
+        return 1;
+    }
+
+    /* Everything queued must come out in order. Silence in between is a glitch. */
+    rw = SDL_RWFromFile(OUTFILE, "rb");
+    if (!rw) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't read %s: %s\n", OUTFILE, SDL_GetError());
+        return 1;
+    }
+    size = SDL_RWsize(rw) / (Sint64) sizeof (Sint32);
+    output = (Sint32 *) SDL_malloc((size_t) size * sizeof (Sint32) + 1);
+    if (!output || SDL_RWread(rw, output, sizeof (Sint32), (size_t) size) != (size_t) size) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't read %s\n", OUTFILE);
+        SDL_RWclose(rw);
+        SDL_free(output);
+        return 1;
+    }
+    SDL_RWclose(rw);
+    remove(OUTFILE);
+
+    for (i = 0; i < size; ++i) {
+        if (output[i] == 0) {
+            if (expected > 1 && expected < state.next && (i == 0 || output[i - 1] != 0)) {
+                glitches++;
+            }
+            continue;
+        }
+        if ((Uint32) output[i] != expected) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Playback: played %u, expected %u\n",
+                         (unsigned int) output[i], (unsigned int) expected);
+            SDL_free(output);
+            return 1;
+        }
+        expected++;
+    }
+    SDL_free(output);
+
+    if (expected != state.next) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Playback: played %u samples of %u\n",
+                     (unsigned int) (expected - 1), (unsigned int) (state.next - 1));
+        return 1;
+    }
+
+    SDL_Log("Playback: %u samples in %u calls, SDL_QueueAudio %.3f ms on average, %.3f ms at worst, %d glitches\n",
+            (unsigned int) (state.next - 1), (unsigned int) state.calls,
+            ticks_to_ms(state.total) / SDL_max(state.calls, 1), ticks_to_ms(state.worst), glitches);
+    if (locked_ms < 0.0 || locked_ms > MAX_WAIT_MS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Playback: SDL_QueueAudio waited for the device lock\n");
+        return 1;
+    }
+    SDL_Log("Playback: SDL_QueueAudio took %.3f ms at worst while the device was locked for %d ms\n",
+            locked_ms, LOCK_HOLD_MS);
+    return 0;
+}
+
+static int
+run_capture(void)
+{
+    const Uint32 total = FREQ * (RUN_MS / 1000);
+    QueueState state;
+    SDL_Thread *consumer, *poller;
+    SDL_RWops *rw;
+    double locked_ms;
+    Uint32 i;
+
+    rw = SDL_RWFromFile(INFILE, "wb");
+    if (!rw) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't write %s: %s\n", INFILE, SDL_GetError());
+        return 1;
+    }
+    for (i = 1; i <= total; ++i) {
+        SDL_WriteLE32(rw, i);
+    }
+    SDL_RWclose(rw);
+
+    SDL_zero(state);
+    state.next = 1;
+    state.seed = 0x9E3779B9;
+    state.dev = open_device(INFILE, SDL_TRUE);
+    if (!state.dev) {
+        remove(INFILE);
+        return 1;
+    }
+
+    consumer = SDL_CreateThread(consumer_thread, "consumer", &state);
+    poller = SDL_CreateThread(poll_thread, "poller", &state);
+    SDL_PauseAudioDevice(state.dev, 0);
+
+    SDL_Delay(RUN_MS / 2);
+    locked_ms = hold_device_lock(&state);
+
+    /* Wait for the whole file, with a generous timeout */
+    for (i = 0; i < 4 * RUN_MS && !state.failed && state.next <= total; ++i) {
+        SDL_Delay(1);
+    }
+
+    SDL_AtomicSet(&state.done, 1);
+    SDL_WaitThread(consumer, NULL);
+    SDL_WaitThread(poller, NULL);
+    SDL_CloseAudioDevice(state.dev);
+    remove(INFILE);
+
+    if (state.failed) {
+        return 1;
+    }
+    if (state.next <= total) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Capture: got %u samples of %u\n",
+                     (unsigned int) (state.next - 1), (unsigned int) total);
+        return 1;
+    }
+
+    SDL_Log("Capture: %u samples in %u calls, SDL_DequeueAudio %.3f ms on average, %.3f ms at worst\n",
+            (unsigned int) total, (unsigned int) state.calls,
+            ticks_to_ms(state.total) / SDL_max(state.calls, 1), ticks_to_ms(state.worst));
+    if (locked_ms < 0.0 || locked_ms > MAX_WAIT_MS) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Capture: SDL_DequeueAudio waited for the device lock\n");
+        return 1;
+    }
+    SDL_Log("Capture: SDL_DequeueAudio took %.3f ms at worst while the device was locked for %d ms\n",
+            locked_ms, LOCK_HOLD_MS);
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int failed = 0;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    SDL_setenv("SDL_AUDIODRIVER", "disk", 1);
+    if (SDL_Init(SDL_INIT_AUDIO) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize the disk audio driver: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    failed |= run_playback();
+    failed |= run_capture();
+    SDL_Log("Audio queue checks %s\n", failed ? "FAILED" : "passed");
+
+    SDL_Quit();
+    return failed ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
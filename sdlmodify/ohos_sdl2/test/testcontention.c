@@ -0,0 +1,426 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Lock contention microbenchmark.
+
+   1 to 8 threads hammer a mutex (or spinlock) around a critical section of
+   a few increments, then two threads ping-pong through a pair of
+   semaphores, with and without a timeout, and through a condition
+   variable. On POSIX systems the same runs are repeated with the raw
+   pthread primitives, which is what SDL used before the futex backend.
+   If SDL was built with LOCK_PROFILING the collected statistics are
+   printed as JSON at the end. */
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAVE_PTHREAD_BASELINE 1
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <time.h>
+#endif
+
+#define DEFAULT_ITERATIONS  200000
+#define MAX_THREADS         8
+#define PINGPONG_ROUNDS     20000
+
+typedef enum
+{
+    LOCK_SDL_MUTEX,
+    LOCK_SDL_SPINLOCK,
+    LOCK_PTHREAD_MUTEX
+} LockType;
+
+static const char *lock_names[] = { "SDL_mutex", "SDL_SpinLock", "pthread_mutex" };
+
+static int iterations = DEFAULT_ITERATIONS;
+static LockType lock_type;
+static SDL_mutex *mutex;
+static SDL_SpinLock spinlock;
+static volatile int shared_counter;
+static volatile int shared_other;
+#if HAVE_PTHREAD_BASELINE
+static pthread_mutex_t pmutex;
+#endif
+
+static double
+elapsed_ns(Uint64 start)
+{
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000000000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static int SDLCALL
+hammer(void *arg)
+{
+    int i;
+
+    for (i = 0; i < iterations; ++i) {
+        switch (lock_type) {
+        case LOCK_SDL_MUTEX:
+            SDL_LockMutex(mutex);
+            break;
+        case LOCK_SDL_SPINLOCK:
+            SDL_AtomicLock(&spinlock);
+            break;
+#if HAVE_PTHREAD_BASELINE
+        case LOCK_PTHREAD_MUTEX:
+            pthread_mutex_lock(&pmutex);
+            break;
+#endif
+        default:
+            break;
+        }
+
+        /* A critical section of a few tens of nanoseconds */
+        shared_counter = shared_counter + 1;
+        shared_other = shared_other + shared_counter;
+
+        switch (lock_type) {
+        case LOCK_SDL_MUTEX:
+            SDL_UnlockMutex(mutex);
+            break;
+        case LOCK_SDL_SPINLOCK:
+            SDL_AtomicUnlock(&spinlock);
+            break;
+#if HAVE_PTHREAD_BASELINE
+        case LOCK_PTHREAD_MUTEX:
+            pthread_mutex_unlock(&pmutex);
+            break;
+#endif
+        default:
+            break;
+        }
+    }
+    return 0;
+}
+
+static int
+run_lock_pass(LockType type, int num_threads)
+{
+    SDL_Thread *threads[MAX_THREADS];
+    const int total = num_threads * iterations;
+    Uint64 start;
+    double ns;
+    int i;
+
+    lock_type = type;
+    shared_counter = 0;
+    shared_other = 0;
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < num_threads; ++i) {
+        threads[i] = SDL_CreateThread(hammer, "Hammer", NULL);
+    }
+    for (i = 0; i < num_threads; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    ns = elapsed_ns(start);
+
+    SDL_Log("%-14s threads=%d  %7.1f ns per lock/unlock%s\n",
+            lock_names[type], num_threads, ns / total,
+            shared_counter != total ? "  LOST UPDATES" : "");
+    return (shared_counter == total) ? 0 : -1;
+}
+
+/* Semaphore ping-pong: each side waits for its semaphore and posts the other */
+
+static SDL_sem *sem_ping;
+static SDL_sem *sem_pong;
+static Uint32 sem_timeout;
+
+static int SDLCALL
+sem_ponger(void *arg)
+{
+    int i;
+
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        if (SDL_SemWaitTimeout(sem_ping, sem_timeout) != 0) {
+            return -1;
+        }
+        SDL_SemPost(sem_pong);
+    }
+    return 0;
+}
+
+static int
+run_sem_pass(Uint32 timeout)
+{
+    SDL_Thread *thread;
+    Uint64 start;
+    int status = 0;
+    int failed = 0;
+    int i;
+
+    sem_ping = SDL_CreateSemaphore(0);
+    sem_pong = SDL_CreateSemaphore(0);
+    SDL_SetSemaphoreName(sem_ping, "testcontention.sem_ping");
+    SDL_SetSemaphoreName(sem_pong, "testcontention.sem_pong");
+    sem_timeout = timeout;
+
+    start = SDL_GetPerformanceCounter();
+    thread = SDL_CreateThread(sem_ponger, "Ponger", NULL);
+    for (i = 0; i < PINGPONG_ROUNDS && !failed; ++i) {
+        SDL_SemPost(sem_ping);
+        if (SDL_SemWaitTimeout(sem_pong, timeout) != 0) {
+            failed = 1;
+        }
+    }
+    SDL_WaitThread(thread, &status);
+
+    SDL_Log("%-14s %s  %7.1f ns per round trip%s\n", "SDL_sem",
+            timeout == SDL_MUTEX_MAXWAIT ? "wait       " : "wait 100 ms",
+            elapsed_ns(start) / PINGPONG_ROUNDS, (failed || status) ? "  FAILED" : "");
+
+    SDL_DestroySemaphore(sem_ping);
+    SDL_DestroySemaphore(sem_pong);
+    return (failed || status) ? -1 : 0;
+}
+
+/* Condition variable ping-pong: a turn flag handed back and forth */
+
+static SDL_cond *cond;
+static int turn;
+
+static int SDLCALL
+cond_ponger(void *arg)
+{
+    int i;
+
+    SDL_LockMutex(mutex);
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        while (turn != 1) {
+            SDL_CondWait(cond, mutex);
+        }
+        turn = 0;
+        SDL_CondSignal(cond);
+    }
+    SDL_UnlockMutex(mutex);
+    return 0;
+}
+
+static int
+run_cond_pass(void)
+{
+    SDL_Thread *thread;
+    Uint64 start;
+    int i;
+
+    cond = SDL_CreateCond();
+    SDL_SetCondName(cond, "testcontention.cond");
+    turn = 0;
+
+    start = SDL_GetPerformanceCounter();
+    thread = SDL_CreateThread(cond_ponger, "Ponger", NULL);
+    SDL_LockMutex(mutex);
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        turn = 1;
+        SDL_CondSignal(cond);
+        while (turn != 0) {
+            SDL_CondWait(cond, mutex);
+        }
+    }
+    SDL_UnlockMutex(mutex);
+    SDL_WaitThread(thread, NULL);
+
+    SDL_Log("%-14s              %7.1f ns per round trip\n", "SDL_cond", elapsed_ns(start) / PINGPONG_ROUNDS);
+
+    SDL_DestroyCond(cond);
+    return 0;
+}
+
+#if HAVE_PTHREAD_BASELINE
+static sem_t psem_ping;
+static sem_t psem_pong;
+static pthread_cond_t pcond;
+
+static int
+psem_wait(sem_t *sem, SDL_bool timed)
+{
+    if (timed) {
+        /* What SDL_SemWaitTimeout() did: an absolute time on the wall clock */
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += 100 * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000;
+        }
+        return sem_timedwait(sem, &deadline);
+    }
+    return sem_wait(sem);
+}
+
+static int SDLCALL
+psem_ponger(void *arg)
+{
+    const SDL_bool timed = (arg != NULL) ? SDL_TRUE : SDL_FALSE;
+    int i;
+
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        if (psem_wait(&psem_ping, timed) != 0) {
+            return -1;
+        }
+        sem_post(&psem_pong);
+    }
+    return 0;
+}
+
+static void
+run_psem_pass(SDL_bool timed)
+{
+    SDL_Thread *thread;
+    Uint64 start;
+    int i;
+
+    sem_init(&psem_ping, 0, 0);
+    sem_init(&psem_pong, 0, 0);
+
+    start = SDL_GetPerformanceCounter();
+    thread = SDL_CreateThread(psem_ponger, "Ponger", timed ? &psem_ping : NULL);
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        sem_post(&psem_ping);
+        psem_wait(&psem_pong, timed);
+    }
+    SDL_WaitThread(thread, NULL);
+
+    SDL_Log("%-14s %s  %7.1f ns per round trip\n", "sem_t",
+            timed ? "wait 100 ms" : "wait       ", elapsed_ns(start) / PINGPONG_ROUNDS);
+
+    sem_destroy(&psem_ping);
+    sem_destroy(&psem_pong);
+}
+
+static int SDLCALL
+pcond_ponger(void *arg)
+{
+    int i;
+
+    pthread_mutex_lock(&pmutex);
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        while (turn != 1) {
+            pthread_cond_wait(&pcond, &pmutex);
+        }
+        turn = 0;
+        pthread_cond_signal(&pcond);
+    }
+    pthread_mutex_unlock(&pmutex);
+    return 0;
+}
+
+static void
+run_pcond_pass(void)
+{
+    SDL_Thread *thread;
+    Uint64 start;
+    int i;
+
+    pthread_cond_init(&pcond, NULL);
+    turn = 0;
+
+    start = SDL_GetPerformanceCounter();
+    thread = SDL_CreateThread(pcond_ponger, "Ponger", NULL);
+    pthread_mutex_lock(&pmutex);
+    for (i = 0; i < PINGPONG_ROUNDS; ++i) {
+        turn = 1;
+        pthread_cond_signal(&pcond);
+        while (turn != 0) {
+            pthread_cond_wait(&pcond, &pmutex);
+        }
+    }
+    pthread_mutex_unlock(&pmutex);
+    SDL_WaitThread(thread, NULL);
+
+    SDL_Log("%-14s              %7.1f ns per round trip\n", "pthread_cond", elapsed_ns(start) / PINGPONG_ROUNDS);
+
+    pthread_cond_destroy(&pcond);
+}
+#endif /* HAVE_PTHREAD_BASELINE */
+
+int
+main(int argc, char *argv[])
+{
+    char *json;
+    int failed = 0;
+    int threads;
+    int i;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--iterations") == 0 && argv[i + 1]) {
+            iterations = SDL_atoi(argv[++i]);
+            iterations = SDL_max(1, iterations);
+        }
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_Log("%d CPU cores\n", SDL_GetCPUCount());
+
+    mutex = SDL_CreateMutex();
+    SDL_SetMutexName(mutex, "testcontention.mutex");
+#if HAVE_PTHREAD_BASELINE
+    {
+        /* Recursive, like the mutexes SDL's pthread backend creates */
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&pmutex, &attr);
+        pthread_mutexattr_destroy(&attr);
+    }
+#endif
+
+    for (threads = 1; threads <= MAX_THREADS; threads *= 2) {
+        if (run_lock_pass(LOCK_SDL_MUTEX, threads) < 0) {
+            failed = 1;
+        }
+        if (run_lock_pass(LOCK_SDL_SPINLOCK, threads) < 0) {
+            failed = 1;
+        }
+#if HAVE_PTHREAD_BASELINE
+        if (run_lock_pass(LOCK_PTHREAD_MUTEX, threads) < 0) {
+            failed = 1;
+        }
+#endif
+    }
+
+    if (run_sem_pass(SDL_MUTEX_MAXWAIT) < 0 || run_sem_pass(100) < 0) {
+        failed = 1;
+    }
+#if HAVE_PTHREAD_BASELINE
+    run_psem_pass(SDL_FALSE);
+    run_psem_pass(SDL_TRUE);
+#endif
+
+    run_cond_pass();
+#if HAVE_PTHREAD_BASELINE
+    run_pcond_pass();
+    pthread_mutex_destroy(&pmutex);
+#endif
+
+    json = SDL_GetLockStatsJSON();
+    if (json) {
+        printf("%s\n", json);
+        SDL_free(json);
+    }
+
+    SDL_DestroyMutex(mutex);
+    SDL_Quit();
+    return failed;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
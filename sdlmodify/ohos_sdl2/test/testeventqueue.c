@@ -0,0 +1,151 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Event queue contention benchmark.
+
+   1 to 16 producer threads push user events while the main thread drains
+   them with SDL_PeepEvents(), first one SDL_PushEvent() at a time and then
+   in batches with SDL_PushEvents(). Every event carries its producer and a
+   sequence number, so lost, duplicated or reordered events are reported. */
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define DEFAULT_EVENTS  100000
+#define MAX_PRODUCERS   16
+#define PUSH_BATCH      32
+#define PEEP_BATCH      64
+
+static Uint32 event_type;
+static int events_per_producer = DEFAULT_EVENTS;
+static int batch_size = 1;
+static SDL_atomic_t queue_full;
+
+static int SDLCALL
+producer(void *arg)
+{
+    const intptr_t id = (intptr_t)arg;
+    SDL_Event batch[PUSH_BATCH];
+    int sent = 0;
+
+    while (sent < events_per_producer) {
+        const int count = SDL_min(batch_size, events_per_producer - sent);
+        int pushed, i;
+
+        for (i = 0; i < count; ++i) {
+            SDL_zero(batch[i]);
+            batch[i].type = event_type;
+            batch[i].user.code = sent + i;
+            batch[i].user.data1 = (void *)id;
+        }
+        if (count == 1) {
+            pushed = (SDL_PushEvent(&batch[0]) > 0) ? 1 : 0;
+        } else {
+            pushed = SDL_PushEvents(batch, count);
+        }
+        if (pushed <= 0) {
+            /* The queue is full, let the consumer catch up */
+            SDL_AtomicIncRef(&queue_full);
+            SDL_Delay(0);
+            continue;
+        }
+        sent += pushed;
+    }
+    return 0;
+}
+
+static double
+run_pass(int num_producers, int batch)
+{
+    SDL_Thread *threads[MAX_PRODUCERS];
+    int expected[MAX_PRODUCERS];
+    SDL_Event events[PEEP_BATCH];
+    const int total = num_producers * events_per_producer;
+    int received = 0, errors = 0;
+    Uint64 start;
+    double seconds;
+    int i;
+
+    SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+    SDL_AtomicSet(&queue_full, 0);
+    batch_size = batch;
+    SDL_zero(expected);
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < num_producers; ++i) {
+        threads[i] = SDL_CreateThread(producer, "Producer", (void *)(intptr_t)i);
+    }
+    while (received < total) {
+        const int got = SDL_PeepEvents(events, PEEP_BATCH, SDL_GETEVENT, event_type, event_type);
+        if (got <= 0) {
+            SDL_Delay(0);
+            continue;
+        }
+        for (i = 0; i < got; ++i) {
+            const int id = (int)(intptr_t)events[i].user.data1;
+            if (id < 0 || id >= num_producers || events[i].user.code != expected[id]) {
+                ++errors;
+            } else {
+                ++expected[id];
+            }
+        }
+        received += got;
+    }
+    seconds = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+    for (i = 0; i < num_producers; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+
+    SDL_Log("producers=%2d batch=%2d events=%8d time=%8.2f ms  %6.2f Mevents/s  full=%d%s\n",
+            num_producers, batch, total, seconds * 1000.0,
+            seconds > 0.0 ? total / seconds / 1000000.0 : 0.0,
+            SDL_AtomicGet(&queue_full), errors ? "  OUT OF ORDER" : "");
+    return errors ? -1.0 : seconds;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int producers;
+    int failed = 0;
+    int i;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--events") == 0 && argv[i + 1]) {
+            events_per_producer = SDL_atoi(argv[++i]);
+            events_per_producer = SDL_max(1, events_per_producer);
+        }
+    }
+
+    if (SDL_Init(SDL_INIT_EVENTS) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    event_type = SDL_RegisterEvents(1);
+
+    for (producers = 1; producers <= MAX_PRODUCERS; producers *= 2) {
+        if (run_pass(producers, 1) < 0.0) {
+            failed = 1;
+        }
+        if (run_pass(producers, PUSH_BATCH) < 0.0) {
+            failed = 1;
+        }
+    }
+
+    SDL_Quit();
+    return failed;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
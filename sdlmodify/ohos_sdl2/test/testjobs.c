@@ -0,0 +1,233 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Job system scalability benchmark.
+
+   Restarts SDL with 1, 2, 4, ... worker threads up to the number of CPU
+   cores (or --max-threads) and times a compute bound SDL_ParallelFor(),
+   a flood of tiny SDL_RunJob() jobs, jobs waiting on other jobs with
+   SDL_RunJobAfter(), and nested SDL_ParallelFor() calls from inside jobs.
+   Results are checked against a single threaded run. */
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define NUM_ITEMS       (1 << 20)
+#define NUM_SMALL_JOBS  100000
+#define NUM_CHAINS      1000
+#define NUM_NESTED      64
+#define NESTED_ITEMS    4096
+
+static float *items;
+static double frequency;
+static SDL_atomic_t small_jobs_done;
+static SDL_atomic_t chain_errors;
+static SDL_atomic_t nested_sum;
+
+typedef struct
+{
+    SDL_atomic_t first_done;
+} Chain;
+
+static float
+work(int i)
+{
+    float x = (float)i * 0.001f;
+    int j;
+
+    for (j = 0; j < 16; ++j) {
+        x = (float)SDL_sin(x) + (float)SDL_sqrt(x * x + 1.0f);
+    }
+    return x;
+}
+
+static void SDLCALL
+compute(int start, int end, void *data)
+{
+    int i;
+
+    for (i = start; i < end; ++i) {
+        items[i] = work(i);
+    }
+}
+
+static void SDLCALL
+small_job(void *data)
+{
+    SDL_AtomicIncRef(&small_jobs_done);
+}
+
+static void SDLCALL
+chain_first(void *data)
+{
+    Chain *chain = (Chain *)data;
+    SDL_AtomicSet(&chain->first_done, 1);
+}
+
+static void SDLCALL
+chain_second(void *data)
+{
+    Chain *chain = (Chain *)data;
+    if (!SDL_AtomicGet(&chain->first_done)) {
+        SDL_AtomicIncRef(&chain_errors);
+    }
+}
+
+static void SDLCALL
+nested_range(int start, int end, void *data)
+{
+    SDL_AtomicAdd(&nested_sum, end - start);
+}
+
+static void SDLCALL
+nested_job(void *data)
+{
+    SDL_ParallelFor(NESTED_ITEMS, 64, nested_range, NULL);
+}
+
+static double
+elapsed_ms(Uint64 start)
+{
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / frequency;
+}
+
+static int
+run_pass(int num_threads, const float *reference, double *serial_ms)
+{
+    SDL_JobCounter *counter, *first, *second;
+    Chain *chains;
+    Uint64 start;
+    double parallel_ms, small_ms, chain_ms, nested_ms;
+    char hint[16];
+    int mismatches = 0;
+    int failed = 0;
+    int i;
+
+    /* The worker count is read when the workers start */
+    SDL_snprintf(hint, sizeof (hint), "%d", num_threads);
+    SDL_SetHint(SDL_HINT_JOB_THREADS, hint);
+    if (SDL_Init(0) < 0 || SDL_GetJobThreadCount() != num_threads) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't start %d workers: %s\n", num_threads, SDL_GetError());
+        return -1;
+    }
+
+    start = SDL_GetPerformanceCounter();
+    SDL_ParallelFor(NUM_ITEMS, 0, compute, NULL);
+    parallel_ms = elapsed_ms(start);
+    for (i = 0; i < NUM_ITEMS; ++i) {
+        if (items[i] != reference[i]) {
+            ++mismatches;
+        }
+    }
+    if (*serial_ms == 0.0) {
+        *serial_ms = parallel_ms;
+    }
+
+    counter = SDL_CreateJobCounter();
+    SDL_AtomicSet(&small_jobs_done, 0);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < NUM_SMALL_JOBS; ++i) {
+        SDL_RunJob(small_job, NULL, counter);
+    }
+    SDL_WaitJobCounter(counter);
+    small_ms = elapsed_ms(start);
+
+    chains = (Chain *)SDL_calloc(NUM_CHAINS, sizeof (*chains));
+    first = SDL_CreateJobCounter();
+    second = SDL_CreateJobCounter();
+    SDL_AtomicSet(&chain_errors, 0);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < NUM_CHAINS; ++i) {
+        SDL_RunJob(chain_first, &chains[i], first);
+    }
+    for (i = 0; i < NUM_CHAINS; ++i) {
+        SDL_RunJobAfter(first, chain_second, &chains[i], second);
+    }
+    SDL_WaitJobCounter(second);
+    chain_ms = elapsed_ms(start);
+
+    SDL_AtomicSet(&nested_sum, 0);
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < NUM_NESTED; ++i) {
+        SDL_RunJob(nested_job, NULL, counter);
+    }
+    SDL_WaitJobCounter(counter);
+    nested_ms = elapsed_ms(start);
+
+    SDL_Log("threads=%2d  parallel_for=%8.2f ms (x%.2f)  small jobs=%6.2f Mjobs/s  chains=%6.2f ms  nested=%6.2f ms%s%s%s%s\n",
+            num_threads, parallel_ms, *serial_ms / parallel_ms,
+            small_ms > 0.0 ? NUM_SMALL_JOBS / small_ms / 1000.0 : 0.0,
+            chain_ms, nested_ms,
+            mismatches ? "  WRONG RESULTS" : "",
+            SDL_AtomicGet(&small_jobs_done) != NUM_SMALL_JOBS ? "  LOST JOBS" : "",
+            SDL_AtomicGet(&chain_errors) ? "  OUT OF ORDER" : "",
+            SDL_AtomicGet(&nested_sum) != NUM_NESTED * NESTED_ITEMS ? "  NESTED MISMATCH" : "");
+    if (mismatches || SDL_AtomicGet(&small_jobs_done) != NUM_SMALL_JOBS ||
+        SDL_AtomicGet(&chain_errors) || SDL_AtomicGet(&nested_sum) != NUM_NESTED * NESTED_ITEMS) {
+        failed = 1;
+    }
+
+    SDL_DestroyJobCounter(second);
+    SDL_DestroyJobCounter(first);
+    SDL_DestroyJobCounter(counter);
+    SDL_free(chains);
+    SDL_Quit();
+    return failed ? -1 : 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    float *reference;
+    double serial_ms = 0.0;
+    int max_threads = SDL_GetCPUCount();
+    int threads;
+    int failed = 0;
+    int i;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--max-threads") == 0 && argv[i + 1]) {
+            max_threads = SDL_atoi(argv[++i]);
+        }
+    }
+    max_threads = SDL_max(1, max_threads);
+    frequency = (double)SDL_GetPerformanceFrequency();
+
+    items = (float *)SDL_malloc(NUM_ITEMS * sizeof (*items));
+    reference = (float *)SDL_malloc(NUM_ITEMS * sizeof (*reference));
+    if (!items || !reference) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
+        return 1;
+    }
+    for (i = 0; i < NUM_ITEMS; ++i) {
+        reference[i] = work(i);
+    }
+
+    for (threads = 1; ; threads *= 2) {
+        threads = SDL_min(threads, max_threads);
+        if (run_pass(threads, reference, &serial_ms) < 0) {
+            failed = 1;
+        }
+        if (threads == max_threads) {
+            break;
+        }
+    }
+
+    SDL_free(reference);
+    SDL_free(items);
+    return failed;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,425 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Audio mixing check and benchmark.
+
+   Checks that SDL_MixAudioFormat() gives exactly the same results as the
+   plain scalar mixing code for native S16, S32 and F32 at every length,
+   and that SDL_MixAudioSources() matches a double precision reference for
+   every format, with and without soft clipping. Then reports how many
+   voices per millisecond each way of mixing a period gets through. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define BENCH_MS        500
+#define BENCH_FRAMES    1024
+#define BENCH_CHANNELS  2
+#define MAX_SAMPLES     1024
+#define MAX_SOURCES     17
+
+static const SDL_AudioFormat mix_formats[] = {
+    AUDIO_U8, AUDIO_S8, AUDIO_U16LSB, AUDIO_U16MSB, AUDIO_S16LSB, AUDIO_S16MSB,
+    AUDIO_S32LSB, AUDIO_S32MSB, AUDIO_F32LSB, AUDIO_F32MSB
+};
+
+static const int lengths[] = { 1, 3, 7, 8, 15, 16, 17, 255, 256, 257, 1003 };
+static const int volumes[] = { 1, 37, 64, 127, SDL_MIX_MAXVOLUME };
+
+static Uint32 seed = 0x12345678;
+
+static Uint32
+random_u32(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static const char *
+format_name(SDL_AudioFormat format)
+{
+    switch (format) {
+    case AUDIO_U8: return "U8";
+    case AUDIO_S8: return "S8";
+    case AUDIO_U16LSB: return "U16LSB";
+    case AUDIO_U16MSB: return "U16MSB";
+    case AUDIO_S16LSB: return "S16LSB";
+    case AUDIO_S16MSB: return "S16MSB";
+    case AUDIO_S32LSB: return "S32LSB";
+    case AUDIO_S32MSB: return "S32MSB";
+    case AUDIO_F32LSB: return "F32LSB";
+    case AUDIO_F32MSB: return "F32MSB";
+    }
+    return "unknown";
+}
+
+/* Random samples, with a good share of them at or near full scale. Float
+   samples also go past full scale, and with extremes, up to FLT_MAX. */
+static void
+fill_random(Uint8 *buf, SDL_AudioFormat format, int samples, SDL_bool extremes)
+{
+    int i;
+
+    if (SDL_AUDIO_ISFLOAT(format)) {
+        for (i = 0; i < samples; ++i) {
+            float value = ((float) (random_u32() % 30001) - 15000.0f) / 10000.0f;
+            if (extremes && random_u32() % 64 == 0) {
+                value = (random_u32() & 1) ? 3.0e38f : -3.0e38f;
+            }
+            value = SDL_AUDIO_ISBIGENDIAN(format) ? SDL_SwapFloatBE(value) : SDL_SwapFloatLE(value);
+            SDL_memcpy(buf + i * 4, &value, 4);
+        }
+    } else {
+        for (i = 0; i < samples * (SDL_AUDIO_BITSIZE(format) / 8); ++i) {
+            const Uint32 r = random_u32();
+            buf[i] = (r % 8 == 0) ? 0x7F : (r % 8 == 1) ? 0x80 : (Uint8) (r >> 8);
+        }
+    }
+}
+
+/* Normalized to -1.0 - 1.0 for integer formats. */
+static double
+read_sample(const Uint8 *buf, SDL_AudioFormat format, int i)
+{
+    switch (format) {
+    case AUDIO_U8: return ((int) buf[i] - 128) / 128.0;
+    case AUDIO_S8: return ((Sint8) buf[i]) / 128.0;
+    case AUDIO_U16LSB: return ((int) SDL_SwapLE16(((const Uint16 *) buf)[i]) - 32768) / 32768.0;
+    case AUDIO_U16MSB: return ((int) SDL_SwapBE16(((const Uint16 *) buf)[i]) - 32768) / 32768.0;
+    case AUDIO_S16LSB: return ((Sint16) SDL_SwapLE16(((const Uint16 *) buf)[i])) / 32768.0;
+    case AUDIO_S16MSB: return ((Sint16) SDL_SwapBE16(((const Uint16 *) buf)[i])) / 32768.0;
+    case AUDIO_S32LSB: return ((Sint32) SDL_SwapLE32(((const Uint32 *) buf)[i])) / 2147483648.0;
+    case AUDIO_S32MSB: return ((Sint32) SDL_SwapBE32(((const Uint32 *) buf)[i])) / 2147483648.0;
+    case AUDIO_F32LSB: return SDL_SwapFloatLE(((const float *) buf)[i]);
+    case AUDIO_F32MSB: return SDL_SwapFloatBE(((const float *) buf)[i]);
+    }
+    return 0.0;
+}
+
+/* The scalar SDL_MixAudioFormat() code for native formats, to compare against. */
+static void
+reference_mix(Uint8 *dst, const Uint8 *src, SDL_AudioFormat format, int samples, int volume)
+{
+    int i;
+
+    if (format == AUDIO_S16SYS) {
+        Sint16 *dst16 = (Sint16 *) dst;
+        const Sint16 *src16 = (const Sint16 *) src;
+        for (i = 0; i < samples; ++i) {
+            const int sample = dst16[i] + (Sint16) ((src16[i] * volume) / SDL_MIX_MAXVOLUME);
+            dst16[i] = (Sint16) SDL_max(SDL_min(sample, 32767), -32768);
+        }
+    } else if (format == AUDIO_S32SYS) {
+        Sint32 *dst32 = (Sint32 *) dst;
+        const Sint32 *src32 = (const Sint32 *) src;
+        for (i = 0; i < samples; ++i) {
+            const Sint64 sample = dst32[i] + (((Sint64) src32[i] * volume) / SDL_MIX_MAXVOLUME);
+            dst32[i] = (Sint32) SDL_max(SDL_min(sample, SDL_MAX_SINT32), SDL_MIN_SINT32);
+        }
+    } else if (format == AUDIO_F32SYS) {
+        float *dstf = (float *) dst;
+        const float *srcf = (const float *) src;
+        for (i = 0; i < samples; ++i) {
+            const double sample = (double) ((srcf[i] * volume) * (1.0f / SDL_MIX_MAXVOLUME)) + dstf[i];
+            dstf[i] = (float) SDL_max(SDL_min(sample, 3.402823466e+38F), -3.402823466e+38F);
+        }
+    }
+}
+
+static int
+check_mix_format(void)
+{
+    static const SDL_AudioFormat native_formats[] = { AUDIO_S16SYS, AUDIO_S32SYS, AUDIO_F32SYS };
+    Uint8 *dst = (Uint8 *) SDL_malloc(MAX_SAMPLES * 4 * 4);
+    Uint8 *expected = dst + MAX_SAMPLES * 4;
+    Uint8 *src = expected + MAX_SAMPLES * 4;
+    int failed = 0;
+    int f, l, v;
+
+    if (!dst) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory\n");
+        return 1;
+    }
+
+    for (f = 0; f < SDL_arraysize(native_formats); ++f) {
+        const SDL_AudioFormat format = native_formats[f];
+        const int samplesize = SDL_AUDIO_BITSIZE(format) / 8;
+        for (l = 0; l < SDL_arraysize(lengths); ++l) {
+            for (v = 0; v < SDL_arraysize(volumes); ++v) {
+                /* Start one sample in, so nothing is vector aligned */
+                Uint8 *d = dst + samplesize;
+                Uint8 *e = expected + samplesize;
+                const Uint8 *s = src + samplesize;
+
+                fill_random(d, format, lengths[l], SDL_TRUE);
+                fill_random(src + samplesize, format, lengths[l], SDL_TRUE);
+                SDL_memcpy(e, d, lengths[l] * samplesize);
+
+                SDL_MixAudioFormat(d, s, format, lengths[l] * samplesize, volumes[v]);
+                reference_mix(e, s, format, lengths[l], volumes[v]);
+                if (SDL_memcmp(d, e, lengths[l] * samplesize) != 0) {
+                    SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_MixAudioFormat: %s, %d samples at volume %d doesn't match\n",
+                                 format_name(format), lengths[l], volumes[v]);
+                    failed = 1;
+                }
+            }
+        }
+    }
+
+    SDL_free(dst);
+    return failed;
+}
+
+static double
+soft_clip(double sample)
+{
+    const double knee = 0.75;
+    const double magnitude = SDL_fabs(sample);
+
+    if (magnitude > knee) {
+        const double clipped = knee + (1.0 - knee) * (magnitude - knee) / ((1.0 - knee) + (magnitude - knee));
+        return (sample < 0.0) ? -clipped : clipped;
+    }
+    return sample;
+}
+
+static int
+check_mix_sources(SDL_AudioFormat format, int samples, int num_srcs, SDL_bool use_volumes, Uint32 flags)
+{
+    const int samplesize = SDL_AUDIO_BITSIZE(format) / 8;
+    const double scale = SDL_AUDIO_ISFLOAT(format) ? 1.0 : (double) ((Uint32) 1 << (SDL_AUDIO_BITSIZE(format) - 1));
+    /* Float accumulation error, plus a step for ties rounding the other way */
+    const double tolerance = (num_srcs + 2) * 2e-6 + (SDL_AUDIO_ISFLOAT(format) ? 0.0 : 1.0 / scale);
+    static Uint8 bufs[MAX_SOURCES + 1][MAX_SAMPLES * 4 + 4];
+    static Uint8 original[MAX_SAMPLES * 4];
+    const Uint8 *srcs[MAX_SOURCES];
+    int vols[MAX_SOURCES];
+    Uint8 *dst = bufs[MAX_SOURCES] + samplesize;
+    double worst = 0.0;
+    int i, j;
+
+    for (j = 0; j < num_srcs; ++j) {
+        fill_random(bufs[j] + samplesize, format, samples, SDL_FALSE);
+        srcs[j] = bufs[j] + samplesize;
+        vols[j] = (j == 0) ? SDL_MIX_MAXVOLUME : (int) (random_u32() % (SDL_MIX_MAXVOLUME + 1));
+    }
+    fill_random(dst, format, samples, SDL_FALSE);
+    SDL_memcpy(original, dst, samples * samplesize);
+
+    if (SDL_MixAudioSources(dst, srcs, use_volumes ? vols : NULL, num_srcs, format, samples * samplesize, flags) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_MixAudioSources failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    for (i = 0; i < samples; ++i) {
+        double expected = read_sample(original, format, i);
+        for (j = 0; j < num_srcs; ++j) {
+            expected += read_sample(srcs[j], format, i) * (use_volumes ? vols[j] : SDL_MIX_MAXVOLUME) / SDL_MIX_MAXVOLUME;
+        }
+        if (flags & SDL_MIX_SOFTCLIP) {
+            expected = soft_clip(expected);
+        }
+        if (SDL_AUDIO_ISFLOAT(format)) {
+            expected = SDL_max(SDL_min(expected, 1.0), -1.0);
+        } else {
+            expected = SDL_max(SDL_min(expected * scale, scale - 1.0), -scale);
+            expected = SDL_floor(expected + 0.5) / scale;
+        }
+        worst = SDL_max(worst, SDL_fabs(read_sample(dst, format, i) - expected));
+    }
+
+    if (worst > tolerance) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_MixAudioSources: %s, %d samples, %d sources%s%s is off by %g\n",
+                     format_name(format), samples, num_srcs, use_volumes ? "" : ", full volume",
+                     (flags & SDL_MIX_SOFTCLIP) ? ", soft clipped" : "", worst);
+        return 1;
+    }
+    return 0;
+}
+
+/* A single full volume source mixed into silence comes out unchanged. */
+static int
+check_passthrough(SDL_AudioFormat format)
+{
+    const int samplesize = SDL_AUDIO_BITSIZE(format) / 8;
+    static Uint8 src[MAX_SAMPLES * 4];
+    static Uint8 dst[MAX_SAMPLES * 4];
+    const Uint8 *srcs[1];
+
+    srcs[0] = src;
+    fill_random(src, format, MAX_SAMPLES, SDL_FALSE);
+    SDL_memset(dst, SDL_AUDIO_ISSIGNED(format) ? 0x00 : 0x80, sizeof (dst));
+    if (format == AUDIO_U16MSB) {
+        int i;
+        for (i = 0; i < MAX_SAMPLES; ++i) {
+            dst[i * 2 + 1] = 0x00;
+        }
+    } else if (format == AUDIO_U16LSB) {
+        int i;
+        for (i = 0; i < MAX_SAMPLES; ++i) {
+            dst[i * 2] = 0x00;
+        }
+    }
+
+    SDL_MixAudioSources(dst, srcs, NULL, 1, format, MAX_SAMPLES * samplesize, 0);
+    if (SDL_memcmp(dst, src, MAX_SAMPLES * samplesize) != 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_MixAudioSources: %s doesn't pass a single source through\n",
+                     format_name(format));
+        return 1;
+    }
+    return 0;
+}
+
+static int
+run_checks(void)
+{
+    static const int num_srcs[] = { 0, 1, 3, MAX_SOURCES };
+    int failed = check_mix_format();
+    int f, l, n;
+
+    for (f = 0; f < SDL_arraysize(mix_formats); ++f) {
+        const SDL_AudioFormat format = mix_formats[f];
+        for (l = 0; l < SDL_arraysize(lengths); ++l) {
+            for (n = 0; n < SDL_arraysize(num_srcs); ++n) {
+                failed |= check_mix_sources(format, lengths[l], num_srcs[n], SDL_TRUE, 0);
+                failed |= check_mix_sources(format, lengths[l], num_srcs[n], SDL_TRUE, SDL_MIX_SOFTCLIP);
+                failed |= check_mix_sources(format, lengths[l], num_srcs[n], SDL_FALSE, 0);
+            }
+        }
+        if (SDL_AUDIO_BITSIZE(format) <= 16) {
+            failed |= check_passthrough(format);
+        }
+    }
+
+    return failed;
+}
+
+typedef enum
+{
+    BENCH_SCALAR,
+    BENCH_MIXAUDIOFORMAT,
+    BENCH_MIXAUDIOSOURCES
+} BenchMethod;
+
+static double
+bench_mix(SDL_AudioFormat format, int voices, BenchMethod method)
+{
+    const int samples = BENCH_FRAMES * BENCH_CHANNELS;
+    const int len = samples * (SDL_AUDIO_BITSIZE(format) / 8);
+    Uint8 *data = (Uint8 *) SDL_malloc(len * (voices + 1));
+    const Uint8 **srcs = (const Uint8 **) SDL_malloc(voices * sizeof (Uint8 *));
+    int *vols = (int *) SDL_malloc(voices * sizeof (int));
+    Uint8 *dst = data + len * voices;
+    const Uint64 limit = SDL_GetPerformanceFrequency() * BENCH_MS / 1000;
+    Uint64 start, elapsed;
+    int periods = 0;
+    int i;
+
+    if (!data || !srcs || !vols) {
+        SDL_free(data);
+        SDL_free((void *) srcs);
+        SDL_free(vols);
+        return 0.0;
+    }
+
+    for (i = 0; i < voices; ++i) {
+        srcs[i] = data + len * i;
+        vols[i] = SDL_MIX_MAXVOLUME / 4 + i % (SDL_MIX_MAXVOLUME / 2);
+        fill_random(data + len * i, format, samples, SDL_FALSE);
+    }
+
+    start = SDL_GetPerformanceCounter();
+    do {
+        SDL_memset(dst, 0, len);
+        if (method == BENCH_MIXAUDIOSOURCES) {
+            SDL_MixAudioSources(dst, srcs, vols, voices, format, len, 0);
+        } else {
+            for (i = 0; i < voices; ++i) {
+                if (method == BENCH_SCALAR) {
+                    reference_mix(dst, srcs[i], format, samples, vols[i]);
+                } else {
+                    SDL_MixAudioFormat(dst, srcs[i], format, len, vols[i]);
+                }
+            }
+        }
+        ++periods;
+        elapsed = SDL_GetPerformanceCounter() - start;
+    } while (elapsed < limit);
+
+    SDL_free(data);
+    SDL_free((void *) srcs);
+    SDL_free(vols);
+
+    return (double) periods * voices / ((double) elapsed * 1000.0 / SDL_GetPerformanceFrequency());
+}
+
+static void
+run_benchmark(void)
+{
+    static const SDL_AudioFormat bench_formats[] = { AUDIO_S16SYS, AUDIO_S32SYS, AUDIO_F32SYS };
+    static const int voice_counts[] = { 32, 64 };
+    int f, v;
+
+    SDL_Log("Voices of %d frames, %d channels, mixed per millisecond:\n", BENCH_FRAMES, BENCH_CHANNELS);
+    for (f = 0; f < SDL_arraysize(bench_formats); ++f) {
+        for (v = 0; v < SDL_arraysize(voice_counts); ++v) {
+            const SDL_AudioFormat format = bench_formats[f];
+            const int voices = voice_counts[v];
+            SDL_Log("  %s, %d voices: scalar %.0f, SDL_MixAudioFormat %.0f, SDL_MixAudioSources %.0f\n",
+                    format_name(format), voices,
+                    bench_mix(format, voices, BENCH_SCALAR),
+                    bench_mix(format, voices, BENCH_MIXAUDIOFORMAT),
+                    bench_mix(format, voices, BENCH_MIXAUDIOSOURCES));
+        }
+    }
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_bool benchmark = SDL_TRUE;
+    int failed;
+    int i;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--check-only") == 0) {
+            benchmark = SDL_FALSE;
+        } else {
+            SDL_Log("Usage: %s [--check-only]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_Log("SSE2: %d  AVX2: %d  NEON: %d\n", SDL_HasSSE2(), SDL_HasAVX2(), SDL_HasNEON());
+
+    failed = run_checks();
+    SDL_Log("Mixer checks %s\n", failed ? "FAILED" : "passed");
+
+    if (benchmark && !failed) {
+        run_benchmark();
+    }
+
+    SDL_Quit();
+    return failed ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,368 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Audio stream resampler quality check and benchmark.
+
+   For each SDL_HINT_AUDIO_RESAMPLING_MODE setting, resamples two tones
+   (a different one per channel) between common rates through an
+   SDL_AudioStream in odd sized chunks, fits each tone back out of the
+   output and reports what's left over as a signal to noise ratio. When
+   downsampling it also feeds a tone above the output Nyquist frequency and
+   reports how far it was attenuated. Then it reports how much faster than
+   real time the streams run. An odd ratio that falls back to the
+   interpolating resampler is listed for comparison. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define CHECK_SECONDS   1
+#define BENCH_SECONDS   10
+/* Not a power of two, and leaves a partial chunk at the end of every check:
+   SDL_AudioStreamFlush() only pushes out the frames the stream holds back
+   for the resampler when it has a partial chunk staged. */
+#define PUT_FRAMES      999
+#define BENCH_FRAMES    4096
+
+typedef struct
+{
+    int inrate;
+    int outrate;
+} RatePair;
+
+static const RatePair rate_pairs[] = {
+    { 44100, 48000 },
+    { 48000, 44100 },
+    { 22050, 48000 },
+    { 8000, 48000 },
+    { 48000, 16000 },
+    { 96000, 48000 }
+};
+
+/* goes to the interpolating resampler, not checked against the limits. */
+static const RatePair fallback_pair = { 44100, 47999 };
+
+typedef struct
+{
+    const char *hint;
+    double min_snr;         /* dB */
+    double min_rejection;   /* dB */
+} Quality;
+
+static const Quality qualities[] = {
+    { "fast", 50.0, 45.0 },
+    { "medium", 70.0, 65.0 },
+    { "best", 85.0, 80.0 }
+};
+
+static const double tone_freqs[] = { 997.0, 1499.0 };
+
+static void
+make_tones(float *buf, int frames, int chans, int rate, const double *freqs)
+{
+    int i, chan;
+
+    for (i = 0; i < frames; i++) {
+        for (chan = 0; chan < chans; chan++) {
+            buf[i * chans + chan] = (float) (0.5 * SDL_sin(2.0 * M_PI * freqs[chan % 2] * i / rate));
+        }
+    }
+}
+
+/* Puts all of in through a new stream and returns everything that comes out. */
+static float *
+resample(int chans, int inrate, int outrate, const float *in, int inframes, int *outframes)
+{
+    const int framelen = chans * (int) sizeof (float);
+    SDL_AudioStream *stream;
+    float *out;
+    int i, avail;
+
+    stream = SDL_NewAudioStream(AUDIO_F32SYS, chans, inrate, AUDIO_F32SYS, chans, outrate);
+    if (!stream) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create audio stream: %s\n", SDL_GetError());
+        return NULL;
+    }
+
+    for (i = 0; i < inframes; i += PUT_FRAMES) {
+        const int frames = SDL_min(PUT_FRAMES, inframes - i);
+        SDL_AudioStreamPut(stream, in + i * chans, frames * framelen);
+    }
+    SDL_AudioStreamFlush(stream);
+
+    avail = SDL_AudioStreamAvailable(stream);
+    out = (float *) SDL_malloc(avail ? avail : 1);
+    if (out) {
+        *outframes = SDL_AudioStreamGet(stream, out, avail) / framelen;
+    }
+    SDL_FreeAudioStream(stream);
+    return out;
+}
+
+/* Least squares fit of a tone at freq to one channel, skipping the edges.
+   Returns the power of the fitted tone, and of the residual in noise. */
+static double
+fit_tone(const float *buf, int frames, int chans, int chan, int rate, double freq, double *noise)
+{
+    const double w = 2.0 * M_PI * freq / rate;
+    const int skip = rate / 20;
+    double ss = 0.0, cc = 0.0, sc = 0.0, ys = 0.0, yc = 0.0;
+    double a, b, det, signal = 0.0;
+    int i;
+
+    *noise = 0.0;
+    if (frames <= 2 * skip) {
+        return 0.0;
+    }
+
+    for (i = skip; i < frames - skip; i++) {
+        const double s = SDL_sin(w * i), c = SDL_cos(w * i);
+        const double y = buf[i * chans + chan];
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        ys += y * s;
+        yc += y * c;
+    }
+    det = ss * cc - sc * sc;
+    a = (ys * cc - yc * sc) / det;
+    b = (yc * ss - ys * sc) / det;
+
+    for (i = skip; i < frames - skip; i++) {
+        const double fit = a * SDL_sin(w * i) + b * SDL_cos(w * i);
+        const double err = buf[i * chans + chan] - fit;
+        signal += fit * fit;
+        *noise += err * err;
+    }
+    return signal;
+}
+
+static double
+to_db(double ratio)
+{
+    return 10.0 * SDL_log(ratio) / SDL_log(10.0);
+}
+
+/* Worst SNR over both channels, or a negative number if the output is broken. */
+static double
+check_snr(int inrate, int outrate)
+{
+    const int chans = 2;
+    const int inframes = inrate * CHECK_SECONDS;
+    const int expected = (int) ((Sint64) inframes * outrate / inrate);
+    float *in = (float *) SDL_malloc(inframes * chans * sizeof (float));
+    float *out;
+    double worst = 1000.0;
+    int outframes = 0;
+    int chan;
+
+    if (!in) {
+        return -1.0;
+    }
+    make_tones(in, inframes, chans, inrate, tone_freqs);
+    out = resample(chans, inrate, outrate, in, inframes, &outframes);
+    SDL_free(in);
+    if (!out) {
+        return -1.0;
+    }
+
+    if (SDL_abs(outframes - expected) > outrate / 100) {
+        SDL_Log("  %d -> %d Hz: got %d frames, expected %d\n", inrate, outrate, outframes, expected);
+        worst = -1.0;
+    }
+
+    for (chan = 0; chan < chans && worst >= 0.0; chan++) {
+        double noise;
+        const double signal = fit_tone(out, outframes, chans, chan, outrate, tone_freqs[chan], &noise);
+        if (signal < 0.1 * 0.125 * outframes) {
+            SDL_Log("  %d -> %d Hz: channel %d lost its tone\n", inrate, outrate, chan);
+            worst = -1.0;
+        } else {
+            worst = SDL_min(worst, to_db(signal / (noise + 1e-30)));
+        }
+    }
+    SDL_free(out);
+    return worst;
+}
+
+/* How far a tone between the output and input Nyquist frequencies is
+   attenuated, in dB. It sits well clear of the transition band, so this
+   is only checked when the input rate leaves room above it. */
+static double
+check_rejection(int inrate, int outrate)
+{
+    const double freq = outrate * 0.6;
+    const double freqs[2] = { freq, freq };
+    const int inframes = inrate * CHECK_SECONDS;
+    const int skip = outrate / 20;
+    float *in = (float *) SDL_malloc(inframes * sizeof (float));
+    float *out;
+    double power = 0.0;
+    int outframes = 0;
+    int i;
+
+    if (!in) {
+        return -1.0;
+    }
+    make_tones(in, inframes, 1, inrate, freqs);
+    out = resample(1, inrate, outrate, in, inframes, &outframes);
+    SDL_free(in);
+    if (!out || outframes <= 2 * skip) {
+        SDL_free(out);
+        return -1.0;
+    }
+
+    for (i = skip; i < outframes - skip; i++) {
+        power += (double) out[i] * out[i];
+    }
+    SDL_free(out);
+    power /= (outframes - 2 * skip);
+    return -to_db((power + 1e-30) / 0.125);
+}
+
+static int
+run_checks(void)
+{
+    int failed = 0;
+    int q, i;
+
+    for (q = 0; q < (int) SDL_arraysize(qualities); q++) {
+        const Quality *quality = &qualities[q];
+
+        SDL_SetHint(SDL_HINT_AUDIO_RESAMPLING_MODE, quality->hint);
+        SDL_Log("%s quality:\n", quality->hint);
+
+        for (i = 0; i < (int) SDL_arraysize(rate_pairs); i++) {
+            const RatePair *pair = &rate_pairs[i];
+            const double snr = check_snr(pair->inrate, pair->outrate);
+            SDL_bool ok = (snr >= quality->min_snr);
+
+            if (pair->inrate * 0.45 > pair->outrate * 0.6) {
+                const double rejection = check_rejection(pair->inrate, pair->outrate);
+                ok = ok && (rejection >= quality->min_rejection);
+                SDL_Log("  %5d -> %5d Hz: SNR %6.1f dB, alias rejection %6.1f dB %s\n",
+                        pair->inrate, pair->outrate, snr, rejection, ok ? "" : "FAILED");
+            } else {
+                SDL_Log("  %5d -> %5d Hz: SNR %6.1f dB %s\n",
+                        pair->inrate, pair->outrate, snr, ok ? "" : "FAILED");
+            }
+            if (!ok) {
+                failed++;
+            }
+        }
+    }
+
+    SDL_SetHint(SDL_HINT_AUDIO_RESAMPLING_MODE, NULL);
+    SDL_Log("interpolating fallback:\n");
+    SDL_Log("  %5d -> %5d Hz: SNR %6.1f dB\n", fallback_pair.inrate, fallback_pair.outrate,
+            check_snr(fallback_pair.inrate, fallback_pair.outrate));
+
+    return failed;
+}
+
+/* Seconds of audio resampled per second of CPU time. */
+static double
+bench_stream(int chans, int inrate, int outrate)
+{
+    const int framelen = chans * (int) sizeof (float);
+    const int inframes = inrate * BENCH_SECONDS;
+    float *in = (float *) SDL_malloc(inframes * framelen);
+    float *out = (float *) SDL_malloc(BENCH_FRAMES * framelen * 8);
+    SDL_AudioStream *stream = SDL_NewAudioStream(AUDIO_F32SYS, chans, inrate, AUDIO_F32SYS, chans, outrate);
+    Uint64 start, elapsed;
+    int i;
+
+    if (!in || !out || !stream) {
+        SDL_free(in);
+        SDL_free(out);
+        SDL_FreeAudioStream(stream);
+        return 0.0;
+    }
+    make_tones(in, inframes, chans, inrate, tone_freqs);
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < inframes; i += BENCH_FRAMES) {
+        const int frames = SDL_min(BENCH_FRAMES, inframes - i);
+        SDL_AudioStreamPut(stream, in + i * chans, frames * framelen);
+        while (SDL_AudioStreamGet(stream, out, BENCH_FRAMES * framelen * 8) > 0) {
+        }
+    }
+    elapsed = SDL_GetPerformanceCounter() - start;
+
+    SDL_FreeAudioStream(stream);
+    SDL_free(in);
+    SDL_free(out);
+    return BENCH_SECONDS / ((double) elapsed / SDL_GetPerformanceFrequency());
+}
+
+static void
+run_benchmark(void)
+{
+    static const int channel_counts[] = { 1, 2, 6 };
+    int q, i, c;
+
+    for (q = 0; q < (int) SDL_arraysize(qualities); q++) {
+        SDL_SetHint(SDL_HINT_AUDIO_RESAMPLING_MODE, qualities[q].hint);
+        SDL_Log("%s quality, times real time:\n", qualities[q].hint);
+        for (i = 0; i < (int) SDL_arraysize(rate_pairs); i++) {
+            char line[128];
+            int len = SDL_snprintf(line, sizeof (line), "  %5d -> %5d Hz:", rate_pairs[i].inrate, rate_pairs[i].outrate);
+            for (c = 0; c < (int) SDL_arraysize(channel_counts); c++) {
+                const double speed = bench_stream(channel_counts[c], rate_pairs[i].inrate, rate_pairs[i].outrate);
+                len += SDL_snprintf(line + len, sizeof (line) - len, " %d ch %7.0fx", channel_counts[c], speed);
+            }
+            SDL_Log("%s\n", line);
+        }
+    }
+
+    SDL_SetHint(SDL_HINT_AUDIO_RESAMPLING_MODE, NULL);
+    SDL_Log("interpolating fallback, %d -> %d Hz, 2 ch: %.0fx\n", fallback_pair.inrate, fallback_pair.outrate,
+            bench_stream(2, fallback_pair.inrate, fallback_pair.outrate));
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_bool benchmark = SDL_TRUE;
+    int failed;
+    int i;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--check-only") == 0) {
+            benchmark = SDL_FALSE;
+        } else {
+            SDL_Log("Usage: %s [--check-only]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_Log("SSE2: %d  AVX2: %d  NEON: %d\n", SDL_HasSSE2(), SDL_HasAVX2(), SDL_HasNEON());
+
+    failed = run_checks();
+    SDL_Log("Resampler checks %s\n", failed ? "FAILED" : "passed");
+
+    if (benchmark && !failed) {
+        run_benchmark();
+    }
+
+    SDL_Quit();
+    return failed ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
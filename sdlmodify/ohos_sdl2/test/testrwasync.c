@@ -0,0 +1,240 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Benchmark asynchronous RWops reads against plain blocking ones.
+
+   Each chunk of the input is "decoded" (a checksum over it, repeated a few
+   times) after it is read. The blocking pass reads and decodes in turn; the
+   asynchronous pass keeps the next chunks in flight on the I/O threads while
+   the current one is decoded. A third pass does the same through
+   SDL_RWFromReadAhead(), and a last one checks the results match. */
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define DEFAULT_SIZE_MB 32
+#define CHUNK_SIZE      (256 * 1024)
+#define IN_FLIGHT       4
+#define DECODE_PASSES   4
+
+static Uint32
+decode(const Uint8 *data, size_t len)
+{
+    Uint32 hash = 2166136261u;
+    int pass;
+    size_t i;
+
+    for (pass = 0; pass < DECODE_PASSES; ++pass) {
+        for (i = 0; i < len; ++i) {
+            hash = (hash ^ data[i]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+static double
+elapsed(Uint64 start)
+{
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static Uint32
+run_blocking(SDL_RWops *rw, Sint64 size, double *ms)
+{
+    Uint8 *chunk = (Uint8 *)SDL_malloc(CHUNK_SIZE);
+    Uint64 start = SDL_GetPerformanceCounter();
+    Uint32 hash = 0;
+    size_t got;
+
+    SDL_RWseek(rw, 0, RW_SEEK_SET);
+    while ((got = SDL_RWread(rw, chunk, 1, CHUNK_SIZE)) > 0) {
+        hash ^= decode(chunk, got);
+    }
+    *ms = elapsed(start);
+    SDL_free(chunk);
+    (void)size;
+    return hash;
+}
+
+static Uint32
+run_async(SDL_RWops *rw, Sint64 size, double *ms)
+{
+    Uint8 *chunks = (Uint8 *)SDL_malloc(CHUNK_SIZE * IN_FLIGHT);
+    Uint64 start = SDL_GetPerformanceCounter();
+    Sint64 next = 0;
+    Uint32 hash = 0;
+    int in_flight = 0;
+    int i;
+
+    /* Each slot keeps one chunk in flight; completions come back in order
+       because requests on one RWops are serviced one after another. */
+    for (i = 0; i < IN_FLIGHT && next < size; ++i, next += CHUNK_SIZE) {
+        SDL_RWAsyncRead request;
+        request.context = rw;
+        request.offset = next;
+        request.buffer = chunks + i * CHUNK_SIZE;
+        request.size = CHUNK_SIZE;
+        request.callback = NULL;
+        request.userdata = (void *)(intptr_t)i;
+        SDL_RWReadAsync(&request, 1, SDL_RWASYNC_POLL);
+        ++in_flight;
+    }
+    while (in_flight > 0) {
+        SDL_RWAsyncResult result;
+        if (!SDL_RWAsyncWait(&result, -1)) {
+            break;
+        }
+        --in_flight;
+        if (result.status < 0) {
+            SDL_Log("Async read failed: %s\n", SDL_GetError());
+            continue;
+        }
+        hash ^= decode((const Uint8 *)result.buffer, result.completed);
+        if (next < size) {
+            SDL_RWAsyncRead request;
+            request.context = rw;
+            request.offset = next;
+            request.buffer = result.buffer;
+            request.size = CHUNK_SIZE;
+            request.callback = NULL;
+            request.userdata = result.userdata;
+            SDL_RWReadAsync(&request, 1, SDL_RWASYNC_POLL);
+            next += CHUNK_SIZE;
+            ++in_flight;
+        }
+    }
+    *ms = elapsed(start);
+    SDL_free(chunks);
+    return hash;
+}
+
+static Uint32
+run_readahead(SDL_RWops *rw, Sint64 size, double *ms)
+{
+    Uint8 *chunk = (Uint8 *)SDL_malloc(CHUNK_SIZE);
+    Uint64 start = SDL_GetPerformanceCounter();
+    Uint32 hash = 0;
+    SDL_RWops *ahead;
+    size_t got;
+
+    SDL_RWseek(rw, 0, RW_SEEK_SET);
+    ahead = SDL_RWFromReadAhead(rw, CHUNK_SIZE * 2, 0);
+    if (!ahead) {
+        SDL_Log("Couldn't create read-ahead stream: %s\n", SDL_GetError());
+        SDL_free(chunk);
+        *ms = 0.0;
+        return 0;
+    }
+    while ((got = SDL_RWread(ahead, chunk, 1, CHUNK_SIZE)) > 0) {
+        hash ^= decode(chunk, got);
+    }
+    if (SDL_RWtell(ahead) != size) {
+        SDL_Log("Read-ahead stream stopped at %d of %d\n", (int)SDL_RWtell(ahead), (int)size);
+    }
+    SDL_RWclose(ahead);
+    *ms = elapsed(start);
+    SDL_free(chunk);
+    return hash;
+}
+
+static int
+run_all(const char *label, SDL_RWops *rw)
+{
+    const Sint64 size = SDL_RWsize(rw);
+    double blocking_ms, async_ms, ahead_ms;
+    Uint32 blocking, async, ahead;
+
+    blocking = run_blocking(rw, size, &blocking_ms);
+    async = run_async(rw, size, &async_ms);
+    ahead = run_readahead(rw, size, &ahead_ms);
+
+    SDL_Log("%-6s %6.1f MB  blocking %8.2f ms  async %8.2f ms (%.2fx)  read-ahead %8.2f ms (%.2fx)\n",
+            label, size / (1024.0 * 1024.0), blocking_ms,
+            async_ms, async_ms > 0.0 ? blocking_ms / async_ms : 0.0,
+            ahead_ms, ahead_ms > 0.0 ? blocking_ms / ahead_ms : 0.0);
+    if (async != blocking || ahead != blocking) {
+        SDL_Log("%s: checksum mismatch (blocking %08x, async %08x, read-ahead %08x)\n",
+                label, blocking, async, ahead);
+        return 1;
+    }
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    const char *path = "testrwasync.tmp";
+    int size_mb = DEFAULT_SIZE_MB;
+    Uint8 *data;
+    size_t size;
+    size_t i;
+    SDL_RWops *rw;
+    int failed = 0;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < (size_t)argc; ++i) {
+        if (SDL_strcmp(argv[i], "--size") == 0 && argv[i + 1]) {
+            size_mb = SDL_atoi(argv[++i]);
+            size_mb = SDL_max(1, size_mb);
+        } else {
+            path = argv[i];
+        }
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    /* An odd size so the last chunk comes back short. */
+    size = (size_t)size_mb * 1024 * 1024 + 4321;
+    data = (Uint8 *)SDL_malloc(size);
+    if (!data) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory\n");
+        SDL_Quit();
+        return 1;
+    }
+    for (i = 0; i < size; ++i) {
+        data[i] = (Uint8)((i * 2654435761u) >> 13);
+    }
+
+    rw = SDL_RWFromFile(path, "wb");
+    if (!rw || SDL_RWwrite(rw, data, 1, size) != size) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't write %s: %s\n", path, SDL_GetError());
+        SDL_free(data);
+        SDL_Quit();
+        return 1;
+    }
+    SDL_RWclose(rw);
+
+    rw = SDL_RWFromFile(path, "rb");
+    if (rw) {
+        failed |= run_all("file", rw);
+        SDL_RWclose(rw);
+    } else {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open %s: %s\n", path, SDL_GetError());
+        failed = 1;
+    }
+
+    rw = SDL_RWFromConstMem(data, (int)size);
+    failed |= run_all("memory", rw);
+    SDL_RWclose(rw);
+
+    remove(path);
+    SDL_free(data);
+    SDL_Quit();
+    return failed;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,168 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Benchmark loading many assets through SDL_RWFromFile from several threads at
+   once, compared with loading them one at a time behind a global lock (which
+   is what a backend with a single shared file state forces on its callers).
+   On OHOS, relative names that are not in internal storage come from rawfile. */
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define DEFAULT_THREADS 4
+#define DEFAULT_ROUNDS  16
+#define CHUNK_SIZE      (64 * 1024)
+
+static const char *default_files[] = {
+    "sample.bmp", "sample.wav", "icon.bmp", "axis.bmp", "button.bmp", "controllermap.bmp"
+};
+
+static const char **files;
+static int num_files;
+static int rounds = DEFAULT_ROUNDS;
+static SDL_mutex *serialize_lock = NULL;
+static SDL_atomic_t next_job;
+static SDL_atomic_t total_bytes;
+static SDL_atomic_t failures;
+
+static Sint64
+load_file(const char *name)
+{
+    Uint8 *scratch;
+    Sint64 total = 0;
+    size_t got;
+    SDL_RWops *rw = SDL_RWFromFile(name, "rb");
+
+    if (!rw) {
+        return -1;
+    }
+    scratch = (Uint8 *)SDL_malloc(CHUNK_SIZE);
+    if (!scratch) {
+        SDL_RWclose(rw);
+        return -1;
+    }
+    SDL_RWsize(rw);
+    while ((got = SDL_RWread(rw, scratch, 1, CHUNK_SIZE)) > 0 && got != (size_t)-1) {
+        total += got;
+    }
+    SDL_free(scratch);
+    SDL_RWclose(rw);
+    return total;
+}
+
+static int SDLCALL
+loader_thread(void *arg)
+{
+    const int jobs = num_files * rounds;
+    int job;
+
+    (void)arg;
+    while ((job = SDL_AtomicAdd(&next_job, 1)) < jobs) {
+        Sint64 bytes;
+        if (serialize_lock) {
+            SDL_LockMutex(serialize_lock);
+        }
+        bytes = load_file(files[job % num_files]);
+        if (serialize_lock) {
+            SDL_UnlockMutex(serialize_lock);
+        }
+        if (bytes < 0) {
+            SDL_AtomicIncRef(&failures);
+        } else {
+            SDL_AtomicAdd(&total_bytes, (int)bytes);
+        }
+    }
+    return 0;
+}
+
+static double
+run_pass(int num_threads, SDL_bool serialized)
+{
+    SDL_Thread **threads = (SDL_Thread **)SDL_calloc(num_threads, sizeof (SDL_Thread *));
+    Uint64 start;
+    double seconds;
+    int i;
+
+    SDL_AtomicSet(&next_job, 0);
+    SDL_AtomicSet(&total_bytes, 0);
+    SDL_AtomicSet(&failures, 0);
+    serialize_lock = serialized ? SDL_CreateMutex() : NULL;
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < num_threads; ++i) {
+        threads[i] = SDL_CreateThread(loader_thread, "Loader", NULL);
+    }
+    for (i = 0; i < num_threads; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+    seconds = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+
+    if (serialize_lock) {
+        SDL_DestroyMutex(serialize_lock);
+        serialize_lock = NULL;
+    }
+    SDL_free(threads);
+
+    SDL_Log("%-10s threads=%d loads=%d failed=%d bytes=%d time=%.3f ms (%.1f MB/s)\n",
+            serialized ? "serialized" : "concurrent", num_threads, num_files * rounds,
+            SDL_AtomicGet(&failures), SDL_AtomicGet(&total_bytes), seconds * 1000.0,
+            seconds > 0.0 ? (SDL_AtomicGet(&total_bytes) / (1024.0 * 1024.0)) / seconds : 0.0);
+    return seconds;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int num_threads = DEFAULT_THREADS;
+    int i;
+    double serialized, concurrent;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    files = default_files;
+    num_files = SDL_arraysize(default_files);
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--threads") == 0 && argv[i + 1]) {
+            num_threads = SDL_atoi(argv[++i]);
+            num_threads = SDL_max(1, num_threads);
+        } else if (SDL_strcmp(argv[i], "--rounds") == 0 && argv[i + 1]) {
+            rounds = SDL_atoi(argv[++i]);
+            rounds = SDL_max(1, rounds);
+        } else {
+            files = (const char **)&argv[i];
+            num_files = argc - i;
+            break;
+        }
+    }
+
+    /* Warm the page cache so both passes measure the same thing. */
+    for (i = 0; i < num_files; ++i) {
+        if (load_file(files[i]) < 0) {
+            SDL_Log("Couldn't open %s: %s\n", files[i], SDL_GetError());
+        }
+    }
+
+    serialized = run_pass(num_threads, SDL_TRUE);
+    concurrent = run_pass(num_threads, SDL_FALSE);
+    if (concurrent > 0.0) {
+        SDL_Log("concurrent speedup: %.2fx\n", serialized / concurrent);
+    }
+
+    SDL_Quit();
+    return 0;
+}
@@ -0,0 +1,260 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Stretch blit benchmark.
+
+   Times SDL_SoftStretch() and SDL_SoftStretchLinear() for 32, 24 and
+   16-bit formats at a range of scale ratios, and reports destination
+   megapixels per second. Nearest sampling is checked against the original
+   fixed point row copier, and linear filtering against a plain per pixel
+   version of the same math, so the SIMD kernels picked for this CPU must
+   give the same bytes as the C code. */
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define SRC_WIDTH   640
+#define SRC_HEIGHT  480
+#define MIN_PIXELS  (16 * 1024 * 1024)
+
+static const Uint32 formats[] = {
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_ABGR8888,
+    SDL_PIXELFORMAT_RGB888,
+    SDL_PIXELFORMAT_RGB24,
+    SDL_PIXELFORMAT_RGB565,
+    SDL_PIXELFORMAT_ARGB1555,
+    SDL_PIXELFORMAT_ARGB4444
+};
+
+static const float ratios[] = { 0.25f, 0.5f, 0.75f, 1.5f, 2.0f, 3.0f };
+
+static Uint32
+get_pixel(SDL_Surface *surface, int x, int y)
+{
+    const Uint8 *p = (const Uint8 *)surface->pixels + y * surface->pitch + x * surface->format->BytesPerPixel;
+
+    switch (surface->format->BytesPerPixel) {
+    case 2:
+        return *(const Uint16 *)p;
+    case 3:
+        return (Uint32)p[0] | ((Uint32)p[1] << 8) | ((Uint32)p[2] << 16);
+    default:
+        return *(const Uint32 *)p;
+    }
+}
+
+static void
+fill_pattern(SDL_Surface *surface)
+{
+    Uint32 seed = 7;
+    int x, y;
+
+    for (y = 0; y < surface->h; ++y) {
+        Uint8 *row = (Uint8 *)surface->pixels + y * surface->pitch;
+        for (x = 0; x < surface->w * surface->format->BytesPerPixel; ++x) {
+            seed = seed * 1103515245 + 12345;
+            row[x] = (Uint8)(((x + y) & 0x40) ? (seed >> 16) : (x ^ y));
+        }
+    }
+}
+
+/* The original nearest neighbour stepping */
+static int
+check_nearest(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst)
+{
+    const int bpp = src->format->BytesPerPixel;
+    int xinc = (srcrect->w << 16) / dst->w;
+    int yinc = (srcrect->h << 16) / dst->h;
+    int ypos = 0x10000, src_row = srcrect->y - 1;
+    int x, y;
+
+    for (y = 0; y < dst->h; ++y) {
+        int xpos = 0x10000, src_col = srcrect->x - 1;
+        while (ypos >= 0x10000) {
+            ++src_row;
+            ypos -= 0x10000;
+        }
+        for (x = 0; x < dst->w; ++x) {
+            while (xpos >= 0x10000) {
+                ++src_col;
+                xpos -= 0x10000;
+            }
+            if (SDL_memcmp((const Uint8 *)src->pixels + src_row * src->pitch + src_col * bpp,
+                           (const Uint8 *)dst->pixels + y * dst->pitch + x * bpp, bpp) != 0) {
+                return -1;
+            }
+            xpos += xinc;
+        }
+        ypos += yinc;
+    }
+    return 0;
+}
+
+static void
+sample_positions(int src_size, int dst_size, int *index0, int *index1, int *weights)
+{
+    const Sint64 step = ((Sint64)src_size << 16) / dst_size;
+    Sint64 pos = step / 2 - 0x8000;
+    int i;
+
+    for (i = 0; i < dst_size; ++i, pos += step) {
+        const Sint64 p = pos < 0 ? 0 : pos;
+        index0[i] = (int)(p >> 16);
+        weights[i] = (int)((p >> 8) & 0xFF);
+        if (index0[i] >= src_size - 1) {
+            index0[i] = src_size - 1;
+            weights[i] = 0;
+        }
+        index1[i] = SDL_min(index0[i] + 1, src_size - 1);
+    }
+}
+
+static Uint8
+lerp(Uint8 a, Uint8 b, int weight)
+{
+    return (Uint8)((a * (256 - weight) + b * weight + 128) >> 8);
+}
+
+static int
+check_linear(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst)
+{
+    int *x0 = (int *)SDL_malloc(dst->w * 3 * sizeof (int));
+    int *y0 = (int *)SDL_malloc(dst->h * 3 * sizeof (int));
+    int *x1 = x0 + dst->w, *wx = x1 + dst->w;
+    int *y1 = y0 + dst->h, *wy = y1 + dst->h;
+    const Uint32 mask = dst->format->Rmask | dst->format->Gmask | dst->format->Bmask | dst->format->Amask;
+    int x, y, c, failed = 0;
+
+    sample_positions(srcrect->w, dst->w, x0, x1, wx);
+    sample_positions(srcrect->h, dst->h, y0, y1, wy);
+    for (y = 0; y < dst->h && !failed; ++y) {
+        for (x = 0; x < dst->w; ++x) {
+            Uint8 p[4][4], top[4], bottom[4], expected[4];
+            Uint32 pixel;
+            SDL_GetRGBA(get_pixel(src, srcrect->x + x0[x], srcrect->y + y0[y]), src->format, &p[0][0], &p[0][1], &p[0][2], &p[0][3]);
+            SDL_GetRGBA(get_pixel(src, srcrect->x + x1[x], srcrect->y + y0[y]), src->format, &p[1][0], &p[1][1], &p[1][2], &p[1][3]);
+            SDL_GetRGBA(get_pixel(src, srcrect->x + x0[x], srcrect->y + y1[y]), src->format, &p[2][0], &p[2][1], &p[2][2], &p[2][3]);
+            SDL_GetRGBA(get_pixel(src, srcrect->x + x1[x], srcrect->y + y1[y]), src->format, &p[3][0], &p[3][1], &p[3][2], &p[3][3]);
+            for (c = 0; c < 4; ++c) {
+                top[c] = lerp(p[0][c], p[1][c], wx[x]);
+                bottom[c] = lerp(p[2][c], p[3][c], wx[x]);
+                expected[c] = wy[y] ? lerp(top[c], bottom[c], wy[y]) : top[c];
+            }
+            pixel = SDL_MapRGBA(dst->format, expected[0], expected[1], expected[2], expected[3]);
+            /* Only compare the channel bits, padding bits are undefined */
+            if ((get_pixel(dst, x, y) & mask) != (pixel & mask)) {
+                failed = 1;
+                break;
+            }
+        }
+    }
+    SDL_free(x0);
+    SDL_free(y0);
+    return failed ? -1 : 0;
+}
+
+static double
+time_stretch(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, SDL_bool linear)
+{
+    const int iterations = SDL_max(1, MIN_PIXELS / (dst->w * dst->h));
+    Uint64 start = SDL_GetPerformanceCounter();
+    double seconds;
+    int i;
+
+    for (i = 0; i < iterations; ++i) {
+        if (linear) {
+            SDL_SoftStretchLinear(src, srcrect, dst, NULL);
+        } else {
+            SDL_SoftStretch(src, srcrect, dst, NULL);
+        }
+    }
+    seconds = (double)(SDL_GetPerformanceCounter() - start) / (double)SDL_GetPerformanceFrequency();
+    return (double)dst->w * dst->h * iterations / seconds / 1e6;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int failed = 0;
+    int i, j;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_Log("SSE2: %d  AVX2: %d  NEON: %d\n", SDL_HasSSE2(), SDL_HasAVX2(), SDL_HasNEON());
+    SDL_Log("%-10s %6s  %14s  %14s\n", "format", "ratio", "nearest Mpx/s", "linear Mpx/s");
+
+    for (i = 0; i < SDL_arraysize(formats); ++i) {
+        SDL_Surface *src = SDL_CreateRGBSurfaceWithFormat(0, SRC_WIDTH, SRC_HEIGHT, 0, formats[i]);
+        const char *name = SDL_GetPixelFormatName(formats[i]) + 16;
+        SDL_Rect srcrect;
+
+        if (!src) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surface: %s\n", SDL_GetError());
+            failed = 1;
+            continue;
+        }
+        fill_pattern(src);
+        srcrect.x = 3;
+        srcrect.y = 5;
+        srcrect.w = SRC_WIDTH - 6;
+        srcrect.h = SRC_HEIGHT - 10;
+
+        for (j = 0; j < SDL_arraysize(ratios); ++j) {
+            SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(0, (int)(srcrect.w * ratios[j]), (int)(srcrect.h * ratios[j]), 0, formats[i]);
+            const char *result = "";
+            double nearest, linear;
+
+            nearest = time_stretch(src, &srcrect, dst, SDL_FALSE);
+            if (check_nearest(src, &srcrect, dst) < 0) {
+                result = "  NEAREST MISMATCH";
+                failed = 1;
+            }
+            linear = time_stretch(src, &srcrect, dst, SDL_TRUE);
+            if (check_linear(src, &srcrect, dst) < 0) {
+                result = "  LINEAR MISMATCH";
+                failed = 1;
+            }
+            SDL_Log("%-10s %6.2f  %14.1f  %14.1f%s\n", name, ratios[j], nearest, linear, result);
+            SDL_FreeSurface(dst);
+        }
+
+        /* Single pixel wide and high sources */
+        for (j = 0; j < 2; ++j) {
+            SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(0, 37, 29, 0, formats[i]);
+            srcrect.w = j ? 7 : 1;
+            srcrect.h = j ? 1 : 7;
+            SDL_SoftStretch(src, &srcrect, dst, NULL);
+            if (check_nearest(src, &srcrect, dst) < 0) {
+                SDL_Log("%-10s %dx%d source: NEAREST MISMATCH\n", name, srcrect.w, srcrect.h);
+                failed = 1;
+            }
+            SDL_SoftStretchLinear(src, &srcrect, dst, NULL);
+            if (check_linear(src, &srcrect, dst) < 0) {
+                SDL_Log("%-10s %dx%d source: LINEAR MISMATCH\n", name, srcrect.w, srcrect.h);
+                failed = 1;
+            }
+            SDL_FreeSurface(dst);
+        }
+        SDL_FreeSurface(src);
+    }
+
+    SDL_Quit();
+    return failed;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,296 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Tiled software renderer benchmark.
+
+   Draws testsprite2 style frames (bouncing sprites in several blend modes,
+   blended rectangles and points, plus a few lines, scaled and rotated
+   copies that are drawn serially) into ARGB8888 and RGB565 surfaces with
+   the software renderer. The frames are drawn once with
+   SDL_HINT_RENDER_SOFTWARE_TILED off, then again with tiling on and SDL
+   restarted with 1, 2, 4, ... job threads up to the number of CPU cores
+   (or --max-threads). Every frame must match the serial one exactly. */
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define WINDOW_WIDTH    1280
+#define WINDOW_HEIGHT   720
+#define NUM_SPRITES     400
+#define NUM_FRAMES      60
+#define SPRITE_SIZE     48
+
+typedef struct
+{
+    SDL_Rect position;
+    int dx, dy;
+} Sprite;
+
+static Sprite sprites[NUM_SPRITES];
+static Uint32 frame_hashes[NUM_FRAMES];
+static double frequency;
+
+static Uint32
+hash_surface(SDL_Surface *surface)
+{
+    Uint32 hash = 2166136261u;
+    int x, y;
+
+    for (y = 0; y < surface->h; ++y) {
+        const Uint8 *row = (const Uint8 *)surface->pixels + y * surface->pitch;
+        for (x = 0; x < surface->w * surface->format->BytesPerPixel; ++x) {
+            hash = (hash ^ row[x]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+static SDL_Texture *
+create_sprite(SDL_Renderer *renderer, Uint32 format, int access)
+{
+    SDL_Surface *surface;
+    SDL_Texture *texture;
+    int x, y;
+
+    surface = SDL_CreateRGBSurfaceWithFormat(0, SPRITE_SIZE, SPRITE_SIZE, 32, format);
+    if (!surface) {
+        return NULL;
+    }
+    for (y = 0; y < SPRITE_SIZE; ++y) {
+        Uint32 *row = (Uint32 *)((Uint8 *)surface->pixels + y * surface->pitch);
+        for (x = 0; x < SPRITE_SIZE; ++x) {
+            const int cx = x - SPRITE_SIZE / 2, cy = y - SPRITE_SIZE / 2;
+            const int d = cx * cx + cy * cy;
+            const Uint8 alpha = d > (SPRITE_SIZE * SPRITE_SIZE / 4) ? 0 : (Uint8)(255 - d / 3);
+            row[x] = SDL_MapRGBA(surface->format, (Uint8)(x * 5), (Uint8)(y * 5), (Uint8)((x ^ y) * 8), alpha);
+        }
+    }
+    texture = SDL_CreateTexture(renderer, format, access, SPRITE_SIZE, SPRITE_SIZE);
+    if (texture) {
+        SDL_UpdateTexture(texture, NULL, surface->pixels, surface->pitch);
+    }
+    SDL_FreeSurface(surface);
+    return texture;
+}
+
+static void
+reset_sprites(void)
+{
+    Uint32 seed = 1;
+    int i;
+
+    for (i = 0; i < NUM_SPRITES; ++i) {
+        Sprite *sprite = &sprites[i];
+        seed = seed * 1103515245 + 12345;
+        sprite->position.x = (int)((seed >> 8) % (WINDOW_WIDTH - SPRITE_SIZE));
+        seed = seed * 1103515245 + 12345;
+        sprite->position.y = (int)((seed >> 8) % (WINDOW_HEIGHT - SPRITE_SIZE));
+        sprite->position.w = SPRITE_SIZE;
+        sprite->position.h = SPRITE_SIZE;
+        sprite->dx = (int)(seed % 7) - 3;
+        sprite->dy = (int)((seed >> 4) % 7) - 3;
+    }
+}
+
+static void
+draw_frame(SDL_Renderer *renderer, SDL_Texture **textures, int frame)
+{
+    static const SDL_BlendMode modes[] = {
+        SDL_BLENDMODE_BLEND, SDL_BLENDMODE_ADD, SDL_BLENDMODE_MOD, SDL_BLENDMODE_NONE
+    };
+    SDL_Point points[256];
+    SDL_Rect rect, clip;
+    int i;
+
+    SDL_RenderSetViewport(renderer, NULL);
+    SDL_RenderSetClipRect(renderer, NULL);
+    SDL_SetRenderDrawColor(renderer, 0xA0, 0xA0, 0xA0, 0xFF);
+    SDL_RenderClear(renderer);
+
+    /* Background rectangles in every blend mode */
+    for (i = 0; i < 32; ++i) {
+        rect.x = (i * 97 + frame * 3) % WINDOW_WIDTH - 40;
+        rect.y = (i * 53) % WINDOW_HEIGHT - 20;
+        rect.w = 200;
+        rect.h = 120;
+        SDL_SetRenderDrawBlendMode(renderer, modes[i % SDL_arraysize(modes)]);
+        SDL_SetRenderDrawColor(renderer, (Uint8)(i * 8), (Uint8)frame, (Uint8)(255 - i * 8), 0x80);
+        SDL_RenderFillRect(renderer, &rect);
+    }
+
+    /* Bouncing sprites, testsprite2 style */
+    for (i = 0; i < NUM_SPRITES; ++i) {
+        Sprite *sprite = &sprites[i];
+        SDL_Texture *texture = textures[i % 3];
+
+        sprite->position.x += sprite->dx;
+        if (sprite->position.x < -8 || sprite->position.x >= WINDOW_WIDTH - SPRITE_SIZE + 8) {
+            sprite->dx = -sprite->dx;
+        }
+        sprite->position.y += sprite->dy;
+        if (sprite->position.y < -8 || sprite->position.y >= WINDOW_HEIGHT - SPRITE_SIZE + 8) {
+            sprite->dy = -sprite->dy;
+        }
+        SDL_SetTextureBlendMode(texture, modes[(i / 3) % SDL_arraysize(modes)]);
+        SDL_SetTextureColorMod(texture, 0xFF, (Uint8)(0xFF - i % 64), 0xFF);
+        SDL_SetTextureAlphaMod(texture, (i % 5) ? 0xFF : 0x80);
+        SDL_RenderCopy(renderer, texture, NULL, &sprite->position);
+    }
+
+    /* Points under a clip rect in a viewport */
+    rect.x = 100;
+    rect.y = 50;
+    rect.w = WINDOW_WIDTH - 200;
+    rect.h = WINDOW_HEIGHT - 100;
+    SDL_RenderSetViewport(renderer, &rect);
+    clip.x = 20;
+    clip.y = 20;
+    clip.w = rect.w - 40;
+    clip.h = rect.h - 40;
+    SDL_RenderSetClipRect(renderer, &clip);
+    for (i = 0; i < SDL_arraysize(points); ++i) {
+        points[i].x = (i * 37 + frame * 11) % rect.w;
+        points[i].y = (i * 91 + frame * 7) % rect.h;
+    }
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    SDL_SetRenderDrawColor(renderer, 0xFF, 0xFF, 0x00, 0xFF);
+    SDL_RenderDrawPoints(renderer, points, SDL_arraysize(points));
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0x00, 0xFF, 0xFF, 0x60);
+    SDL_RenderDrawPoints(renderer, points, SDL_arraysize(points) / 2);
+
+    /* Serial commands in between tiled ones */
+    SDL_RenderDrawLine(renderer, 0, 0, rect.w, rect.h);
+    rect.x = frame * 4;
+    rect.y = 100;
+    rect.w = SPRITE_SIZE * 3;
+    rect.h = SPRITE_SIZE * 2;
+    SDL_RenderCopy(renderer, textures[0], NULL, &rect);
+    SDL_RenderCopyEx(renderer, textures[1], NULL, &rect, frame * 6.0, NULL, SDL_FLIP_NONE);
+    rect.y = 300;
+    rect.w = 300;
+    SDL_RenderFillRect(renderer, &rect);
+    SDL_RenderCopy(renderer, textures[2], NULL, &rect);
+
+    SDL_RenderPresent(renderer);
+}
+
+static int
+run_pass(SDL_bool tiled, int num_threads, Uint32 format, double *serial_ms)
+{
+    SDL_Surface *target;
+    SDL_Renderer *renderer;
+    SDL_Texture *textures[3];
+    Uint64 start;
+    double ms;
+    char hint[16];
+    int mismatches = 0;
+    int frame;
+
+    SDL_SetHint(SDL_HINT_RENDER_SOFTWARE_TILED, tiled ? "1" : "0");
+    SDL_snprintf(hint, sizeof (hint), "%d", num_threads);
+    SDL_SetHint(SDL_HINT_JOB_THREADS, hint);
+    if (SDL_Init(0) < 0 || (tiled && SDL_GetJobThreadCount() != num_threads)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't start %d workers: %s\n", num_threads, SDL_GetError());
+        return -1;
+    }
+
+    target = SDL_CreateRGBSurfaceWithFormat(0, WINDOW_WIDTH, WINDOW_HEIGHT, 0, format);
+    renderer = target ? SDL_CreateSoftwareRenderer(target) : NULL;
+    if (!renderer) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create renderer: %s\n", SDL_GetError());
+        SDL_Quit();
+        return -1;
+    }
+    /* Alpha textures, and a static one without alpha that gets RLE encoded */
+    textures[0] = create_sprite(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING);
+    textures[1] = create_sprite(renderer, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STATIC);
+    textures[2] = create_sprite(renderer, SDL_PIXELFORMAT_RGB888, SDL_TEXTUREACCESS_STATIC);
+    if (!textures[0] || !textures[1] || !textures[2]) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create textures: %s\n", SDL_GetError());
+        SDL_Quit();
+        return -1;
+    }
+
+    reset_sprites();
+    start = SDL_GetPerformanceCounter();
+    for (frame = 0; frame < NUM_FRAMES; ++frame) {
+        Uint32 hash;
+
+        draw_frame(renderer, textures, frame);
+        hash = hash_surface(target);
+        if (!tiled) {
+            frame_hashes[frame] = hash;
+        } else if (hash != frame_hashes[frame]) {
+            ++mismatches;
+        }
+    }
+    /* Hashing is the same work in every pass */
+    ms = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / frequency / NUM_FRAMES;
+    if (*serial_ms == 0.0) {
+        *serial_ms = ms;
+    }
+
+    if (tiled) {
+        SDL_Log("%-8s threads=%2d  %7.2f ms/frame (x%.2f)%s\n",
+                SDL_GetPixelFormatName(format) + 16, num_threads, ms, *serial_ms / ms,
+                mismatches ? "  WRONG PIXELS" : "");
+    } else {
+        SDL_Log("%-8s serial      %7.2f ms/frame\n", SDL_GetPixelFormatName(format) + 16, ms);
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(target);
+    SDL_Quit();
+    return mismatches ? -1 : 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const Uint32 formats[] = { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB565 };
+    int max_threads = SDL_GetCPUCount();
+    int failed = 0;
+    int threads;
+    int i;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--max-threads") == 0 && argv[i + 1]) {
+            max_threads = SDL_atoi(argv[++i]);
+        }
+    }
+    max_threads = SDL_max(1, max_threads);
+    frequency = (double)SDL_GetPerformanceFrequency();
+
+    for (i = 0; i < SDL_arraysize(formats); ++i) {
+        double serial_ms = 0.0;
+
+        if (run_pass(SDL_FALSE, 1, formats[i], &serial_ms) < 0) {
+            return 1;
+        }
+        for (threads = 1; ; threads *= 2) {
+            threads = SDL_min(threads, max_threads);
+            if (run_pass(SDL_TRUE, threads, formats[i], &serial_ms) < 0) {
+                failed = 1;
+            }
+            if (threads == max_threads) {
+                break;
+            }
+        }
+    }
+    return failed;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,163 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Timer scheduler benchmark.
+
+   Adds 10k and then 100k one-shot timers with random intervals, removes
+   every fourth one right away, and waits for the rest to fire. Reports the
+   cost of adding and removing a timer and how late the callbacks ran, for
+   SDL_AddTimer() with millisecond intervals and SDL_AddTimerNS() with
+   sub-millisecond ones. */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define MAX_INTERVAL_MS 500
+#define REMOVE_EVERY    4
+
+typedef struct
+{
+    Uint64 due;
+    SDL_TimerID id;
+} TimerInfo;
+
+static double frequency;
+static SDL_atomic_t fired;
+static double total_late;
+static double max_late;
+
+static void
+record_lateness(TimerInfo *info)
+{
+    const double late = (double)(Sint64)(SDL_GetPerformanceCounter() - info->due) * 1000.0 / frequency;
+
+    /* Callbacks all run on the timer thread, only the counter is shared */
+    total_late += late;
+    if (late > max_late) {
+        max_late = late;
+    }
+    SDL_AtomicIncRef(&fired);
+}
+
+static Uint32 SDLCALL
+oneshot(Uint32 interval, void *param)
+{
+    record_lateness((TimerInfo *)param);
+    return 0;
+}
+
+static Uint64 SDLCALL
+oneshot_ns(Uint64 interval, void *param)
+{
+    record_lateness((TimerInfo *)param);
+    return 0;
+}
+
+static int
+run_pass(TimerInfo *timers, int count, SDL_bool nanoseconds)
+{
+    const int to_remove = (count + REMOVE_EVERY - 1) / REMOVE_EVERY;
+    int expected = count;
+    Uint64 start, added, removed;
+    Uint32 deadline;
+    int i;
+
+    SDL_AtomicSet(&fired, 0);
+    total_late = 0.0;
+    max_late = 0.0;
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < count; ++i) {
+        if (nanoseconds) {
+            /* 0.1 ms steps, so most of these aren't whole milliseconds */
+            const Uint64 interval = (Uint64)(1 + rand() % (MAX_INTERVAL_MS * 10)) * 100000;
+            timers[i].due = SDL_GetPerformanceCounter() + (Uint64)(interval * frequency / 1000000000.0);
+            timers[i].id = SDL_AddTimerNS(interval, oneshot_ns, &timers[i]);
+        } else {
+            const Uint32 interval = 1 + rand() % MAX_INTERVAL_MS;
+            timers[i].due = SDL_GetPerformanceCounter() + (Uint64)(interval * frequency / 1000.0);
+            timers[i].id = SDL_AddTimer(interval, oneshot, &timers[i]);
+        }
+        if (!timers[i].id) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't add timer: %s\n", SDL_GetError());
+            return -1;
+        }
+    }
+    added = SDL_GetPerformanceCounter();
+
+    /* The shortest ones may have fired already, those can't be removed */
+    for (i = 0; i < count; i += REMOVE_EVERY) {
+        if (SDL_RemoveTimer(timers[i].id)) {
+            --expected;
+        }
+    }
+    removed = SDL_GetPerformanceCounter();
+
+    deadline = SDL_GetTicks() + MAX_INTERVAL_MS + 5000;
+    while (SDL_AtomicGet(&fired) < expected && !SDL_TICKS_PASSED(SDL_GetTicks(), deadline)) {
+        SDL_Delay(10);
+    }
+
+    SDL_Log("%s timers=%6d  add=%7.1f ns  remove=%7.1f ns  fired=%6d/%d  late avg=%.3f ms max=%.3f ms\n",
+            nanoseconds ? "AddTimerNS" : "AddTimer  ", count,
+            (double)(added - start) * 1000000000.0 / frequency / count,
+            (double)(removed - added) * 1000000000.0 / frequency / to_remove,
+            SDL_AtomicGet(&fired), expected,
+            SDL_AtomicGet(&fired) ? total_late / SDL_AtomicGet(&fired) : 0.0, max_late);
+
+    /* Give anything that shouldn't have fired a chance to show up */
+    SDL_Delay(20);
+    return (SDL_AtomicGet(&fired) == expected) ? 0 : -1;
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const int counts[] = { 10000, 100000 };
+    TimerInfo *timers;
+    int failed = 0;
+    int i;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if (SDL_Init(SDL_INIT_TIMER) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    frequency = (double)SDL_GetPerformanceFrequency();
+    srand(12345);
+
+    timers = (TimerInfo *)SDL_malloc(counts[SDL_arraysize(counts) - 1] * sizeof (*timers));
+    if (!timers) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
+        SDL_Quit();
+        return 1;
+    }
+
+    for (i = 0; i < SDL_arraysize(counts); ++i) {
+        if (run_pass(timers, counts[i], SDL_FALSE) < 0) {
+            failed = 1;
+        }
+        if (run_pass(timers, counts[i], SDL_TRUE) < 0) {
+            failed = 1;
+        }
+    }
+
+    SDL_free(timers);
+    SDL_Quit();
+    return failed;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
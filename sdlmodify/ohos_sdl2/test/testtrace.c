@@ -0,0 +1,176 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Trace recorder test.
+
+   Records a few frames of software rendering and blitting on the main
+   thread while worker threads record nested scopes, instants and
+   counters, then saves the trace (to trace.json, or the file given on the
+   command line) for loading into chrome://tracing or ui.perfetto.dev.
+   Also times the cost of an annotation with and without a running trace. */
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define NUM_THREADS     4
+#define NUM_FRAMES      60
+#define TIMING_ROUNDS   20000
+
+static SDL_atomic_t threads_done;
+
+static int SDLCALL
+worker(void *data)
+{
+    int frame, i;
+
+    for (frame = 0; frame < NUM_FRAMES; ++frame) {
+        SDL_TraceBegin("worker frame");
+        for (i = 0; i < 4; ++i) {
+            SDL_TraceBegin("worker step");
+            SDL_Delay(1);
+            SDL_TraceEnd();
+        }
+        SDL_TraceCounter("worker frame", frame);
+        SDL_TraceEnd();
+    }
+    SDL_TraceInstant("worker done");
+    SDL_AtomicIncRef(&threads_done);
+    return 0;
+}
+
+static void SDLCALL
+fill_rows(int start, int end, void *data)
+{
+    SDL_Surface *surface = (SDL_Surface *)data;
+    SDL_Rect rect;
+
+    rect.x = 0;
+    rect.y = start;
+    rect.w = surface->w;
+    rect.h = end - start;
+    SDL_FillRect(surface, &rect, SDL_MapRGB(surface->format, (Uint8)start, 0x80, 0xFF));
+}
+
+static double
+time_annotations(void)
+{
+    Uint64 start = SDL_GetPerformanceCounter();
+    int i;
+
+    for (i = 0; i < TIMING_ROUNDS; ++i) {
+        SDL_TraceBegin("timing");
+        SDL_TraceEnd();
+    }
+    return (double)(SDL_GetPerformanceCounter() - start) * 1e9 /
+           (double)SDL_GetPerformanceFrequency() / (2.0 * TIMING_ROUNDS);
+}
+
+int
+main(int argc, char *argv[])
+{
+    const char *file = argc > 1 ? argv[1] : "trace.json";
+    SDL_Thread *threads[NUM_THREADS];
+    SDL_Surface *target, *sprite;
+    SDL_Renderer *renderer;
+    double idle_ns, tracing_ns;
+    Sint64 size;
+    SDL_RWops *rw;
+    int frame, i;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    idle_ns = time_annotations();
+
+    target = SDL_CreateRGBSurfaceWithFormat(0, 640, 480, 32, SDL_PIXELFORMAT_ARGB8888);
+    sprite = SDL_CreateRGBSurfaceWithFormat(0, 64, 64, 32, SDL_PIXELFORMAT_ABGR8888);
+    renderer = target ? SDL_CreateSoftwareRenderer(target) : NULL;
+    if (!sprite || !renderer) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create the render target: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    if (SDL_StartTrace() < 0 || !SDL_IsTracing()) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't start the trace: %s\n", SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    tracing_ns = time_annotations();
+
+    for (i = 0; i < NUM_THREADS; ++i) {
+        threads[i] = SDL_CreateThread(worker, "TraceWorker", NULL);
+    }
+
+    for (frame = 0; frame < NUM_FRAMES; ++frame) {
+        SDL_Rect rect;
+
+        SDL_TraceBegin("frame");
+        SDL_ParallelFor(sprite->h, 8, fill_rows, sprite);
+        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0xFF);
+        SDL_RenderClear(renderer);
+        for (i = 0; i < 16; ++i) {
+            rect.x = (frame * 4 + i * 37) % 600;
+            rect.y = (i * 29) % 440;
+            rect.w = 40;
+            rect.h = 40;
+            SDL_SetRenderDrawColor(renderer, (Uint8)(i * 16), (Uint8)frame, 0x40, 0xFF);
+            SDL_RenderFillRect(renderer, &rect);
+        }
+        SDL_RenderPresent(renderer);
+
+        rect.x = frame * 8;
+        rect.y = 100;
+        SDL_BlitSurface(sprite, NULL, target, &rect);
+        SDL_PumpEvents();
+        SDL_TraceEnd();
+    }
+
+    for (i = 0; i < NUM_THREADS; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+    }
+
+    /* Leave one scope open across the stop, the exporter closes it */
+    SDL_TraceBegin("left open");
+    SDL_StopTrace();
+    SDL_TraceEnd();
+
+    if (SDL_SaveTrace(file) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't save %s: %s\n", file, SDL_GetError());
+        SDL_Quit();
+        return 1;
+    }
+
+    rw = SDL_RWFromFile(file, "rb");
+    size = rw ? SDL_RWsize(rw) : -1;
+    if (rw) {
+        SDL_RWclose(rw);
+    }
+
+    SDL_Log("Annotation cost: %.1f ns idle, %.1f ns while tracing\n", idle_ns, tracing_ns);
+    SDL_Log("Saved %s (%" SDL_PRIs64 " bytes), %d worker threads finished\n",
+            file, size, SDL_AtomicGet(&threads_done));
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(sprite);
+    SDL_FreeSurface(target);
+    SDL_Quit();
+    return (size > 0 && SDL_AtomicGet(&threads_done) == NUM_THREADS) ? 0 : 1;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
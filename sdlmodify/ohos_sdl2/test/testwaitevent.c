@@ -0,0 +1,136 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* SDL_WaitEventTimeout() wakeup latency benchmark.
+
+   A second thread pushes user events at random intervals, stamped with
+   the performance counter, while the main thread waits for them. The
+   time from SDL_PushEvent() to SDL_WaitEventTimeout() returning is the
+   wakeup latency. Then a few waits with nothing to deliver check that
+   timeouts are honored. */
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define DEFAULT_WAKEUPS 200
+#define IDLE_WAITS      5
+#define IDLE_TIMEOUT    50
+
+static Uint32 event_type;
+static int num_wakeups = DEFAULT_WAKEUPS;
+
+static int SDLCALL
+pusher(void *arg)
+{
+    int i;
+
+    for (i = 0; i < num_wakeups; ++i) {
+        SDL_Event event;
+
+        /* Give the main thread time to go back to sleep */
+        SDL_Delay(2 + (rand() % 4));
+
+        SDL_zero(event);
+        event.type = event_type;
+        event.user.code = i;
+        event.user.data1 = (void *)(uintptr_t)SDL_GetPerformanceCounter();
+        SDL_PushEvent(&event);
+    }
+    return 0;
+}
+
+static int
+compare_latency(const void *a, const void *b)
+{
+    const double da = *(const double *)a;
+    const double db = *(const double *)b;
+    return (da < db) ? -1 : (da > db) ? 1 : 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    const double freq = (double)SDL_GetPerformanceFrequency();
+    SDL_Thread *thread;
+    double *latency;
+    double total = 0.0;
+    int received = 0;
+    int failed = 0;
+    int i;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--wakeups") == 0 && argv[i + 1]) {
+            num_wakeups = SDL_atoi(argv[++i]);
+            num_wakeups = SDL_max(1, num_wakeups);
+        }
+    }
+
+    if (SDL_Init(SDL_INIT_EVENTS) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    event_type = SDL_RegisterEvents(1);
+
+    latency = (double *)SDL_malloc(num_wakeups * sizeof (*latency));
+    if (!latency) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory!\n");
+        SDL_Quit();
+        return 1;
+    }
+
+    thread = SDL_CreateThread(pusher, "Pusher", NULL);
+    while (received < num_wakeups) {
+        SDL_Event event;
+
+        if (!SDL_WaitEventTimeout(&event, 1000)) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Timed out waiting for event %d\n", received);
+            failed = 1;
+            break;
+        }
+        if (event.type == event_type) {
+            const Uint64 sent = (Uint64)(uintptr_t)event.user.data1;
+            latency[received] = (double)(SDL_GetPerformanceCounter() - sent) * 1000000.0 / freq;
+            total += latency[received];
+            ++received;
+        }
+    }
+    SDL_WaitThread(thread, NULL);
+
+    if (received > 0) {
+        SDL_qsort(latency, received, sizeof (*latency), compare_latency);
+        SDL_Log("wakeups=%d  avg=%.1f us  median=%.1f us  p99=%.1f us  max=%.1f us\n",
+                received, total / received, latency[received / 2],
+                latency[(received * 99) / 100], latency[received - 1]);
+    }
+    SDL_free(latency);
+
+    for (i = 0; i < IDLE_WAITS; ++i) {
+        SDL_Event event;
+        const Uint64 start = SDL_GetPerformanceCounter();
+        const int got = SDL_WaitEventTimeout(&event, IDLE_TIMEOUT);
+        const double waited = (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / freq;
+
+        SDL_Log("idle wait %d: timeout=%d ms  returned after %.2f ms%s\n",
+                i, IDLE_TIMEOUT, waited, got ? " with an event" : "");
+        if (!got && waited < IDLE_TIMEOUT - 1) {
+            failed = 1;
+        }
+    }
+
+    SDL_Quit();
+    return failed;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
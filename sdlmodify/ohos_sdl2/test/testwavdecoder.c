@@ -0,0 +1,520 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Checks SDL_WAVDecoder against SDL_LoadWAV_RW and compares the two.
+
+   For each supported encoding, a WAVE file of random audio data is written
+   to disk. The decoder must return exactly what SDL_LoadWAV_RW returns, with
+   and without SDL_WAV_DECODE_THREADED, for any read size, after seeks into
+   the middle of ADPCM blocks, into an SDL_AudioStream, and for truncated
+   files. The content doesn't matter for this, both decode the same bytes.
+
+   Without --check-only it also loads a three minute track of each encoding
+   and reports the peak memory allocated through SDL, the time until the
+   first sample frames are available, and the time to decode all of it. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define FREQ            44100
+#define CHANNELS        2
+#define ADPCM_BLOCK     1024
+
+#define WAVFILE "testwavdecoder-tmp.wav"
+
+typedef struct
+{
+    const char *name;
+    Uint16 tag;
+    Uint16 bits;
+} WavEncoding;
+
+static const WavEncoding encodings[] = {
+    { "PCM 8-bit",   0x0001, 8 },
+    { "PCM 16-bit",  0x0001, 16 },
+    { "PCM 24-bit",  0x0001, 24 },
+    { "Float 32-bit", 0x0003, 32 },
+    { "A-law",       0x0006, 8 },
+    { "mu-law",      0x0007, 8 },
+    { "MS ADPCM",    0x0002, 4 },
+    { "IMA ADPCM",   0x0011, 4 }
+};
+
+/* Allocations made through SDL, tracked to find the peak. */
+static SDL_atomic_t allocated;
+static SDL_atomic_t peak_allocated;
+
+static void
+track_allocation(int size)
+{
+    const int now = SDL_AtomicAdd(&allocated, size) + size;
+    int peak = SDL_AtomicGet(&peak_allocated);
+    while (now > peak && !SDL_AtomicCAS(&peak_allocated, peak, now)) {
+        peak = SDL_AtomicGet(&peak_allocated);
+    }
+}
+
+/* Each block starts with its size, padded to keep the alignment. */
+static void * SDLCALL
+counting_malloc(size_t size)
+{
+    size_t *mem = (size_t *) malloc(size + 16);
+    if (!mem) {
+        return NULL;
+    }
+    *mem = size;
+    track_allocation((int) size);
+    return (Uint8 *) mem + 16;
+}
+
+static void * SDLCALL
+counting_calloc(size_t nmemb, size_t size)
+{
+    void *mem = counting_malloc(nmemb * size);
+    if (mem) {
+        SDL_memset(mem, 0, nmemb * size);
+    }
+    return mem;
+}
+
+static void * SDLCALL
+counting_realloc(void *ptr, size_t size)
+{
+    size_t *mem = ptr ? (size_t *) ((Uint8 *) ptr - 16) : NULL;
+    const size_t old = mem ? *mem : 0;
+
+    mem = (size_t *) realloc(mem, size + 16);
+    if (!mem) {
+        return NULL;
+    }
+    *mem = size;
+    track_allocation((int) size - (int) old);
+    return (Uint8 *) mem + 16;
+}
+
+static void SDLCALL
+counting_free(void *ptr)
+{
+    if (ptr) {
+        size_t *mem = (size_t *) ((Uint8 *) ptr - 16);
+        track_allocation(-(int) *mem);
+        free(mem);
+    }
+}
+
+static void
+reset_peak(void)
+{
+    SDL_AtomicSet(&peak_allocated, SDL_AtomicGet(&allocated));
+}
+
+static Uint32 random_state = 1;
+
+static Uint32
+next_random(void)
+{
+    random_state = random_state * 1103515245 + 12345;
+    return random_state >> 8;
+}
+
+static Uint16
+samples_per_block(const WavEncoding *enc)
+{
+    if (enc->tag == 0x0002) {
+        return (ADPCM_BLOCK - CHANNELS * 7) * 8 / (4 * CHANNELS) + 2;
+    }
+    return (ADPCM_BLOCK - CHANNELS * 4) * 8 / (4 * CHANNELS) + 1;
+}
+
+/* Random ADPCM data with valid block headers. */
+static void
+fill_adpcm_block(const WavEncoding *enc, Uint8 *block)
+{
+    int i, c;
+
+    for (i = 0; i < ADPCM_BLOCK; ++i) {
+        block[i] = (Uint8) next_random();
+    }
+    for (c = 0; c < CHANNELS; ++c) {
+        if (enc->tag == 0x0002) {
+            const Uint16 delta = 16 + next_random() % 1000;
+            block[c] = (Uint8) (next_random() % 7);
+            block[CHANNELS + c * 2] = (Uint8) delta;
+            block[CHANNELS + c * 2 + 1] = (Uint8) (delta >> 8);
+        } else {
+            block[c * 4 + 2] = (Uint8) (next_random() % 89);
+            block[c * 4 + 3] = 0;
+        }
+    }
+}
+
+/* Writes a WAVE file with the given number of sample frames. The header
+   promises the full data chunk, but the last missing_bytes are left out.
+   factframes goes into the fact chunk. */
+static int
+write_wav(const WavEncoding *enc, Sint64 frames, Uint32 missing_bytes, Uint32 factframes)
+{
+    const SDL_bool adpcm = (enc->tag == 0x0002 || enc->tag == 0x0011);
+    const Uint16 blockalign = adpcm ? ADPCM_BLOCK : enc->bits / 8 * CHANNELS;
+    const Uint16 spb = adpcm ? samples_per_block(enc) : 1;
+    const Uint32 datalen = (Uint32) ((frames + spb - 1) / spb * blockalign);
+    const Uint16 extsize = enc->tag == 0x0002 ? 32 : (enc->tag == 0x0011 ? 2 : 0);
+    const Uint32 fmtlen = 18 + extsize;
+    static const Sint16 coeffs[14] = { 256, 0, 512, -256, 0, 0, 192, 64, 240, 0, 460, -208, 392, -232 };
+    Uint8 block[ADPCM_BLOCK];
+    Uint32 written = 0;
+    SDL_RWops *rw;
+    int i;
+
+    rw = SDL_RWFromFile(WAVFILE, "wb");
+    if (!rw) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create %s: %s\n", WAVFILE, SDL_GetError());
+        return -1;
+    }
+
+    SDL_RWwrite(rw, "RIFF", 4, 1);
+    SDL_WriteLE32(rw, 4 + 8 + fmtlen + 12 + 8 + datalen);
+    SDL_RWwrite(rw, "WAVEfmt ", 8, 1);
+    SDL_WriteLE32(rw, fmtlen);
+    SDL_WriteLE16(rw, enc->tag);
+    SDL_WriteLE16(rw, CHANNELS);
+    SDL_WriteLE32(rw, FREQ);
+    SDL_WriteLE32(rw, (Uint32) ((Uint64) FREQ * blockalign / spb));
+    SDL_WriteLE16(rw, blockalign);
+    SDL_WriteLE16(rw, enc->bits);
+    SDL_WriteLE16(rw, extsize);
+    if (enc->tag == 0x0002) {
+        SDL_WriteLE16(rw, spb);
+        SDL_WriteLE16(rw, 7);
+        for (i = 0; i < 14; ++i) {
+            SDL_WriteLE16(rw, (Uint16) coeffs[i]);
+        }
+    } else if (enc->tag == 0x0011) {
+        SDL_WriteLE16(rw, spb);
+    }
+    SDL_RWwrite(rw, "fact", 4, 1);
+    SDL_WriteLE32(rw, 4);
+    SDL_WriteLE32(rw, factframes);
+    SDL_RWwrite(rw, "data", 4, 1);
+    SDL_WriteLE32(rw, datalen);
+
+    while (written < datalen - missing_bytes) {
+        const Uint32 size = SDL_min((Uint32) sizeof (block), datalen - missing_bytes - written);
+        if (adpcm) {
+            fill_adpcm_block(enc, block);
+        } else {
+            for (i = 0; i < (int) size; ++i) {
+                block[i] = (Uint8) next_random();
+            }
+        }
+        SDL_RWwrite(rw, block, 1, size);
+        written += size;
+    }
+
+    if (SDL_RWclose(rw) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't write %s: %s\n", WAVFILE, SDL_GetError());
+        return -1;
+    }
+    return 0;
+}
+
+static int
+check_decoder(const char *name, Uint32 flags, const SDL_AudioSpec *refspec, const Uint8 *ref, Uint32 reflen)
+{
+    const char *mode = (flags & SDL_WAV_DECODE_THREADED) ? "threaded" : "sync";
+    static const int read_frames[] = { 1, 333, 4096, 10000, 7 };
+    SDL_WAVDecoder *decoder;
+    SDL_AudioStream *stream;
+    SDL_AudioSpec spec;
+    Uint8 *buf;
+    int framesize, got, n, i;
+    Uint32 pos = 0;
+    Sint64 length;
+
+    decoder = SDL_OpenWAVDecoder_RW(SDL_RWFromFile(WAVFILE, "rb"), 1, &spec, flags);
+    if (!decoder) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s, %s: couldn't open decoder: %s\n", name, mode, SDL_GetError());
+        return 1;
+    }
+
+    framesize = SDL_AUDIO_BITSIZE(spec.format) / 8 * spec.channels;
+    length = SDL_GetWAVDecoderLength(decoder);
+    if (spec.format != refspec->format || spec.channels != refspec->channels || spec.freq != refspec->freq) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s, %s: spec differs from SDL_LoadWAV_RW\n", name, mode);
+        SDL_CloseWAVDecoder(decoder);
+        return 1;
+    }
+    if (length * framesize != reflen) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s, %s: %d sample frames, SDL_LoadWAV_RW has %d\n",
+                     name, mode, (int) length, (int) (reflen / framesize));
+        SDL_CloseWAVDecoder(decoder);
+        return 1;
+    }
+
+    buf = (Uint8 *) SDL_malloc(10000 * framesize);
+
+    /* Everything in order, with changing read sizes. */
+    for (i = 0; pos < reflen; ++i) {
+        got = SDL_DecodeWAV(decoder, buf, read_frames[i % SDL_arraysize(read_frames)] * framesize);
+        if (got <= 0 || pos + got > reflen || SDL_memcmp(buf, ref + pos, got) != 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s, %s: wrong data at frame %u (%d)\n",
+                         name, mode, (unsigned int) (pos / framesize), got);
+            goto failed;
+        }
+        pos += got;
+    }
+    if (SDL_DecodeWAV(decoder, buf, framesize) != 0 || SDL_TellWAVDecoder(decoder) != length) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s, %s: no end after the last frame\n", name, mode);
+        goto failed;
+    }
+
+    /* Random seeks, mostly into the middle of ADPCM blocks. */
+    for (i = 0; i < 50; ++i) {
+        const Sint64 frame = (i == 0) ? length : (Sint64) (next_random() % (Uint32) (length + 1));
+        const int want = (int) SDL_min(5000, length - frame) * framesize;
+
+        if (SDL_SeekWAVDecoder(decoder, frame) < 0 || SDL_TellWAVDecoder(decoder) != frame) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s, %s: couldn't seek to %d: %s\n",
+                         name, mode, (int) frame, SDL_GetError());
+            goto failed;
+        }
+        for (pos = 0; pos < (Uint32) want; pos += got) {
+            got = SDL_DecodeWAV(decoder, buf + pos, want - pos);
+            if (got <= 0) {
+                break;
+            }
+        }
+        if (pos != (Uint32) want || SDL_memcmp(buf, ref + frame * framesize, want) != 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s, %s: wrong data after seeking to %d\n", name, mode, (int) frame);
+            goto failed;
+        }
+    }
+
+    /* Into an audio stream without conversion. */
+    stream = SDL_NewAudioStream(spec.format, spec.channels, spec.freq, spec.format, spec.channels, spec.freq);
+    SDL_SeekWAVDecoder(decoder, 0);
+    do {
+        got = SDL_DecodeWAVToStream(decoder, stream, 8192);
+    } while (got > 0);
+    SDL_AudioStreamFlush(stream);
+    for (pos = 0; got == 0 && pos < reflen; pos += n) {
+        n = SDL_AudioStreamGet(stream, buf, 10000 * framesize);
+        if (n <= 0 || pos + n > reflen || SDL_memcmp(buf, ref + pos, n) != 0) {
+            break;
+        }
+    }
+    SDL_FreeAudioStream(stream);
+    if (got != 0 || pos != reflen) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s, %s: wrong data through the audio stream\n", name, mode);
+        goto failed;
+    }
+
+    SDL_free(buf);
+    SDL_CloseWAVDecoder(decoder);
+    return 0;
+
+failed:
+    SDL_free(buf);
+    SDL_CloseWAVDecoder(decoder);
+    return 1;
+}
+
+static int
+check_file(const char *name)
+{
+    SDL_AudioSpec spec;
+    Uint8 *ref = NULL;
+    Uint32 reflen = 0;
+    int failed = 0;
+
+    if (!SDL_LoadWAV(WAVFILE, &spec, &ref, &reflen)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "%s: SDL_LoadWAV failed: %s\n", name, SDL_GetError());
+        return 1;
+    }
+    failed |= check_decoder(name, 0, &spec, ref, reflen);
+    failed |= check_decoder(name, SDL_WAV_DECODE_THREADED, &spec, ref, reflen);
+    SDL_FreeWAV(ref);
+    return failed;
+}
+
+static int
+run_checks(void)
+{
+    const Sint64 frames = FREQ * 3 + 123;
+    char name[64];
+    int failed = 0;
+    int i;
+
+    for (i = 0; i < (int) SDL_arraysize(encodings); ++i) {
+        const WavEncoding *enc = &encodings[i];
+
+        if (write_wav(enc, frames, 0, (Uint32) frames) < 0) {
+            return 1;
+        }
+        failed |= check_file(enc->name);
+
+        /* A fact chunk that ends in the middle of a block. */
+        SDL_SetHint(SDL_HINT_WAVE_FACT_CHUNK, "truncate");
+        SDL_snprintf(name, sizeof (name), "%s, fact chunk", enc->name);
+        failed |= check_file(name);
+        SDL_SetHint(SDL_HINT_WAVE_FACT_CHUNK, NULL);
+
+        /* Missing the end of the last block, with either way to handle it. */
+        if (write_wav(enc, frames, 301, (Uint32) frames) < 0) {
+            return 1;
+        }
+        SDL_snprintf(name, sizeof (name), "%s, truncated", enc->name);
+        failed |= check_file(name);
+        SDL_SetHint(SDL_HINT_WAVE_TRUNCATION, "dropframe");
+        SDL_snprintf(name, sizeof (name), "%s, truncated, dropframe", enc->name);
+        failed |= check_file(name);
+        SDL_SetHint(SDL_HINT_WAVE_TRUNCATION, NULL);
+    }
+
+    remove(WAVFILE);
+    return failed;
+}
+
+typedef struct
+{
+    double first_ms;    /* until the first 4096 sample frames are available */
+    double total_ms;
+    double peak_mb;
+} WavResult;
+
+static int
+bench_load(WavResult *result)
+{
+    const double freq = (double) SDL_GetPerformanceFrequency();
+    const int base = SDL_AtomicGet(&allocated);
+    SDL_AudioSpec spec;
+    Uint8 *buf = NULL;
+    Uint32 len = 0;
+    Uint64 start;
+
+    reset_peak();
+    start = SDL_GetPerformanceCounter();
+    if (!SDL_LoadWAV(WAVFILE, &spec, &buf, &len)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_LoadWAV failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    result->first_ms = result->total_ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / freq;
+    result->peak_mb = (SDL_AtomicGet(&peak_allocated) - base) / (1024.0 * 1024.0);
+    SDL_FreeWAV(buf);
+    return 0;
+}
+
+static int
+bench_decoder(Uint32 flags, WavResult *result)
+{
+    const double freq = (double) SDL_GetPerformanceFrequency();
+    const int base = SDL_AtomicGet(&allocated);
+    SDL_WAVDecoder *decoder;
+    SDL_AudioSpec spec;
+    Uint8 buf[4096 * 8];
+    Uint64 start;
+    int framesize, got;
+
+    reset_peak();
+    start = SDL_GetPerformanceCounter();
+    decoder = SDL_OpenWAVDecoder_RW(SDL_RWFromFile(WAVFILE, "rb"), 1, &spec, flags);
+    if (!decoder) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't open decoder: %s\n", SDL_GetError());
+        return 1;
+    }
+    framesize = SDL_AUDIO_BITSIZE(spec.format) / 8 * spec.channels;
+    got = SDL_DecodeWAV(decoder, buf, 4096 * framesize);
+    result->first_ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / freq;
+    while (got > 0) {
+        got = SDL_DecodeWAV(decoder, buf, 4096 * framesize);
+    }
+    result->total_ms = (SDL_GetPerformanceCounter() - start) * 1000.0 / freq;
+    result->peak_mb = (SDL_AtomicGet(&peak_allocated) - base) / (1024.0 * 1024.0);
+    SDL_CloseWAVDecoder(decoder);
+
+    if (got < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Decoding failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    return 0;
+}
+
+static int
+run_benchmark(void)
+{
+    const Sint64 frames = (Sint64) FREQ * 180;
+    static const char *modes[] = { "SDL_LoadWAV", "decoder", "decoder, threaded" };
+    WavResult result[3];
+    int i, m;
+
+    SDL_Log("Three minutes at %d Hz, %d channels:\n", FREQ, CHANNELS);
+    SDL_Log("  %-13s %-18s %10s %14s %12s\n", "", "", "peak MB", "first frames", "all frames");
+    for (i = 0; i < (int) SDL_arraysize(encodings); ++i) {
+        const WavEncoding *enc = &encodings[i];
+
+        if (write_wav(enc, frames, 0, (Uint32) frames) < 0) {
+            return 1;
+        }
+        if (bench_load(&result[0]) || bench_decoder(0, &result[1]) ||
+            bench_decoder(SDL_WAV_DECODE_THREADED, &result[2])) {
+            return 1;
+        }
+        for (m = 0; m < 3; ++m) {
+            SDL_Log("  %-13s %-18s %10.2f %11.3f ms %9.1f ms\n", m == 0 ? enc->name : "", modes[m],
+                    result[m].peak_mb, result[m].first_ms, result[m].total_ms);
+        }
+    }
+
+    remove(WAVFILE);
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_bool benchmark = SDL_TRUE;
+    int failed;
+    int i;
+
+    SDL_SetMemoryFunctions(counting_malloc, counting_calloc, counting_realloc, counting_free);
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--check-only") == 0) {
+            benchmark = SDL_FALSE;
+        } else {
+            SDL_Log("Usage: %s [--check-only]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    /* Start the job workers now, so they don't count as decoding time. */
+    SDL_GetJobThreadCount();
+
+    failed = run_checks();
+    SDL_Log("WAV decoder checks %s\n", failed ? "FAILED" : "passed");
+    if (!failed && benchmark) {
+        failed = run_benchmark();
+    }
+
+    SDL_Quit();
+    return failed ? 1 : 0;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,399 @@
+/*
+  Copyright (C) 1997-2020 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* YUV conversion check and benchmark.
+
+   Converts random YUV images of odd and even sizes to every RGB format
+   with a fast path, in all three conversion modes, and compares the result
+   with a per pixel version of the fixed point math in yuv2rgb. It also
+   converts between the planar formats and between the packed formats and
+   checks that every sample ends up in the right place. Whichever SIMD
+   kernels this CPU uses must give exactly the same bytes. Then it reports
+   the throughput of each conversion for a 1920x1080 frame. */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "SDL.h"
+
+#define BENCH_WIDTH     1920
+#define BENCH_HEIGHT    1080
+#define BENCH_PIXELS    (64 * 1024 * 1024)
+
+static const Uint32 yuv_formats[] = {
+    SDL_PIXELFORMAT_YV12,
+    SDL_PIXELFORMAT_IYUV,
+    SDL_PIXELFORMAT_NV12,
+    SDL_PIXELFORMAT_NV21,
+    SDL_PIXELFORMAT_YUY2,
+    SDL_PIXELFORMAT_UYVY,
+    SDL_PIXELFORMAT_YVYU
+};
+
+static const Uint32 rgb_formats[] = {
+    SDL_PIXELFORMAT_RGB565,
+    SDL_PIXELFORMAT_RGB24,
+    SDL_PIXELFORMAT_RGBA8888,
+    SDL_PIXELFORMAT_RGBX8888,
+    SDL_PIXELFORMAT_BGRA8888,
+    SDL_PIXELFORMAT_BGRX8888,
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_RGB888,
+    SDL_PIXELFORMAT_ABGR8888,
+    SDL_PIXELFORMAT_BGR888
+};
+
+/* The yuv2rgb matrices, with 6 bits of precision */
+#define V(value) (int)((value * 64) + 0.5)
+
+static const struct
+{
+    SDL_YUV_CONVERSION_MODE mode;
+    const char *name;
+    int y_shift, y_factor, v_r_factor, u_g_factor, v_g_factor, u_b_factor;
+} modes[] = {
+    { SDL_YUV_CONVERSION_JPEG,  "JPEG",  0, V(1.0),    V(1.402),  -V(0.3441), -V(0.7141), V(1.772) },
+    { SDL_YUV_CONVERSION_BT601, "BT601", 16, V(1.1644), V(1.596),  -V(0.3918), -V(0.813),  V(2.0172) },
+    { SDL_YUV_CONVERSION_BT709, "BT709", 16, V(1.1644), V(1.7927), -V(0.2132), -V(0.5329), V(2.1124) }
+};
+
+static const char *
+format_name(Uint32 format)
+{
+    return SDL_GetPixelFormatName(format) + 16;
+}
+
+static SDL_bool
+is_packed(Uint32 format)
+{
+    return (format == SDL_PIXELFORMAT_YUY2 ||
+            format == SDL_PIXELFORMAT_UYVY ||
+            format == SDL_PIXELFORMAT_YVYU);
+}
+
+static int
+yuv_pitch(Uint32 format, int width)
+{
+    /* Leave some padding so the rows aren't contiguous */
+    if (is_packed(format)) {
+        return ((width + 1) / 2) * 4 + 8;
+    }
+    return width + 6;
+}
+
+static size_t
+yuv_size(Uint32 format, int width, int height)
+{
+    const int pitch = yuv_pitch(format, width);
+
+    if (is_packed(format)) {
+        return (size_t)pitch * height;
+    }
+    return (size_t)pitch * height + 2 * ((pitch + 1) / 2) * ((height + 1) / 2);
+}
+
+/* Find the Y, U and V samples used by pixel x, y, following GetYUVPlanes() */
+static void
+get_yuv(Uint32 format, const Uint8 *yuv, int pitch, int height, int x, int y, Uint8 *Y, Uint8 *U, Uint8 *V)
+{
+    const Uint8 *uv_plane = yuv + pitch * height;
+    const int uv_pitch = (pitch + 1) / 2;
+    const Uint8 *p;
+
+    switch (format) {
+    case SDL_PIXELFORMAT_YV12:
+    case SDL_PIXELFORMAT_IYUV:
+        {
+            const Uint8 *first = uv_plane + (y / 2) * uv_pitch + (x / 2);
+            const Uint8 *second = first + uv_pitch * ((height + 1) / 2);
+            *Y = yuv[y * pitch + x];
+            *U = (format == SDL_PIXELFORMAT_IYUV) ? *first : *second;
+            *V = (format == SDL_PIXELFORMAT_IYUV) ? *second : *first;
+        }
+        break;
+    case SDL_PIXELFORMAT_NV12:
+    case SDL_PIXELFORMAT_NV21:
+        p = uv_plane + (y / 2) * 2 * uv_pitch + (x / 2) * 2;
+        *Y = yuv[y * pitch + x];
+        *U = (format == SDL_PIXELFORMAT_NV12) ? p[0] : p[1];
+        *V = (format == SDL_PIXELFORMAT_NV12) ? p[1] : p[0];
+        break;
+    case SDL_PIXELFORMAT_YUY2:
+        p = yuv + y * pitch + (x / 2) * 4;
+        *Y = p[(x & 1) * 2];
+        *U = p[1];
+        *V = p[3];
+        break;
+    case SDL_PIXELFORMAT_UYVY:
+        p = yuv + y * pitch + (x / 2) * 4;
+        *Y = p[1 + (x & 1) * 2];
+        *U = p[0];
+        *V = p[2];
+        break;
+    case SDL_PIXELFORMAT_YVYU:
+        p = yuv + y * pitch + (x / 2) * 4;
+        *Y = p[(x & 1) * 2];
+        *U = p[3];
+        *V = p[1];
+        break;
+    default:
+        *Y = *U = *V = 0;
+        break;
+    }
+}
+
+static Uint8
+clamp_channel(int value)
+{
+    value >>= 6;
+    return (Uint8)((value < 0) ? 0 : (value > 255) ? 255 : value);
+}
+
+static int
+check_yuv_to_rgb(Uint32 yuv_format, const Uint8 *yuv, int width, int height, int mode,
+                 Uint32 rgb_format, const Uint8 *rgb, int rgb_pitch)
+{
+    SDL_PixelFormat *format = SDL_AllocFormat(rgb_format);
+    const int bpp = format->BytesPerPixel;
+    const Uint32 mask = format->Rmask | format->Gmask | format->Bmask | format->Amask;
+    const int pitch = yuv_pitch(yuv_format, width);
+    int x, y, result = 0;
+
+    for (y = 0; y < height && result == 0; ++y) {
+        for (x = 0; x < width; ++x) {
+            const Uint8 *p = rgb + y * rgb_pitch + x * bpp;
+            Uint8 Y, U, V;
+            int y_tmp, u_tmp, v_tmp;
+            Uint8 r, g, b;
+            Uint32 expected, actual;
+
+            get_yuv(yuv_format, yuv, pitch, height, x, y, &Y, &U, &V);
+            y_tmp = (Y - modes[mode].y_shift) * modes[mode].y_factor;
+            u_tmp = U - 128;
+            v_tmp = V - 128;
+            r = clamp_channel(y_tmp + v_tmp * modes[mode].v_r_factor);
+            g = clamp_channel(y_tmp + u_tmp * modes[mode].u_g_factor + v_tmp * modes[mode].v_g_factor);
+            b = clamp_channel(y_tmp + u_tmp * modes[mode].u_b_factor);
+
+            if (bpp == 3) {
+                expected = r | (g << 8) | (b << 16);
+                actual = p[0] | (p[1] << 8) | (p[2] << 16);
+            } else {
+                expected = SDL_MapRGBA(format, r, g, b, 255);
+                actual = (bpp == 2) ? *(const Uint16 *)p : *(const Uint32 *)p;
+                actual &= mask;
+            }
+            if (actual != expected) {
+                SDL_Log("%s -> %s %dx%d %s: pixel %d,%d is 0x%.8x, expected 0x%.8x\n",
+                        format_name(yuv_format), format_name(rgb_format), width, height,
+                        modes[mode].name, x, y, actual, expected);
+                result = -1;
+                break;
+            }
+        }
+    }
+    SDL_FreeFormat(format);
+    return result;
+}
+
+static int
+check_yuv_to_yuv(Uint32 src_format, const Uint8 *src, Uint32 dst_format, const Uint8 *dst, int width, int height)
+{
+    const int src_pitch = yuv_pitch(src_format, width);
+    const int dst_pitch = yuv_pitch(dst_format, width);
+    int x, y;
+
+    for (y = 0; y < height; ++y) {
+        for (x = 0; x < width; ++x) {
+            Uint8 sY, sU, sV, dY, dU, dV;
+
+            get_yuv(src_format, src, src_pitch, height, x, y, &sY, &sU, &sV);
+            get_yuv(dst_format, dst, dst_pitch, height, x, y, &dY, &dU, &dV);
+            if (sY != dY || sU != dU || sV != dV) {
+                SDL_Log("%s -> %s %dx%d: pixel %d,%d is %d,%d,%d, expected %d,%d,%d\n",
+                        format_name(src_format), format_name(dst_format), width, height,
+                        x, y, dY, dU, dV, sY, sU, sV);
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void
+fill_random(Uint8 *buffer, size_t size, SDL_bool saturated)
+{
+    size_t i;
+
+    for (i = 0; i < size; ++i) {
+        /* Extreme values push the colors out of range in both directions */
+        buffer[i] = saturated ? ((rand() & 1) ? 255 : 0) : (Uint8)rand();
+    }
+}
+
+static int
+run_checks(void)
+{
+    int failed = 0;
+    int iteration;
+
+    for (iteration = 0; iteration < 40; ++iteration) {
+        /* Mix sizes below and above the SIMD block sizes, odd and even */
+        const int width = (iteration < 4) ? (1 + iteration) : (1 + rand() % 100);
+        const int height = (iteration < 4) ? (4 - iteration) : (1 + rand() % 7);
+        const int rgb_pitch = width * 4 + 12;
+        Uint8 *rgb = (Uint8 *)SDL_malloc(rgb_pitch * height);
+        int i, j, mode;
+
+        for (i = 0; i < SDL_arraysize(yuv_formats); ++i) {
+            const Uint32 src_format = yuv_formats[i];
+            const size_t size = yuv_size(src_format, width, height);
+            Uint8 *yuv = (Uint8 *)SDL_malloc(size);
+            Uint8 *converted = (Uint8 *)SDL_malloc(2 * size);
+
+            fill_random(yuv, size, (iteration % 3) == 0);
+
+            for (mode = 0; mode < SDL_arraysize(modes); ++mode) {
+                SDL_SetYUVConversionMode(modes[mode].mode);
+                for (j = 0; j < SDL_arraysize(rgb_formats); ++j) {
+                    if (SDL_ConvertPixels(width, height, src_format, yuv, yuv_pitch(src_format, width),
+                                          rgb_formats[j], rgb, rgb_pitch) < 0) {
+                        SDL_Log("Couldn't convert %s -> %s: %s\n", format_name(src_format),
+                                format_name(rgb_formats[j]), SDL_GetError());
+                        failed = 1;
+                    } else if (check_yuv_to_rgb(src_format, yuv, width, height, mode, rgb_formats[j], rgb, rgb_pitch) < 0) {
+                        failed = 1;
+                    }
+                }
+            }
+
+            /* Swizzles between formats with the same chroma layout */
+            for (j = 0; j < SDL_arraysize(yuv_formats); ++j) {
+                const Uint32 dst_format = yuv_formats[j];
+
+                if (dst_format == src_format || is_packed(dst_format) != is_packed(src_format)) {
+                    continue;
+                }
+                if (SDL_ConvertPixels(width, height, src_format, yuv, yuv_pitch(src_format, width),
+                                      dst_format, converted, yuv_pitch(dst_format, width)) < 0) {
+                    SDL_Log("Couldn't convert %s -> %s: %s\n", format_name(src_format),
+                            format_name(dst_format), SDL_GetError());
+                    failed = 1;
+                } else if (check_yuv_to_yuv(src_format, yuv, dst_format, converted, width, height) < 0) {
+                    failed = 1;
+                }
+            }
+            SDL_free(converted);
+            SDL_free(yuv);
+        }
+        SDL_free(rgb);
+    }
+    SDL_SetYUVConversionMode(SDL_YUV_CONVERSION_BT601);
+    return failed;
+}
+
+static double
+time_conversion(Uint32 src_format, const void *src, Uint32 dst_format, void *dst, int dst_pitch)
+{
+    const int iterations = BENCH_PIXELS / (BENCH_WIDTH * BENCH_HEIGHT);
+    Uint64 start, elapsed;
+    int i;
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < iterations; ++i) {
+        SDL_ConvertPixels(BENCH_WIDTH, BENCH_HEIGHT, src_format, src, yuv_pitch(src_format, BENCH_WIDTH),
+                          dst_format, dst, dst_pitch);
+    }
+    elapsed = SDL_GetPerformanceCounter() - start;
+    if (elapsed == 0) {
+        elapsed = 1;
+    }
+    return ((double)iterations * BENCH_WIDTH * BENCH_HEIGHT / 1000000.0) /
+           ((double)elapsed / SDL_GetPerformanceFrequency());
+}
+
+static void
+run_benchmark(void)
+{
+    const int rgb_pitch = BENCH_WIDTH * 4;
+    Uint8 *rgb = (Uint8 *)SDL_malloc(rgb_pitch * BENCH_HEIGHT);
+    Uint8 *yuv = (Uint8 *)SDL_malloc(yuv_size(SDL_PIXELFORMAT_YUY2, BENCH_WIDTH, BENCH_HEIGHT));
+    Uint8 *converted = (Uint8 *)SDL_malloc(yuv_size(SDL_PIXELFORMAT_YUY2, BENCH_WIDTH, BENCH_HEIGHT));
+    int i, j;
+
+    fill_random(yuv, yuv_size(SDL_PIXELFORMAT_YUY2, BENCH_WIDTH, BENCH_HEIGHT), SDL_FALSE);
+
+    SDL_Log("%dx%d, megapixels per second\n", BENCH_WIDTH, BENCH_HEIGHT);
+    for (i = 0; i < SDL_arraysize(yuv_formats); ++i) {
+        char line[256];
+        size_t length;
+
+        length = SDL_snprintf(line, sizeof(line), "%-5s", format_name(yuv_formats[i]));
+        for (j = 0; j < SDL_arraysize(rgb_formats); j += 2) {
+            length += SDL_snprintf(line + length, sizeof(line) - length, "  %s %7.1f",
+                                   format_name(rgb_formats[j]),
+                                   time_conversion(yuv_formats[i], yuv, rgb_formats[j], rgb, rgb_pitch));
+        }
+        SDL_Log("%s\n", line);
+    }
+    for (i = 0; i < SDL_arraysize(yuv_formats); ++i) {
+        for (j = 0; j < SDL_arraysize(yuv_formats); ++j) {
+            if (i == j || is_packed(yuv_formats[i]) != is_packed(yuv_formats[j])) {
+                continue;
+            }
+            SDL_Log("%-5s -> %-5s %7.1f\n", format_name(yuv_formats[i]), format_name(yuv_formats[j]),
+                    time_conversion(yuv_formats[i], yuv, yuv_formats[j], converted, yuv_pitch(yuv_formats[j], BENCH_WIDTH)));
+        }
+    }
+
+    SDL_free(converted);
+    SDL_free(yuv);
+    SDL_free(rgb);
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_bool benchmark = SDL_TRUE;
+    int failed;
+    int i;
+
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--check-only") == 0) {
+            benchmark = SDL_FALSE;
+        } else {
+            SDL_Log("Usage: %s [--check-only]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return 1;
+    }
+    SDL_Log("SSE2: %d  NEON: %d\n", SDL_HasSSE2(), SDL_HasNEON());
+
+    srand(1);
+    failed = run_checks();
+    SDL_Log("Conversion checks %s\n", failed ? "FAILED" : "passed");
+
+    if (benchmark && !failed) {
+        run_benchmark();
+    }
+
+    SDL_Quit();
+    return failed;
+}
+
+/* vi: set ts=4 sw=4 expandtab: */